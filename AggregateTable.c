@@ -0,0 +1,247 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "AggregateTable.h"
+#include "AggregateTable_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+uint64_t AggKeyToSlot(AggregateTable *table, HTKey_t key) {
+  // The splitmix64 finalizer: a cheap bijective mix with full avalanche.
+  uint64_t x = key;
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x & table->mask;
+}
+
+// The value that leaves any other value unchanged under "op".
+static uint64_t Identity(uint32_t op) {
+  return (op == AGG_OP_MIN) ? UINT64_MAX : 0;
+}
+
+// Wait for a slot that another thread has claimed to become ready, and
+// return its (now stable) state.
+static uint32_t WaitUntilReady(AggregateSlot *slot) {
+  uint32_t state;
+  while ((state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE)) ==
+         AGG_SLOT_CLAIMED) {
+  }
+  return state;
+}
+
+// Find key's slot, or claim an empty one for it.  A newly claimed slot is
+// initialized to (key, op, initial) before any other thread can see it.
+//
+// Returns the slot, or NULL if the key is new and every slot is taken.
+// On success, *created reports whether the slot was claimed by this call.
+static AggregateSlot *FindOrClaim(AggregateTable *table, HTKey_t key,
+                                  uint32_t op, uint64_t initial,
+                                  bool *created) {
+  uint64_t i = AggKeyToSlot(table, key);
+  uint64_t probes;
+
+  for (probes = 0; probes <= table->mask; probes++) {
+    AggregateSlot *slot = &table->slots[i];
+    uint32_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+
+    if (state == AGG_SLOT_EMPTY) {
+      if (__atomic_compare_exchange_n(&slot->state, &state, AGG_SLOT_CLAIMED,
+                                      false, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_ACQUIRE)) {
+        slot->key = key;
+        slot->op = op;
+        __atomic_store_n(&slot->value, initial, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->state, AGG_SLOT_READY, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&table->num_elements, 1, __ATOMIC_RELAXED);
+        *created = true;
+        return slot;
+      }
+      // We lost the race for this slot; see what the winner put there.
+    }
+    if (WaitUntilReady(slot) == AGG_SLOT_READY && slot->key == key) {
+      *created = false;
+      return slot;
+    }
+    i = (i + 1) & table->mask;
+  }
+  return NULL;
+}
+
+// Atomically combine "operand" into slot's value with "op".
+static void Combine(AggregateSlot *slot, uint32_t op, uint64_t operand) {
+  uint64_t old;
+
+  if (op == AGG_OP_SUM) {
+    __atomic_fetch_add(&slot->value, operand, __ATOMIC_RELAXED);
+    return;
+  }
+
+  old = __atomic_load_n(&slot->value, __ATOMIC_RELAXED);
+  while ((op == AGG_OP_MIN) ? (operand < old) : (operand > old)) {
+    if (__atomic_compare_exchange_n(&slot->value, &old, operand, true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      return;
+    }
+    // "old" now holds the current value; re-check whether we still win.
+  }
+}
+
+static bool Update(AggregateTable *table, HTKey_t key, uint32_t op,
+                   uint64_t operand) {
+  AggregateSlot *slot;
+  bool created;
+
+  Verify333(table != NULL);
+
+  slot = FindOrClaim(table, key, op, operand, &created);
+  if (slot == NULL) {
+    return false;
+  }
+  if (!created) {
+    // A key's operation is fixed by its first update.
+    Verify333(slot->op == op);
+    Combine(slot, op, operand);
+  }
+  return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AggregateTable implementation.
+
+AggregateTable* AggregateTable_Allocate(int max_keys) {
+  AggregateTable *table;
+  uint64_t num_slots = 2;
+
+  Verify333(max_keys > 0);
+
+  // Keep the table at most half full.
+  while (num_slots < 2 * (uint64_t) max_keys) {
+    num_slots *= 2;
+  }
+
+  table = (AggregateTable *) malloc(sizeof(AggregateTable));
+  Verify333(table != NULL);
+  table->mask = num_slots - 1;
+  table->num_elements = 0;
+  table->slots = (AggregateSlot *) calloc(num_slots, sizeof(AggregateSlot));
+  Verify333(table->slots != NULL);
+  return table;
+}
+
+void AggregateTable_Free(AggregateTable *table) {
+  Verify333(table != NULL);
+  free(table->slots);
+  free(table);
+}
+
+int AggregateTable_NumElements(AggregateTable *table) {
+  Verify333(table != NULL);
+  return __atomic_load_n(&table->num_elements, __ATOMIC_RELAXED);
+}
+
+bool AggregateTable_AddU64(AggregateTable *table, HTKey_t key,
+                           uint64_t delta) {
+  return Update(table, key, AGG_OP_SUM, delta);
+}
+
+bool AggregateTable_MinU64(AggregateTable *table, HTKey_t key,
+                           uint64_t value) {
+  return Update(table, key, AGG_OP_MIN, value);
+}
+
+bool AggregateTable_MaxU64(AggregateTable *table, HTKey_t key,
+                           uint64_t value) {
+  return Update(table, key, AGG_OP_MAX, value);
+}
+
+bool AggregateTable_Find(AggregateTable *table, HTKey_t key,
+                         uint64_t *value) {
+  uint64_t i, probes;
+
+  Verify333(table != NULL);
+  Verify333(value != NULL);
+
+  i = AggKeyToSlot(table, key);
+  for (probes = 0; probes <= table->mask; probes++) {
+    AggregateSlot *slot = &table->slots[i];
+    uint32_t state = WaitUntilReady(slot);
+
+    if (state == AGG_SLOT_EMPTY) {
+      return false;  // keys are never removed, so the probe ends here
+    }
+    if (slot->key == key) {
+      *value = __atomic_load_n(&slot->value, __ATOMIC_RELAXED);
+      return true;
+    }
+    i = (i + 1) & table->mask;
+  }
+  return false;
+}
+
+void AggregateTable_Drain(AggregateTable *table, AggregateDrainFnPtr fn,
+                          void *ctx) {
+  uint64_t i;
+
+  Verify333(table != NULL);
+  Verify333(fn != NULL);
+
+  for (i = 0; i <= table->mask; i++) {
+    AggregateSlot *slot = &table->slots[i];
+    uint64_t identity, value;
+
+    // A slot that is still being claimed holds nothing to collect yet; it
+    // will be picked up by the next drain.
+    if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != AGG_SLOT_READY) {
+      continue;
+    }
+    identity = Identity(slot->op);
+    value = __atomic_exchange_n(&slot->value, identity, __ATOMIC_RELAXED);
+    if (value != identity) {
+      fn(slot->key, value, ctx);
+    }
+  }
+}
+
+bool AggregateTable_Merge(AggregateTable *dst, AggregateTable *src) {
+  bool success = true;
+  uint64_t i;
+
+  Verify333(dst != NULL);
+  Verify333(src != NULL);
+  Verify333(dst != src);
+
+  // The same walk as AggregateTable_Drain, but we need each slot's op to
+  // combine its value into dst.
+  for (i = 0; i <= src->mask; i++) {
+    AggregateSlot *slot = &src->slots[i];
+    uint64_t identity, value;
+
+    if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != AGG_SLOT_READY) {
+      continue;
+    }
+    identity = Identity(slot->op);
+    value = __atomic_exchange_n(&slot->value, identity, __ATOMIC_RELAXED);
+    if (value != identity && !Update(dst, slot->key, slot->op, value)) {
+      success = false;
+    }
+  }
+  return success;
+}
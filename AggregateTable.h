@@ -0,0 +1,149 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_AGGREGATETABLE_H_
+#define HW1_AGGREGATETABLE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HTKey_t
+
+///////////////////////////////////////////////////////////////////////////////
+// An AggregateTable is a concurrent map from HTKey_t keys to 64-bit
+// counters, built for "bump a counter for this key" workloads shared by many
+// threads.
+//
+// Unlike HashTable, the values are stored inline in the table and updated in
+// place with atomic instructions, so an update never allocates and never
+// takes a lock: AggregateTable_AddU64(table, key, 1) replaces the usual
+// lock / HashTable_Find / malloc / HashTable_Insert / unlock sequence.
+//
+// Each key is combined with one operation -- sum, min or max -- fixed by
+// the first update to that key.  Updating a key with a different operation
+// afterward is an error.
+//
+// The table has a fixed capacity chosen at allocation time; it never
+// resizes, so that updates never have to wait for one.  Keys are never
+// removed while the table is shared.  Instead, AggregateTable_Drain
+// periodically collects the values and resets them, which suits
+// counters that are reported once per interval.
+//
+// All functions except AggregateTable_Allocate and AggregateTable_Free may
+// be called concurrently from any number of threads.
+typedef struct agg_table AggregateTable;
+
+// Allocate and return a new AggregateTable.
+//
+// Arguments:
+// - max_keys: the largest number of distinct keys the table must hold;
+//   MUST be greater than zero.  The table reserves roughly twice this many
+//   slots so that probe sequences stay short.
+//
+// Returns a pointer to the newly allocated AggregateTable.
+AggregateTable* AggregateTable_Allocate(int max_keys);
+
+// Free an AggregateTable.  No other thread may be using it.
+//
+// Arguments:
+// - table: the table to free.  It is unsafe to use table after this
+//   function returns.
+void AggregateTable_Free(AggregateTable *table);
+
+// Figure out the number of distinct keys in the table.
+//
+// Arguments:
+// - table: the table to query.
+//
+// Returns:
+// - the number of keys (>= 0).
+int AggregateTable_NumElements(AggregateTable *table);
+
+// Atomically add delta to key's value.  If the key is new, its value
+// starts at delta.
+//
+// Arguments:
+// - table: the table to update.
+// - key: the key whose value to update.
+// - delta: the amount to add; the sum wraps modulo 2^64.
+//
+// Returns:
+// - true on success.
+// - false if key is new and the table has no room for it.
+bool AggregateTable_AddU64(AggregateTable *table, HTKey_t key,
+                           uint64_t delta);
+
+// Atomically lower key's value to value, if value is smaller.  If the key is
+// new, its value starts at value.
+//
+// Arguments and return value: as for AggregateTable_AddU64.
+bool AggregateTable_MinU64(AggregateTable *table, HTKey_t key,
+                           uint64_t value);
+
+// Atomically raise key's value to value, if value is larger.  If the key is
+// new, its value starts at value.
+//
+// Arguments and return value: as for AggregateTable_AddU64.
+bool AggregateTable_MaxU64(AggregateTable *table, HTKey_t key,
+                           uint64_t value);
+
+// Look up key's current value.
+//
+// Arguments:
+// - table: the table to look in.
+// - key: the key to look up.
+// - value: if the key is present, its current value is returned through
+//   this return parameter.
+//
+// Returns:
+// - false: if the key wasn't found.
+// - true: if the key was found.
+bool AggregateTable_Find(AggregateTable *table, HTKey_t key,
+                         uint64_t *value);
+
+// The per-key callback for AggregateTable_Drain.
+//
+// Arguments:
+// - key: the key.
+// - value: the value the key accumulated since the previous drain.
+// - ctx: the caller's context pointer, passed through unchanged.
+typedef void(*AggregateDrainFnPtr)(HTKey_t key, uint64_t value, void *ctx);
+
+// Collect and reset every value in the table.
+//
+// Each key's value is atomically swapped for the identity of its operation
+// (0 for sum and max, UINT64_MAX for min) and, if the old value was not
+// already the identity, passed to fn.  Updates that race with the drain are
+// never lost: each one lands either in the value passed to fn or in the
+// value left behind for the next drain.  Keys stay in the table.
+//
+// Arguments:
+// - table: the table to drain.
+// - fn: invoked once per key with a non-identity value.
+// - ctx: passed through to every invocation of fn.
+void AggregateTable_Drain(AggregateTable *table, AggregateDrainFnPtr fn,
+                          void *ctx);
+
+// Drain src into dst: every value collected from src is combined into the
+// same key in dst with that key's operation.  Typically used to fold
+// per-thread or per-interval tables into a global one.
+//
+// Arguments:
+// - dst: the table to combine into.
+// - src: the table to drain.  Must not be dst.
+//
+// Returns:
+// - true on success.
+// - false if dst ran out of room for a key; that key's value is lost, but
+//   the rest of src is still merged.
+bool AggregateTable_Merge(AggregateTable *dst, AggregateTable *src);
+
+#endif  // HW1_AGGREGATETABLE_H_
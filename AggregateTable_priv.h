@@ -0,0 +1,63 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_AGGREGATETABLE_PRIV_H_
+#define HW1_AGGREGATETABLE_PRIV_H_
+
+#include <stdint.h>  // for uint32_t, etc.
+
+#include "./AggregateTable.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our AggregateTable
+// implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// A slot's life cycle: EMPTY -> CLAIMED (one thread won the race to insert
+// a key here and is writing it) -> READY (key and op are immutable from now
+// on; only value changes).
+#define AGG_SLOT_EMPTY   0
+#define AGG_SLOT_CLAIMED 1
+#define AGG_SLOT_READY   2
+
+// The operation that combines a key's values.
+typedef enum {
+  AGG_OP_SUM = 0,
+  AGG_OP_MIN = 1,
+  AGG_OP_MAX = 2
+} AggregateOp;
+
+// One slot of the open-addressed table.  All fields are accessed with the
+// __atomic builtins once the table is shared.
+typedef struct {
+  HTKey_t  key;
+  uint64_t value;
+  uint32_t state;   // AGG_SLOT_EMPTY, AGG_SLOT_CLAIMED or AGG_SLOT_READY
+  uint32_t op;      // an AggregateOp
+} AggregateSlot;
+
+// The table: a power-of-two array of slots, probed linearly from the
+// (mixed) key.
+typedef struct agg_table {
+  uint64_t       mask;          // num_slots - 1
+  int            num_elements;  // # of READY or CLAIMED slots
+  AggregateSlot *slots;
+} AggregateTable;
+
+// Maps a key to its home slot.  Keys are mixed first so that runs of
+// sequential keys don't form one long probe cluster.
+uint64_t AggKeyToSlot(AggregateTable *table, HTKey_t key);
+
+#endif  // HW1_AGGREGATETABLE_PRIV_H_
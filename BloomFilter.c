@@ -0,0 +1,126 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CSE333.h"
+#include "BloomFilter.h"
+#include "BloomFilter_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+// An odd constant (2^64 / the golden ratio); multiplying by it is a
+// bijection that spreads every bit of its input into the high bits.
+#define BF_MULTIPLIER 0x9e3779b97f4a7c15ULL
+
+// Returns the block that hash's bits go in.  The top 32 bits of the hash
+// pick it, by multiplying rather than by %.
+static inline const uint64_t *BlockFor(const BloomFilter *filter,
+                                       uint64_t hash) {
+  uint64_t b = ((hash >> 32) * filter->num_blocks) >> 32;
+  return filter->blocks + b * BF_BLOCK_WORDS;
+}
+
+// A hash's bits within its block come from the successive products
+// hash * M, hash * M^2, ...: each contributes its top 9 bits.  Every bit of
+// the hash, including the ones that picked the block, feeds each product's
+// top bits.
+static inline int NextProbe(uint64_t *h) {
+  *h *= BF_MULTIPLIER;
+  return (int) (*h >> 55);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BloomFilter implementation.
+
+BloomFilter* BloomFilter_Allocate(uint64_t capacity, double fp_rate) {
+  BloomFilter *filter;
+  double bits_per_hash, num_blocks;
+  size_t size;
+  int k;
+
+  Verify333(capacity > 0);
+  Verify333(fp_rate > 0 && fp_rate <= 0.5);
+
+  // A classic Bloom filter needs log2(1/p) / ln 2 bits per hash and
+  // log2(1/p) probes.  Confining the probes to one block makes the bits
+  // pile up unevenly across blocks, which hurts more the more probes there
+  // are; giving it 1.2% more bits per probe brings the measured rate back
+  // under p for p from 0.5 down to 1e-4.
+  k = (int) (log2(1 / fp_rate) + 0.5);
+  if (k < 1) {
+    k = 1;
+  } else if (k > BF_MAX_PROBES) {
+    k = BF_MAX_PROBES;
+  }
+  bits_per_hash = (1 + 0.012 * log2(1 / fp_rate)) * log2(1 / fp_rate) /
+                  log(2);
+  num_blocks = ceil(capacity * bits_per_hash / BF_BLOCK_BITS);
+  Verify333(num_blocks <= UINT32_MAX);
+
+  filter = (BloomFilter *) malloc(sizeof(BloomFilter));
+  Verify333(filter != NULL);
+  filter->num_blocks = (uint32_t) num_blocks;
+  filter->num_probes = k;
+  size = (size_t) filter->num_blocks * BF_BLOCK_WORDS * sizeof(uint64_t);
+  filter->blocks = (uint64_t *) aligned_alloc(64, size);
+  Verify333(filter->blocks != NULL);
+  memset(filter->blocks, 0, size);
+  return filter;
+}
+
+void BloomFilter_Free(BloomFilter *filter) {
+  Verify333(filter != NULL);
+  free(filter->blocks);
+  free(filter);
+}
+
+void BloomFilter_Add(BloomFilter *filter, uint64_t hash) {
+  uint64_t *block, h = hash;
+  int i;
+
+  Verify333(filter != NULL);
+  block = (uint64_t *) BlockFor(filter, hash);
+  for (i = 0; i < filter->num_probes; i++) {
+    int bit = NextProbe(&h);
+    block[bit / 64] |= 1ULL << (bit % 64);
+  }
+}
+
+bool BloomFilter_MayContain(const BloomFilter *filter, uint64_t hash) {
+  const uint64_t *block;
+  uint64_t h = hash;
+  int i;
+
+  Verify333(filter != NULL);
+  block = BlockFor(filter, hash);
+  for (i = 0; i < filter->num_probes; i++) {
+    int bit = NextProbe(&h);
+    if ((block[bit / 64] & (1ULL << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BloomFilter_Prefetch(const BloomFilter *filter, uint64_t hash) {
+  __builtin_prefetch(BlockFor(filter, hash));
+}
+
+size_t BloomFilter_SizeBytes(const BloomFilter *filter) {
+  Verify333(filter != NULL);
+  return (size_t) filter->num_blocks * BF_BLOCK_WORDS * sizeof(uint64_t);
+}
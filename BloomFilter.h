@@ -0,0 +1,90 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_BLOOMFILTER_H_
+#define HW1_BLOOMFILTER_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for uint64_t, etc.
+
+///////////////////////////////////////////////////////////////////////////////
+// A BloomFilter is a compact, approximate set of 64-bit hashes.  Asking
+// whether it contains a hash that was added always says yes; asking about
+// one that wasn't usually says no, but says yes by mistake with a small
+// probability, the false-positive rate.  A "no" is therefore a definite
+// answer that lets a caller skip a more expensive lookup.
+//
+// This is a blocked Bloom filter: all of a hash's bits fall in a single
+// 64-byte block, so a query touches one cache line, where a classic Bloom
+// filter touches one per bit.  The price is a slightly higher
+// false-positive rate for the same memory, which the sizing makes up for.
+//
+// Hashes can only be added, never removed; to forget some, build a new
+// filter.  The hashes should be well mixed, like the output of the
+// functions in Hash.h -- the filter uses their bits as they are.
+typedef struct bloom_filter BloomFilter;
+
+// Allocate and return a new, empty BloomFilter.
+//
+// Arguments:
+// - capacity: the number of hashes the filter is sized for (> 0).  It
+//   accepts more, but its false-positive rate climbs past fp_rate.
+// - fp_rate: the false-positive rate once capacity hashes are in it, in
+//   (0, 0.5].  Each halving of the rate costs about 1.5 bits per hash.
+//
+// Returns:
+// - the newly-allocated filter, never NULL.
+BloomFilter* BloomFilter_Allocate(uint64_t capacity, double fp_rate);
+
+// Free a BloomFilter.
+//
+// Arguments:
+// - filter: the filter to free.  It is unsafe to use filter after this
+//   function returns.
+void BloomFilter_Free(BloomFilter *filter);
+
+// Add a hash to a BloomFilter.
+//
+// Arguments:
+// - filter: the filter to add to.
+// - hash: the hash to add.
+void BloomFilter_Add(BloomFilter *filter, uint64_t hash);
+
+// Test whether a hash may be in a BloomFilter.
+//
+// Arguments:
+// - filter: the filter to query.
+// - hash: the hash to look for.
+//
+// Returns:
+// - false if hash was definitely never added; true if it was added, or
+//   (with probability about fp_rate) if it wasn't.
+bool BloomFilter_MayContain(const BloomFilter *filter, uint64_t hash);
+
+// Start loading the cache line that BloomFilter_MayContain will read for a
+// hash, so that a caller testing many hashes can overlap the misses.
+//
+// Arguments:
+// - filter: the filter that will be queried.
+// - hash: the hash that will be looked for.
+void BloomFilter_Prefetch(const BloomFilter *filter, uint64_t hash);
+
+// Figure out how much memory a BloomFilter's bits take.
+//
+// Arguments:
+// - filter: the filter to query.
+//
+// Returns:
+// - the size of the filter's bit array, in bytes.
+size_t BloomFilter_SizeBytes(const BloomFilter *filter);
+
+#endif  // HW1_BLOOMFILTER_H_
@@ -0,0 +1,41 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_BLOOMFILTER_PRIV_H_
+#define HW1_BLOOMFILTER_PRIV_H_
+
+#include <stdint.h>   // for uint64_t, etc.
+
+#include "./BloomFilter.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures for our BloomFilter implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// A block is one 64-byte cache line: 8 words, 512 bits.
+#define BF_BLOCK_WORDS 8
+#define BF_BLOCK_BITS (64 * BF_BLOCK_WORDS)
+
+// The most bits a hash may set.
+#define BF_MAX_PROBES 16
+
+// The filter.
+typedef struct bloom_filter {
+  uint64_t *blocks;      // num_blocks * BF_BLOCK_WORDS words, line-aligned
+  uint32_t  num_blocks;
+  int       num_probes;  // # of bits each hash sets, all in one block
+} BloomFilter;
+
+#endif  // HW1_BLOOMFILTER_PRIV_H_
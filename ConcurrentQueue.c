@@ -0,0 +1,410 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "CSE333.h"
+#include "ConcurrentQueue.h"
+#include "ConcurrentQueue_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Hazard pointers.
+//
+// A popping thread publishes the nodes it is about to dereference in its
+// hazard record and then re-reads the queue to make sure they are still
+// reachable.  A popped dummy node is "retired" rather than freed; once a
+// thread has retired enough nodes it scans every record and frees the ones
+// that nobody has published.
+
+// Scan once a thread holds this many retired nodes (or more, if there are
+// enough threads that a scan would otherwise find little to free).
+#define CQ_RETIRE_THRESHOLD 64
+
+static CQHazardRecord *hazard_list = NULL;   // global list of records
+static int             num_hazard_records = 0;
+static pthread_key_t   hazard_key;           // releases a record at exit
+static pthread_once_t  hazard_once = PTHREAD_ONCE_INIT;
+static _Thread_local CQHazardRecord *my_record = NULL;
+
+static void ReleaseRecord(void *rec_arg) {
+  CQHazardRecord *rec = (CQHazardRecord *) rec_arg;
+  int i;
+
+  for (i = 0; i < CQ_HAZARDS_PER_THREAD; i++) {
+    __atomic_store_n(&rec->hazard[i], NULL, __ATOMIC_RELEASE);
+  }
+  // The retired nodes stay with the record; whoever claims it next will
+  // free them during its first scan.
+  __atomic_store_n(&rec->active, 0, __ATOMIC_RELEASE);
+}
+
+static void InitHazardKey(void) {
+  Verify333(pthread_key_create(&hazard_key, &ReleaseRecord) == 0);
+}
+
+// Return the calling thread's hazard record, claiming an inactive one or
+// adding a new one to the global list on first use.
+static CQHazardRecord *MyRecord(void) {
+  CQHazardRecord *rec;
+
+  if (my_record != NULL) {
+    return my_record;
+  }
+  pthread_once(&hazard_once, &InitHazardKey);
+
+  // Try to recycle a record left behind by a thread that has exited.
+  for (rec = __atomic_load_n(&hazard_list, __ATOMIC_ACQUIRE);
+       rec != NULL;
+       rec = rec->next) {
+    int expected = 0;
+    if (__atomic_load_n(&rec->active, __ATOMIC_RELAXED) == 0 &&
+        __atomic_compare_exchange_n(&rec->active, &expected, 1, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+
+  if (rec == NULL) {
+    rec = (CQHazardRecord *) calloc(1, sizeof(CQHazardRecord));
+    Verify333(rec != NULL);
+    rec->active = 1;
+    rec->next = __atomic_load_n(&hazard_list, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&hazard_list, &rec->next, rec, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    __atomic_fetch_add(&num_hazard_records, 1, __ATOMIC_RELAXED);
+  }
+
+  pthread_setspecific(hazard_key, rec);
+  my_record = rec;
+  return rec;
+}
+
+// Publish "node" in hazard slot "slot".  The seq_cst store orders the
+// publication before the caller's re-validating load of the queue.
+static void Protect(CQHazardRecord *rec, int slot, CQNode *node) {
+  __atomic_store_n(&rec->hazard[slot], node, __ATOMIC_SEQ_CST);
+}
+
+static void ClearHazards(CQHazardRecord *rec) {
+  int i;
+  for (i = 0; i < CQ_HAZARDS_PER_THREAD; i++) {
+    __atomic_store_n(&rec->hazard[i], NULL, __ATOMIC_RELEASE);
+  }
+}
+
+static int ComparePointers(const void *a, const void *b) {
+  uintptr_t pa = (uintptr_t) *(CQNode * const *) a;
+  uintptr_t pb = (uintptr_t) *(CQNode * const *) b;
+  return (pa > pb) - (pa < pb);
+}
+
+// Free each of rec's retired nodes that isn't currently published as a
+// hazard by any thread.
+static void Scan(CQHazardRecord *rec) {
+  CQHazardRecord *r;
+  CQNode **protected_nodes;
+  int num_protected = 0, capacity, i, kept = 0;
+
+  capacity = CQ_HAZARDS_PER_THREAD *
+      (__atomic_load_n(&num_hazard_records, __ATOMIC_ACQUIRE) + 1);
+  protected_nodes = (CQNode **) malloc(capacity * sizeof(CQNode *));
+  Verify333(protected_nodes != NULL);
+
+  // Snapshot every published hazard.  Records may be added while we walk
+  // the list, so grow the snapshot rather than trusting the count.
+  for (r = __atomic_load_n(&hazard_list, __ATOMIC_ACQUIRE);
+       r != NULL;
+       r = r->next) {
+    if (num_protected + CQ_HAZARDS_PER_THREAD > capacity) {
+      capacity *= 2;
+      protected_nodes = (CQNode **) realloc(protected_nodes,
+                                            capacity * sizeof(CQNode *));
+      Verify333(protected_nodes != NULL);
+    }
+    for (i = 0; i < CQ_HAZARDS_PER_THREAD; i++) {
+      CQNode *h = __atomic_load_n(&r->hazard[i], __ATOMIC_SEQ_CST);
+      if (h != NULL) {
+        protected_nodes[num_protected++] = h;
+      }
+    }
+  }
+  qsort(protected_nodes, num_protected, sizeof(CQNode *), &ComparePointers);
+
+  for (i = 0; i < rec->num_retired; i++) {
+    CQNode *node = rec->retired[i];
+    if (bsearch(&node, protected_nodes, num_protected, sizeof(CQNode *),
+                &ComparePointers) != NULL) {
+      rec->retired[kept++] = node;
+    } else {
+      free(node);
+    }
+  }
+  rec->num_retired = kept;
+  free(protected_nodes);
+}
+
+static void Retire(CQHazardRecord *rec, CQNode *node) {
+  int threshold;
+
+  if (rec->num_retired == rec->retired_capacity) {
+    rec->retired_capacity = rec->retired_capacity == 0 ?
+        CQ_RETIRE_THRESHOLD : rec->retired_capacity * 2;
+    rec->retired = (CQNode **) realloc(rec->retired,
+                                       rec->retired_capacity *
+                                       sizeof(CQNode *));
+    Verify333(rec->retired != NULL);
+  }
+  rec->retired[rec->num_retired++] = node;
+
+  threshold = 2 * CQ_HAZARDS_PER_THREAD *
+      __atomic_load_n(&num_hazard_records, __ATOMIC_RELAXED);
+  if (threshold < CQ_RETIRE_THRESHOLD) {
+    threshold = CQ_RETIRE_THRESHOLD;
+  }
+  if (rec->num_retired >= threshold) {
+    Scan(rec);
+  }
+}
+
+int CQReclaim(void) {
+  CQHazardRecord *rec = MyRecord();
+  Scan(rec);
+  return rec->num_retired;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ConcurrentQueue implementation.
+
+ConcurrentQueue* ConcurrentQueue_Allocate(void) {
+  ConcurrentQueue *queue;
+  CQNode *dummy;
+
+  queue = (ConcurrentQueue *) malloc(sizeof(ConcurrentQueue));
+  Verify333(queue != NULL);
+  dummy = (CQNode *) malloc(sizeof(CQNode));
+  Verify333(dummy != NULL);
+
+  dummy->payload = NULL;
+  dummy->next = NULL;
+  queue->head = queue->tail = dummy;
+  queue->sleepers = 0;
+  queue->closed = false;
+  Verify333(pthread_mutex_init(&queue->lock, NULL) == 0);
+  Verify333(pthread_cond_init(&queue->nonempty, NULL) == 0);
+  return queue;
+}
+
+void ConcurrentQueue_Free(ConcurrentQueue *queue,
+                          LLPayloadFreeFnPtr payload_free_function) {
+  CQNode *node, *next;
+
+  Verify333(queue != NULL);
+  Verify333(payload_free_function != NULL);
+
+  // The dummy's payload was already handed out by the Pop that made it
+  // the dummy, so only the nodes after it carry live payloads.
+  node = queue->head;
+  next = node->next;
+  free(node);
+  for (node = next; node != NULL; node = next) {
+    next = node->next;
+    payload_free_function(node->payload);
+    free(node);
+  }
+
+  pthread_mutex_destroy(&queue->lock);
+  pthread_cond_destroy(&queue->nonempty);
+  free(queue);
+}
+
+// Wake sleeping poppers, if there are any.  An appender that reads
+// sleepers == 0 is ordered (seq_cst) before the popper's increment, so that
+// popper's re-check of the queue is guaranteed to see the new element.
+static void WakeSleepers(ConcurrentQueue *queue, bool all) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&queue->sleepers, __ATOMIC_SEQ_CST) == 0) {
+    return;
+  }
+  pthread_mutex_lock(&queue->lock);
+  if (all) {
+    pthread_cond_broadcast(&queue->nonempty);
+  } else {
+    pthread_cond_signal(&queue->nonempty);
+  }
+  pthread_mutex_unlock(&queue->lock);
+}
+
+void ConcurrentQueue_Append(ConcurrentQueue *queue, LLPayload_t payload) {
+  CQHazardRecord *rec;
+  CQNode *node, *tail, *next;
+
+  Verify333(queue != NULL);
+  rec = MyRecord();
+
+  node = (CQNode *) malloc(sizeof(CQNode));
+  Verify333(node != NULL);
+  node->payload = payload;
+  node->next = NULL;
+
+  while (true) {
+    tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    Protect(rec, 0, tail);
+    if (tail != __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST)) {
+      continue;  // tail was popped and retired before we protected it
+    }
+
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next != NULL) {
+      // Another appender linked its node but hasn't swung tail yet; help.
+      __atomic_compare_exchange_n(&queue->tail, &tail, next, false,
+                                  __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+      continue;
+    }
+    if (__atomic_compare_exchange_n(&tail->next, &next, node, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+
+  // Swing tail to our node.  If this fails, someone already helped.
+  __atomic_compare_exchange_n(&queue->tail, &tail, node, false,
+                              __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+  ClearHazards(rec);
+  WakeSleepers(queue, false);
+}
+
+bool ConcurrentQueue_Pop(ConcurrentQueue *queue, LLPayload_t *payload_ptr) {
+  CQHazardRecord *rec;
+  CQNode *head, *tail, *next;
+  LLPayload_t payload;
+
+  Verify333(queue != NULL);
+  Verify333(payload_ptr != NULL);
+  rec = MyRecord();
+
+  while (true) {
+    head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    Protect(rec, 0, head);
+    if (head != __atomic_load_n(&queue->head, __ATOMIC_SEQ_CST)) {
+      continue;
+    }
+
+    tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+    Protect(rec, 1, next);
+    if (head != __atomic_load_n(&queue->head, __ATOMIC_SEQ_CST)) {
+      continue;
+    }
+
+    if (next == NULL) {
+      // Only the dummy is left: the queue is empty.
+      ClearHazards(rec);
+      return false;
+    }
+    if (head == tail) {
+      // Tail is lagging behind a half-finished append; help it along
+      // before we pop past it.
+      __atomic_compare_exchange_n(&queue->tail, &tail, next, false,
+                                  __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    // Read the payload before the CAS; afterward another popper may
+    // retire "next" as its dummy.  Our hazard keeps it alive either way.
+    payload = next->payload;
+    if (__atomic_compare_exchange_n(&queue->head, &head, next, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+
+  ClearHazards(rec);
+  Retire(rec, head);
+  *payload_ptr = payload;
+  return true;
+}
+
+bool ConcurrentQueue_PopWait(ConcurrentQueue *queue,
+                             LLPayload_t *payload_ptr) {
+  bool success;
+
+  Verify333(queue != NULL);
+
+  if (ConcurrentQueue_Pop(queue, payload_ptr)) {
+    return true;
+  }
+
+  // Slow path.  Announce that we are about to sleep, then re-check the
+  // queue under the lock so an append can't slip in between our check and
+  // the wait without signalling us.
+  pthread_mutex_lock(&queue->lock);
+  __atomic_fetch_add(&queue->sleepers, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  while (!(success = ConcurrentQueue_Pop(queue, payload_ptr)) &&
+         !__atomic_load_n(&queue->closed, __ATOMIC_ACQUIRE)) {
+    pthread_cond_wait(&queue->nonempty, &queue->lock);
+  }
+  __atomic_fetch_sub(&queue->sleepers, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&queue->lock);
+  return success;
+}
+
+int ConcurrentQueue_PopBatch(ConcurrentQueue *queue, LLPayload_t *payloads,
+                             int max_payloads, bool wait) {
+  int n = 0;
+
+  Verify333(queue != NULL);
+  Verify333(payloads != NULL);
+  Verify333(max_payloads > 0);
+
+  if (wait) {
+    if (!ConcurrentQueue_PopWait(queue, &payloads[0])) {
+      return 0;
+    }
+    n = 1;
+  }
+  while (n < max_payloads && ConcurrentQueue_Pop(queue, &payloads[n])) {
+    n++;
+  }
+  return n;
+}
+
+void ConcurrentQueue_Close(ConcurrentQueue *queue) {
+  Verify333(queue != NULL);
+
+  // Take the lock so a popper between its re-check and its wait can't miss
+  // the broadcast.
+  pthread_mutex_lock(&queue->lock);
+  __atomic_store_n(&queue->closed, true, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&queue->nonempty);
+  pthread_mutex_unlock(&queue->lock);
+}
+
+bool ConcurrentQueue_IsEmpty(ConcurrentQueue *queue) {
+  CQHazardRecord *rec;
+  CQNode *head;
+  bool empty;
+
+  Verify333(queue != NULL);
+  rec = MyRecord();
+
+  do {
+    head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    Protect(rec, 0, head);
+  } while (head != __atomic_load_n(&queue->head, __ATOMIC_SEQ_CST));
+  empty = (__atomic_load_n(&head->next, __ATOMIC_ACQUIRE) == NULL);
+  ClearHazards(rec);
+  return empty;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_CONCURRENTQUEUE_H_
+#define HW1_CONCURRENTQUEUE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+
+#include "./LinkedList.h"  // for LLPayload_t, LLPayloadFreeFnPtr
+
+///////////////////////////////////////////////////////////////////////////////
+// A ConcurrentQueue is a lock-free, multi-producer multi-consumer FIFO queue.
+//
+// It has the same Append-to-tail and Pop-from-head semantics as a LinkedList
+// that is used as a work queue, but any number of threads may call
+// ConcurrentQueue_Append and ConcurrentQueue_Pop at the same time without
+// wrapping the queue in a mutex.
+//
+// The implementation is the Michael-Scott queue.  Popped nodes are reclaimed
+// with hazard pointers, so a node is never freed while another thread may
+// still be reading it.
+//
+// As with LinkedList, we hide the implementation behind an opaque typedef;
+// the structure is defined in ConcurrentQueue_priv.h.
+typedef struct cq ConcurrentQueue;
+
+// Allocate and return a new, empty queue.  The caller takes responsibility
+// for eventually calling ConcurrentQueue_Free.
+//
+// Returns:
+// - the newly-allocated queue (never NULL).
+ConcurrentQueue* ConcurrentQueue_Allocate(void);
+
+// Free a queue that was previously allocated by ConcurrentQueue_Allocate.
+// No other thread may be using the queue when this is called.
+//
+// Arguments:
+// - queue: the queue to free.  It is unsafe to use "queue" after this
+//   function returns.
+// - payload_free_function: invoked once for each payload still in the queue.
+void ConcurrentQueue_Free(ConcurrentQueue *queue,
+                          LLPayloadFreeFnPtr payload_free_function);
+
+// Adds a new element to the tail of the queue.  Safe to call concurrently
+// with any other Append or Pop on the same queue.
+//
+// Arguments:
+// - queue: the queue to append to.
+// - payload: the payload to append; it's up to the caller to interpret and
+//   manage the memory of the payload.
+void ConcurrentQueue_Append(ConcurrentQueue *queue, LLPayload_t payload);
+
+// Pop an element from the head of the queue without blocking.
+//
+// Arguments:
+// - queue: the queue to pop from.
+// - payload_ptr: a return parameter; on success, the popped payload
+//   is returned through this parameter.
+//
+// Returns:
+// - false if the queue was empty.
+// - true on success.
+bool ConcurrentQueue_Pop(ConcurrentQueue *queue, LLPayload_t *payload_ptr);
+
+// Pop an element from the head of the queue, sleeping until one is
+// appended if the queue is empty.
+//
+// Arguments:
+// - queue: the queue to pop from.
+// - payload_ptr: a return parameter; on success, the popped payload
+//   is returned through this parameter.
+//
+// Returns:
+// - false if the queue is empty and has been closed with
+//   ConcurrentQueue_Close.
+// - true on success.
+bool ConcurrentQueue_PopWait(ConcurrentQueue *queue,
+                             LLPayload_t *payload_ptr);
+
+// Pop up to max_payloads elements from the head of the queue in FIFO order.
+//
+// Arguments:
+// - queue: the queue to pop from.
+// - payloads: an array of at least max_payloads entries that receives the
+//   popped payloads.
+// - max_payloads: the most elements to pop; must be greater than zero.
+// - wait: if true, sleep until at least one element is available (or the
+//   queue is closed); if false, return immediately.
+//
+// Returns:
+// - the number of payloads popped, which is 0 only if the queue was empty
+//   (and, when waiting, closed).
+int ConcurrentQueue_PopBatch(ConcurrentQueue *queue, LLPayload_t *payloads,
+                             int max_payloads, bool wait);
+
+// Close the queue, waking every thread blocked in ConcurrentQueue_PopWait
+// or a waiting ConcurrentQueue_PopBatch.  Elements already in the queue can
+// still be popped; once it drains, waiting pops return without an element.
+// Appending to a closed queue is still permitted.
+//
+// Arguments:
+// - queue: the queue to close.
+void ConcurrentQueue_Close(ConcurrentQueue *queue);
+
+// Tests whether the queue was empty at some instant during the call.  With
+// other threads running, the answer may be stale by the time it's returned.
+//
+// Arguments:
+// - queue: the queue to query.
+//
+// Returns:
+// - true if the queue was observed empty, false otherwise.
+bool ConcurrentQueue_IsEmpty(ConcurrentQueue *queue);
+
+#endif  // HW1_CONCURRENTQUEUE_H_
@@ -0,0 +1,78 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_CONCURRENTQUEUE_PRIV_H_
+#define HW1_CONCURRENTQUEUE_PRIV_H_
+
+#include <pthread.h>  // for pthread_mutex_t, pthread_cond_t
+
+#include "./ConcurrentQueue.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our ConcurrentQueue
+// implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+//
+// Every field that is shared between threads is only ever accessed with
+// the __atomic builtins, so the structures stay plain C (and C++) types.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// Keeps fields that are written by different threads on different cache
+// lines.
+#define CQ_CACHE_LINE 64
+
+// A single node within a queue.  The queue always holds one "dummy" node
+// at its head; the payload of the node after the dummy is the next one
+// to be popped.
+typedef struct cq_node {
+  LLPayload_t     payload;  // customer-supplied payload pointer
+  struct cq_node *next;     // next node toward the tail, or NULL
+} CQNode;
+
+// The entire queue.
+typedef struct cq {
+  CQNode         *head;     // the dummy node; popped from here
+  char            pad0[CQ_CACHE_LINE - sizeof(CQNode *)];
+  CQNode         *tail;     // last node, or (briefly) its predecessor
+  char            pad1[CQ_CACHE_LINE - sizeof(CQNode *)];
+  int             sleepers;  // # of threads about to sleep in PopWait
+  bool            closed;    // set by ConcurrentQueue_Close
+  pthread_mutex_t lock;      // only taken by sleeping poppers and wakers
+  pthread_cond_t  nonempty;  // signalled when an append may wake a sleeper
+} ConcurrentQueue;
+
+// The number of hazard pointers each thread may publish at once.  Pop
+// needs two: the head (dummy) node and its successor.
+#define CQ_HAZARDS_PER_THREAD 2
+
+// Per-thread hazard pointer record.  Records live on a global list and are
+// never freed; when a thread exits, its record is marked inactive and may
+// be claimed by a later thread, along with any retired nodes it still holds.
+typedef struct cq_hazard_rec {
+  struct cq_hazard_rec *next;     // next record on the global list
+  int                   active;   // 1 if owned by a live thread
+  CQNode               *hazard[CQ_HAZARDS_PER_THREAD];
+  CQNode              **retired;  // popped nodes waiting to be freed
+  int                   num_retired;
+  int                   retired_capacity;
+} CQHazardRecord;
+
+// Free every node the calling thread has retired that no thread currently
+// protects with a hazard pointer.
+//
+// Returns:
+// - the number of retired nodes the calling thread still holds afterward.
+int CQReclaim(void);
+
+#endif  // HW1_CONCURRENTQUEUE_PRIV_H_
@@ -0,0 +1,513 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HASH_HAVE_X86 1
+#endif
+
+#include "CSE333.h"
+#include "Hash.h"
+#include "Hash_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+//
+
+// gcc and clang support 128-bit integers as an extension.
+__extension__ typedef unsigned __int128 HashU128;
+
+// Unaligned native-order reads.  memcpy compiles to a single load.
+static inline uint64_t Read64(const unsigned char *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t Read32(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t Rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// FNV-1a's constants; the same as FNVHash64's in HashTable.c.
+static const uint64_t FNV1_64_INIT = 0xcbf29ce484222325ULL;
+static const uint64_t FNV_64_PRIME = 0x100000001b3ULL;
+
+// Continues an FNV-1a hash from state hval over len more bytes.
+static inline uint64_t FNVContinue(uint64_t hval, const void *buffer,
+                                   size_t len) {
+  const unsigned char *bp = (const unsigned char *) buffer;
+  const unsigned char *be = bp + len;
+
+  while (bp < be) {
+    hval ^= (uint64_t) *bp++;
+    hval *= FNV_64_PRIME;
+  }
+  return hval;
+}
+
+// FNV-1a with a size_t length and a seed folded into the starting value.
+static HTKey_t FNVHashSeeded(const void *buffer, size_t len, uint64_t seed);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// XXHash64.  Adapted from the xxHash reference implementation by Yann
+// Collet:
+//     https://github.com/Cyan4973/xxHash
+
+static const uint64_t XXH_PRIME1 = 0x9e3779b185ebca87ULL;
+static const uint64_t XXH_PRIME2 = 0xc2b2ae3d27d4eb4fULL;
+static const uint64_t XXH_PRIME3 = 0x165667b19e3779f9ULL;
+static const uint64_t XXH_PRIME4 = 0x85ebca77c2b2ae63ULL;
+static const uint64_t XXH_PRIME5 = 0x27d4eb2f165667c5ULL;
+
+static inline uint64_t XXHRound(uint64_t acc, uint64_t input) {
+  acc += input * XXH_PRIME2;
+  acc = Rotl64(acc, 31);
+  return acc * XXH_PRIME1;
+}
+
+static inline uint64_t XXHMergeRound(uint64_t acc, uint64_t val) {
+  acc ^= XXHRound(0, val);
+  return acc * XXH_PRIME1 + XXH_PRIME4;
+}
+
+HTKey_t XXHash64(const void *buffer, size_t len, uint64_t seed) {
+  const unsigned char *p = (const unsigned char *) buffer;
+  const unsigned char *end = p + len;
+  uint64_t h;
+
+  if (len >= 32) {
+    // Four independent lanes, 8 bytes each per step.
+    const unsigned char *limit = end - 32;
+    uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+    uint64_t v2 = seed + XXH_PRIME2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - XXH_PRIME1;
+
+    do {
+      v1 = XXHRound(v1, Read64(p));
+      v2 = XXHRound(v2, Read64(p + 8));
+      v3 = XXHRound(v3, Read64(p + 16));
+      v4 = XXHRound(v4, Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+    h = XXHMergeRound(h, v1);
+    h = XXHMergeRound(h, v2);
+    h = XXHMergeRound(h, v3);
+    h = XXHMergeRound(h, v4);
+  } else {
+    h = seed + XXH_PRIME5;
+  }
+  h += (uint64_t) len;
+
+  // The tail: words, then a half word, then bytes.
+  while (p + 8 <= end) {
+    h ^= XXHRound(0, Read64(p));
+    h = Rotl64(h, 27) * XXH_PRIME1 + XXH_PRIME4;
+    p += 8;
+  }
+  if (p + 4 <= end) {
+    h ^= Read32(p) * XXH_PRIME1;
+    h = Rotl64(h, 23) * XXH_PRIME2 + XXH_PRIME3;
+    p += 4;
+  }
+  while (p < end) {
+    h ^= (*p++) * XXH_PRIME5;
+    h = Rotl64(h, 11) * XXH_PRIME1;
+  }
+
+  // Final avalanche.
+  h ^= h >> 33;
+  h *= XXH_PRIME2;
+  h ^= h >> 29;
+  h *= XXH_PRIME3;
+  h ^= h >> 32;
+  return h;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// WyHash64.  Adapted from wyhash (final version 4) by Wang Yi:
+//     https://github.com/wangyi-fudan/wyhash
+
+static const uint64_t WY_SECRET[4] = {
+  0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+  0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+// Multiplies a and b into 128 bits and returns the two halves xor'ed
+// together: every output bit depends on every input bit of both.
+static inline uint64_t WyMix(uint64_t a, uint64_t b) {
+  HashU128 r = (HashU128) a * b;
+  return (uint64_t) r ^ (uint64_t) (r >> 64);
+}
+
+// Reads 1..3 bytes so that every byte reaches the result.
+static inline uint64_t WyRead3(const unsigned char *p, size_t k) {
+  return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+}
+
+HTKey_t WyHash64(const void *buffer, size_t len, uint64_t seed) {
+  const unsigned char *p = (const unsigned char *) buffer;
+  uint64_t a, b;
+  HashU128 r;
+
+  seed ^= WyMix(seed ^ WY_SECRET[0], WY_SECRET[1]);
+  if (len <= 16) {
+    if (len >= 4) {
+      // Two (possibly overlapping) pairs of 4-byte reads cover 4..16 bytes.
+      size_t off = (len >> 3) << 2;
+      a = (Read32(p) << 32) | Read32(p + off);
+      b = (Read32(p + len - 4) << 32) | Read32(p + len - 4 - off);
+    } else if (len > 0) {
+      a = WyRead3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      // Three independent lanes, 16 bytes each per step.
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = WyMix(Read64(p) ^ WY_SECRET[1], Read64(p + 8) ^ seed);
+        see1 = WyMix(Read64(p + 16) ^ WY_SECRET[2], Read64(p + 24) ^ see1);
+        see2 = WyMix(Read64(p + 32) ^ WY_SECRET[3], Read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = WyMix(Read64(p) ^ WY_SECRET[1], Read64(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    // The last 16 bytes of the input, overlapping what we've already mixed
+    // if the length isn't a multiple of 16.
+    a = Read64(p + i - 16);
+    b = Read64(p + i - 8);
+  }
+
+  a ^= WY_SECRET[1];
+  b ^= seed;
+  r = (HashU128) a * b;
+  a = (uint64_t) r;
+  b = (uint64_t) (r >> 64);
+  return WyMix(a ^ WY_SECRET[0] ^ len, b ^ WY_SECRET[1]);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SipHash-2-4.  Adapted from the reference implementation by Jean-Philippe
+// Aumasson and Daniel J. Bernstein:
+//     https://github.com/veorq/SipHash
+
+#define SIPROUND(v0, v1, v2, v3) \
+  do { \
+    v0 += v1; v1 = Rotl64(v1, 13); v1 ^= v0; v0 = Rotl64(v0, 32); \
+    v2 += v3; v3 = Rotl64(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = Rotl64(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = Rotl64(v1, 17); v1 ^= v2; v2 = Rotl64(v2, 32); \
+  } while (0)
+
+HTKey_t SipHash64(const void *buffer, size_t len, uint64_t k0, uint64_t k1) {
+  const unsigned char *p = (const unsigned char *) buffer;
+  const unsigned char *end = p + (len & ~(size_t) 7);
+  uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+  uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+  uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+  uint64_t v3 = 0x7465646279746573ULL ^ k1;
+  uint64_t m, last;
+  int i;
+
+  // Two rounds per 8-byte word.
+  for (; p < end; p += 8) {
+    m = Read64(p);
+    v3 ^= m;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= m;
+  }
+
+  // The last 0..7 bytes, with the length in the top byte.
+  last = ((uint64_t) len) << 56;
+  for (i = (int) (len & 7) - 1; i >= 0; i--) {
+    last |= ((uint64_t) p[i]) << (8 * i);
+  }
+  v3 ^= last;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  v0 ^= last;
+
+  // Four finalization rounds.
+  v2 ^= 0xff;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Selecting a hash.
+
+static HTKey_t FNVHashSeeded(const void *buffer, size_t len, uint64_t seed) {
+  return FNVContinue(FNV1_64_INIT ^ seed, buffer, len);
+}
+
+HashFnPtr Hash_Function(HashAlgorithm algorithm) {
+  static const HashFnPtr functions[HASH_NUM_ALGORITHMS] = {
+    [HASH_FNV1A] = &FNVHashSeeded,
+    [HASH_XXHASH64] = &XXHash64,
+    [HASH_WYHASH64] = &WyHash64,
+  };
+
+  Verify333(algorithm >= 0 && algorithm < HASH_NUM_ALGORITHMS);
+  return functions[algorithm];
+}
+
+HTKey_t Hash_Bytes(HashAlgorithm algorithm, const void *buffer, size_t len,
+                   uint64_t seed) {
+  return Hash_Function(algorithm)(buffer, len, seed);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Incremental FNV-1a.  FNV-1a carries no state besides the running hash,
+// so an update just continues it.
+
+void FNVHash64_Init(FNVHashState *state) {
+  Verify333(state != NULL);
+  state->hval = FNV1_64_INIT;
+}
+
+void FNVHash64_Update(FNVHashState *state, const void *buffer, size_t len) {
+  Verify333(state != NULL);
+  state->hval = FNVContinue(state->hval, buffer, len);
+}
+
+HTKey_t FNVHash64_Final(const FNVHashState *state) {
+  Verify333(state != NULL);
+  return state->hval;
+}
+
+HTKey_t FNVHash64_IoVec(const struct iovec *iov, int iovcnt) {
+  FNVHashState state;
+  int i;
+
+  Verify333(iovcnt >= 0);
+  FNVHash64_Init(&state);
+  for (i = 0; i < iovcnt; i++) {
+    FNVHash64_Update(&state, iov[i].iov_base, iov[i].iov_len);
+  }
+  return FNVHash64_Final(&state);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Batched FNV-1a.
+//
+// The FNV prime is 2^40 + 0x1b3, so h * prime (mod 2^64) is
+//     (h << 40) + lo(h) * 0x1b3 + ((hi(h) * 0x1b3) << 32)
+// where lo and hi are h's 32-bit halves.  SSE2 and AVX2 have no 64-bit
+// multiply, but they do have a 32x32->64 one (mul_epu32), so each lane
+// costs two of those plus shifts and adds.  With four lanes that is a clear
+// win over the scalar loop; SSE2's two lanes only win on 32-bit x86, where
+// the scalar 64-bit multiply is expensive too.
+//
+// A multiply's latency is several times its throughput, so each group of
+// keys fills two registers whose chains overlap: four keys for SSE2, eight
+// for AVX2.  A group runs in lockstep up to its shortest buffer, eight
+// bytes at a time where possible: one 64-bit load per lane, then eight
+// rounds that each peel off the low byte.  The rest of each buffer is
+// finished one lane at a time by FNVContinue.
+
+// A buffer's length as FNVHash64 sees it: a negative length is empty.
+static inline int BatchLen(int len) {
+  return len > 0 ? len : 0;
+}
+
+// The shortest of lens[0..n-1] (see BatchLen).
+static inline int MinLen(const int *lens, int n) {
+  int min = BatchLen(lens[0]), i;
+  for (i = 1; i < n; i++) {
+    if (BatchLen(lens[i]) < min) {
+      min = BatchLen(lens[i]);
+    }
+  }
+  return min;
+}
+
+void FNVBatchScalar(unsigned char **buffers, const int *lens, HTKey_t *out,
+                    int n) {
+  int i;
+  for (i = 0; i < n; i++) {
+    out[i] = FNVContinue(FNV1_64_INIT, buffers[i], BatchLen(lens[i]));
+  }
+}
+
+#ifdef HASH_HAVE_X86
+
+__attribute__((target("sse2")))
+static inline __m128i FNVMul128(__m128i h) {
+  const __m128i c = _mm_set1_epi64x(0x1b3);
+  __m128i lo = _mm_mul_epu32(h, c);
+  __m128i hi = _mm_mul_epu32(_mm_srli_epi64(h, 32), c);
+  return _mm_add_epi64(_mm_add_epi64(lo, _mm_slli_epi64(hi, 32)),
+                       _mm_slli_epi64(h, 40));
+}
+
+__attribute__((target("sse2")))
+void FNVBatchSSE2(unsigned char **buffers, const int *lens, HTKey_t *out,
+                  int n) {
+  const __m128i low_byte = _mm_set1_epi64x(0xff);
+  uint64_t lanes[4];
+  int i, j, k;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    unsigned char **b = buffers + i;
+    int min_len = MinLen(lens + i, 4);
+    __m128i h0 = _mm_set1_epi64x(FNV1_64_INIT), h1 = h0;
+
+    for (j = 0; j + 8 <= min_len; j += 8) {
+      __m128i w0 = _mm_set_epi64x(Read64(b[1] + j), Read64(b[0] + j));
+      __m128i w1 = _mm_set_epi64x(Read64(b[3] + j), Read64(b[2] + j));
+      for (k = 0; k < 8; k++) {
+        h0 = FNVMul128(_mm_xor_si128(h0, _mm_and_si128(w0, low_byte)));
+        h1 = FNVMul128(_mm_xor_si128(h1, _mm_and_si128(w1, low_byte)));
+        w0 = _mm_srli_epi64(w0, 8);
+        w1 = _mm_srli_epi64(w1, 8);
+      }
+    }
+    for (; j < min_len; j++) {
+      h0 = FNVMul128(_mm_xor_si128(h0, _mm_set_epi64x(b[1][j], b[0][j])));
+      h1 = FNVMul128(_mm_xor_si128(h1, _mm_set_epi64x(b[3][j], b[2][j])));
+    }
+
+    _mm_storeu_si128((__m128i *) lanes, h0);
+    _mm_storeu_si128((__m128i *) (lanes + 2), h1);
+    for (k = 0; k < 4; k++) {
+      out[i + k] = FNVContinue(lanes[k], b[k] + min_len,
+                               BatchLen(lens[i + k]) - min_len);
+    }
+  }
+  FNVBatchScalar(buffers + i, lens + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i FNVMul256(__m256i h) {
+  const __m256i c = _mm256_set1_epi64x(0x1b3);
+  __m256i lo = _mm256_mul_epu32(h, c);
+  __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(h, 32), c);
+  return _mm256_add_epi64(_mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32)),
+                          _mm256_slli_epi64(h, 40));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i Load4x64(unsigned char **b, int j) {
+  return _mm256_set_epi64x(Read64(b[3] + j), Read64(b[2] + j),
+                           Read64(b[1] + j), Read64(b[0] + j));
+}
+
+__attribute__((target("avx2")))
+void FNVBatchAVX2(unsigned char **buffers, const int *lens, HTKey_t *out,
+                  int n) {
+  const __m256i low_byte = _mm256_set1_epi64x(0xff);
+  uint64_t lanes[8];
+  int i, j, k;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    unsigned char **b = buffers + i;
+    int min_len = MinLen(lens + i, 8);
+    __m256i h0 = _mm256_set1_epi64x(FNV1_64_INIT), h1 = h0;
+
+    for (j = 0; j + 8 <= min_len; j += 8) {
+      __m256i w0 = Load4x64(b, j), w1 = Load4x64(b + 4, j);
+      for (k = 0; k < 8; k++) {
+        h0 = FNVMul256(_mm256_xor_si256(h0, _mm256_and_si256(w0, low_byte)));
+        h1 = FNVMul256(_mm256_xor_si256(h1, _mm256_and_si256(w1, low_byte)));
+        w0 = _mm256_srli_epi64(w0, 8);
+        w1 = _mm256_srli_epi64(w1, 8);
+      }
+    }
+    for (; j < min_len; j++) {
+      h0 = FNVMul256(_mm256_xor_si256(
+          h0, _mm256_set_epi64x(b[3][j], b[2][j], b[1][j], b[0][j])));
+      h1 = FNVMul256(_mm256_xor_si256(
+          h1, _mm256_set_epi64x(b[7][j], b[6][j], b[5][j], b[4][j])));
+    }
+
+    _mm256_storeu_si256((__m256i *) lanes, h0);
+    _mm256_storeu_si256((__m256i *) (lanes + 4), h1);
+    for (k = 0; k < 8; k++) {
+      out[i + k] = FNVContinue(lanes[k], b[k] + min_len,
+                               BatchLen(lens[i + k]) - min_len);
+    }
+  }
+  FNVBatchScalar(buffers + i, lens + i, out + i, n - i);
+}
+
+bool FNVBatchHaveSSE2(void) {
+  return __builtin_cpu_supports("sse2");
+}
+
+bool FNVBatchHaveAVX2(void) {
+  return __builtin_cpu_supports("avx2");
+}
+
+#else  // HASH_HAVE_X86
+
+void FNVBatchSSE2(unsigned char **buffers, const int *lens, HTKey_t *out,
+                  int n) {
+  Verify333(false);
+}
+
+void FNVBatchAVX2(unsigned char **buffers, const int *lens, HTKey_t *out,
+                  int n) {
+  Verify333(false);
+}
+
+bool FNVBatchHaveSSE2(void) {
+  return false;
+}
+
+bool FNVBatchHaveAVX2(void) {
+  return false;
+}
+
+#endif  // HASH_HAVE_X86
+
+void FNVHash64_Batch(unsigned char **buffers, const int *lens, HTKey_t *out,
+                     int n) {
+  Verify333(n >= 0);
+  if (FNVBatchHaveAVX2()) {
+    FNVBatchAVX2(buffers, lens, out, n);
+  } else if (sizeof(void *) == 4 && FNVBatchHaveSSE2()) {
+    // Two 32x32 multiplies per lane only beat the scalar loop when the
+    // scalar loop's 64-bit multiply is itself built from 32-bit ones.
+    FNVBatchSSE2(buffers, lens, out, n);
+  } else {
+    FNVBatchScalar(buffers, lens, out, n);
+  }
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_HASH_H_
+#define HW1_HASH_H_
+
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for uint64_t, etc.
+#include <sys/uio.h>    // for struct iovec
+
+#include "./HashTable.h"  // for HTKey_t, FNVHash64
+
+///////////////////////////////////////////////////////////////////////////////
+// Hash functions for turning byte strings into HTKey_t keys.
+//
+// FNVHash64 (declared in HashTable.h) is simple, but it does one multiply
+// per byte in a single dependency chain, so it tops out around one byte per
+// cycle.  The hashes here read the input a machine word at a time and run
+// several independent multiply chains, which is many times faster on
+// anything longer than a few bytes while mixing at least as well:
+//
+// - XXHash64 is the xxHash XXH64 algorithm: 32 bytes per step across four
+//   accumulators, using only 64-bit multiplies.  Its output matches the
+//   reference implementation, so keys can be shared with other programs.
+//
+// - WyHash64 follows wyhash: 16 or 48 bytes per step, folding each 128-bit
+//   product back onto itself.  It is the fastest choice for short keys.
+//
+// Every function takes a seed; different seeds give unrelated hash
+// functions.  The hashes read multi-byte words in the machine's native
+// (little-endian on x86) byte order.
+//
+// Code that lets its customer choose the hash -- a table keyed by strings,
+// say -- should store a HashAlgorithm or a HashFnPtr rather than calling
+// one function directly.
+
+// The available hash algorithms.
+typedef enum {
+  HASH_FNV1A,     // FNVHash64; for a nonzero seed, FNV-1a from a seeded start
+  HASH_XXHASH64,  // XXHash64
+  HASH_WYHASH64,  // WyHash64
+  HASH_NUM_ALGORITHMS
+} HashAlgorithm;
+
+// A hash function over a buffer of bytes.
+//
+// Arguments:
+// - buffer: a pointer to a len-size buffer.
+// - len: how many bytes are in the buffer.
+// - seed: selects one member of the hash function family.
+//
+// Returns:
+// - a 64-bit hash value suitable for use in a HTKeyValue_t.
+typedef HTKey_t(*HashFnPtr)(const void *buffer, size_t len, uint64_t seed);
+
+// xxHash's XXH64.  With a seed of zero, XXHash64("", 0, 0) is
+// 0xef46db3751d8e999.
+HTKey_t XXHash64(const void *buffer, size_t len, uint64_t seed);
+
+// A wyhash-style hash.
+HTKey_t WyHash64(const void *buffer, size_t len, uint64_t seed);
+
+// SipHash-2-4, a keyed hash (a "pseudorandom function") for hash tables
+// whose keys may come from an adversary.  Without the 128-bit key, nobody
+// can predict which inputs collide, so nobody can pick inputs that all
+// land in one bucket.  It is several times slower than the hashes above.
+//
+// Arguments:
+// - buffer: a pointer to a len-size buffer.
+// - len: how many bytes are in the buffer.
+// - k0, k1: the two halves of the secret key; pick them at random.
+//
+// Returns:
+// - the 64-bit SipHash-2-4 value, matching the reference implementation
+//   (with the key bytes taken as k0 then k1 in little-endian order).
+HTKey_t SipHash64(const void *buffer, size_t len, uint64_t k0, uint64_t k1);
+
+// Look up the function for a hash algorithm.
+//
+// Arguments:
+// - algorithm: one of the HashAlgorithm values (not HASH_NUM_ALGORITHMS).
+//
+// Returns:
+// - the hash function.  For HASH_FNV1A with a seed of zero, it returns the
+//   same values as FNVHash64.
+HashFnPtr Hash_Function(HashAlgorithm algorithm);
+
+// Hash a buffer with the given algorithm; a shorthand for
+// Hash_Function(algorithm)(buffer, len, seed).
+HTKey_t Hash_Bytes(HashAlgorithm algorithm, const void *buffer, size_t len,
+                   uint64_t seed);
+
+// Choose the hash a table applies to its byte-string keys (see
+// HashTable_InsertBytes); by default it is WyHash64.  This is declared
+// here rather than in HashTable.h, which can't see HashAlgorithm.
+//
+// Arguments:
+// - table: the HashTable.  It must not have had a byte-string key
+//   inserted yet, since its entries keep the hashes of their keys.
+// - algorithm: one of the HashAlgorithm values (not HASH_NUM_ALGORITHMS).
+void HashTable_SetBytesHash(HashTable *table, HashAlgorithm algorithm);
+
+// Incremental FNV hashing.
+//
+// FNVHash64 needs the whole input in one buffer, and its length must fit
+// in an int.  To hash a large file, or a message scattered across several
+// buffers, feed the pieces one after another to FNVHash64_Update instead:
+//
+//     FNVHashState state;
+//     FNVHash64_Init(&state);
+//     while (... more data ...) {
+//       FNVHash64_Update(&state, chunk, chunk_len);
+//     }
+//     key = FNVHash64_Final(&state);
+//
+// The result is the same as FNVHash64 over all of the bytes in order, no
+// matter how they are split up.  Lengths are size_t throughout.
+
+// The state of an incremental hash.  Its fields are private; it is
+// declared here only so that customers can put one on the stack.
+typedef struct {
+  uint64_t hval;
+} FNVHashState;
+
+// Start a new hash.
+//
+// Arguments:
+// - state: the state to initialize.
+void FNVHash64_Init(FNVHashState *state);
+
+// Add bytes to a hash.
+//
+// Arguments:
+// - state: a state set up by FNVHash64_Init.
+// - buffer: a pointer to a len-size buffer.
+// - len: how many bytes are in the buffer (may be zero).
+void FNVHash64_Update(FNVHashState *state, const void *buffer, size_t len);
+
+// Finish a hash.  The state may be updated further afterward; the next
+// FNVHash64_Final then covers all of the bytes so far.
+//
+// Arguments:
+// - state: the state to read.
+//
+// Returns:
+// - the hash of every byte passed to FNVHash64_Update since
+//   FNVHash64_Init.
+HTKey_t FNVHash64_Final(const FNVHashState *state);
+
+// Hash the concatenation of several buffers, as writev would write them.
+//
+// Arguments:
+// - iov: an array of iovcnt buffers.
+// - iovcnt: the number of buffers (>= 0).
+//
+// Returns:
+// - the same value as FNVHash64 over the concatenated bytes.
+HTKey_t FNVHash64_IoVec(const struct iovec *iov, int iovcnt);
+
+// Hash many buffers with FNVHash64 at once.
+//
+// FNVHash64 is a single chain of dependent multiplies, so hashing keys one
+// after another leaves most of the CPU idle.  This hashes several keys side
+// by side in the lanes of SIMD registers: eight at a time with AVX2, or
+// four with SSE2 on 32-bit x86, chosen when called based on what the CPU
+// supports.  Elsewhere it falls back to a plain loop.  The results are
+// exactly the same as calling FNVHash64 on each buffer.
+//
+// Keys are taken in consecutive groups, one key per lane; a group runs in
+// lockstep only up to its shortest key, so batches of keys with similar
+// lengths go fastest.
+//
+// Arguments:
+// - buffers: an array of n pointers to the buffers to hash.
+// - lens: an array of n lengths; buffer i has lens[i] bytes.  As with
+//   FNVHash64, a negative length hashes as an empty buffer.
+// - out: an array of n hash values; out[i] receives
+//   FNVHash64(buffers[i], lens[i]).
+// - n: how many buffers to hash (>= 0).
+void FNVHash64_Batch(unsigned char **buffers, const int *lens, HTKey_t *out,
+                     int n);
+
+#endif  // HW1_HASH_H_
@@ -0,0 +1,286 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashSet.h"
+#include "HashSet_priv.h"
+
+// The fewest slots a set has.
+#define HS_MIN_SLOTS 8
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+uint64_t HSKeyToSlot(HashSet *set, HTKey_t key) {
+  // The splitmix64 finalizer, as in AggregateTable.
+  uint64_t x = key;
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x & set->mask;
+}
+
+// Would holding num_elements keys take the set over its load factor of
+// 3/4?
+static inline bool OverLoaded(uint64_t num_slots, int num_elements) {
+  return 4 * (uint64_t) num_elements > 3 * num_slots;
+}
+
+// Returns the slot holding a nonzero key, or the empty slot that ends its
+// probe run.
+static inline uint64_t Probe(HashSet *set, HTKey_t key) {
+  uint64_t i = HSKeyToSlot(set, key);
+
+  while (set->slots[i] != HS_EMPTY_SLOT && set->slots[i] != key) {
+    i = (i + 1) & set->mask;
+  }
+  return i;
+}
+
+// Doubles the slot array and reinserts the keys.
+static void Grow(HashSet *set) {
+  HTKey_t *old_slots = set->slots;
+  uint64_t old_num_slots = set->mask + 1, i;
+
+  set->mask = 2 * old_num_slots - 1;
+  set->slots = (HTKey_t *) calloc(2 * old_num_slots, sizeof(HTKey_t));
+  Verify333(set->slots != NULL);
+  for (i = 0; i < old_num_slots; i++) {
+    if (old_slots[i] != HS_EMPTY_SLOT) {
+      set->slots[Probe(set, old_slots[i])] = old_slots[i];
+    }
+  }
+  free(old_slots);
+}
+
+// Calls HashSet_Add(dst, key) for each key of src for which
+// HashSet_Contains(filter, key) is want; a NULL filter takes every key.
+static void AddFiltered(HashSet *dst, HashSet *src, HashSet *filter,
+                        bool want) {
+  uint64_t i;
+
+  for (i = 0; i <= src->mask; i++) {
+    HTKey_t key = src->slots[i];
+
+    if (key != HS_EMPTY_SLOT &&
+        (filter == NULL || HashSet_Contains(filter, key) == want)) {
+      HashSet_Add(dst, key);
+    }
+  }
+  if (src->has_zero &&
+      (filter == NULL || HashSet_Contains(filter, 0) == want)) {
+    HashSet_Add(dst, 0);
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HashSet implementation.
+
+HashSet* HashSet_Allocate(int capacity) {
+  HashSet *set;
+  uint64_t num_slots = HS_MIN_SLOTS;
+
+  Verify333(capacity > 0);
+  while (OverLoaded(num_slots, capacity)) {
+    num_slots *= 2;
+  }
+
+  set = (HashSet *) malloc(sizeof(HashSet));
+  Verify333(set != NULL);
+  set->mask = num_slots - 1;
+  set->num_elements = 0;
+  set->has_zero = false;
+  set->slots = (HTKey_t *) calloc(num_slots, sizeof(HTKey_t));
+  Verify333(set->slots != NULL);
+  return set;
+}
+
+void HashSet_Free(HashSet *set) {
+  Verify333(set != NULL);
+  free(set->slots);
+  free(set);
+}
+
+int HashSet_NumElements(HashSet *set) {
+  Verify333(set != NULL);
+  return set->num_elements;
+}
+
+bool HashSet_Add(HashSet *set, HTKey_t key) {
+  uint64_t i;
+
+  Verify333(set != NULL);
+  if (key == HS_EMPTY_SLOT) {
+    if (set->has_zero) {
+      return false;
+    }
+    set->has_zero = true;
+    set->num_elements++;
+    return true;
+  }
+
+  i = Probe(set, key);
+  if (set->slots[i] == key) {
+    return false;
+  }
+  if (OverLoaded(set->mask + 1, set->num_elements + 1)) {
+    Grow(set);
+    i = Probe(set, key);
+  }
+  set->slots[i] = key;
+  set->num_elements++;
+  return true;
+}
+
+bool HashSet_Contains(HashSet *set, HTKey_t key) {
+  Verify333(set != NULL);
+  if (key == HS_EMPTY_SLOT) {
+    return set->has_zero;
+  }
+  return set->slots[Probe(set, key)] == key;
+}
+
+bool HashSet_Remove(HashSet *set, HTKey_t key) {
+  uint64_t hole, j;
+
+  Verify333(set != NULL);
+  if (key == HS_EMPTY_SLOT) {
+    if (!set->has_zero) {
+      return false;
+    }
+    set->has_zero = false;
+    set->num_elements--;
+    return true;
+  }
+
+  hole = Probe(set, key);
+  if (set->slots[hole] != key) {
+    return false;
+  }
+
+  // Walk the rest of the probe run, moving back into the hole each key
+  // whose home slot is at or before it (cyclically), so that no key is
+  // left past an empty slot from its home.
+  for (j = (hole + 1) & set->mask; set->slots[j] != HS_EMPTY_SLOT;
+       j = (j + 1) & set->mask) {
+    uint64_t home = HSKeyToSlot(set, set->slots[j]);
+
+    if (((j - home) & set->mask) >= ((j - hole) & set->mask)) {
+      set->slots[hole] = set->slots[j];
+      hole = j;
+    }
+  }
+  set->slots[hole] = HS_EMPTY_SLOT;
+  set->num_elements--;
+  return true;
+}
+
+HashSet* HashSet_Union(HashSet *a, HashSet *b) {
+  HashSet *result;
+
+  Verify333(a != NULL);
+  Verify333(b != NULL);
+  result = HashSet_Allocate(a->num_elements + b->num_elements + 1);
+  AddFiltered(result, a, NULL, true);
+  AddFiltered(result, b, NULL, true);
+  return result;
+}
+
+HashSet* HashSet_Intersection(HashSet *a, HashSet *b) {
+  HashSet *result;
+
+  Verify333(a != NULL);
+  Verify333(b != NULL);
+
+  // Walk the smaller set, probing the larger.
+  if (a->num_elements > b->num_elements) {
+    HashSet *tmp = a;
+    a = b;
+    b = tmp;
+  }
+  result = HashSet_Allocate(a->num_elements + 1);
+  AddFiltered(result, a, b, true);
+  return result;
+}
+
+HashSet* HashSet_Difference(HashSet *a, HashSet *b) {
+  HashSet *result;
+
+  Verify333(a != NULL);
+  Verify333(b != NULL);
+  result = HashSet_Allocate(a->num_elements + 1);
+  AddFiltered(result, a, b, false);
+  return result;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HSIterator implementation.
+
+// Moves iter->pos forward from where it is to the first key at or after
+// it, or to num_slots + 1 if there are none.
+static bool SkipEmpty(HSIterator *iter) {
+  HashSet *set = iter->set;
+
+  while (iter->pos <= set->mask && set->slots[iter->pos] == HS_EMPTY_SLOT) {
+    iter->pos++;
+  }
+  if (iter->pos == set->mask + 1 && !set->has_zero) {
+    iter->pos++;
+  }
+  return iter->pos <= set->mask + 1;
+}
+
+HSIterator* HSIterator_Allocate(HashSet *set) {
+  HSIterator *iter;
+
+  Verify333(set != NULL);
+  iter = (HSIterator *) malloc(sizeof(HSIterator));
+  Verify333(iter != NULL);
+  iter->set = set;
+  iter->pos = 0;
+  SkipEmpty(iter);
+  return iter;
+}
+
+void HSIterator_Free(HSIterator *iter) {
+  Verify333(iter != NULL);
+  free(iter);
+}
+
+bool HSIterator_IsValid(HSIterator *iter) {
+  Verify333(iter != NULL);
+  return iter->pos <= iter->set->mask + 1;
+}
+
+bool HSIterator_Next(HSIterator *iter) {
+  Verify333(iter != NULL);
+  if (!HSIterator_IsValid(iter)) {
+    return false;
+  }
+  iter->pos++;
+  return SkipEmpty(iter);
+}
+
+bool HSIterator_Get(HSIterator *iter, HTKey_t *key) {
+  Verify333(iter != NULL);
+  if (!HSIterator_IsValid(iter)) {
+    return false;
+  }
+  *key = iter->pos == iter->set->mask + 1 ? 0 : iter->set->slots[iter->pos];
+  return true;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_HASHSET_H_
+#define HW1_HASHSET_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+
+#include "./HashTable.h"  // for HTKey_t
+
+///////////////////////////////////////////////////////////////////////////////
+// A HashSet is a set of HTKey_t keys: a HashTable without values, for
+// membership tests.
+//
+// Where a HashTable allocates a chain node and an HTKeyValue_t for every
+// element, a HashSet keeps its keys in one flat array, open-addressed and
+// probed linearly, so a key costs 8 bytes a slot (at most 4/3 slots per
+// key before the set grows) and a lookup usually reads one cache line.
+// The set grows by doubling as keys are added.
+typedef struct hash_set HashSet;
+
+// Allocate and return a new, empty HashSet.  The caller must eventually
+// free it with HashSet_Free.
+//
+// Arguments:
+// - capacity: the number of keys the set should hold before it first
+//   grows; MUST be greater than zero.
+//
+// Returns a pointer to the newly allocated HashSet.
+HashSet* HashSet_Allocate(int capacity);
+
+// Free a HashSet.
+//
+// Arguments:
+// - set: the set to free.  It is unsafe to use set after this function
+//   returns.
+void HashSet_Free(HashSet *set);
+
+// Figure out the number of keys in a set.
+//
+// Arguments:
+// - set: the set to query.
+//
+// Returns:
+// - the number of keys (>= 0).
+int HashSet_NumElements(HashSet *set);
+
+// Adds a key to a set.
+//
+// Arguments:
+// - set: the HashSet to add to.
+// - key: the key to add.
+//
+// Returns:
+//  - false: if the key was already in the set.
+//  - true: if the key was added.
+bool HashSet_Add(HashSet *set, HTKey_t key);
+
+// Looks up a key in a set.
+//
+// Arguments:
+// - set: the HashSet to look in.
+// - key: the key to look up.
+//
+// Returns:
+//  - false: if the key isn't in the set.
+//  - true: if it is.
+bool HashSet_Contains(HashSet *set, HTKey_t key);
+
+// Removes a key from a set.
+//
+// Arguments:
+// - set: the HashSet to remove from.
+// - key: the key to remove.
+//
+// Returns:
+//  - false: if the key wasn't in the set.
+//  - true: if the key was removed.
+bool HashSet_Remove(HashSet *set, HTKey_t key);
+
+// Set algebra.  Each returns a new HashSet, which the caller must
+// eventually free with HashSet_Free, and leaves its arguments unchanged.
+//
+// Arguments:
+// - a, b: the sets to combine; they may be the same set.
+//
+// Returns a pointer to a newly allocated HashSet holding:
+// - HashSet_Union: the keys in a or b.
+// - HashSet_Intersection: the keys in both a and b.
+// - HashSet_Difference: the keys in a but not in b.
+HashSet* HashSet_Union(HashSet *a, HashSet *b);
+HashSet* HashSet_Intersection(HashSet *a, HashSet *b);
+HashSet* HashSet_Difference(HashSet *a, HashSet *b);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HashSet iterator.
+//
+// An HSIterator visits each key of a set once, in no particular order.
+// Adding a key to or removing one from the set invalidates its iterators.
+typedef struct hs_iterator HSIterator;
+
+// Manufacture an iterator for the set, pointing at the set's first key (if
+// any).  The caller must eventually free it with HSIterator_Free.
+//
+// Arguments:
+// - set: the set to iterate over.
+//
+// Returns a pointer to the newly allocated HSIterator.
+HSIterator* HSIterator_Allocate(HashSet *set);
+
+// Free an iterator.
+//
+// Arguments:
+// - iter: the iterator to free.  It is unsafe to use iter after this
+//   function returns.
+void HSIterator_Free(HSIterator *iter);
+
+// Tests whether the iterator points at a key.
+//
+// Arguments:
+// - iter: the iterator to test.
+//
+// Returns:
+// - true: if iter is not past the end of the set.
+// - false: if iter is past the end of the set.
+bool HSIterator_IsValid(HSIterator *iter);
+
+// Advance the iterator to the next key.
+//
+// Arguments:
+// - iter: the iterator to advance.
+//
+// Returns:
+// - true: if the iterator now points at a key.
+// - false: if the iterator has fallen off the end of the set.
+bool HSIterator_Next(HSIterator *iter);
+
+// Returns the key the iterator points at.
+//
+// Arguments:
+// - iter: the iterator to fetch from.
+// - key: a return parameter through which the key is returned.
+//
+// Returns:
+// - false: if the iterator is not valid.
+// - true: success.
+bool HSIterator_Get(HSIterator *iter, HTKey_t *key);
+
+#endif  // HW1_HASHSET_H_
@@ -0,0 +1,51 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_HASHSET_PRIV_H_
+#define HW1_HASHSET_PRIV_H_
+
+#include <stdbool.h>  // for bool
+#include <stdint.h>   // for uint64_t
+
+#include "./HashSet.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our HashSet implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// A slot holding this key is empty.  Key 0 itself lives outside the slots,
+// in has_zero.
+#define HS_EMPTY_SLOT 0
+
+// The set: a power-of-two array of keys, probed linearly from the (mixed)
+// key.  Removal shifts later keys of the probe run back rather than
+// leaving tombstones, so a probe always ends at the first empty slot.
+typedef struct hash_set {
+  uint64_t  mask;          // num_slots - 1
+  int       num_elements;  // # of keys, counting key 0
+  bool      has_zero;      // is key 0 in the set?
+  HTKey_t  *slots;
+} HashSet;
+
+// An iterator's position is a slot index, or num_slots for key 0.
+typedef struct hs_iterator {
+  HashSet  *set;
+  uint64_t  pos;
+} HSIterator;
+
+// Maps a key to its home slot.
+uint64_t HSKeyToSlot(HashSet *set, HTKey_t key);
+
+#endif  // HW1_HASHSET_PRIV_H_
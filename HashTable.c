@@ -12,30 +12,242 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
+#include "BloomFilter.h"
 #include "CSE333.h"
+#include "Hash.h"
 #include "HashTable.h"
 #include "LinkedList.h"
+#include "LinkedList_priv.h"
 #include "HashTable_priv.h"
+#include "ThreadPool.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Internal helper functions.
 //
 #define INVALID_IDX -1
 
+// HashTable_FindBatch runs this many lookups side by side: enough to keep
+// the memory system busy, few enough that their lines all stay in L1.
+#define FIND_BATCH_GROUP 16
+
 // Grows the hashtable (ie, increase the number of buckets) if its load
-// factor has become too high.
+// factor has become too high, and rebuilds its Bloom filter, if it has one,
+// if that has filled up or gone stale.
 static void MaybeResize(HashTable *ht);
 
+// The number of entries on a table's chains: all of them, less any in its
+// window.
+static inline int ChainElements(HashTable *ht) {
+  return ht->num_elements - (ht->dense != NULL ? ht->dense->num_present : 0);
+}
+
+// Gives a table a new, empty array of num_buckets buckets and their tags.
+static void AllocateBuckets(HashTable *ht, int num_buckets);
+
+// Whether a table from HashTable_AllocateSmall is still keeping its
+// entries in ht->small.
+static inline bool IsSmall(HashTable *ht) {
+  return ht->buckets == NULL && ht->frozen == NULL && ht->cuckoo == NULL;
+}
+
+// Whether HashTable_Freeze has run on a table.
+static inline bool IsFrozen(HashTable *ht) {
+  return ht->frozen != NULL;
+}
+
+// Whether a table is from HashTable_AllocateCuckoo (and not since frozen).
+static inline bool IsCuckoo(HashTable *ht) {
+  return ht->cuckoo != NULL;
+}
+
+// Whether slot (a global index into cuckoo->slots) holds an entry.
+static inline bool CuckooOccupied(HTCuckoo *cuckoo, int slot) {
+  return ((cuckoo->tags[slot / HT_CUCKOO_SLOTS] >>
+           (8 * (slot % HT_CUCKOO_SLOTS))) & 0xff) != 0;
+}
+
+// Moves the entries of a table without buckets onto chains.
+static void ConvertToBuckets(HashTable *ht);
+
+// Finds the entry whose key is key in a frozen table.  Returns it, or
+// NULL if there is none.
+static HTKeyValue_t* FindFrozen(HashTable *ht, HTKey_t key);
+
+// HashTable_FindBatch for a frozen table.
+static int FindBatchFrozen(HashTable *ht, const HTKey_t *keys, int n,
+                           HTKeyValue_t *results, bool *found);
+
+// The slot of key in a table's window, or -1 if the table has no window or
+// the key is outside it.
+static inline int DenseSlot(HashTable *ht, HTKey_t key) {
+  if (ht->dense == NULL ||
+      key - ht->dense->first_key >= (uint64_t) ht->dense->num_slots) {
+    return -1;
+  }
+  return (int) (key - ht->dense->first_key);
+}
+
+// Whether the entry in a window slot is in the table.  Range iterators on
+// other threads may be clearing bits in the same word.
+static inline bool DenseHas(HTDense *dense, int slot) {
+  return (__atomic_load_n(&dense->present[slot / 64], __ATOMIC_RELAXED) >>
+          (slot % 64)) & 1;
+}
+
+// Doubles a table's window, if that would take in key and the window is at
+// least half full.  Returns key's slot, or -1 if the window didn't grow.
+static int GrowDense(HashTable *ht, HTKey_t key);
+
+// Looks for a dense range among the keys on a table's chains and, if it
+// finds one, moves them into a new window.
+static void DetectDense(HashTable *ht);
+
+// The global index into ht->cuckoo->slots of the entry whose key is key,
+// or -1 if there is none.
+static int FindCuckooSlot(HashTable *ht, HTKey_t key);
+
+// Inserts into a cuckoo table; see HashTable_Insert.
+static bool InsertCuckoo(HashTable *ht, HTKeyValue_t newkeyvalue,
+                         HTKeyValue_t *oldkeyvalue);
+
+// HashTable_FindBatch for a cuckoo table.
+static int FindBatchCuckoo(HashTable *ht, const HTKey_t *keys, int n,
+                           HTKeyValue_t *results, bool *found);
+
+// Makes empty storage for a cuckoo table of num_buckets buckets, and
+// frees it (but not the values in it).
+static HTCuckoo* NewCuckoo(int num_buckets);
+static void FreeCuckoo(HTCuckoo *cuckoo);
+
+// Makes an empty window of num_slots slots, starting at first_key.
+static HTDense* NewDense(HTKey_t first_key, int num_slots);
+
+// Frees a window, but not the values in it.
+static void FreeDense(HTDense *dense);
+
+// Whether a bucket's chain has a tree.
+static inline bool HasTree(HashTable *ht, int bucket) {
+  return ht->trees != NULL && ht->trees[bucket] != NULL;
+}
+
+// The chain node holding the entry whose key is key in a bucket's tree, or
+// NULL if there is none.  The bucket must have a tree.
+static LinkedListNode* FindInTree(HashTable *ht, int bucket, HTKey_t key);
+
+// Keeps a bucket's tree in step after an entry is pushed onto its chain,
+// or gives the chain a tree if it has grown long enough to need one.
+static void ChainGrew(HashTable *ht, int bucket);
+
+// RemoveFromChain for a chain with a tree.
+static void RemoveFromTree(HashTable *ht, int bucket, HTKeyValue_t *kv);
+
+// Frees all of a table's trees (but not its chains), and gives a tree to
+// every chain that needs one.
+static void FreeTrees(HashTable *ht);
+static void TreeifyLongChains(HashTable *ht);
+
 int HashKeyToBucketNum(HashTable *ht, HTKey_t key) {
+  if (ht->seeded) {
+    key = SipHash64(&key, sizeof(key), ht->seed[0], ht->seed[1]);
+  }
   return key % ht->num_buckets;
 }
 
-// Deallocation functions that do nothing.  Useful if we want to deallocate
-// the structure (eg, the linked list) without deallocating its elements or
-// if we know that the structure is empty.
+uint8_t HashKeyToTag(HTKey_t key) {
+  // The top byte of a multiplicative hash; the bucket comes from the low
+  // bits of the key (or from SipHash), so the two are unrelated.
+  uint8_t tag = (uint8_t) ((key * 0x9e3779b97f4a7c15ULL) >> 56);
+  return tag != 0 ? tag : 1;
+}
+
+// Returns a word with the high bit set in each byte of tags that equals
+// tag, and every other bit clear.
+static inline uint64_t TagMatches(uint64_t tags, uint8_t tag) {
+  static const uint64_t kLow7 = 0x7f7f7f7f7f7f7f7fULL;
+  uint64_t x = tags ^ (0x0101010101010101ULL * tag);
+
+  // A byte of x is 0 exactly where the tags match.  Adding 0x7f to its low
+  // 7 bits carries into its high bit unless they are all 0, and no carry
+  // crosses into the next byte.
+  return ~(((x & kLow7) + kLow7) | x | kLow7);
+}
+
+// HashTable_FindBatch walks a chain one node at a time, guided by two
+// facts from its bucket's tags: matches, the TagMatches of the key's tag,
+// and short_chain, whether the chain is shorter than HT_NUM_TAGS (so that
+// every entry is tagged).
+//
+// Returns whether the entry at position pos needs its key compared.
+static inline bool TagMayMatch(uint64_t matches, int pos) {
+  return pos >= HT_NUM_TAGS || ((matches >> (8 * pos)) & 0x80) != 0;
+}
+
+// Returns whether the entries from position pos on may hold the key.
+static inline bool TagsMayMatchFrom(uint64_t matches, bool short_chain,
+                                    int pos) {
+  return !short_chain || (pos < HT_NUM_TAGS && (matches >> (8 * pos)) != 0);
+}
+
+// Records that an entry with the given key was pushed onto the head of a
+// bucket's chain.  The old last tag, if any, falls off the end.
+static inline void PushTag(HashTable *ht, int bucket, HTKey_t key) {
+  ht->tags[bucket] = (ht->tags[bucket] << 8) | HashKeyToTag(key);
+}
+
+// Fixes up a bucket's tags after the entry at position pos of its chain
+// has been removed.
+static void RemoveTag(HashTable *ht, int bucket, int pos);
+
+uint64_t HashKeyToBloomHash(HashTable *ht, HTKey_t key) {
+  // The SplitMix64 finalizer: cheap, and every input bit affects every
+  // output bit.
+  uint64_t x = key + ht->seed[1] + 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// Replaces a table's Bloom filter with one sized for its current contents,
+// holding every key in the table.
+static void RebuildBloomFilter(HashTable *ht);
+
+// Returns false if the table's Bloom filter shows that key isn't in the
+// table; true if key may be there, or if the table has no filter.
+static inline bool BloomMayContain(HashTable *ht, HTKey_t key) {
+  return ht->bloom == NULL ||
+         BloomFilter_MayContain(ht->bloom, HashKeyToBloomHash(ht, key));
+}
+
+// Records a newly inserted key in the table's Bloom filter, if any.
+static inline void BloomAdd(HashTable *ht, HTKey_t key) {
+  if (ht->bloom != NULL) {
+    BloomFilter_Add(ht->bloom, HashKeyToBloomHash(ht, key));
+  }
+}
+
+// Counts a removal against the table's Bloom filter, if any, rebuilding the
+// filter once half its capacity has been removed.
+static inline void BloomRemoved(HashTable *ht) {
+  if (ht->bloom != NULL && ++ht->bloom_removed > ht->bloom_capacity / 2) {
+    RebuildBloomFilter(ht);
+  }
+}
+
+// Fills seed with len random bytes from the operating system.
+static void RandomSeed(void *seed, size_t len);
+
+// Runs fn on each of the num_tasks task records in the tasks array (each
+// task_size bytes long) on the shared ThreadPool.  The calling thread helps
+// run them.  Returns once every task has finished.
+static void RunParallel(void *tasks, size_t task_size, int num_tasks,
+                        void (*fn)(void *));
+
+// A deallocation function that does nothing.  Useful if we want to
+// deallocate the structure (eg, the linked list) without deallocating its
+// elements or if we know that the structure is empty.
 static void LLNoOpFree(LLPayload_t freeme) { }
-static void HTNoOpFree(HTValue_t freeme) { }
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -61,25 +273,93 @@ HTKey_t FNVHash64(unsigned char *buffer, int len) {
   return hval;
 }
 
-HashTable* HashTable_Allocate(int num_buckets) {
+// Allocates a table record with no entries and no buckets.
+static HashTable* AllocateRecord(void) {
   HashTable *ht;
-  int i;
-
-  Verify333(num_buckets > 0);
 
   // Allocate the hash table record.
   ht = (HashTable *) malloc(sizeof(HashTable));
   Verify333(ht != NULL);
 
   // Initialize the record.
-  ht->num_buckets = num_buckets;
+  ht->num_buckets = 1;
   ht->num_elements = 0;
-  ht->buckets = (LinkedList **) malloc(num_buckets * sizeof(LinkedList *));
-  Verify333(ht->buckets != NULL);
-  for (i = 0; i < num_buckets; i++) {
-    ht->buckets[i] = LinkedList_Allocate();
+  ht->buckets = NULL;
+  ht->tags = NULL;
+  ht->seeded = false;
+  ht->seed[0] = ht->seed[1] = 0;
+  ht->bloom = NULL;
+  ht->bloom_fp_rate = 0;
+  ht->bloom_capacity = ht->bloom_removed = 0;
+  ht->chain_policy = HT_CHAIN_STATIC;
+  ht->byte_keys = false;
+  ht->bytes_hash = &WyHash64;
+  ht->frozen = NULL;
+  ht->multi = false;
+  ht->dense_enabled = false;
+  ht->dense = NULL;
+  ht->cuckoo = NULL;
+  ht->trees = NULL;
+  return ht;
+}
+
+HashTable* HashTable_Allocate(int num_buckets) {
+  HashTable *ht;
+
+  Verify333(num_buckets > 0);
+
+  ht = AllocateRecord();
+  AllocateBuckets(ht, num_buckets);
+  return ht;
+}
+
+HashTable* HashTable_AllocateSmall(void) {
+  // The buckets wait until ht->small overflows.
+  return AllocateRecord();
+}
+
+HashTable* HashTable_AllocateMulti(int num_buckets) {
+  HashTable *ht = HashTable_Allocate(num_buckets);
+
+  ht->multi = true;
+  return ht;
+}
+
+HashTable* HashTable_AllocateDense(HTKey_t first_key, int num_keys) {
+  HashTable *ht;
+
+  Verify333(num_keys > 0 && num_keys <= HT_DENSE_MAX_SLOTS);
+  Verify333(first_key + (num_keys - 1) >= first_key);
+
+  // The buckets are only for outliers, so start with few.
+  ht = HashTable_Allocate(1);
+  ht->dense_enabled = true;
+  ht->dense = NewDense(first_key, num_keys);
+  return ht;
+}
+
+HashTable* HashTable_AllocateCuckoo(int num_keys) {
+  HashTable *ht;
+  int num_buckets = 2;
+
+  Verify333(num_keys >= 0);
+
+  // Room for num_keys at the maximum load.
+  while ((int64_t) num_buckets * HT_CUCKOO_SLOTS * HT_CUCKOO_MAX_LOAD <
+         (int64_t) num_keys * 100) {
+    num_buckets *= 2;
   }
+  ht = AllocateRecord();
+  ht->num_buckets = num_buckets;
+  ht->cuckoo = NewCuckoo(num_buckets);
+  return ht;
+}
 
+HashTable* HashTable_AllocateSeeded(int num_buckets) {
+  HashTable *ht = HashTable_Allocate(num_buckets);
+
+  ht->seeded = true;
+  RandomSeed(ht->seed, sizeof(ht->seed));
   return ht;
 }
 
@@ -89,6 +369,50 @@ void HashTable_Free(HashTable *table,
 
   Verify333(table != NULL);
 
+  if (IsFrozen(table)) {
+    HTFrozen *fz = table->frozen;
+
+    for (i = 0; i < fz->num_keys; i++) {
+      value_free_function(fz->entries[i].value);
+    }
+    free(fz->pilots);
+    free(fz->remap);
+    free(fz->entries);
+    free(fz);
+    free(table);
+    return;
+  }
+  if (IsSmall(table)) {
+    for (i = 0; i < table->num_elements; i++) {
+      value_free_function(table->small[i].value);
+    }
+    if (table->bloom != NULL) {
+      BloomFilter_Free(table->bloom);
+    }
+    free(table);
+    return;
+  }
+  if (IsCuckoo(table)) {
+    for (i = 0; i < table->num_buckets * HT_CUCKOO_SLOTS; i++) {
+      if (CuckooOccupied(table->cuckoo, i)) {
+        value_free_function(table->cuckoo->slots[i].value);
+      }
+    }
+    FreeCuckoo(table->cuckoo);
+    free(table);
+    return;
+  }
+
+  if (table->dense != NULL) {
+    for (i = 0; i < table->dense->num_slots; i++) {
+      if (DenseHas(table->dense, i)) {
+        value_free_function(table->dense->entries[i].value);
+      }
+    }
+    FreeDense(table->dense);
+  }
+  FreeTrees(table);
+
   // Free each bucket's chain.
   for (i = 0; i < table->num_buckets; i++) {
     LinkedList *bucket = table->buckets[i];
@@ -110,51 +434,245 @@ void HashTable_Free(HashTable *table,
 
   // Free the bucket array within the table, then free the table record itself.
   free(table->buckets);
+  free(table->tags);
+  if (table->bloom != NULL) {
+    BloomFilter_Free(table->bloom);
+  }
   free(table);
 }
 
 int HashTable_NumElements(HashTable *table) {
   Verify333(table != NULL);
-  return table->num_elements;
+  // Range iterators on other threads may be removing elements.
+  return __atomic_load_n(&table->num_elements, __ATOMIC_RELAXED);
+}
+
+int HashTable_NumBuckets(HashTable *table) {
+  Verify333(table != NULL);
+  return table->num_buckets;
+}
+
+// Returns whether kv, an entry whose key matched, is the one we want: if
+// is_bytes, its bytes must match as well.
+static inline bool EntryMatches(HTKeyValue_t *kv, bool is_bytes,
+                                const void *bytes, size_t key_len) {
+  HTBytesEntry *entry = (HTBytesEntry *) kv;
+
+  return !is_bytes || (entry->key_len == key_len &&
+                       memcmp(HTBytesEntry_Key(entry), bytes, key_len) == 0);
+}
+
+// Finds the entry whose key is key in a bucket's chain.  If is_bytes, the
+// chain's entries are HTBytesEntry, key is the hash of the key_len bytes at
+// bytes, and the entry's bytes must match too.  Returns the chain node
+// holding the entry, and its position in the chain through found_pos, or
+// NULL if there is none.  A chain with a tree is searched through the
+// tree, and the position reported is -1.
+static LinkedListNode* FindInBucket(HashTable *ht, int bucket, HTKey_t key,
+                                    bool is_bytes, const void *bytes,
+                                    size_t key_len, int *found_pos) {
+  LinkedList *chain = ht->buckets[bucket];
+  uint64_t tags, matches;
+  LinkedListNode *node;
+  bool short_chain;
+  int pos = 0;
+
+  if (HasTree(ht, bucket)) {
+    *found_pos = -1;
+    return FindInTree(ht, bucket, key);  // never a byte-keyed table
+  }
+
+  // Walk the nodes directly rather than through an LLIterator, which would
+  // cost a malloc and free on every lookup.  The chain's LinkedList is
+  // needed unless the tags rule it out, so start loading it while the tags
+  // load.
+  __builtin_prefetch(chain);
+  tags = ht->tags[bucket];
+  matches = TagMatches(tags, HashKeyToTag(key));
+  short_chain = TagMatches(tags, 0) != 0;
+  if (matches == 0 && short_chain) {
+    return NULL;  // every entry is tagged, and none matches
+  }
+
+  // Hop from one entry with a matching tag to the next, loading only the
+  // nodes in between.  Keeping this loop tight matters: the CPU can then
+  // run ahead to the next node while an HTKeyValue_t is still loading.
+  node = chain->head;
+  while (matches != 0) {
+    HTKeyValue_t *kv;
+    int target = __builtin_ctzll(matches) / 8;
+
+    for (; pos < target; pos++) {
+      node = node->next;
+    }
+    kv = (HTKeyValue_t *) node->payload;
+    if (kv->key == key && EntryMatches(kv, is_bytes, bytes, key_len)) {
+      *found_pos = pos;
+      return node;
+    }
+    matches &= matches - 1;
+  }
+  if (short_chain) {
+    return NULL;  // no more candidates
+  }
+
+  // The chain is at least HT_NUM_TAGS long: compare the untagged rest.
+  for (; pos < HT_NUM_TAGS && node != NULL; pos++) {
+    node = node->next;
+  }
+  for (; node != NULL; node = node->next, pos++) {
+    HTKeyValue_t *kv = (HTKeyValue_t *) node->payload;
+    if (kv->key == key && EntryMatches(kv, is_bytes, bytes, key_len)) {
+      *found_pos = pos;
+      return node;
+    }
+  }
+  return NULL;
 }
 
 // helper function to find a key in a chain and return its key-value pair
-// parameters: the chain to traverse through, the key we are wanting to find,
-            // and a pointer to the key-value pair
+// parameters: the table and the bucket whose chain to traverse through,
+            // the key we are wanting to find, and a pointer to the
+            // key-value pair
 // returns true if the key is found, false otherwise
-static bool FindKey(LinkedList *chain, HTKey_t key, HTKeyValue_t **kv_ptr) {
-  LLIterator *it;
-  HTKeyValue_t *kv;
+static bool FindKey(HashTable *ht, int bucket, HTKey_t key,
+                    HTKeyValue_t **kv_ptr) {
+  int pos;
+  LinkedListNode *node = FindInBucket(ht, bucket, key, false, NULL, 0, &pos);
 
-  it = LLIterator_Allocate(chain);
-  while (LLIterator_IsValid(it)) {
-    LLIterator_Get(it, (LLPayload_t*)&kv);
-    if (kv->key == key) {
-      // if the key is found, store the pointer and free the iterator
-      *kv_ptr = kv;
-      LLIterator_Free(it);
-      return true;  // return true since the key was found
-    }
-    // if the current key is not the key we are looking for,
-    // move the iterator to the next element in the chain to keep traversing
-    LLIterator_Next(it);
+  *kv_ptr = node != NULL ? (HTKeyValue_t *) node->payload : NULL;
+  return node != NULL;
+}
+
+// Applies the table's chain policy to the node at position pos of a
+// bucket's chain, which a lookup has just found.
+static void ReorderChain(HashTable *ht, int bucket, LinkedListNode *node,
+                         int pos) {
+  LinkedList *chain = ht->buckets[bucket];
+  uint64_t tags = ht->tags[bucket];
+  uint64_t tag = HashKeyToTag(((HTKeyValue_t *) node->payload)->key);
+
+  if (pos <= 0) {
+    // Already at the front, or in a chain with a tree, whose lookups don't
+    // walk the chain at all.
+    return;
+  }
+
+  if (ht->chain_policy == HT_CHAIN_MOVE_TO_FRONT) {
+    // Unlink the node (it isn't the head, so it has a prev) and relink it
+    // at the head.
+    node->prev->next = node->next;
+    if (node->next != NULL) {
+      node->next->prev = node->prev;
+    } else {
+      chain->tail = node->prev;
+    }
+    node->prev = NULL;
+    node->next = chain->head;
+    chain->head->prev = node;
+    chain->head = node;
+
+    // The tags before pos shift up one to make room for the node's at 0;
+    // if the node was untagged, the last tagged entry loses its tag.
+    if (pos < HT_NUM_TAGS) {
+      uint64_t below = (1ULL << (8 * pos)) - 1;
+      uint64_t upto = below | (0xFFULL << (8 * pos));
+      tags = (tags & ~upto) | ((tags & below) << 8) | tag;
+    } else {
+      tags = (tags << 8) | tag;
+    }
+  } else {
+    // Transpose: swap the entry with the one before it.  Swapping the
+    // payloads is cheaper than relinking, and the nodes are private.
+    LLPayload_t payload = node->payload;
+    node->payload = node->prev->payload;
+    node->prev->payload = payload;
+
+    if (pos < HT_NUM_TAGS) {
+      int shift = 8 * (pos - 1);
+      uint64_t pair = (tags >> shift) & 0xFFFF;
+      pair = (pair >> 8) | ((pair & 0xFF) << 8);
+      tags = (tags & ~(0xFFFFULL << shift)) | (pair << shift);
+    } else if (pos == HT_NUM_TAGS) {
+      // The entry moves into the last tagged position.
+      int shift = 8 * (HT_NUM_TAGS - 1);
+      tags = (tags & ~(0xFFULL << shift)) | (tag << shift);
+    }
+  }
+  ht->tags[bucket] = tags;
+}
+
+// Finds the entry whose key is key in a table without buckets.  Returns
+// it, or NULL if there is none.
+static HTKeyValue_t* FindSmall(HashTable *ht, HTKey_t key) {
+  int i;
+
+  for (i = 0; i < ht->num_elements; i++) {
+    if (ht->small[i].key == key) {
+      return &ht->small[i];
+    }
   }
-  // if we reach the end of the chain and the key is not found,
-  // free the iterator since the search is over
-  LLIterator_Free(it);
-  return false;  // return false since the key was not found
+  return NULL;
+}
+
+// Removes the entry at ht->small[i] from a table without buckets, sliding
+// the later entries down so that the rest keep their order.
+static void RemoveSmall(HashTable *ht, int i) {
+  memmove(&ht->small[i], &ht->small[i + 1],
+          (ht->num_elements - i - 1) * sizeof(HTKeyValue_t));
+  ht->num_elements--;
 }
 
 bool HashTable_Insert(HashTable *table,
                       HTKeyValue_t newkeyvalue,
                       HTKeyValue_t *oldkeyvalue) {
-  int bucket;
+  int bucket, slot;
   LinkedList *chain;
   HTKeyValue_t *kv;
 
   Verify333(table != NULL);
+  Verify333(!IsFrozen(table));
+  if (IsCuckoo(table)) {
+    return InsertCuckoo(table, newkeyvalue, oldkeyvalue);
+  }
   MaybeResize(table);
 
+  if (IsSmall(table)) {
+    // a table without buckets is searched and filled in place, until the
+    // new key doesn't fit
+    kv = FindSmall(table, newkeyvalue.key);
+    if (kv != NULL) {
+      *oldkeyvalue = *kv;
+      kv->value = newkeyvalue.value;
+      return true;
+    }
+    if (table->num_elements < HT_SMALL_CAPACITY) {
+      table->small[table->num_elements++] = newkeyvalue;
+      BloomAdd(table, newkeyvalue.key);
+      return false;
+    }
+    ConvertToBuckets(table);
+  }
+
+  // a key in (or just past) the table's window goes straight to its slot
+  slot = DenseSlot(table, newkeyvalue.key);
+  if (slot < 0 && table->dense != NULL) {
+    slot = GrowDense(table, newkeyvalue.key);
+  }
+  if (slot >= 0) {
+    kv = &table->dense->entries[slot];
+    if (DenseHas(table->dense, slot)) {
+      *oldkeyvalue = *kv;
+      kv->value = newkeyvalue.value;
+      return true;
+    }
+    kv->value = newkeyvalue.value;
+    table->dense->present[slot / 64] |= 1ULL << (slot % 64);
+    table->dense->num_present++;
+    table->num_elements++;
+    return false;
+  }
+
   // calculate which bucket the key is in
   bucket = HashKeyToBucketNum(table, newkeyvalue.key);
   // get the linked list at that bucket
@@ -167,7 +685,8 @@ bool HashTable_Insert(HashTable *table,
   // all that logic inside here.  You might also find that your helper
   // can be reused in steps 2 and 3.
 
-  if (FindKey(chain, newkeyvalue.key, &kv)) {
+  // a multimap keeps every (key,value), so it has nothing to look for
+  if (!table->multi && FindKey(table, bucket, newkeyvalue.key, &kv)) {
     // if the key is found, replace the value
     *oldkeyvalue = *kv;  // copy the old key-value pair
     kv->value = newkeyvalue.value;  // update with the new value
@@ -182,6 +701,9 @@ bool HashTable_Insert(HashTable *table,
   Verify333(kv != NULL);
   *kv = newkeyvalue;
   LinkedList_Push(chain, (LLPayload_t)kv);
+  PushTag(table, bucket, kv->key);
+  ChainGrew(table, bucket);
+  BloomAdd(table, kv->key);
   // update num_elements to show a new key-value pair was added
   table->num_elements++;
   // return false because there was no existing pair with that key
@@ -192,239 +714,2240 @@ bool HashTable_Find(HashTable *table,
                     HTKey_t key,
                     HTKeyValue_t *keyvalue) {
   int bucket;  // index of the bucket where the key should be
-  LinkedList *chain;  // the chain we're traversing through
-  HTKeyValue_t *kv;  // the key-value pair
+  LinkedListNode *node;  // the chain node holding the key-value pair
+  int pos;  // and its position in the chain
+  int slot;  // the key's slot in the table's window (or cuckoo slots)
 
   Verify333(table != NULL);
 
+  if (table->buckets == NULL) {
+    // a table without buckets is small, frozen or cuckoo; any way, the
+    // entry is found without walking a chain
+    HTKeyValue_t *kv;
+
+    if (IsCuckoo(table)) {
+      slot = FindCuckooSlot(table, key);
+      kv = slot >= 0 ? &table->cuckoo->slots[slot] : NULL;
+    } else {
+      kv = IsFrozen(table) ? FindFrozen(table, key) : FindSmall(table, key);
+    }
+    if (kv == NULL) {
+      return false;
+    }
+    *keyvalue = *kv;
+    return true;
+  }
+
+  // a key in the window is in its slot or nowhere
+  slot = DenseSlot(table, key);
+  if (slot >= 0) {
+    if (!DenseHas(table->dense, slot)) {
+      return false;
+    }
+    *keyvalue = table->dense->entries[slot];
+    return true;
+  }
+
+  // a definite miss in the Bloom filter saves walking the chain
+  if (!BloomMayContain(table, key)) {
+    return false;
+  }
+
   // calculate which bucket this key is in
   bucket = HashKeyToBucketNum(table, key);
-  // get the linked list at that bucket
-  chain = table->buckets[bucket];
 
-  if (FindKey(chain, key, &kv)) {
+  node = FindInBucket(table, bucket, key, false, NULL, 0, &pos);
+  if (node != NULL) {
     // if the key is found, copy the key-value pair
-    *keyvalue = *kv;
+    *keyvalue = *(HTKeyValue_t *) node->payload;
+    // then, if the table reorders its chains, move the pair forward
+    if (table->chain_policy != HT_CHAIN_STATIC) {
+      ReorderChain(table, bucket, node, pos);
+    }
     return true;  // return true since we found the key
   }
   return false;  // return false since we did not find the key
 }
 
+int HashTable_FindBatch(HashTable *table, const HTKey_t *keys, int n,
+                        HTKeyValue_t *results, bool *found) {
+  LinkedListNode *nodes[FIND_BATCH_GROUP];
+  LinkedList *chains[FIND_BATCH_GROUP];
+  uint64_t bloom_hashes[FIND_BATCH_GROUP];
+  uint64_t matches[FIND_BATCH_GROUP];
+  bool short_chains[FIND_BATCH_GROUP];
+  int buckets[FIND_BATCH_GROUP], positions[FIND_BATCH_GROUP];
+  int base, i, num_found = 0;
+
+  Verify333(table != NULL);
+  Verify333(n >= 0);
+
+  if (IsFrozen(table)) {
+    return FindBatchFrozen(table, keys, n, results, found);
+  }
+  if (IsCuckoo(table)) {
+    return FindBatchCuckoo(table, keys, n, results, found);
+  }
+  if (IsSmall(table)) {
+    // Everything is in one or two cache lines; there's nothing to overlap.
+    for (i = 0; i < n; i++) {
+      found[i] = HashTable_Find(table, keys[i], &results[i]);
+      num_found += found[i];
+    }
+    return num_found;
+  }
+
+  // Each group of lookups goes through the same dependent loads as
+  // HashTable_Find -- bucket tags and array slot, LinkedList, node,
+  // HTKeyValue_t -- one level at a time: prefetch that level for every
+  // lookup in the group, then read it for every lookup.  By the time we
+  // read a lookup's line, its miss has been in flight while we issued the
+  // others'.  A table with a Bloom filter checks it alongside the bucket,
+  // and drops the lookups it rules out; the tags drop more, and say which
+  // HTKeyValue_ts are worth loading.
+  for (base = 0; base < n; base += FIND_BATCH_GROUP) {
+    int count = (n - base < FIND_BATCH_GROUP) ? n - base : FIND_BATCH_GROUP;
+    int active = 0;
+
+    for (i = 0; i < count; i++) {
+      int slot = DenseSlot(table, keys[base + i]);
+
+      found[base + i] = false;
+      if (slot >= 0) {
+        // The window answers right away; there's no chain to walk.
+        buckets[i] = INVALID_IDX;
+        if (DenseHas(table->dense, slot)) {
+          results[base + i] = table->dense->entries[slot];
+          found[base + i] = true;
+          num_found++;
+        }
+        continue;
+      }
+      if (table->bloom != NULL) {
+        bloom_hashes[i] = HashKeyToBloomHash(table, keys[base + i]);
+        BloomFilter_Prefetch(table->bloom, bloom_hashes[i]);
+      }
+      buckets[i] = HashKeyToBucketNum(table, keys[base + i]);
+      __builtin_prefetch(&table->tags[buckets[i]]);
+      __builtin_prefetch(&table->buckets[buckets[i]]);
+    }
+    for (i = 0; i < count; i++) {
+      uint64_t tags;
+
+      chains[i] = NULL;
+      if (buckets[i] == INVALID_IDX ||
+          (table->bloom != NULL &&
+           !BloomFilter_MayContain(table->bloom, bloom_hashes[i]))) {
+        continue;
+      }
+      if (HasTree(table, buckets[i])) {
+        // A long chain's tree answers without the side-by-side walk.
+        LinkedListNode *node = FindInTree(table, buckets[i], keys[base + i]);
+
+        if (node != NULL) {
+          results[base + i] = *(HTKeyValue_t *) node->payload;
+          found[base + i] = true;
+          num_found++;
+        }
+        continue;
+      }
+      tags = table->tags[buckets[i]];
+      matches[i] = TagMatches(tags, HashKeyToTag(keys[base + i]));
+      short_chains[i] = TagMatches(tags, 0) != 0;
+      if (TagsMayMatchFrom(matches[i], short_chains[i], 0)) {
+        chains[i] = table->buckets[buckets[i]];
+        __builtin_prefetch(chains[i]);
+      }
+    }
+    for (i = 0; i < count; i++) {
+      nodes[i] = (chains[i] != NULL) ? chains[i]->head : NULL;
+      positions[i] = 0;
+      if (nodes[i] != NULL) {
+        __builtin_prefetch(nodes[i]);
+        active++;
+      }
+    }
+
+    // Walk the chains side by side, one node per lookup per round.
+    while (active > 0) {
+      for (i = 0; i < count; i++) {
+        if (nodes[i] != NULL && TagMayMatch(matches[i], positions[i])) {
+          __builtin_prefetch(nodes[i]->payload);
+        }
+      }
+      for (i = 0; i < count; i++) {
+        if (nodes[i] == NULL) {
+          continue;
+        }
+        if (TagMayMatch(matches[i], positions[i])) {
+          HTKeyValue_t *kv = (HTKeyValue_t *) nodes[i]->payload;
+          if (kv->key == keys[base + i]) {
+            results[base + i] = *kv;
+            found[base + i] = true;
+            num_found++;
+            nodes[i] = NULL;
+            active--;
+            continue;
+          }
+        }
+        nodes[i] = nodes[i]->next;
+        positions[i]++;
+        if (nodes[i] != NULL &&
+            TagsMayMatchFrom(matches[i], short_chains[i], positions[i])) {
+          __builtin_prefetch(nodes[i]);
+        } else {
+          nodes[i] = NULL;
+          active--;
+        }
+      }
+    }
+  }
+  return num_found;
+}
+
+// helper function to unlink a key-value pair from a chain and free it
+// parameters: the table and the bucket whose chain holds the pair, and a
+            // pointer to the pair itself (as found by FindKey or an
+            // iterator)
+static void RemoveFromChain(HashTable *ht, int bucket, HTKeyValue_t *kv) {
+  LLIterator *it;
+  int pos = 0;
+
+  if (HasTree(ht, bucket)) {
+    // the tree finds the node without a walk
+    RemoveFromTree(ht, bucket, kv);
+    return;
+  }
+
+  it = LLIterator_Allocate(ht->buckets[bucket]);
+  while (LLIterator_IsValid(it)) {
+    HTKeyValue_t *curr;
+    LLIterator_Get(it, (LLPayload_t*)&curr);
+    if (curr == kv) {
+      // the current element is the one we want to remove
+      LLIterator_Remove(it, free);
+      LLIterator_Free(it);  // free the iterator since we're done
+      if (pos < HT_NUM_TAGS) {
+        RemoveTag(ht, bucket, pos);
+      }
+      return;
+    }
+    // if the current element is not the one we want to remove,
+    // continue iterating through the chain
+    LLIterator_Next(it);
+    pos++;
+  }
+  // the caller promised that kv is in this chain
+  Verify333(false);
+}
+
+static void RemoveTag(HashTable *ht, int bucket, int pos) {
+  LinkedList *chain = ht->buckets[bucket];
+  uint64_t below = (1ULL << (8 * pos)) - 1;  // the tags before pos
+  uint64_t tags = ht->tags[bucket];
+
+  // Slide the tags after pos down over it.
+  tags = (tags & below) | ((tags >> 8) & ~below);
+  if (LinkedList_NumElements(chain) >= HT_NUM_TAGS) {
+    // The chain was longer than HT_NUM_TAGS, so the entry that slid into
+    // the last tagged position has no tag yet.
+    LinkedListNode *node = chain->head;
+    int i;
+
+    for (i = 0; i < HT_NUM_TAGS - 1; i++) {
+      node = node->next;
+    }
+    tags |= (uint64_t) HashKeyToTag(((HTKeyValue_t *) node->payload)->key)
+            << (8 * (HT_NUM_TAGS - 1));
+  }
+  ht->tags[bucket] = tags;
+}
+
 bool HashTable_Remove(HashTable *table,
                       HTKey_t key,
                       HTKeyValue_t *keyvalue) {
   int bucket;  // the index of the bucket where the key should be
-  LinkedList *chain;  // the chain we're iterating through
+  int slot;  // or its slot in the table's window
   HTKeyValue_t *kv;  // the key-value pair
-  LLIterator *it;  // the iterator
 
   Verify333(table != NULL);
+  Verify333(!IsFrozen(table));
+
+  if (IsSmall(table)) {
+    kv = FindSmall(table, key);
+    if (kv == NULL) {
+      return false;
+    }
+    *keyvalue = *kv;
+    RemoveSmall(table, (int) (kv - table->small));
+    BloomRemoved(table);
+    return true;
+  }
+  if (IsCuckoo(table)) {
+    slot = FindCuckooSlot(table, key);
+    if (slot < 0) {
+      return false;
+    }
+    *keyvalue = table->cuckoo->slots[slot];
+    table->cuckoo->tags[slot / HT_CUCKOO_SLOTS] &=
+        ~(0xffU << (8 * (slot % HT_CUCKOO_SLOTS)));
+    table->num_elements--;
+    return true;
+  }
+
+  slot = DenseSlot(table, key);
+  if (slot >= 0) {
+    if (!DenseHas(table->dense, slot)) {
+      return false;
+    }
+    *keyvalue = table->dense->entries[slot];
+    table->dense->present[slot / 64] &= ~(1ULL << (slot % 64));
+    table->dense->num_present--;
+    table->num_elements--;
+    return true;
+  }
 
   // calculate which bucket this key is in
   bucket = HashKeyToBucketNum(table, key);
-  // get the linked list at that bucket
-  chain = table->buckets[bucket];
 
-  if (FindKey(chain, key, &kv)) {
+  if (FindKey(table, bucket, key, &kv)) {
     // if the key is found, copy the key-value pair
     *keyvalue = *kv;
-    // create an iterator to remove the element
-    it = LLIterator_Allocate(chain);
-    while (LLIterator_IsValid(it)) {
-      HTKeyValue_t *curr;
-      LLIterator_Get(it, (LLPayload_t*)&curr);
-      if (curr == kv) {
-        // the current element is the one we want to remove
-        LLIterator_Remove(it, free);
-        LLIterator_Free(it);  // free the iterator since we're done
-        // update num_elements to show we removed an element from the chain
-        table->num_elements--;
-        // return true since the key was found, and therefore the associated
-        // key-value pair was returned to the caller via that keyvalue return
-        // parameter and the key-value pair was removed from the HashTable
-        return true;
-      }
-      // if the current element is not the one we want to remove,
-      // continue iterating through the chain
-      LLIterator_Next(it);
-    }
-    // if we reach the end of the chain and the goal element is not found,
-    // free the iterator since we are done
-    LLIterator_Free(it);
+    RemoveFromChain(table, bucket, kv);
+    // update num_elements to show we removed an element from the chain
+    table->num_elements--;
+    BloomRemoved(table);
+    // return true since the key was found, and therefore the associated
+    // key-value pair was returned to the caller via that keyvalue return
+    // parameter and the key-value pair was removed from the HashTable
+    return true;
   }
   return false;  // return false since the key wasn't found in the HashTable
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
-// HTIterator implementation.
-
-HTIterator* HTIterator_Allocate(HashTable *table) {
-  HTIterator *iter;
-  int         i;
-
+void HashTable_EnableBloomFilter(HashTable *table, double fp_rate) {
   Verify333(table != NULL);
+  Verify333(fp_rate >= 0 && fp_rate <= 0.5);
 
-  iter = (HTIterator *) malloc(sizeof(HTIterator));
+  if (IsFrozen(table) || IsCuckoo(table)) {
+    return;  // its lookups never walk a chain
+  }
+  if (table->bloom != NULL) {
+    BloomFilter_Free(table->bloom);
+    table->bloom = NULL;
+  }
+  if (fp_rate > 0) {
+    table->bloom_fp_rate = fp_rate;
+    RebuildBloomFilter(table);
+  }
+}
+
+void HashTable_SetChainPolicy(HashTable *table, HTChainPolicy policy) {
+  Verify333(table != NULL);
+  Verify333(policy == HT_CHAIN_STATIC || policy == HT_CHAIN_MOVE_TO_FRONT ||
+            policy == HT_CHAIN_TRANSPOSE);
+  table->chain_policy = policy;
+}
+
+static void RebuildBloomFilter(HashTable *ht) {
+  int i;
+
+  // Leave room to double before the next rebuild.
+  ht->bloom_capacity = 2 * ht->num_elements;
+  if (ht->bloom_capacity < HT_BLOOM_MIN_CAPACITY) {
+    ht->bloom_capacity = HT_BLOOM_MIN_CAPACITY;
+  }
+  ht->bloom_removed = 0;
+  if (ht->bloom != NULL) {
+    BloomFilter_Free(ht->bloom);
+  }
+  ht->bloom = BloomFilter_Allocate(ht->bloom_capacity, ht->bloom_fp_rate);
+
+  if (IsSmall(ht)) {
+    for (i = 0; i < ht->num_elements; i++) {
+      BloomFilter_Add(ht->bloom, HashKeyToBloomHash(ht, ht->small[i].key));
+    }
+    return;
+  }
+  for (i = 0; i < ht->num_buckets; i++) {
+    LinkedListNode *node;
+
+    for (node = ht->buckets[i]->head; node != NULL; node = node->next) {
+      HTKeyValue_t *kv = (HTKeyValue_t *) node->payload;
+      BloomFilter_Add(ht->bloom, HashKeyToBloomHash(ht, kv->key));
+    }
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Byte-string keys.
+
+// Hashes a byte-string key with the table's hash (see
+// HashTable_SetBytesHash).  A seeded table seeds this hash too, though its
+// buckets are chosen by HashKeyToBucketNum's SipHash either way.
+static HTKey_t HashKeyBytes(HashTable *table, const void *key,
+                            size_t key_len) {
+  return table->bytes_hash(key, key_len, table->seed[0]);
+}
+
+void HashTable_SetBytesHash(HashTable *table, HashAlgorithm algorithm) {
+  Verify333(table != NULL);
+  // The entries cache their hashes, so the hash can't change under them.
+  Verify333(!table->byte_keys);
+  table->bytes_hash = Hash_Function(algorithm);
+}
+
+// Finds the entry whose key is the key_len bytes at key (and whose hash is
+// hash) in a bucket's chain.  Returns it, or NULL if there is none.
+static HTBytesEntry* FindBytesEntry(HashTable *table, int bucket,
+                                    HTKey_t hash, const void *key,
+                                    size_t key_len) {
+  int pos;
+  LinkedListNode *node = FindInBucket(table, bucket, hash, true, key,
+                                      key_len, &pos);
+
+  return node != NULL ? (HTBytesEntry *) node->payload : NULL;
+}
+
+bool HashTable_InsertBytes(HashTable *table, const void *key, size_t key_len,
+                           HTValue_t value, HTValue_t *oldvalue) {
+  HTBytesEntry *entry;
+  HTKey_t hash;
+  int bucket;
+
+  Verify333(table != NULL);
+  Verify333(!IsFrozen(table) && !IsCuckoo(table) && !table->multi &&
+            !table->dense_enabled);
+  // Hashes of byte strings needn't be unique, so trees can't index them.
+  table->byte_keys = true;
+  FreeTrees(table);
+  if (IsSmall(table)) {
+    ConvertToBuckets(table);
+  }
+  MaybeResize(table);
+
+  hash = HashKeyBytes(table, key, key_len);
+  bucket = HashKeyToBucketNum(table, hash);
+  entry = FindBytesEntry(table, bucket, hash, key, key_len);
+  if (entry != NULL) {
+    *oldvalue = entry->kv.value;
+    entry->kv.value = value;
+    return true;
+  }
+
+  // One allocation holds the entry and a copy of the key.
+  entry = (HTBytesEntry *) malloc(sizeof(HTBytesEntry) + key_len);
+  Verify333(entry != NULL);
+  entry->kv.key = hash;
+  entry->kv.value = value;
+  entry->key_len = key_len;
+  memcpy(HTBytesEntry_Key(entry), key, key_len);
+  LinkedList_Push(table->buckets[bucket], (LLPayload_t)entry);
+  PushTag(table, bucket, hash);
+  BloomAdd(table, hash);
+  table->num_elements++;
+  return false;
+}
+
+bool HashTable_FindBytes(HashTable *table, const void *key, size_t key_len,
+                         HTValue_t *value) {
+  LinkedListNode *node;
+  HTKey_t hash;
+  int bucket, pos;
+
+  Verify333(table != NULL);
+  if (table->buckets == NULL) {
+    return false;  // byte-string keys are always in buckets
+  }
+
+  hash = HashKeyBytes(table, key, key_len);
+  if (!BloomMayContain(table, hash)) {
+    return false;
+  }
+  bucket = HashKeyToBucketNum(table, hash);
+  node = FindInBucket(table, bucket, hash, true, key, key_len, &pos);
+  if (node == NULL) {
+    return false;
+  }
+  *value = ((HTBytesEntry *) node->payload)->kv.value;
+  if (table->chain_policy != HT_CHAIN_STATIC) {
+    ReorderChain(table, bucket, node, pos);
+  }
+  return true;
+}
+
+bool HashTable_RemoveBytes(HashTable *table, const void *key, size_t key_len,
+                           HTValue_t *value) {
+  HTBytesEntry *entry;
+  HTKey_t hash;
+  int bucket;
+
+  Verify333(table != NULL);
+  Verify333(!IsFrozen(table));
+  if (table->buckets == NULL) {
+    return false;  // byte-string keys are always in buckets
+  }
+
+  hash = HashKeyBytes(table, key, key_len);
+  bucket = HashKeyToBucketNum(table, hash);
+  entry = FindBytesEntry(table, bucket, hash, key, key_len);
+  if (entry == NULL) {
+    return false;
+  }
+  *value = entry->kv.value;
+  RemoveFromChain(table, bucket, &entry->kv);
+  table->num_elements--;
+  BloomRemoved(table);
+  return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Frozen tables.
+
+// The slot that a key with mixed hash hash goes to, if its group's pilot
+// is pilot.
+static inline uint32_t FrozenSlot(uint64_t hash, uint32_t pilot,
+                                  uint32_t num_slots) {
+  uint64_t x = hash ^ ((uint64_t) pilot * 0x9e3779b97f4a7c15ULL);
+
+  x ^= x >> 32;
+  x *= 0xd6e8feb86659fd93ULL;
+  x ^= x >> 32;
+  return (uint32_t) (((x >> 32) * num_slots) >> 32);
+}
+
+// The group of a key with mixed hash hash.
+static inline uint32_t FrozenGroup(uint64_t hash, uint32_t num_groups) {
+  return (uint32_t) (((hash >> 32) * num_groups) >> 32);
+}
+
+// The index into fz->entries of the key with mixed hash hash, if it is
+// one of the table's keys.  fz must have at least one key.
+static inline uint32_t FrozenIndex(HTFrozen *fz, uint64_t hash) {
+  uint32_t slot = FrozenSlot(hash,
+                             fz->pilots[FrozenGroup(hash, fz->num_groups)],
+                             fz->num_slots);
+
+  return slot < (uint32_t) fz->num_keys ? slot
+                                        : fz->remap[slot - fz->num_keys];
+}
+
+static HTKeyValue_t* FindFrozen(HashTable *ht, HTKey_t key) {
+  HTFrozen *fz = ht->frozen;
+  HTKeyValue_t *kv;
+
+  if (fz->num_keys == 0) {
+    return NULL;
+  }
+  kv = &fz->entries[FrozenIndex(fz, HashKeyToBloomHash(ht, key))];
+  return kv->key == key ? kv : NULL;
+}
+
+static int FindBatchFrozen(HashTable *ht, const HTKey_t *keys, int n,
+                           HTKeyValue_t *results, bool *found) {
+  HTFrozen *fz = ht->frozen;
+  uint64_t hashes[FIND_BATCH_GROUP];
+  uint32_t slots[FIND_BATCH_GROUP];
+  int base, i, num_found = 0;
+
+  if (fz->num_keys == 0) {
+    for (i = 0; i < n; i++) {
+      found[i] = false;
+    }
+    return 0;
+  }
+
+  // The same idea as for a chained table, with two levels: prefetch every
+  // lookup's pilot, then every lookup's entry, then compare.
+  for (base = 0; base < n; base += FIND_BATCH_GROUP) {
+    int count = n - base < FIND_BATCH_GROUP ? n - base : FIND_BATCH_GROUP;
+
+    for (i = 0; i < count; i++) {
+      hashes[i] = HashKeyToBloomHash(ht, keys[base + i]);
+      __builtin_prefetch(
+          &fz->pilots[FrozenGroup(hashes[i], fz->num_groups)]);
+    }
+    for (i = 0; i < count; i++) {
+      slots[i] = FrozenIndex(fz, hashes[i]);
+      __builtin_prefetch(&fz->entries[slots[i]]);
+    }
+    for (i = 0; i < count; i++) {
+      HTKeyValue_t *kv = &fz->entries[slots[i]];
+
+      found[base + i] = kv->key == keys[base + i];
+      if (found[base + i]) {
+        results[base + i] = *kv;
+        num_found++;
+      }
+    }
+  }
+  return num_found;
+}
+
+// Finds a pilot for each group of the index, in fz->pilots, and marks the
+// slots its keys take in taken.  group_start[g] .. group_start[g + 1] - 1
+// index the hashes of group g's keys in hashes.  order is scratch space
+// for fz->num_groups ints.
+static void FindPilots(HTFrozen *fz, const uint64_t *hashes,
+                       const int *group_start, uint64_t *taken, int *order) {
+  uint32_t slots[64];
+  int *size_count, max_size = 0, g, i;
+
+  // Place the biggest groups first, while most slots are still free.
+  for (g = 0; g < fz->num_groups; g++) {
+    int size = group_start[g + 1] - group_start[g];
+    if (size > max_size) {
+      max_size = size;
+    }
+  }
+  Verify333(max_size <= 64);
+  size_count = (int *) calloc(max_size + 2, sizeof(int));
+  Verify333(size_count != NULL);
+  for (g = 0; g < fz->num_groups; g++) {
+    size_count[max_size - (group_start[g + 1] - group_start[g]) + 1]++;
+  }
+  for (i = 1; i <= max_size + 1; i++) {
+    size_count[i] += size_count[i - 1];
+  }
+  for (g = 0; g < fz->num_groups; g++) {
+    order[size_count[max_size - (group_start[g + 1] - group_start[g])]++] = g;
+  }
+
+  for (i = 0; i < fz->num_groups; i++) {
+    int begin, size, j, k;
+    uint32_t pilot;
+
+    g = order[i];
+    begin = group_start[g];
+    size = group_start[g + 1] - begin;
+    fz->pilots[g] = 0;
+    if (size == 0) {
+      continue;
+    }
+    // Try pilots until every key of the group lands on a free slot, and
+    // no two on the same one.
+    for (pilot = 0; ; pilot++) {
+      bool fits = true;
+
+      Verify333(pilot != UINT32_MAX);
+      for (j = 0; j < size && fits; j++) {
+        slots[j] = FrozenSlot(hashes[begin + j], pilot, fz->num_slots);
+        fits = !(taken[slots[j] / 64] & (1ULL << (slots[j] % 64)));
+        for (k = 0; k < j && fits; k++) {
+          fits = slots[k] != slots[j];
+        }
+      }
+      if (fits) {
+        break;
+      }
+    }
+    fz->pilots[g] = pilot;
+    for (j = 0; j < size; j++) {
+      taken[slots[j] / 64] |= 1ULL << (slots[j] % 64);
+    }
+  }
+  free(size_count);
+}
+
+void HashTable_Freeze(HashTable *table) {
+  HTFrozen *fz;
+  HTKeyValue_t *flat;
+  uint64_t *hashes, *taken;
+  int *group_start, *group_of, *order, n, i, free_slot;
+
+  Verify333(table != NULL);
+  Verify333(!table->byte_keys && !table->multi);
+  if (IsFrozen(table)) {
+    return;
+  }
+
+  // Allocate everything first: freeing the chains leaves malloc with a
+  // great many small free chunks to tidy up, which it does, slowly, at the
+  // next big allocation.
+  n = table->num_elements;
+  fz = (HTFrozen *) malloc(sizeof(HTFrozen));
+  Verify333(fz != NULL);
+  fz->num_keys = n;
+  fz->num_slots = n + n / 32 + 1;
+  fz->num_groups = n / HT_FROZEN_GROUP_SIZE + 1;
+  fz->pilots = (uint32_t *) malloc(fz->num_groups * sizeof(uint32_t));
+  fz->remap = (uint32_t *) calloc(fz->num_slots - n, sizeof(uint32_t));
+  fz->entries = (HTKeyValue_t *) malloc((n > 0 ? n : 1) *
+                                        sizeof(HTKeyValue_t));
+  Verify333(fz->pilots != NULL && fz->remap != NULL && fz->entries != NULL);
+
+  flat = (HTKeyValue_t *) malloc((n > 0 ? n : 1) * sizeof(HTKeyValue_t));
+  hashes = (uint64_t *) malloc((n > 0 ? n : 1) * sizeof(uint64_t));
+  group_of = (int *) malloc((n > 0 ? n : 1) * sizeof(int));
+  group_start = (int *) calloc(fz->num_groups + 2, sizeof(int));
+  taken = (uint64_t *) calloc(fz->num_slots / 64 + 1, sizeof(uint64_t));
+  order = (int *) malloc(fz->num_groups * sizeof(int));
+  Verify333(flat != NULL && hashes != NULL && group_of != NULL &&
+            group_start != NULL && taken != NULL && order != NULL);
+
+  // Move the entries out, freeing the old layout (but not the values) as
+  // we go, so that each node is only loaded once.
+  if (IsSmall(table)) {
+    memcpy(flat, table->small, n * sizeof(HTKeyValue_t));
+  } else if (IsCuckoo(table)) {
+    int s;
+
+    for (i = 0, s = 0; s < table->num_buckets * HT_CUCKOO_SLOTS; s++) {
+      if (CuckooOccupied(table->cuckoo, s)) {
+        flat[i++] = table->cuckoo->slots[s];
+      }
+    }
+    Verify333(i == n);
+    FreeCuckoo(table->cuckoo);
+    table->cuckoo = NULL;
+  } else {
+    HTKeyValue_t *kv;
+    int b;
+
+    i = 0;
+    if (table->dense != NULL) {
+      for (b = 0; b < table->dense->num_slots; b++) {
+        if (DenseHas(table->dense, b)) {
+          flat[i++] = table->dense->entries[b];
+        }
+      }
+      FreeDense(table->dense);
+      table->dense = NULL;
+    }
+    FreeTrees(table);
+    for (b = 0; b < table->num_buckets; b++) {
+      while (LinkedList_Pop(table->buckets[b], (LLPayload_t *)&kv)) {
+        flat[i++] = *kv;
+        free(kv);
+      }
+      LinkedList_Free(table->buckets[b], &LLNoOpFree);
+    }
+    Verify333(i == n);
+    free(table->buckets);
+    free(table->tags);
+    table->buckets = NULL;
+    table->tags = NULL;
+  }
+  if (table->bloom != NULL) {
+    BloomFilter_Free(table->bloom);
+    table->bloom = NULL;
+  }
+
+  // Sort the keys' hashes by group (a counting sort), so each group's are
+  // together.
+  for (i = 0; i < n; i++) {
+    group_of[i] = (int) FrozenGroup(HashKeyToBloomHash(table, flat[i].key),
+                                    fz->num_groups);
+    group_start[group_of[i] + 2]++;
+  }
+  for (i = 0; i < fz->num_groups; i++) {
+    group_start[i + 1] += group_start[i];
+  }
+  // Now group_start[g + 1] is where group g begins; filling the groups
+  // moves it up to where group g ends, which is where g + 1 begins.
+  for (i = 0; i < n; i++) {
+    hashes[group_start[group_of[i] + 1]++] =
+        HashKeyToBloomHash(table, flat[i].key);
+  }
+
+  FindPilots(fz, hashes, group_start, taken, order);
+
+  // Send each taken slot past the end to a free one before it.
+  free_slot = 0;
+  for (i = n; i < fz->num_slots; i++) {
+    if (taken[i / 64] & (1ULL << (i % 64))) {
+      while (taken[free_slot / 64] & (1ULL << (free_slot % 64))) {
+        free_slot++;
+      }
+      fz->remap[i - n] = free_slot++;
+    }
+  }
+
+  for (i = 0; i < n; i++) {
+    fz->entries[FrozenIndex(fz, HashKeyToBloomHash(table, flat[i].key))] =
+        flat[i];
+  }
+  table->frozen = fz;
+  table->num_buckets = n / HT_FLAT_RANGE + 1;
+
+  free(order);
+  free(taken);
+  free(group_start);
+  free(group_of);
+  free(hashes);
+  free(flat);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers for the parallel operations.
+
+static void RunParallel(void *tasks, size_t task_size, int num_tasks,
+                        void (*fn)(void *)) {
+  TaskGroup *group;
+  int t;
+
+  if (num_tasks == 1) {
+    fn(tasks);  // not worth a trip through the pool
+    return;
+  }
+  group = TaskGroup_Allocate(ThreadPool_Default());
+  for (t = 0; t < num_tasks; t++) {
+    TaskGroup_Submit(group, fn, (char *) tasks + t * task_size);
+  }
+  TaskGroup_Wait(group);
+  TaskGroup_Free(group);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parallel bulk build.
+//
+// HashTable_BuildFromArray runs in three phases, each spread over
+// num_threads threads:
+//  1. each thread hashes a contiguous slice of the input and counts how
+//     many of its pairs fall into each thread's range of buckets;
+//  2. each thread scatters its slice into a scratch array that is grouped
+//     by bucket range, using offsets computed from the phase 1 counts;
+//  3. each thread builds the chains for its own range of buckets.
+// Phase 2 preserves input order within each range, so phase 3 sees
+// duplicate keys in array order and the last one wins.
+
+// Per-thread state for the build.
+typedef struct {
+  HashTable      *ht;
+  HTKeyValue_t   *input;          // the caller's array
+  int             in_begin;       // [in_begin, in_end) is our input slice
+  int             in_end;
+  int            *bucket_of;      // bucket number of each input pair
+  int            *counts;         // phase 1: # pairs per bucket range
+  int            *cursors;        // phase 2: next scratch slot per range
+  HTKeyValue_t   *scratch;        // input pairs, grouped by bucket range
+  int             out_begin;      // [out_begin, out_end) of scratch is
+  int             out_end;        //   the pairs in our bucket range
+  int             buckets_per_range;
+  ValueFreeFnPtr  value_free_function;
+  int             num_added;      // phase 3: # of distinct keys inserted
+} BuildTask;
+
+static void BuildCount(void *arg) {
+  BuildTask *task = (BuildTask *) arg;
+  int i;
+
+  for (i = task->in_begin; i < task->in_end; i++) {
+    int b = HashKeyToBucketNum(task->ht, task->input[i].key);
+    task->bucket_of[i] = b;
+    task->counts[b / task->buckets_per_range]++;
+  }
+}
+
+static void BuildScatter(void *arg) {
+  BuildTask *task = (BuildTask *) arg;
+  int i;
+
+  for (i = task->in_begin; i < task->in_end; i++) {
+    int range = task->bucket_of[i] / task->buckets_per_range;
+    task->scratch[task->cursors[range]++] = task->input[i];
+  }
+}
+
+static void BuildChains(void *arg) {
+  BuildTask *task = (BuildTask *) arg;
+  int i;
+
+  for (i = task->out_begin; i < task->out_end; i++) {
+    HTKeyValue_t *newkv = &task->scratch[i];
+    int bucket = HashKeyToBucketNum(task->ht, newkv->key);
+    HTKeyValue_t *kv;
+
+    if (FindKey(task->ht, bucket, newkv->key, &kv)) {
+      task->value_free_function(kv->value);
+      kv->value = newkv->value;
+      continue;
+    }
+    kv = (HTKeyValue_t *) malloc(sizeof(HTKeyValue_t));
+    Verify333(kv != NULL);
+    *kv = *newkv;
+    LinkedList_Push(task->ht->buckets[bucket], (LLPayload_t) kv);
+    PushTag(task->ht, bucket, kv->key);
+    task->num_added++;
+  }
+}
+
+HashTable* HashTable_BuildFromArray(HTKeyValue_t *keyvalues,
+                                    int num_keyvalues,
+                                    int num_threads,
+                                    ValueFreeFnPtr value_free_function) {
+  HashTable *ht;
+  BuildTask *tasks;
+  HTKeyValue_t *scratch;
+  int *bucket_of, *counts, *cursors;
+  int num_tasks, per_slice, t, r, offset;
+
+  Verify333(num_keyvalues >= 0);
+  Verify333(keyvalues != NULL || num_keyvalues == 0);
+  Verify333(num_threads > 0);
+  Verify333(value_free_function != NULL);
+
+  // Size the table for a load factor of 1 so that it won't need to resize
+  // until it has tripled in size.
+  ht = HashTable_Allocate(num_keyvalues > 0 ? num_keyvalues : 1);
+  if (num_keyvalues == 0) {
+    return ht;
+  }
+
+  // There's no point in having more threads than buckets.
+  num_tasks = num_threads;
+  if (num_tasks > ht->num_buckets) {
+    num_tasks = ht->num_buckets;
+  }
+
+  tasks = (BuildTask *) malloc(num_tasks * sizeof(BuildTask));
+  bucket_of = (int *) malloc(num_keyvalues * sizeof(int));
+  scratch = (HTKeyValue_t *) malloc(num_keyvalues * sizeof(HTKeyValue_t));
+  counts = (int *) calloc(num_tasks * num_tasks, sizeof(int));
+  cursors = (int *) malloc(num_tasks * num_tasks * sizeof(int));
+  Verify333(tasks != NULL && bucket_of != NULL && scratch != NULL &&
+            counts != NULL && cursors != NULL);
+
+  per_slice = (num_keyvalues + num_tasks - 1) / num_tasks;
+  for (t = 0; t < num_tasks; t++) {
+    BuildTask *task = &tasks[t];
+    task->ht = ht;
+    task->input = keyvalues;
+    task->in_begin = t * per_slice < num_keyvalues ?
+        t * per_slice : num_keyvalues;
+    task->in_end = task->in_begin + per_slice < num_keyvalues ?
+        task->in_begin + per_slice : num_keyvalues;
+    task->bucket_of = bucket_of;
+    task->counts = &counts[t * num_tasks];
+    task->cursors = &cursors[t * num_tasks];
+    task->scratch = scratch;
+    task->buckets_per_range =
+        (ht->num_buckets + num_tasks - 1) / num_tasks;
+    task->value_free_function = value_free_function;
+    task->num_added = 0;
+  }
+
+  RunParallel(tasks, sizeof(BuildTask), num_tasks, &BuildCount);
+
+  // Lay out the scratch array range by range; within a range, slice t's
+  // pairs follow slice t-1's, which keeps the input order.
+  offset = 0;
+  for (r = 0; r < num_tasks; r++) {
+    tasks[r].out_begin = offset;
+    for (t = 0; t < num_tasks; t++) {
+      tasks[t].cursors[r] = offset;
+      offset += tasks[t].counts[r];
+    }
+    tasks[r].out_end = offset;
+  }
+  Verify333(offset == num_keyvalues);
+
+  RunParallel(tasks, sizeof(BuildTask), num_tasks, &BuildScatter);
+  RunParallel(tasks, sizeof(BuildTask), num_tasks, &BuildChains);
+  TreeifyLongChains(ht);
+
+  for (t = 0; t < num_tasks; t++) {
+    ht->num_elements += tasks[t].num_added;
+  }
+
+  free(tasks);
+  free(bucket_of);
+  free(scratch);
+  free(counts);
+  free(cursors);
+  return ht;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HTIterator implementation.
+
+// The entries of a table without buckets.
+static inline HTKeyValue_t* FlatEntries(HashTable *ht) {
+  return IsFrozen(ht) ? ht->frozen->entries : ht->small;
+}
+
+// One past the last slot of FlatEntries an iterator may visit.
+static inline int FlatEnd(HTIterator *iter) {
+  int64_t end = (int64_t) iter->bucket_end * HT_FLAT_RANGE;
+  return end < iter->ht->num_elements ? (int) end : iter->ht->num_elements;
+}
+
+// The first slot of a table's window that an iterator over buckets
+// [bucket, ...) visits: the window is shared out among the buckets in
+// proportion.
+static inline int DenseRangeStart(HashTable *ht, int bucket) {
+  return (int) ((int64_t) bucket * ht->dense->num_slots / ht->num_buckets);
+}
+
+// Returns the first slot in [slot, end) of a window whose entry is in the
+// table, or end if there is none.
+static int NextDenseSlot(HTDense *dense, int slot, int end) {
+  while (slot < end) {
+    uint64_t word = __atomic_load_n(&dense->present[slot / 64],
+                                    __ATOMIC_RELAXED) >> (slot % 64);
+    if (word != 0) {
+      slot += __builtin_ctzll(word);
+      return slot < end ? slot : end;
+    }
+    slot = (slot / 64 + 1) * 64;
+  }
+  return end;
+}
+
+// Returns the first slot in [slot, end) of a cuckoo table that holds an
+// entry, or end if there is none.
+static int NextCuckooSlot(HTCuckoo *cuckoo, int slot, int end) {
+  while (slot < end && !CuckooOccupied(cuckoo, slot)) {
+    slot++;
+  }
+  return slot;
+}
+
+// Points an iterator at the first entry of the first nonempty chain in
+// buckets [bucket, iter->bucket_end), or makes it invalid if there is
+// none.  Returns whether it is valid.
+static bool FirstChainFrom(HTIterator *iter, int bucket) {
+  for (; bucket < iter->bucket_end; bucket++) {
+    if (LinkedList_NumElements(iter->ht->buckets[bucket]) > 0) {
+      iter->bucket_idx = bucket;
+      iter->bucket_it = LLIterator_Allocate(iter->ht->buckets[bucket]);
+      return true;
+    }
+  }
+  iter->bucket_idx = INVALID_IDX;
+  return false;
+}
+
+// The entry a valid iterator points at.
+static inline HTKeyValue_t* IterEntry(HTIterator *iter) {
+  HTKeyValue_t *kv;
+
+  if (iter->dense_slot < iter->dense_end) {
+    return &iter->ht->dense->entries[iter->dense_slot];
+  }
+  if (IsCuckoo(iter->ht)) {
+    return &iter->ht->cuckoo->slots[iter->slot];
+  }
+  if (iter->ht->buckets == NULL) {
+    return &FlatEntries(iter->ht)[iter->slot];
+  }
+  LLIterator_Get(iter->bucket_it, (LLPayload_t*)&kv);
+  return kv;
+}
+
+// Moves an iterator to the next element, whatever its key.
+static bool StepIterator(HTIterator *iter);
+
+// Moves an iterator from HashTable_FindAll forward until it points at an
+// entry with its key, if it doesn't already.  Returns whether it is valid.
+static bool SkipToMatch(HTIterator *iter) {
+  while (iter->match_key && HTIterator_IsValid(iter) &&
+         IterEntry(iter)->key != iter->key) {
+    StepIterator(iter);
+  }
+  return HTIterator_IsValid(iter);
+}
+
+HTIterator* HTIterator_Allocate(HashTable *table) {
+  Verify333(table != NULL);
+  return HTIterator_AllocateRange(table, 0, table->num_buckets);
+}
+
+HTIterator* HTIterator_AllocateRange(HashTable *table,
+                                     int bucket_begin, int bucket_end) {
+  HTIterator *iter;
+
+  Verify333(table != NULL);
+  Verify333(0 <= bucket_begin && bucket_begin <= bucket_end);
+  Verify333(bucket_end <= table->num_buckets);
+
+  iter = (HTIterator *) malloc(sizeof(HTIterator));
   Verify333(iter != NULL);
 
+  iter->ht = table;
+  iter->bucket_end = bucket_end;
+  iter->bucket_it = NULL;
+  iter->bucket_idx = INVALID_IDX;
+  iter->slot = 0;
+  iter->match_key = false;
+  iter->key = 0;
+  iter->dense_slot = iter->dense_end = 0;
+
   // If the hash table is empty, the iterator is immediately invalid,
   // since it can't point to anything.
-  if (table->num_elements == 0) {
-    iter->ht = table;
+  if (HashTable_NumElements(table) == 0) {
+    return iter;
+  }
+
+  // A cuckoo table's buckets are its own.
+  if (IsCuckoo(table)) {
+    iter->slot = NextCuckooSlot(table->cuckoo,
+                                bucket_begin * HT_CUCKOO_SLOTS,
+                                bucket_end * HT_CUCKOO_SLOTS);
+    if (iter->slot < bucket_end * HT_CUCKOO_SLOTS) {
+      iter->bucket_idx = bucket_begin;
+    }
+    return iter;
+  }
+
+  // A table without buckets splits its flat array into "buckets" of
+  // HT_FLAT_RANGE entries.
+  if (table->buckets == NULL) {
+    iter->slot = bucket_begin * HT_FLAT_RANGE;
+    if (iter->slot < FlatEnd(iter)) {
+      iter->bucket_idx = bucket_begin;
+    }
+    return iter;
+  }
+
+  // The range's share of the window, if any, comes first.
+  if (table->dense != NULL) {
+    iter->dense_end = DenseRangeStart(table, bucket_end);
+    iter->dense_slot = NextDenseSlot(table->dense,
+                                     DenseRangeStart(table, bucket_begin),
+                                     iter->dense_end);
+    if (iter->dense_slot < iter->dense_end) {
+      iter->bucket_idx = bucket_begin;
+      return iter;
+    }
+  }
+
+  // Initialize the iterator.  Find the first element in the range and
+  // point the iterator at it; if there is none, the iterator stays invalid.
+  FirstChainFrom(iter, bucket_begin);
+  return iter;
+}
+
+void HTIterator_Free(HTIterator *iter) {
+  Verify333(iter != NULL);
+  if (iter->bucket_it != NULL) {
+    LLIterator_Free(iter->bucket_it);
     iter->bucket_it = NULL;
+  }
+  free(iter);
+}
+
+bool HTIterator_IsValid(HTIterator *iter) {
+  Verify333(iter != NULL);
+
+  // STEP 4: implement HTIterator_IsValid.
+
+  // check if the iterator is valid and returning false if it is invalid/NULL
+  if (iter->bucket_idx == INVALID_IDX) {
+    return false;
+  }
+  if (iter->dense_slot < iter->dense_end) {
+    return true;
+  }
+  if (IsCuckoo(iter->ht)) {
+    return iter->slot < iter->bucket_end * HT_CUCKOO_SLOTS;
+  }
+  if (iter->ht->buckets == NULL) {
+    return iter->slot < FlatEnd(iter);
+  }
+  if (iter->bucket_it == NULL) {
+    return false;
+  }
+
+  // checking if the iterator is valid using our function from LinkedList.c
+  return LLIterator_IsValid(iter->bucket_it);
+}
+
+bool HTIterator_Next(HTIterator *iter) {
+  Verify333(iter != NULL);
+  if (iter->match_key && IsFrozen(iter->ht)) {
+    // A frozen table holds a key once, and HashTable_FindAll pointed the
+    // iterator straight at it: there's nothing after it to visit.
     iter->bucket_idx = INVALID_IDX;
+    return false;
+  }
+  return StepIterator(iter) && SkipToMatch(iter);
+}
+
+static bool StepIterator(HTIterator *iter) {
+  // STEP 5: implement HTIterator_Next.
+
+  // returning false if the iterator is invalid
+  if (!HTIterator_IsValid(iter)) {
+    return false;
+  }
+
+  if (iter->dense_slot < iter->dense_end) {
+    iter->dense_slot = NextDenseSlot(iter->ht->dense, iter->dense_slot + 1,
+                                     iter->dense_end);
+    if (iter->dense_slot < iter->dense_end) {
+      return true;
+    }
+    // On to the range's chains, from its first bucket.
+    return FirstChainFrom(iter, iter->bucket_idx);
+  }
+
+  if (IsCuckoo(iter->ht)) {
+    int end = iter->bucket_end * HT_CUCKOO_SLOTS;
+
+    iter->slot = NextCuckooSlot(iter->ht->cuckoo, iter->slot + 1, end);
+    if (iter->slot < end) {
+      return true;
+    }
+    iter->bucket_idx = INVALID_IDX;
+    return false;
+  }
+
+  if (iter->ht->buckets == NULL) {
+    if (++iter->slot < FlatEnd(iter)) {
+      return true;
+    }
+    iter->bucket_idx = INVALID_IDX;
+    return false;
+  }
+
+  // trying to iterate through the current bucket
+  if (LLIterator_Next(iter->bucket_it)) {
+    return true;  // successfuly moved to the next element in current bucket
+  }
+
+  // once we reach the end of the current bucket, free the iterator
+  LLIterator_Free(iter->bucket_it);
+  iter->bucket_it = NULL;
+
+  // searching for the next non-empty bucket; if there are no more, the
+  // iterator is done
+  return FirstChainFrom(iter, iter->bucket_idx + 1);
+}
+
+bool HTIterator_Get(HTIterator *iter, HTKeyValue_t *keyvalue) {
+  HTKeyValue_t *kv;
+
+  Verify333(iter != NULL);
+
+  // STEP 6: implement HTIterator_Get.
+
+  // return false if the iterator is invalid
+  if (!HTIterator_IsValid(iter)) {
+    return false;
+  }
+
+  // get the current element from the iterator
+  kv = IterEntry(iter);
+
+  // copy the key-value pair to the output parameter
+  *keyvalue = *kv;
+  return true;  // you may need to change this return value
+}
+
+bool HTIterator_GetBytes(HTIterator *iter, const void **key, size_t *key_len,
+                         HTValue_t *value) {
+  HTBytesEntry *entry;
+
+  Verify333(iter != NULL);
+  if (!HTIterator_IsValid(iter)) {
+    return false;
+  }
+  // a table without buckets, or with a window, has no byte-string keys
+  Verify333(iter->ht->buckets != NULL && iter->ht->dense == NULL);
+
+  LLIterator_Get(iter->bucket_it, (LLPayload_t*)&entry);
+  *key = HTBytesEntry_Key(entry);
+  *key_len = entry->key_len;
+  *value = entry->kv.value;
+  return true;
+}
+
+bool HTIterator_Remove(HTIterator *iter, HTKeyValue_t *keyvalue) {
+  HTKeyValue_t *kv;
+  int bucket;
+
+  Verify333(iter != NULL);
+
+  // Try to get what the iterator is pointing to.
+  if (!HTIterator_IsValid(iter)) {
+    return false;
+  }
+  Verify333(!IsFrozen(iter->ht));
+
+  if (IsSmall(iter->ht)) {
+    // The later entries slide down, so the iterator already points at the
+    // next one.
+    *keyvalue = iter->ht->small[iter->slot];
+    RemoveSmall(iter->ht, iter->slot);
+    if (iter->slot >= FlatEnd(iter)) {
+      iter->bucket_idx = INVALID_IDX;
+    }
+    SkipToMatch(iter);
+    if (iter->ht->bloom != NULL) {
+      iter->ht->bloom_removed++;
+    }
+    return true;
+  }
+
+  if (IsCuckoo(iter->ht)) {
+    int slot = iter->slot;
+
+    // Only this slot's bucket, which no other range visits, and the count
+    // change.
+    *keyvalue = iter->ht->cuckoo->slots[slot];
+    iter->ht->cuckoo->tags[slot / HT_CUCKOO_SLOTS] &=
+        ~(0xffU << (8 * (slot % HT_CUCKOO_SLOTS)));
+    HTIterator_Next(iter);
+    __atomic_fetch_sub(&iter->ht->num_elements, 1, __ATOMIC_RELAXED);
+    return true;
+  }
+
+  if (iter->dense_slot < iter->dense_end) {
+    HTDense *dense = iter->ht->dense;
+    int slot = iter->dense_slot;
+
+    // As below, only this slot's bit and the counts change, atomically.
+    *keyvalue = dense->entries[slot];
+    HTIterator_Next(iter);
+    __atomic_fetch_and(&dense->present[slot / 64], ~(1ULL << (slot % 64)),
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&dense->num_present, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&iter->ht->num_elements, 1, __ATOMIC_RELAXED);
+    return true;
+  }
+
+  LLIterator_Get(iter->bucket_it, (LLPayload_t*)&kv);
+  bucket = iter->bucket_idx;
+
+  // Advance the iterator.  Thanks to the above check, we know that this
+  // iterator is valid (though it may not be valid after this call to
+  // HTIterator_Next).
+  HTIterator_Next(iter);
+
+  // Lastly, remove the element.  We unlink the exact entry we were pointing
+  // at rather than looking its key up again, and we only touch its chain,
+  // its tags and the element count, so range iterators over other buckets
+  // can be removing at the same time.
+  *keyvalue = *kv;
+  RemoveFromChain(iter->ht, bucket, kv);
+  __atomic_fetch_sub(&iter->ht->num_elements, 1, __ATOMIC_RELAXED);
+  if (iter->ht->bloom != NULL) {
+    // Don't rebuild here: other range iterators may be using the table.
+    // The next insert or remove will.
+    __atomic_fetch_add(&iter->ht->bloom_removed, 1, __ATOMIC_RELAXED);
+  }
+
+  return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Multimap tables.
+
+HTIterator* HashTable_FindAll(HashTable *table, HTKey_t key) {
+  HTIterator *iter;
+  int begin, end, slot;
+
+  Verify333(table != NULL);
+
+  // Only the key's bucket can hold it, and if the Bloom filter rules the
+  // key out, the iterator needn't visit anything.  (A table without
+  // buckets reports one, which holds everything.)
+  if (IsCuckoo(table)) {
+    // The key is in one of two buckets; point a range at the one it's in.
+    slot = FindCuckooSlot(table, key);
+    begin = slot >= 0 ? slot / HT_CUCKOO_SLOTS : 0;
+    iter = HTIterator_AllocateRange(table, begin, slot >= 0 ? begin + 1
+                                                            : begin);
+    iter->match_key = true;
+    iter->key = key;
+    SkipToMatch(iter);
     return iter;
   }
 
-  // Initialize the iterator.  There is at least one element in the
-  // table, so find the first element and point the iterator at it.
-  iter->ht = table;
-  for (i = 0; i < table->num_buckets; i++) {
-    if (LinkedList_NumElements(table->buckets[i]) > 0) {
-      iter->bucket_idx = i;
+  if (IsFrozen(table)) {
+    // The index finds the key's one entry, if any; point a range over its
+    // stretch of the flat array at the entry itself.
+    HTKeyValue_t *kv = FindFrozen(table, key);
+
+    slot = kv != NULL ? (int) (kv - table->frozen->entries) : 0;
+    begin = slot / HT_FLAT_RANGE;
+    iter = HTIterator_AllocateRange(table, begin, kv != NULL ? begin + 1
+                                                             : begin);
+    iter->match_key = true;
+    iter->key = key;
+    iter->slot = slot;
+    return iter;
+  }
+
+  begin = table->buckets != NULL ? HashKeyToBucketNum(table, key) : 0;
+  end = begin + 1;
+  slot = DenseSlot(table, key);
+  if (slot >= 0 || !BloomMayContain(table, key)) {
+    end = begin;
+  }
+  iter = HTIterator_AllocateRange(table, begin, end);
+  iter->match_key = true;
+  iter->key = key;
+
+  // A key in the window is in its slot or nowhere: visit just the slot.
+  if (slot >= 0 && DenseHas(table->dense, slot)) {
+    iter->dense_slot = slot;
+    iter->dense_end = slot + 1;
+    iter->bucket_idx = begin;
+  }
+  SkipToMatch(iter);
+  return iter;
+}
+
+bool HashTable_RemoveOne(HashTable *table, HTKey_t key, HTValue_t value) {
+  HTIterator *iter;
+  HTKeyValue_t kv;
+  bool found = false;
+
+  Verify333(table != NULL);
+  Verify333(!IsFrozen(table));
+
+  iter = HashTable_FindAll(table, key);
+  while (HTIterator_Get(iter, &kv)) {
+    if (kv.value == value) {
+      HTIterator_Remove(iter, &kv);
+      found = true;
       break;
     }
+    HTIterator_Next(iter);
   }
-  Verify333(i < table->num_buckets);  // make sure we found it.
-  iter->bucket_it = LLIterator_Allocate(table->buckets[iter->bucket_idx]);
-  return iter;
+  HTIterator_Free(iter);
+  return found;
 }
 
-void HTIterator_Free(HTIterator *iter) {
-  Verify333(iter != NULL);
-  if (iter->bucket_it != NULL) {
-    LLIterator_Free(iter->bucket_it);
-    iter->bucket_it = NULL;
+int HashTable_RemoveAll(HashTable *table, HTKey_t key,
+                        ValueFreeFnPtr value_free_function) {
+  HTIterator *iter;
+  HTKeyValue_t kv;
+  int num_removed = 0;
+
+  Verify333(table != NULL);
+  Verify333(!IsFrozen(table));
+
+  // HTIterator_Remove moves on to the next entry with the key.
+  iter = HashTable_FindAll(table, key);
+  while (HTIterator_Remove(iter, &kv)) {
+    value_free_function(kv.value);
+    num_removed++;
   }
-  free(iter);
+  HTIterator_Free(iter);
+  return num_removed;
 }
 
-bool HTIterator_IsValid(HTIterator *iter) {
-  Verify333(iter != NULL);
 
-  // STEP 4: implement HTIterator_IsValid.
+///////////////////////////////////////////////////////////////////////////////
+// Dense key ranges.
 
-  // check if the iterator is valid and returning false if it is invalid/NULL
-  if (iter->bucket_idx == INVALID_IDX || iter->bucket_it == NULL) {
-    return false;
+void HashTable_EnableDense(HashTable *table) {
+  Verify333(table != NULL);
+  Verify333(!IsFrozen(table) && !IsCuckoo(table) && !table->multi &&
+            !table->byte_keys);
+
+  // The outliers need chains.
+  if (IsSmall(table)) {
+    ConvertToBuckets(table);
+  }
+  table->dense_enabled = true;
+  if (table->dense == NULL) {
+    DetectDense(table);
   }
+}
 
-  // checking if the iterator is valid using our function from LinkedList.c
-  return LLIterator_IsValid(iter->bucket_it);
+static HTDense* NewDense(HTKey_t first_key, int num_slots) {
+  HTDense *dense = (HTDense *) malloc(sizeof(HTDense));
+  int i;
+
+  Verify333(dense != NULL);
+  dense->first_key = first_key;
+  dense->num_slots = num_slots;
+  dense->num_present = 0;
+  dense->present = (uint64_t *) calloc((num_slots + 63) / 64,
+                                       sizeof(uint64_t));
+  dense->entries = (HTKeyValue_t *) malloc(num_slots * sizeof(HTKeyValue_t));
+  Verify333(dense->present != NULL && dense->entries != NULL);
+  for (i = 0; i < num_slots; i++) {
+    dense->entries[i].key = first_key + i;
+    dense->entries[i].value = NULL;
+  }
+  return dense;
 }
 
-bool HTIterator_Next(HTIterator *iter) {
-  Verify333(iter != NULL);
+static void FreeDense(HTDense *dense) {
+  free(dense->present);
+  free(dense->entries);
+  free(dense);
+}
 
-  // STEP 5: implement HTIterator_Next.
+// Moves every entry on a table's chains whose key is in its window into
+// the window, and retags the chains it took entries from.
+static void PullIntoDense(HashTable *ht) {
+  HTDense *dense = ht->dense;
+  int b;
 
-  // returning false if the iterator is invalid
-  if (!HTIterator_IsValid(iter)) {
-    return false;
+  // The chains shrink, so their trees are rebuilt afterward.
+  FreeTrees(ht);
+  for (b = 0; b < ht->num_buckets; b++) {
+    LLIterator *it;
+    bool moved = false;
+
+    if (LinkedList_NumElements(ht->buckets[b]) == 0) {
+      continue;
+    }
+    it = LLIterator_Allocate(ht->buckets[b]);
+    while (LLIterator_IsValid(it)) {
+      HTKeyValue_t *kv;
+      int slot;
+
+      LLIterator_Get(it, (LLPayload_t*)&kv);
+      slot = DenseSlot(ht, kv->key);
+      if (slot < 0) {
+        LLIterator_Next(it);
+        continue;
+      }
+      dense->entries[slot].value = kv->value;
+      dense->present[slot / 64] |= 1ULL << (slot % 64);
+      dense->num_present++;
+      LLIterator_Remove(it, free);
+      moved = true;
+    }
+    LLIterator_Free(it);
+
+    if (moved) {
+      LinkedListNode *node = ht->buckets[b]->head;
+      int pos;
+
+      ht->tags[b] = 0;
+      for (pos = 0; pos < HT_NUM_TAGS && node != NULL; pos++) {
+        ht->tags[b] |= (uint64_t) HashKeyToTag(
+            ((HTKeyValue_t *) node->payload)->key) << (8 * pos);
+        node = node->next;
+      }
+    }
+  }
+  TreeifyLongChains(ht);
+  if (ht->bloom != NULL) {
+    // The keys that moved are stale in the filter now.
+    RebuildBloomFilter(ht);
   }
+}
 
-  // trying to iterate through the current bucket
-  if (LLIterator_Next(iter->bucket_it)) {
-    return true;  // successfuly moved to the next element in current bucket
+static int GrowDense(HashTable *ht, HTKey_t key) {
+  HTDense *dense = ht->dense;
+  uint64_t offset = key - dense->first_key;
+  int old_slots = dense->num_slots, new_slots = 2 * old_slots, i;
+
+  if (offset >= (uint64_t) new_slots || new_slots > HT_DENSE_MAX_SLOTS ||
+      2 * dense->num_present < old_slots ||
+      dense->first_key + (new_slots - 1) < dense->first_key) {
+    return -1;
   }
 
-  // once we reach the end of the current bucket, free the iterator
-  LLIterator_Free(iter->bucket_it);
-  iter->bucket_it = NULL;
+  dense->present = (uint64_t *) realloc(dense->present,
+                                        (new_slots + 63) / 64 *
+                                        sizeof(uint64_t));
+  dense->entries = (HTKeyValue_t *) realloc(dense->entries,
+                                            new_slots * sizeof(HTKeyValue_t));
+  Verify333(dense->present != NULL && dense->entries != NULL);
+  for (i = (old_slots + 63) / 64; i < (new_slots + 63) / 64; i++) {
+    dense->present[i] = 0;
+  }
+  for (i = old_slots; i < new_slots; i++) {
+    dense->entries[i].key = dense->first_key + i;
+    dense->entries[i].value = NULL;
+  }
+  dense->num_slots = new_slots;
+
+  // Some outliers may be outliers no more.
+  PullIntoDense(ht);
+  return (int) offset;
+}
 
-  // searching for the next non-empty bucket
-  for (int i = iter->bucket_idx + 1; i < iter->ht->num_buckets; i++) {
-    if (LinkedList_NumElements(iter->ht->buckets[i]) > 0) {
-      // found a non-empty bucket
-      iter->bucket_idx = i;  // update the bucket index
-      iter->bucket_it = LLIterator_Allocate(iter->ht->buckets[i]);
-      return true;  // successfully moved to the first element in the new bucket
+static void DetectDense(HashTable *ht) {
+  int counts[65] = {0};
+  int num_keys = ChainElements(ht), in_window = 0, best = -1, b, bits;
+  HTKey_t first_key = UINT64_MAX;
+  LinkedListNode *node;
+
+  if (num_keys < HT_DENSE_MIN_SLOTS / 2) {
+    return;
+  }
+
+  // The window starts at the smallest key.  Count the keys by how many
+  // bits their distance from it takes: the keys less than 2^bits past it
+  // are counts[0] + ... + counts[bits].
+  for (b = 0; b < ht->num_buckets; b++) {
+    for (node = ht->buckets[b]->head; node != NULL; node = node->next) {
+      HTKey_t key = ((HTKeyValue_t *) node->payload)->key;
+      first_key = key < first_key ? key : first_key;
+    }
+  }
+  for (b = 0; b < ht->num_buckets; b++) {
+    for (node = ht->buckets[b]->head; node != NULL; node = node->next) {
+      uint64_t offset = ((HTKeyValue_t *) node->payload)->key - first_key;
+      counts[offset == 0 ? 0 : 64 - __builtin_clzll(offset)]++;
     }
   }
 
-  // if there are no more non-empty buckets found, return false
-  iter->bucket_idx = INVALID_IDX;
+  // Take the biggest window that would be at least a quarter full (as a
+  // grown window is) and hold at least half the keys, so that high
+  // outliers don't spoil it.
+  for (bits = 0; (1 << bits) <= HT_DENSE_MAX_SLOTS; bits++) {
+    in_window += counts[bits];
+    if ((1 << bits) >= HT_DENSE_MIN_SLOTS &&
+        4 * in_window >= (1 << bits) && 2 * in_window >= num_keys &&
+        first_key + ((1 << bits) - 1) >= first_key) {
+      best = bits;
+    }
+  }
+  if (best < 0) {
+    return;
+  }
+  ht->dense = NewDense(first_key, 1 << best);
+  PullIntoDense(ht);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Cuckoo tables.
+
+// One bucket visited by the search for an empty slot: bucket, reached by
+// moving the key in slot from_slot of queue[parent]'s bucket (the roots,
+// the new key's own buckets, have parent -1).
+typedef struct {
+  int bucket;
+  int parent;
+  int from_slot;
+} CuckooSearchNode;
+
+static HTCuckoo* NewCuckoo(int num_buckets) {
+  HTCuckoo *cuckoo = (HTCuckoo *) malloc(sizeof(HTCuckoo));
+
+  Verify333(cuckoo != NULL);
+  cuckoo->tags = (uint32_t *) calloc(num_buckets, sizeof(uint32_t));
+  // A bucket's slots are a cache line, so line them up with the lines.
+  cuckoo->slots = (HTKeyValue_t *) aligned_alloc(
+      64, (size_t) num_buckets * HT_CUCKOO_SLOTS * sizeof(HTKeyValue_t));
+  Verify333(cuckoo->tags != NULL && cuckoo->slots != NULL);
+  return cuckoo;
+}
+
+static void FreeCuckoo(HTCuckoo *cuckoo) {
+  free(cuckoo->tags);
+  free(cuckoo->slots);
+  free(cuckoo);
+}
+
+// Finds key's two buckets in a table of num_buckets (a power of two): two
+// independent halves of its mixed hash, kept distinct.
+static inline void CuckooBuckets(HashTable *ht, int num_buckets, HTKey_t key,
+                                 int *b1, int *b2) {
+  uint64_t hash = HashKeyToBloomHash(ht, key);
+
+  *b1 = (int) (hash & (num_buckets - 1));
+  *b2 = (int) ((hash >> 32) & (num_buckets - 1));
+  if (*b2 == *b1) {
+    *b2 = *b1 ^ 1;
+  }
+}
+
+// The index in bucket of the key whose tag is tag and key is key, or -1.
+static inline int FindInCuckooBucket(HTCuckoo *cuckoo, int bucket,
+                                     uint8_t tag, HTKey_t key) {
+  uint64_t matches = TagMatches(cuckoo->tags[bucket], tag);
+
+  while (matches != 0) {
+    int i = __builtin_ctzll(matches) / 8;
+
+    if (cuckoo->slots[bucket * HT_CUCKOO_SLOTS + i].key == key) {
+      return i;
+    }
+    matches &= matches - 1;
+  }
+  return -1;
+}
+
+// The index of an empty slot in bucket, or -1 if it is full.
+static inline int EmptyCuckooSlot(HTCuckoo *cuckoo, int bucket) {
+  uint32_t tags = cuckoo->tags[bucket];
+  int i;
+
+  for (i = 0; i < HT_CUCKOO_SLOTS; i++) {
+    if (((tags >> (8 * i)) & 0xff) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Stores kv in slot i of bucket.
+static inline void SetCuckooSlot(HTCuckoo *cuckoo, int bucket, int i,
+                                 HTKeyValue_t kv) {
+  cuckoo->slots[bucket * HT_CUCKOO_SLOTS + i] = kv;
+  cuckoo->tags[bucket] = (cuckoo->tags[bucket] & ~(0xffU << (8 * i))) |
+                         ((uint32_t) HashKeyToTag(kv.key) << (8 * i));
+}
+
+static int FindCuckooSlot(HashTable *ht, HTKey_t key) {
+  uint8_t tag = HashKeyToTag(key);
+  int b1, b2, i;
+
+  CuckooBuckets(ht, ht->num_buckets, key, &b1, &b2);
+  if ((i = FindInCuckooBucket(ht->cuckoo, b1, tag, key)) >= 0) {
+    return b1 * HT_CUCKOO_SLOTS + i;
+  }
+  if ((i = FindInCuckooBucket(ht->cuckoo, b2, tag, key)) >= 0) {
+    return b2 * HT_CUCKOO_SLOTS + i;
+  }
+  return -1;
+}
+
+// Places kv, whose key isn't in the table, in storage with num_buckets
+// buckets.  If both of its buckets are full, searches breadth-first from
+// them for the shortest chain of keys to move, each to its other bucket,
+// that ends in an empty slot, and makes the moves.  Returns false, with
+// nothing changed, if there is no such chain within
+// HT_CUCKOO_SEARCH_NODES buckets.
+static bool PlaceCuckoo(HashTable *ht, HTCuckoo *cuckoo, int num_buckets,
+                        HTKeyValue_t kv) {
+  CuckooSearchNode queue[HT_CUCKOO_SEARCH_NODES];
+  int head, tail = 2, b1, b2;
+
+  CuckooBuckets(ht, num_buckets, kv.key, &b1, &b2);
+  queue[0] = (CuckooSearchNode) {b1, -1, -1};
+  queue[1] = (CuckooSearchNode) {b2, -1, -1};
+
+  for (head = 0; head < tail; head++) {
+    int bucket = queue[head].bucket, empty = EmptyCuckooSlot(cuckoo, bucket);
+    int node, i;
+
+    if (empty >= 0) {
+      // Walk back to the root, moving each key forward into the slot the
+      // one after it vacated.
+      for (node = head; queue[node].parent >= 0; node = queue[node].parent) {
+        CuckooSearchNode *n = &queue[node];
+        int from = queue[n->parent].bucket;
+
+        SetCuckooSlot(cuckoo, n->bucket, empty,
+                      cuckoo->slots[from * HT_CUCKOO_SLOTS + n->from_slot]);
+        empty = n->from_slot;
+      }
+      SetCuckooSlot(cuckoo, queue[node].bucket, empty, kv);
+      return true;
+    }
+
+    // Every slot is taken: queue the other bucket of each key in it,
+    // unless that bucket is already on the path here, since moving a key
+    // twice would undo a move.
+    for (i = 0; i < HT_CUCKOO_SLOTS && tail < HT_CUCKOO_SEARCH_NODES; i++) {
+      HTKey_t key = cuckoo->slots[bucket * HT_CUCKOO_SLOTS + i].key;
+      int c1, c2, other;
+
+      CuckooBuckets(ht, num_buckets, key, &c1, &c2);
+      other = (c1 == bucket) ? c2 : c1;
+      for (node = head; node >= 0; node = queue[node].parent) {
+        if (queue[node].bucket == other) {
+          break;
+        }
+      }
+      if (node < 0) {
+        queue[tail++] = (CuckooSearchNode) {other, head, i};
+      }
+    }
+  }
   return false;
 }
 
-bool HTIterator_Get(HTIterator *iter, HTKeyValue_t *keyvalue) {
-  HTKeyValue_t *kv;
+// Doubles a cuckoo table's buckets (or more, if the entries don't all fit)
+// and places every entry again.
+static void GrowCuckoo(HashTable *ht) {
+  HTCuckoo *old = ht->cuckoo;
+  int old_num_slots = ht->num_buckets * HT_CUCKOO_SLOTS;
+  int num_buckets = ht->num_buckets;
+
+  for (;;) {
+    HTCuckoo *cuckoo;
+    int i;
+
+    num_buckets *= 2;
+    cuckoo = NewCuckoo(num_buckets);
+    for (i = 0; i < old_num_slots; i++) {
+      if (CuckooOccupied(old, i) &&
+          !PlaceCuckoo(ht, cuckoo, num_buckets, old->slots[i])) {
+        break;
+      }
+    }
+    if (i == old_num_slots) {
+      FreeCuckoo(old);
+      ht->cuckoo = cuckoo;
+      ht->num_buckets = num_buckets;
+      return;
+    }
+    FreeCuckoo(cuckoo);
+  }
+}
 
-  Verify333(iter != NULL);
+static bool InsertCuckoo(HashTable *ht, HTKeyValue_t newkeyvalue,
+                         HTKeyValue_t *oldkeyvalue) {
+  int slot = FindCuckooSlot(ht, newkeyvalue.key);
 
-  // STEP 6: implement HTIterator_Get.
+  if (slot >= 0) {
+    *oldkeyvalue = ht->cuckoo->slots[slot];
+    ht->cuckoo->slots[slot].value = newkeyvalue.value;
+    return true;
+  }
 
-  // return false if the iterator is invalid
-  if (!HTIterator_IsValid(iter)) {
-    return false;
+  // Grow at the maximum load, or when the search for a free slot fails.
+  if ((int64_t) (ht->num_elements + 1) * 100 >
+      (int64_t) ht->num_buckets * HT_CUCKOO_SLOTS * HT_CUCKOO_MAX_LOAD) {
+    GrowCuckoo(ht);
+  }
+  while (!PlaceCuckoo(ht, ht->cuckoo, ht->num_buckets, newkeyvalue)) {
+    GrowCuckoo(ht);
   }
+  ht->num_elements++;
+  return false;
+}
 
-  // get the current element from the iterator
-  LLIterator_Get(iter->bucket_it, (LLPayload_t*)&kv);
+static int FindBatchCuckoo(HashTable *ht, const HTKey_t *keys, int n,
+                           HTKeyValue_t *results, bool *found) {
+  int b1[FIND_BATCH_GROUP], b2[FIND_BATCH_GROUP];
+  int base, i, num_found = 0;
+
+  // Two levels of loads, bucket tags then slots, each prefetched for the
+  // whole group before any of it is read, as in HashTable_FindBatch.
+  for (base = 0; base < n; base += FIND_BATCH_GROUP) {
+    int count = (n - base < FIND_BATCH_GROUP) ? n - base : FIND_BATCH_GROUP;
+
+    for (i = 0; i < count; i++) {
+      CuckooBuckets(ht, ht->num_buckets, keys[base + i], &b1[i], &b2[i]);
+      __builtin_prefetch(&ht->cuckoo->tags[b1[i]]);
+      __builtin_prefetch(&ht->cuckoo->tags[b2[i]]);
+      __builtin_prefetch(&ht->cuckoo->slots[b1[i] * HT_CUCKOO_SLOTS]);
+      __builtin_prefetch(&ht->cuckoo->slots[b2[i] * HT_CUCKOO_SLOTS]);
+    }
+    for (i = 0; i < count; i++) {
+      HTKey_t key = keys[base + i];
+      uint8_t tag = HashKeyToTag(key);
+      int bucket = b1[i], j = FindInCuckooBucket(ht->cuckoo, bucket, tag, key);
+
+      if (j < 0) {
+        bucket = b2[i];
+        j = FindInCuckooBucket(ht->cuckoo, bucket, tag, key);
+      }
+      found[base + i] = j >= 0;
+      if (j >= 0) {
+        results[base + i] = ht->cuckoo->slots[bucket * HT_CUCKOO_SLOTS + j];
+        num_found++;
+      }
+    }
+  }
+  return num_found;
+}
 
-  // copy the key-value pair to the output parameter
-  *keyvalue = *kv;
-  return true;  // you may need to change this return value
+
+///////////////////////////////////////////////////////////////////////////////
+// Long chains.
+
+// The height of a tree, which is 0 if it is empty.
+static inline int TreeHeight(HTTreeNode *t) {
+  return t != NULL ? t->height : 0;
 }
 
-bool HTIterator_Remove(HTIterator *iter, HTKeyValue_t *keyvalue) {
-  HTKeyValue_t kv;
+static inline void UpdateHeight(HTTreeNode *t) {
+  int left = TreeHeight(t->left), right = TreeHeight(t->right);
 
-  Verify333(iter != NULL);
+  t->height = (left > right ? left : right) + 1;
+}
 
-  // Try to get what the iterator is pointing to.
-  if (!HTIterator_Get(iter, &kv)) {
-    return false;
+// Rotates t's right (or left) child up into t's place, and returns it.
+static HTTreeNode* RotateLeft(HTTreeNode *t) {
+  HTTreeNode *r = t->right;
+
+  t->right = r->left;
+  r->left = t;
+  UpdateHeight(t);
+  UpdateHeight(r);
+  return r;
+}
+
+static HTTreeNode* RotateRight(HTTreeNode *t) {
+  HTTreeNode *l = t->left;
+
+  t->left = l->right;
+  l->right = t;
+  UpdateHeight(t);
+  UpdateHeight(l);
+  return l;
+}
+
+// Restores the AVL balance at t, whose subtrees are balanced but may
+// differ in height by two after an insert or remove below it.  Returns
+// the subtree's new root.
+static HTTreeNode* Rebalance(HTTreeNode *t) {
+  int balance = TreeHeight(t->left) - TreeHeight(t->right);
+
+  if (balance > 1) {
+    if (TreeHeight(t->left->left) < TreeHeight(t->left->right)) {
+      t->left = RotateLeft(t->left);
+    }
+    return RotateRight(t);
   }
+  if (balance < -1) {
+    if (TreeHeight(t->right->right) < TreeHeight(t->right->left)) {
+      t->right = RotateRight(t->right);
+    }
+    return RotateLeft(t);
+  }
+  UpdateHeight(t);
+  return t;
+}
 
-  // Advance the iterator.  Thanks to the above call to
-  // HTIterator_Get, we know that this iterator is valid (though it
-  // may not be valid after this call to HTIterator_Next).
-  HTIterator_Next(iter);
+// Adds n, whose key isn't in t yet, to t.  Returns t's new root.
+static HTTreeNode* TreeInsert(HTTreeNode *t, HTTreeNode *n) {
+  if (t == NULL) {
+    return n;
+  }
+  if (n->key < t->key) {
+    t->left = TreeInsert(t->left, n);
+  } else {
+    t->right = TreeInsert(t->right, n);
+  }
+  return Rebalance(t);
+}
+
+// Unlinks the node with the smallest key from t, which isn't empty, and
+// returns it through min.  Returns t's new root.
+static HTTreeNode* TreeRemoveMin(HTTreeNode *t, HTTreeNode **min) {
+  if (t->left == NULL) {
+    *min = t;
+    return t->right;
+  }
+  t->left = TreeRemoveMin(t->left, min);
+  return Rebalance(t);
+}
 
-  // Lastly, remove the element.  Again, we know this call will succeed
-  // due to the successful HTIterator_Get above.
-  Verify333(HashTable_Remove(iter->ht, kv.key, keyvalue));
-  Verify333(kv.key == keyvalue->key);
-  Verify333(kv.value == keyvalue->value);
+// Unlinks the node whose key is key from t, and returns it through
+// removed.  Returns t's new root.
+static HTTreeNode* TreeRemove(HTTreeNode *t, HTKey_t key,
+                              HTTreeNode **removed) {
+  // the caller promised that key is in the tree
+  Verify333(t != NULL);
+  if (key < t->key) {
+    t->left = TreeRemove(t->left, key, removed);
+  } else if (key > t->key) {
+    t->right = TreeRemove(t->right, key, removed);
+  } else {
+    HTTreeNode *min;
+
+    // Put the next larger node in t's place, if it has one.
+    *removed = t;
+    if (t->right == NULL) {
+      return t->left;
+    }
+    t->right = TreeRemoveMin(t->right, &min);
+    min->left = t->left;
+    min->right = t->right;
+    t = min;
+  }
+  return Rebalance(t);
+}
 
-  return true;
+static void FreeTree(HTTreeNode *t) {
+  if (t != NULL) {
+    FreeTree(t->left);
+    FreeTree(t->right);
+    free(t);
+  }
+}
+
+static LinkedListNode* FindInTree(HashTable *ht, int bucket, HTKey_t key) {
+  HTTreeNode *t = ht->trees[bucket];
+
+  while (t != NULL && t->key != key) {
+    t = key < t->key ? t->left : t->right;
+  }
+  return t != NULL ? t->node : NULL;
+}
+
+// Adds a chain node to its bucket's tree.
+static void AddToTree(HashTable *ht, int bucket, LinkedListNode *node) {
+  HTTreeNode *n = (HTTreeNode *) malloc(sizeof(HTTreeNode));
+
+  Verify333(n != NULL);
+  n->key = ((HTKeyValue_t *) node->payload)->key;
+  n->node = node;
+  n->left = n->right = NULL;
+  n->height = 1;
+  ht->trees[bucket] = TreeInsert(ht->trees[bucket], n);
+}
+
+// Whether a bucket's chain, which has no tree, is long enough to need one.
+// A multimap's or byte-keyed table's never do: their keys may repeat.
+static inline bool NeedsTree(HashTable *ht, int bucket) {
+  return !ht->multi && !ht->byte_keys &&
+         LinkedList_NumElements(ht->buckets[bucket]) > HT_TREEIFY_THRESHOLD;
+}
+
+// Gives a bucket's chain a tree.
+static void Treeify(HashTable *ht, int bucket) {
+  LinkedListNode *node;
+
+  if (ht->trees == NULL) {
+    ht->trees = (HTTreeNode **) calloc(ht->num_buckets,
+                                       sizeof(HTTreeNode *));
+    Verify333(ht->trees != NULL);
+  }
+  for (node = ht->buckets[bucket]->head; node != NULL; node = node->next) {
+    AddToTree(ht, bucket, node);
+  }
+}
+
+static void ChainGrew(HashTable *ht, int bucket) {
+  if (HasTree(ht, bucket)) {
+    AddToTree(ht, bucket, ht->buckets[bucket]->head);
+  } else if (NeedsTree(ht, bucket)) {
+    Treeify(ht, bucket);
+  }
+}
+
+static void RemoveFromTree(HashTable *ht, int bucket, HTKeyValue_t *kv) {
+  LinkedList *chain = ht->buckets[bucket];
+  LinkedListNode *node, *n;
+  HTTreeNode *removed;
+  int pos = 0;
+
+  ht->trees[bucket] = TreeRemove(ht->trees[bucket], kv->key, &removed);
+  node = removed->node;
+  free(removed);
+  Verify333(node->payload == kv);
+
+  // Only the first HT_NUM_TAGS entries have tags, so that's as far as we
+  // need to look for the node's position.
+  for (n = chain->head; n != node && pos < HT_NUM_TAGS; n = n->next) {
+    pos++;
+  }
+
+  // Unlink the node directly, as ReorderChain does.
+  if (node->prev != NULL) {
+    node->prev->next = node->next;
+  } else {
+    chain->head = node->next;
+  }
+  if (node->next != NULL) {
+    node->next->prev = node->prev;
+  } else {
+    chain->tail = node->prev;
+  }
+  chain->num_elements--;
+  free(node);
+  free(kv);
+  if (pos < HT_NUM_TAGS) {
+    RemoveTag(ht, bucket, pos);
+  }
+
+  if (chain->num_elements <= HT_UNTREEIFY_THRESHOLD) {
+    FreeTree(ht->trees[bucket]);
+    ht->trees[bucket] = NULL;
+  }
+}
+
+static void FreeTrees(HashTable *ht) {
+  int b;
+
+  if (ht->trees == NULL) {
+    return;
+  }
+  for (b = 0; b < ht->num_buckets; b++) {
+    FreeTree(ht->trees[b]);
+  }
+  free(ht->trees);
+  ht->trees = NULL;
+}
+
+static void TreeifyLongChains(HashTable *ht) {
+  int b;
+
+  for (b = 0; b < ht->num_buckets; b++) {
+    if (!HasTree(ht, b) && NeedsTree(ht, b)) {
+      Treeify(ht, b);
+    }
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parallel iteration.
+
+// HashTable_ForEachParallel splits the buckets into this many ranges per
+// thread.
+#define RANGES_PER_THREAD 4
+
+// The state of one HashTable_ForEachParallel scan, shared by all of its
+// tasks.
+typedef struct {
+  HashTable      *ht;
+  HTForEachFnPtr  fn;
+  void           *ctx;
+  int             per_range;   // buckets per range (the last may be short)
+  int             num_ranges;
+  int             next_range;  // the next unclaimed range; updated atomically
+} ForEachScan;
+
+// Claims ranges from the scan one at a time, and scans each, until there
+// are none left.
+static void ForEachInRanges(void *arg) {
+  ForEachScan *scan = (ForEachScan *) arg;
+  int r;
+
+  while ((r = __atomic_fetch_add(&scan->next_range, 1, __ATOMIC_RELAXED)) <
+         scan->num_ranges) {
+    int begin = r * scan->per_range, end = begin + scan->per_range;
+    HTIterator *it;
+
+    if (begin > scan->ht->num_buckets) {
+      begin = scan->ht->num_buckets;
+    }
+    if (end > scan->ht->num_buckets) {
+      end = scan->ht->num_buckets;
+    }
+    it = HTIterator_AllocateRange(scan->ht, begin, end);
+    while (HTIterator_IsValid(it)) {
+      HTKeyValue_t kv, removed;
+
+      Verify333(HTIterator_Get(it, &kv));
+      if (scan->fn(kv, scan->ctx)) {
+        Verify333(HTIterator_Remove(it, &removed));
+      } else {
+        HTIterator_Next(it);
+      }
+    }
+    HTIterator_Free(it);
+  }
+}
+
+void HashTable_ForEachParallel(HashTable *table, HTForEachFnPtr fn,
+                               void *ctx, int num_threads) {
+  ForEachScan scan;
+
+  Verify333(table != NULL);
+  Verify333(fn != NULL);
+  Verify333(num_threads > 0);
+
+  // A few ranges per thread lets threads that finish early claim the ones
+  // left behind long chains.
+  scan.ht = table;
+  scan.fn = fn;
+  scan.ctx = ctx;
+  scan.num_ranges = (num_threads == 1) ? 1 : num_threads * RANGES_PER_THREAD;
+  if (scan.num_ranges > table->num_buckets) {
+    scan.num_ranges = table->num_buckets;
+  }
+  if (num_threads > scan.num_ranges) {
+    num_threads = scan.num_ranges;
+  }
+  scan.per_range = scan.num_ranges == 0 ? 0 :
+      (table->num_buckets + scan.num_ranges - 1) / scan.num_ranges;
+  scan.next_range = 0;
+
+  // One task per thread, all sharing the scan (hence the task size of 0),
+  // so that no more than num_threads of them run at once however large
+  // the pool is.
+  RunParallel(&scan, 0, num_threads, &ForEachInRanges);
 }
 
 static void MaybeResize(HashTable *ht) {
-  HashTable *newht;
-  HashTable tmp;
-  HTIterator *it;
+  LinkedList **old_buckets;
+  uint64_t *old_tags;
+  int old_num_buckets, i;
+
+  // The Bloom filter doesn't depend on the buckets, so it has thresholds
+  // of its own: rebuild it when it is full, or when removals have left
+  // half its capacity stale.
+  if (ht->bloom != NULL && (ht->num_elements >= ht->bloom_capacity ||
+                            ht->bloom_removed > ht->bloom_capacity / 2)) {
+    RebuildBloomFilter(ht);
+  }
 
-  // Resize if the load factor is > 3.
-  if (ht->num_elements < 3 * ht->num_buckets)
+  // Resize if the load factor is > 3.  A table without buckets grows by
+  // getting some, which HashTable_Insert does once it's full.  Only the
+  // chains count: a key in the table's window costs them nothing.
+  if (IsSmall(ht) || ChainElements(ht) < 3 * ht->num_buckets)
     return;
 
-  // This is the resize case.  Allocate a new hashtable,
-  // iterate over the old hashtable, do the surgery on
-  // the old hashtable record and free up the new hashtable
-  // record.
-  newht = HashTable_Allocate(ht->num_buckets * 9);
+  // A table watching for a dense range looks for one among the chains'
+  // keys now, when it is about to touch them all anyway.  If it finds one,
+  // the chains may not need the buckets after all.
+  if (ht->dense_enabled && ht->dense == NULL) {
+    DetectDense(ht);
+    if (ChainElements(ht) < 3 * ht->num_buckets)
+      return;
+  }
+
+  // This is the resize case.  Give the table a new bucket array nine times
+  // the size, then move each entry from the old chains onto its new chain.
+  // We move the entries themselves rather than copies: that saves a malloc
+  // and a free per element, and some entries (HTBytesEntry) are bigger
+  // than an HTKeyValue_t.  The seed, if any, doesn't change.
+  old_buckets = ht->buckets;
+  old_tags = ht->tags;
+  old_num_buckets = ht->num_buckets;
+  FreeTrees(ht);
+  AllocateBuckets(ht, old_num_buckets * 9);
+
+  for (i = 0; i < old_num_buckets; i++) {
+    HTKeyValue_t *kv;
+
+    while (LinkedList_Pop(old_buckets[i], (LLPayload_t *)&kv)) {
+      int bucket = HashKeyToBucketNum(ht, kv->key);
+      LinkedList_Push(ht->buckets[bucket], (LLPayload_t)kv);
+      PushTag(ht, bucket, kv->key);
+    }
+    LinkedList_Free(old_buckets[i], &LLNoOpFree);
+  }
+  free(old_buckets);
+  free(old_tags);
+
+  // Most long chains have been split up, but keys that differ by multiples
+  // of the new number of buckets still share one.
+  TreeifyLongChains(ht);
+}
+
+static void AllocateBuckets(HashTable *ht, int num_buckets) {
+  int i;
+
+  ht->num_buckets = num_buckets;
+  ht->buckets = (LinkedList **) malloc(num_buckets * sizeof(LinkedList *));
+  Verify333(ht->buckets != NULL);
+  ht->tags = (uint64_t *) calloc(num_buckets, sizeof(uint64_t));
+  Verify333(ht->tags != NULL);
+  for (i = 0; i < num_buckets; i++) {
+    ht->buckets[i] = LinkedList_Allocate();
+  }
+}
 
-  // Loop through the old ht copying its elements over into the new one.
-  for (it = HTIterator_Allocate(ht);
-       HTIterator_IsValid(it);
-       HTIterator_Next(it)) {
-    HTKeyValue_t item, unused;
+static void ConvertToBuckets(HashTable *ht) {
+  int i;
 
-    Verify333(HTIterator_Get(it, &item));
-    HashTable_Insert(newht, item, &unused);
+  // One bucket per entry that fit is a load factor of about one, with
+  // room to grow three times over before the first resize.
+  AllocateBuckets(ht, HT_SMALL_CAPACITY);
+  for (i = 0; i < ht->num_elements; i++) {
+    HTKeyValue_t *kv = (HTKeyValue_t *) malloc(sizeof(HTKeyValue_t));
+    int bucket = HashKeyToBucketNum(ht, ht->small[i].key);
+
+    Verify333(kv != NULL);
+    *kv = ht->small[i];
+    LinkedList_Push(ht->buckets[bucket], (LLPayload_t)kv);
+    PushTag(ht, bucket, kv->key);
   }
+}
 
-  // Swap the new table onto the old, then free the old table (tricky!).  We
-  // use the "no-op free" because we don't actually want to free the elements;
-  // they're owned by the new table.
-  tmp = *ht;
-  *ht = *newht;
-  *newht = tmp;
+static void RandomSeed(void *seed, size_t len) {
+  FILE *f = fopen("/dev/urandom", "rb");
 
-  // Done!  Clean up our iterator and temporary table.
-  HTIterator_Free(it);
-  HashTable_Free(newht, &HTNoOpFree);
+  Verify333(f != NULL);
+  Verify333(fread(seed, 1, len, f) == len);
+  fclose(f);
 }
@@ -13,6 +13,7 @@
 #define HW1_HASHTABLE_H_
 
 #include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
 #include <stdint.h>     // for uint64_t, etc.
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -31,6 +32,14 @@
 // hashtable when the load factor exceeds 3.  It will multiple the number
 // of buckets in the hashtable by 9, so that post-resize load factor is 1/3.
 //
+// Resizing doesn't help keys that collide whatever the number of buckets,
+// such as keys chosen by an adversary, or keys that are all multiples of
+// some large number.  So a chain that grows past eight entries also gets a
+// balanced tree over its keys, which finds, inserts and removes any of
+// them in O(log n) steps, and loses it again once it is down to six.  (A
+// multimap's or byte-keyed table's chains don't, since their keys may
+// repeat.)
+//
 // To hide the implementation of HashTable, we declare the "struct ht"
 // structure and its associated typedef here, but we *define* the structure
 // in the internal header HashTable_priv.h.  This lets us define a pointer
@@ -86,6 +95,142 @@ HTKey_t FNVHash64(unsigned char *buffer, int len);
 // Returns a pointer to the newly allocated HashTable.
 HashTable* HashTable_Allocate(int num_buckets);
 
+// Allocate and return a new HashTable that is safe to fill with keys
+// chosen by an adversary.
+//
+// A table from HashTable_Allocate picks a key's bucket from the key's low
+// bits.  That is fast, and fine for keys the program controls, but anyone
+// who controls the keys (eg, a client whose strings are hashed with the
+// unseeded FNVHash64) can make every key land in the same bucket, so
+// that each operation walks one long chain.  A seeded table instead picks
+// the bucket with SipHash64 under a secret random seed drawn when it is
+// allocated, so which keys collide can't be predicted.  Its operations are
+// somewhat slower on trusted keys, but it behaves the same way otherwise.
+//
+// Arguments:
+// - num_buckets: the number of buckets the hash table should
+//   initially contain; MUST be greater than zero.
+//
+// Returns a pointer to the newly allocated HashTable.
+HashTable* HashTable_AllocateSeeded(int num_buckets);
+
+// Allocate a new HashTable for a handful of keys.  Until it holds more
+// than eight, such a table has no buckets: its entries are kept in an
+// array inside the HashTable itself and searched one by one, so it takes
+// a single allocation, and an insert none at all.  The entry that doesn't
+// fit gives the table buckets, after which it behaves exactly like one
+// from HashTable_Allocate.  Programs that keep many tiny tables save most
+// of their memory this way.
+//
+// Every function works on a table without buckets, which reports one
+// bucket to HashTable_NumBuckets and HTIterator_AllocateRange.  Its
+// lookups ignore the table's chain policy.  Byte-string keys are always
+// kept in buckets: the first HashTable_InsertBytes gives the table its
+// buckets.
+//
+// Returns a pointer to the newly allocated HashTable.
+HashTable* HashTable_AllocateSmall(void);
+
+// Allocate and return a new HashTable that is a multimap: it may hold any
+// number of (key,value)s with the same key.  HashTable_Insert never
+// replaces anything in such a table; it adds the (key,value) to its
+// bucket's chain alongside any others with that key, which is cheaper
+// than keeping a LinkedList of values under each key.  See "Multimap
+// tables" below for the functions that find and remove them all.
+//
+// The other functions work as usual, treating each (key,value) as an
+// element of its own: HashTable_Find and HashTable_Remove find or remove
+// one of a key's (key,value)s, no telling which, and HashTable_NumElements
+// counts them all.  A multimap can't be frozen or hold byte-string keys.
+//
+// Arguments:
+// - num_buckets: the number of buckets the hash table should
+//   initially contain; MUST be greater than zero.
+//
+// Returns a pointer to the newly allocated HashTable.
+HashTable* HashTable_AllocateMulti(int num_buckets);
+
+// Allocate a new HashTable for keys that are mostly a dense range of
+// integers, such as row IDs or counters: first_key .. first_key +
+// num_keys - 1, and upward from there.
+//
+// Such a table keeps the keys in its range in an array indexed by key,
+// with a bit per key saying whether it is present, so that a lookup is an
+// index and a bit test, with no hashing and no chain, and an insert
+// allocates nothing.  An insert just past the end of the range doubles
+// it, as long as it is at least half full.  Keys outside the range (the
+// outliers) go in buckets as usual.  The range costs its 16 bytes per key
+// whether or not the keys are present, and it never shrinks.
+//
+// Otherwise the table behaves like one from HashTable_Allocate: every
+// function and iterator works on it, visiting the keys in the range along
+// with the others.  It is a table that HashTable_EnableDense has run on
+// (see below), so it can't hold byte-string keys.
+//
+// Arguments:
+// - first_key: the first key of the range.
+// - num_keys: the number of keys in the range; MUST be greater than zero
+//   and at most 2^26.
+//
+// Returns a pointer to the newly allocated HashTable.
+HashTable* HashTable_AllocateDense(HTKey_t first_key, int num_keys);
+
+// Allocate a new HashTable that stores its entries by bucketized cuckoo
+// hashing rather than on chains.
+//
+// Each key may live in either of two buckets of four slots, chosen by two
+// hashes of the key, and the slots hold the (key,value)s themselves.  So
+// every lookup, hit or miss, reads at most two buckets -- there are no
+// chains to get long -- and an entry costs its 16 bytes plus a byte of tag
+// and the empty slots, with no allocation of its own.  The table fills to
+// 95% of its slots before it doubles.  An insert whose buckets are both
+// full makes room by moving other keys to their other buckets, searching
+// breadth-first for the shortest such chain of moves; if there isn't one
+// close by, the table doubles instead.
+//
+// Every function works on a cuckoo table except the ones for byte-string
+// keys, HashTable_EnableDense and, since there are no chains,
+// HashTable_EnableBloomFilter and HashTable_SetChainPolicy, which have no
+// effect.  Its buckets, for HashTable_NumBuckets and
+// HTIterator_AllocateRange, are the cuckoo buckets.  Inserts take longer
+// than for a chained table at high load, as they move keys.
+//
+// Arguments:
+// - num_keys: the number of keys the table should have room for before
+//   it first doubles (>= 0).
+//
+// Returns a pointer to the newly allocated HashTable.
+HashTable* HashTable_AllocateCuckoo(int num_keys);
+
+// Allocate a new HashTable and fill it with an array of (key,value)
+// pairs, using several threads.
+//
+// This is much faster than allocating a table and calling HashTable_Insert
+// once per pair: the bucket array is sized up front for the whole input, so
+// the table never resizes, and each thread builds the chains for its own
+// range of buckets without any locking.  The threads come from the shared
+// ThreadPool (see ThreadPool_Default in ThreadPool.h).
+//
+// If a key appears more than once in the array, the result is the same as
+// inserting the pairs in array order: the last pair wins, and the values of
+// the earlier pairs are passed to value_free_function.
+//
+// Arguments:
+// - keyvalues: the array of (key,value) pairs to insert.  The table
+//   takes ownership of the values; the array itself is not retained.
+// - num_keyvalues: the number of pairs in the array (>= 0).
+// - num_threads: how many ways to split the build; MUST be greater than
+//   zero.  More than the pool's worker count (plus the calling thread,
+//   which helps) gains nothing.
+// - value_free_function: invoked (possibly from any of the build threads)
+//   on each value that is replaced by a later pair with the same key.
+//
+// Returns a pointer to the newly allocated HashTable.
+HashTable* HashTable_BuildFromArray(HTKeyValue_t *keyvalues,
+                                    int num_keyvalues,
+                                    int num_threads,
+                                    ValueFreeFnPtr value_free_function);
+
 // Free a HashTable and its entries.
 //
 // Arguments:
@@ -107,6 +252,19 @@ void HashTable_Free(HashTable *table, ValueFreeFnPtr value_free_function);
 // - table size (>=0)
 int HashTable_NumElements(HashTable *table);
 
+// Figure out the number of buckets in the hash table.  Buckets are
+// numbered from 0 to HashTable_NumBuckets(table) - 1; see
+// HTIterator_AllocateRange.  The number changes when the table resizes.
+//
+// Arguments:
+//
+// - table:  the table to query
+//
+// Returns:
+//
+// - number of buckets (>0)
+int HashTable_NumBuckets(HashTable *table);
+
 // Inserts a (key,value) pair into the HashTable.
 //
 // Arguments:
@@ -124,7 +282,8 @@ int HashTable_NumElements(HashTable *table);
 //  - true: if the newkeyvalue was inserted and an old (key,value)
 //    with the same key was replaced and returned through
 //    the oldkeyval return parameter.  In this case, the caller assumes
-//    ownership of oldkeyvalue.
+//    ownership of oldkeyvalue.  A multimap (see HashTable_AllocateMulti)
+//    never replaces, so this is never returned for one.
 bool HashTable_Insert(HashTable *table,
                       HTKeyValue_t newkeyvalue,
                       HTKeyValue_t *oldkeyvalue);
@@ -148,6 +307,92 @@ bool HashTable_Find(HashTable *table,
                     HTKey_t key,
                     HTKeyValue_t *keyvalue);
 
+// Puts a Bloom filter in front of a HashTable, so that a lookup of a key
+// that isn't there (by HashTable_Find, HashTable_FindBatch or
+// HashTable_FindBytes) can usually answer from one cache line of the
+// filter rather than by walking a chain.  Tables whose lookups mostly
+// miss want one; it costs a little memory and a little time on each
+// insert.
+//
+// The filter is kept up to date by the table's own operations: inserts
+// add to it, and it is rebuilt, sized for the table's current contents,
+// whenever it fills up or whenever enough keys have been removed (which a
+// Bloom filter can't forget) that it has gone stale.  Removals made by
+// HashTable_ForEachParallel are counted toward the next rebuild.
+//
+// Arguments:
+// - table: the HashTable to filter.
+// - fp_rate: how often, at most, a missing key gets past the filter to the
+//   chains, in (0, 0.5].  Lower rates take more memory: about 10 bits per
+//   key at 0.01, 15 at 0.001.  Pass 0 to remove the table's filter.
+void HashTable_EnableBloomFilter(HashTable *table, double fp_rate);
+
+// How a table rearranges a chain when a lookup finds a key in it.  Under a
+// skewed workload, where a few keys get most of the lookups, moving the
+// keys that are found toward the front of their chains means the popular
+// ones are found after fewer steps.
+typedef enum {
+  HT_CHAIN_STATIC,         // never; the default
+  HT_CHAIN_MOVE_TO_FRONT,  // move the key to the front of its chain
+  HT_CHAIN_TRANSPOSE       // swap the key with the one before it
+} HTChainPolicy;
+
+// Sets how HashTable_Find and HashTable_FindBytes rearrange the chain a
+// key is found in.  Move-to-front adapts fastest when the popular keys
+// change; transpose moves a key only one step per hit, so a key that is
+// looked up once doesn't push the popular ones back.  Neither helps when
+// lookups are spread evenly over the keys; then the reordering, which
+// writes to several cache lines, only costs time.
+//
+// Under either policy other than HT_CHAIN_STATIC, a successful lookup
+// changes the table: it invalidates iterators like any other mutation, and
+// it may not run concurrently with anything else, including other
+// lookups.  HashTable_FindBatch never rearranges chains, and nothing
+// rearranges a chain long enough to have a tree, since lookups in it don't
+// walk it.
+//
+// Arguments:
+// - table: the HashTable to set the policy of.
+// - policy: the new policy.  It applies to later lookups.
+void HashTable_SetChainPolicy(HashTable *table, HTChainPolicy policy);
+
+// Sets a table to watch for a dense range of integer keys, and to keep it
+// in an array indexed by key as in HashTable_AllocateDense.  The table
+// looks for one now, and again whenever it is about to resize, until it
+// has one: the range starts at the smallest key in the table, and is the
+// biggest power of two long that would be at least a quarter full and
+// hold at least half the keys.  Keys outside it stay in buckets.
+//
+// Tables whose keys are sequential, or nearly so, want this.  Its cost on
+// other tables is one extra pass over the keys per resize.  A table that
+// is watching for a dense range can't hold byte-string keys or be a
+// multimap.
+//
+// Arguments:
+// - table: the HashTable to watch; it may not be frozen.
+void HashTable_EnableDense(HashTable *table);
+
+// Looks up many keys at once.  The results are the same as calling
+// HashTable_Find on each key in turn, but much faster for a table bigger
+// than the CPU's caches: each HashTable_Find waits for several cache misses
+// one after another, while this function overlaps the misses of many
+// lookups by prefetching.
+//
+// Arguments:
+// - table: the HashTable to look in.
+// - keys: an array of n keys to look up.  It may contain duplicates.
+// - n: the number of keys (>= 0).
+// - results: an array of n (key,value)s.  If keys[i] is present, a copy
+//   of its (key,value) is returned in results[i]; otherwise results[i] is
+//   left alone.  The values stay in the HashTable.
+// - found: an array of n flags; found[i] is set to whether keys[i] was
+//   present.
+//
+// Returns:
+// - the number of keys that were found.
+int HashTable_FindBatch(HashTable *table, const HTKey_t *keys, int n,
+                        HTKeyValue_t *results, bool *found);
+
 // Removes a (key,value) from the HashTable and returns it to the
 // caller.
 //
@@ -170,6 +415,102 @@ bool HashTable_Remove(HashTable *table,
                       HTKey_t key,
                       HTKeyValue_t *keyvalue);
 
+// Makes a HashTable read-only, and rebuilds it so that lookups are as fast
+// and the table as small as can be.  This is for data that is loaded once
+// and then only read.
+//
+// A frozen table keeps its (key,value)s in one flat array, with a minimal
+// perfect hash of the keys -- about a byte per key -- to say where each
+// one is.  A lookup reads one word of the hash and then one (key,value),
+// two cache misses at most for a table of any size, where a chained
+// lookup follows three or more pointers.  The table needs about 17 bytes
+// per (key,value), well under half what the chains take.
+//
+// After freezing, HashTable_Find, HashTable_FindBatch, the query functions,
+// the iterators (without HTIterator_Remove), HashTable_ForEachParallel
+// (with a callback that never removes) and HashTable_Free work as before,
+// and may all run concurrently.  Every other function that would change
+// the table is an error.  HashTable_EnableBloomFilter and
+// HashTable_SetChainPolicy have no effect on a frozen table.
+//
+// Freezing takes time roughly linear in the number of (key,value)s, and
+// briefly needs memory for both layouts.
+//
+// Arguments:
+// - table: the HashTable to freeze.  It must never have held byte-string
+//   keys (see HashTable_InsertBytes).  Freezing a frozen table does
+//   nothing.
+void HashTable_Freeze(HashTable *table);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Byte-string keys
+//
+// The functions above take a key that the customer has already hashed, so
+// two different strings whose hashes collide are the same key as far as the
+// table is concerned.  The functions below take the key bytes themselves:
+// the table hashes them, stores a copy of them in the same allocation as
+// the (key,value) entry, and compares them on lookup, so distinct keys
+// never alias.  Each lookup compares the cached 64-bit hash before
+// comparing any bytes, so a mismatch costs no more than an integer-keyed
+// lookup.
+//
+// The table hashes the key bytes with WyHash64 unless told otherwise
+// before the first insert; see HashTable_SetBytesHash in Hash.h.
+//
+// A table should be used with either the integer-key functions or the
+// byte-string functions, not both.  The iterator functions, HashTable_Free
+// and HashTable_ForEachParallel work on either kind; for a byte-keyed table,
+// the HTKey_t they report is the hash of the key bytes, and
+// HTIterator_GetBytes returns the bytes themselves.
+
+// Inserts a (key,value) pair with a byte-string key into the HashTable.
+//
+// Arguments:
+// - table: the HashTable to insert into.
+// - key: a pointer to the key_len bytes of the key; the table keeps its
+//   own copy.
+// - key_len: the length of the key (may be zero).
+// - value: the value to associate with the key.
+// - oldvalue: if the key is already present, its old value is replaced
+//   with value and returned through this return parameter; the caller
+//   takes ownership of it.
+//
+// Returns:
+//  - false: if the key was not already present.
+//  - true: if the key was present, and its old value was returned through
+//    oldvalue.
+bool HashTable_InsertBytes(HashTable *table, const void *key, size_t key_len,
+                           HTValue_t value, HTValue_t *oldvalue);
+
+// Looks up a byte-string key in the HashTable.
+//
+// Arguments:
+// - table: the HashTable to look in.
+// - key, key_len: the key to look up.
+// - value: if the key is present, its value is returned through this
+//   return parameter.  The value stays in the table.
+//
+// Returns:
+//  - false: if the key wasn't found in the HashTable.
+//  - true: if the key was found and its value returned.
+bool HashTable_FindBytes(HashTable *table, const void *key, size_t key_len,
+                         HTValue_t *value);
+
+// Removes a byte-string key from the HashTable.
+//
+// Arguments:
+// - table: the HashTable to look in.
+// - key, key_len: the key to remove.
+// - value: if the key is present, its value is returned through this
+//   return parameter; the caller takes ownership of it.
+//
+// Returns:
+//  - false: if the key wasn't found in the HashTable.
+//  - true: if the key was found, removed, and its value returned.
+bool HashTable_RemoveBytes(HashTable *table, const void *key, size_t key_len,
+                           HTValue_t *value);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // HashTable iterator
@@ -183,6 +524,30 @@ bool HashTable_Remove(HashTable *table,
 // dangerous to use; arbitrary memory corruption can occur).
 typedef struct ht_it HTIterator;  // same trick to hide implementation.
 
+// Manufacture an iterator that only visits the (key,value)s in buckets
+// [bucket_begin, bucket_end) of the table.  Otherwise it behaves exactly
+// like an iterator from HTIterator_Allocate, and is freed the same way.
+//
+// Range iterators let a scan be split across threads.  Iterators over
+// disjoint bucket ranges of the same table may be used concurrently from
+// different threads, including HTIterator_Remove, as long as no thread
+// calls any other function that mutates the table (Insert, Remove, etc.)
+// until all of them are done.  Read-only use (IsValid, Next, Get) may also
+// run concurrently with HashTable_Find and HashTable_NumElements, unless
+// the table has a chain policy (see HashTable_SetChainPolicy).
+//
+// Arguments:
+// - table:  the table from which to return an iterator.
+// - bucket_begin: the first bucket to visit; 0 <= bucket_begin.
+// - bucket_end: one past the last bucket to visit;
+//   bucket_begin <= bucket_end <= HashTable_NumBuckets(table).
+//
+// Returns:
+// - the newly-allocated iterator, which may be invalid or "past the end"
+//   if there are no elements in the range.
+HTIterator* HTIterator_AllocateRange(HashTable *table,
+                                     int bucket_begin, int bucket_end);
+
 // Manufacture an iterator for the table.  If there are
 // elements in the hash table, the iterator is initialized
 // to point at the "first" one.  The caller is responsible
@@ -239,6 +604,23 @@ bool HTIterator_Next(HTIterator *iter);
 // - true: success.
 bool HTIterator_Get(HTIterator *iter, HTKeyValue_t *keyvalue);
 
+// Returns the byte-string key and the value that the iterator is currently
+// pointing at.  Only for tables filled with HashTable_InsertBytes.
+//
+// Arguments:
+// - iter: the iterator to fetch from.  Must be non-NULL.
+// - key: a return parameter through which a pointer to the key bytes is
+//   returned.  They belong to the table, and stay valid until the entry
+//   is removed or the table is freed.
+// - key_len: a return parameter for the length of the key.
+// - value: a return parameter for the value.
+//
+// Returns:
+// - false: if the iterator is not valid or the table is empty.
+// - true: success.
+bool HTIterator_GetBytes(HTIterator *iter, const void **key, size_t *key_len,
+                         HTValue_t *value);
+
 // Returns a copy of (key,value) that the iterator is currently
 // pointing at, and removes that (key,value) from the
 // hashtable.  The caller assumes ownership of any memory
@@ -258,4 +640,102 @@ bool HTIterator_Get(HTIterator *iter, HTKeyValue_t *keyvalue);
 //   now invalid.
 bool HTIterator_Remove(HTIterator *iter, HTKeyValue_t *keyvalue);
 
+
+///////////////////////////////////////////////////////////////////////////////
+// Multimap tables
+//
+// These find and remove all the (key,value)s with a given key, and are
+// meant for tables from HashTable_AllocateMulti, though they work on any
+// table that isn't frozen (HashTable_FindAll on a frozen one, too), where
+// a key has at most one (key,value).
+
+// Manufacture an iterator over the (key,value)s with the given key, in no
+// particular order.  It only walks the key's own chain.  It is used and
+// freed like any other HTIterator: HTIterator_Next moves it to the key's
+// next (key,value), and HTIterator_Remove removes the one it points at and
+// moves it on.
+//
+// Arguments:
+// - table: the HashTable to look in.
+// - key: the key to look up.
+//
+// Returns:
+// - the newly-allocated iterator, which is invalid if the key isn't in
+//   the table.
+HTIterator* HashTable_FindAll(HashTable *table, HTKey_t key);
+
+// Removes one (key,value) that has both the given key and the given value.
+//
+// Arguments:
+// - table: the HashTable to remove from.
+// - key: the key of the (key,value) to remove.
+// - value: its value, compared as a pointer.  Ownership of the value
+//   passes back to the caller.
+//
+// Returns:
+//  - false: if there was no such (key,value).
+//  - true: if one was found and removed.
+bool HashTable_RemoveOne(HashTable *table, HTKey_t key, HTValue_t value);
+
+// Removes every (key,value) with the given key.
+//
+// Arguments:
+// - table: the HashTable to remove from.
+// - key: the key to remove.
+// - value_free_function: invoked once on each removed value.
+//
+// Returns:
+// - the number of (key,value)s removed (>= 0).
+int HashTable_RemoveAll(HashTable *table, HTKey_t key,
+                        ValueFreeFnPtr value_free_function);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parallel iteration
+//
+// HashTable_ForEachParallel splits the table's buckets into ranges and
+// scans them on the shared ThreadPool with range iterators (see
+// HTIterator_AllocateRange).  It runs one task per thread, each claiming
+// ranges until none are left; there are several ranges per thread, so
+// that threads that finish early take over the ranges that would have
+// followed long chains.
+//
+// The callback is invoked once for each (key,value), from whichever thread
+// is scanning its bucket, so it may run concurrently with itself on other
+// elements and must synchronize any shared state it updates through ctx.
+//
+// - A read-only scan (a callback that always returns false) may run
+//   concurrently with HashTable_Find and HashTable_NumElements, unless the
+//   table has a chain policy.
+// - A callback may remove the element it was passed by returning true;
+//   ownership of that value passes to the callback.  This is the only
+//   mutation allowed during the scan: the callback must not call Insert,
+//   Remove, or any other mutating function on the table, and no other
+//   thread may either.  Removing other elements is not supported.
+
+// The per-element callback for HashTable_ForEachParallel.
+//
+// Arguments:
+// - keyvalue: a copy of the current (key,value).
+// - ctx: the caller's context pointer, passed through unchanged.
+//
+// Returns:
+// - true to remove this (key,value) from the table; the callback then
+//   owns keyvalue.value.
+// - false to leave it in place.
+typedef bool(*HTForEachFnPtr)(HTKeyValue_t keyvalue, void *ctx);
+
+// Invoke fn on every (key,value) in the table using up to num_threads
+// threads, and return once all of them have been visited.
+//
+// Arguments:
+// - table: the table to scan.
+// - fn: the callback; see above.
+// - ctx: passed through to every invocation of fn.
+// - num_threads: the most threads to scan with at once; MUST be greater
+//   than zero.  A value of 1 scans on the calling thread.  The scan uses
+//   fewer if the pool has fewer workers (the calling thread helps too).
+void HashTable_ForEachParallel(HashTable *table, HTForEachFnPtr fn,
+                               void *ctx, int num_threads);
+
 #endif  // HW1_HASHTABLE_H_
@@ -12,9 +12,13 @@
 #ifndef HW1_HASHTABLE_PRIV_H_
 #define HW1_HASHTABLE_PRIV_H_
 
-#include <stdint.h>  // for uint32_t, etc.
+#include <stdbool.h>  // for bool
+#include <stdint.h>   // for uint32_t, etc.
 
+#include "./BloomFilter.h"
+#include "./Hash.h"
 #include "./LinkedList.h"
+#include "./LinkedList_priv.h"
 #include "./HashTable.h"
 
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -29,25 +33,208 @@
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
 
+// The number of entries a table from HashTable_AllocateSmall holds before
+// it needs buckets.
+#define HT_SMALL_CAPACITY 8
+
+// A table without buckets (one not yet grown out of HT_SMALL_CAPACITY, or
+// a frozen one) keeps its entries in a flat array.  Iterators see the
+// array as consecutive "buckets" of this many entries each, so that
+// HashTable_ForEachParallel can still split it across threads.
+#define HT_FLAT_RANGE 1024
+
+// A frozen table's index (see HashTable_Freeze): a minimal perfect hash
+// of its keys, in the style of PTHash.
+//
+// Each key's mixed hash (HashKeyToBloomHash) picks one of num_groups
+// groups, about HT_FROZEN_GROUP_SIZE keys apiece, and the group's pilot
+// is a small number, found when the table was frozen, that sends the
+// group's keys (via FrozenSlot in HashTable.c) to slots in
+// [0, num_slots) that no other key uses.  There are a few more slots than
+// keys, which makes pilots much quicker to find; a key whose slot is
+// num_keys or more is redirected through remap[slot - num_keys] to one of
+// the slots below num_keys that no key landed in.  So entries holds
+// exactly num_keys entries, and a lookup reads one pilot, then one entry.
+typedef struct {
+  int           num_keys;
+  int           num_slots;   // num_keys <= num_slots
+  int           num_groups;  // > 0
+  uint32_t     *pilots;      // one per group
+  uint32_t     *remap;       // num_slots - num_keys redirections
+  HTKeyValue_t *entries;     // num_keys entries, by slot
+} HTFrozen;
+
+// Keys per group, on average, in a frozen table's index.  More keys per
+// group means fewer pilots to store but longer to find each one.
+#define HT_FROZEN_GROUP_SIZE 4
+
+// A table's direct-addressed window (see HashTable_EnableDense): the keys
+// first_key .. first_key + num_slots - 1 don't go on chains at all.  The
+// entry for key k is entries[k - first_key], whose key is filled in when
+// the window is made, and bit (k - first_key) of present says whether k is
+// in the table.  Keys outside the window, the outliers, are on chains as
+// usual, and no chain ever holds a key inside it.  The window grows by
+// doubling, upward, while it is at least half full; it never shrinks.
+typedef struct {
+  HTKey_t       first_key;    // the key of entries[0]
+  int           num_slots;
+  int           num_present;  // # of entries in the table
+  uint64_t     *present;      // one bit per slot, 64 to a word
+  HTKeyValue_t *entries;
+} HTDense;
+
+// The bounds on a window's number of slots; a window made by
+// HashTable_AllocateDense may start smaller.
+#define HT_DENSE_MIN_SLOTS 64
+#define HT_DENSE_MAX_SLOTS (1 << 26)
+
+// A cuckoo table's storage (see HashTable_AllocateCuckoo): num_buckets
+// buckets of HT_CUCKOO_SLOTS slots each, one cache line apiece.  Every key
+// is in one of two buckets, both picked from its HashKeyToBloomHash (see
+// CuckooBuckets in HashTable.c), so a lookup reads at most two.  Byte i of
+// tags[b] is the HashKeyToTag of the key in slot i of bucket b, or 0 if
+// the slot is empty.
+typedef struct {
+  uint32_t     *tags;   // one word per bucket
+  HTKeyValue_t *slots;  // bucket b's are slots[b * HT_CUCKOO_SLOTS ...]
+} HTCuckoo;
+
+// Slots per cuckoo bucket, and the fraction of all slots (in percent) a
+// cuckoo table fills before it doubles.  With four slots and two choices,
+// inserts rarely need to move more than a few keys until well past this.
+#define HT_CUCKOO_SLOTS 4
+#define HT_CUCKOO_MAX_LOAD 95
+
+// The most buckets an insert into a full pair of buckets looks at, in
+// breadth-first order, for a chain of moves that ends in an empty slot.
+// If there is none, the table doubles.
+#define HT_CUCKOO_SEARCH_NODES 256
+
+// A node of a long chain's tree: an AVL tree over the chain's nodes,
+// ordered by key, which finds any of them in O(log n) steps however many
+// keys share the bucket.  The chain itself doesn't change, so iterators
+// and everything else that walks chains still work; the tree is only an
+// index into it.
+typedef struct ht_tree_node {
+  HTKey_t              key;     // the key of node's entry
+  LinkedListNode      *node;    // the chain node holding the entry
+  struct ht_tree_node *left;    // the subtree of smaller keys, or NULL
+  struct ht_tree_node *right;   // the subtree of larger keys, or NULL
+  int                  height;  // of the subtree rooted here; a leaf's is 1
+} HTTreeNode;
+
+// A chain that grows past HT_TREEIFY_THRESHOLD entries gets a tree, and
+// loses it when it shrinks to HT_UNTREEIFY_THRESHOLD; the gap keeps a
+// chain hovering around the threshold from building and freeing a tree on
+// every insert and remove.  Below the threshold, the tags make walking the
+// chain faster than a tree would be.
+#define HT_TREEIFY_THRESHOLD 8
+#define HT_UNTREEIFY_THRESHOLD 6
+
 // The hash table implementation.
 //
 // A hash table is an array of buckets, where each bucket is a linked list
 // of HTKeyValue structs.
+//
+// Beside each bucket is a word of tags: byte i of tags[b] is the
+// HashKeyToTag of the i-th entry of bucket b's chain, counting from the
+// head, for the first HT_NUM_TAGS entries, and 0 past the end of the chain.
+// A lookup compares tags before it touches the chain, and follows the
+// chain only as far as the entries whose tags match, so a miss usually
+// costs one cache line and a hit doesn't dereference the other entries'
+// HTKeyValue_ts.  Entries past the first HT_NUM_TAGS have no tags and are
+// compared the slow way.
+//
+// A table from HashTable_AllocateSmall starts out with no buckets at all:
+// buckets and tags are NULL, num_buckets is 1, and the first
+// HT_SMALL_CAPACITY entries are kept in small[0 .. num_elements - 1] and
+// searched in order.  The entry that doesn't fit moves them all onto
+// chains, and from then on the table is like any other.
+//
+// A frozen table has no buckets either: buckets and tags are NULL, and
+// frozen holds its entries and the index that finds them.
+//
+// A cuckoo table has no chains: buckets and tags are NULL, num_buckets
+// counts its cuckoo buckets, and cuckoo holds them.
+//
+// A chain longer than HT_TREEIFY_THRESHOLD has a tree (see HTTreeNode),
+// which lookups and removals use instead of walking it: trees[b] is
+// bucket b's, or NULL.  trees itself is NULL until some chain needs one.
+// A multimap's or byte-keyed table's chains never get trees, since their
+// keys needn't be unique.
+//
+// A table with a window (dense non-NULL) keeps the keys in its range
+// there, and only the rest on its chains.  Its Bloom filter, if any, holds
+// just the chains' keys, and only the chains count toward a resize.
 typedef struct ht {
   int             num_buckets;   // # of buckets in this HT?
   int             num_elements;  // # of elements currently in this HT?
   LinkedList    **buckets;       // the array of buckets
+  uint64_t       *tags;          // the tags of each bucket's first entries
+  bool            seeded;        // pick buckets with SipHash64(key, seed)?
+  uint64_t        seed[2];       // the SipHash key, if seeded
+  BloomFilter    *bloom;         // NULL unless HashTable_EnableBloomFilter
+  double          bloom_fp_rate;
+  int             bloom_capacity;  // the # of keys bloom is sized for
+  int             bloom_removed;   // removals since bloom was built
+  HTChainPolicy   chain_policy;  // how HashTable_Find reorders chains
+  bool            byte_keys;     // ever used with HashTable_InsertBytes?
+  HashFnPtr       bytes_hash;    // hashes the byte-string keys
+  HTFrozen       *frozen;        // non-NULL once HashTable_Freeze has run
+  bool            multi;         // a multimap (HashTable_AllocateMulti)?
+  bool            dense_enabled;  // HashTable_EnableDense has run?
+  HTDense        *dense;         // the direct-addressed window, or NULL
+  HTCuckoo       *cuckoo;        // non-NULL for HashTable_AllocateCuckoo
+  HTTreeNode    **trees;         // each bucket's tree, or NULL (see above)
+  HTKeyValue_t    small[HT_SMALL_CAPACITY];  // the entries, if small
 } HashTable;
 
+// An entry in a table keyed by byte strings (see HashTable_InsertBytes).
+// The HTKeyValue_t comes first, so the chains, the iterators and
+// HashTable_Free handle it like any other entry; kv.key caches the full
+// 64-bit hash of the key.  The key_len bytes of the key follow the struct
+// in the same allocation; HTBytesEntry_Key finds them.
+typedef struct {
+  HTKeyValue_t kv;       // key is the hash of the key bytes
+  size_t       key_len;  // # of key bytes after the struct
+} HTBytesEntry;
+
+#define HTBytesEntry_Key(entry) ((unsigned char *) ((entry) + 1))
+
 // The hash table iterator.
 typedef struct ht_it {
   HashTable  *ht;          // the HT we're pointing into
   int         bucket_idx;  // which bucket are we in?
+  int         bucket_end;  // one past the last bucket we may visit
   LLIterator *bucket_it;   // iterator for the bucket, or NULL
+  int         slot;        // the index into the flat entries or the
+                           // cuckoo slots, if no buckets
+  bool        match_key;   // only visit entries whose key is key?
+  HTKey_t     key;         // (see HashTable_FindAll)
+  int         dense_slot;  // the window slot we're at, if < dense_end (a
+  int         dense_end;   // range visits its share of the window before
+                           // its chains, with bucket_idx at its first)
 } HTIterator;
 
 // This is the internal hash function we use to map from HTKey_t keys to a
-// bucket number.
+// bucket number.  Normally it is key % num_buckets; a table allocated with
+// HashTable_AllocateSeeded hashes the key with its secret seed first.
 int HashKeyToBucketNum(HashTable *ht, HTKey_t key);
 
+// The number of tags per bucket: one per byte of a tags word.
+#define HT_NUM_TAGS 8
+
+// A key's tag: eight bits of it, mixed, and never 0 so that a tags word's
+// 0 bytes mark the end of a short chain.  The tag is independent of the
+// bucket, so keys that share a bucket still get different tags.
+uint8_t HashKeyToTag(HTKey_t key);
+
+// The hash of a key that a table's Bloom filter stores, and that a frozen
+// table's index is built on: the key, mixed (with the seed, if any) so that
+// every bit counts.
+uint64_t HashKeyToBloomHash(HashTable *ht, HTKey_t key);
+
+// The smallest capacity a table's Bloom filter is built with.
+#define HT_BLOOM_MIN_CAPACITY 1024
+
 #endif  // HW1_HASHTABLE_PRIV_H_
@@ -0,0 +1,41 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_HASH_PRIV_H_
+#define HW1_HASH_PRIV_H_
+
+#include <stdbool.h>  // for bool
+
+#include "./Hash.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal helper functions for our hash implementations.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// The implementations FNVHash64_Batch chooses between.  They take the same
+// arguments as FNVHash64_Batch.  The SIMD ones must only be called when
+// the CPU supports them (see FNVBatchHaveSSE2 and FNVBatchHaveAVX2).
+void FNVBatchScalar(unsigned char **buffers, const int *lens, HTKey_t *out,
+                    int n);
+void FNVBatchSSE2(unsigned char **buffers, const int *lens, HTKey_t *out,
+                  int n);
+void FNVBatchAVX2(unsigned char **buffers, const int *lens, HTKey_t *out,
+                  int n);
+
+// Whether this build and CPU can run FNVBatchSSE2 / FNVBatchAVX2.
+bool FNVBatchHaveSSE2(void);
+bool FNVBatchHaveAVX2(void);
+
+#endif  // HW1_HASH_PRIV_H_
@@ -0,0 +1,191 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdlib.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "LinkedList.h"
+#include "LinkedList_priv.h"
+#include "LRUCache.h"
+#include "LRUCache_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+static void NoOpFree(LLPayload_t payload) { }
+
+static void NoOpValueFree(HTValue_t value) { }
+
+// Links an entry in at the head of the recency list.
+static inline void PushFront(LinkedList *list, LRUEntry *entry) {
+  LinkedListNode *node = &entry->node;
+
+  node->prev = NULL;
+  node->next = list->head;
+  if (list->head != NULL) {
+    list->head->prev = node;
+  } else {
+    list->tail = node;
+  }
+  list->head = node;
+  list->num_elements++;
+}
+
+// Unlinks an entry from the recency list.
+static inline void Unlink(LinkedList *list, LRUEntry *entry) {
+  LinkedListNode *node = &entry->node;
+
+  if (node->prev != NULL) {
+    node->prev->next = node->next;
+  } else {
+    list->head = node->next;
+  }
+  if (node->next != NULL) {
+    node->next->prev = node->prev;
+  } else {
+    list->tail = node->prev;
+  }
+  list->num_elements--;
+}
+
+// Takes an entry out of the cache and frees it, returning its value.
+static HTValue_t DropEntry(LRUCache *cache, LRUEntry *entry) {
+  HTValue_t value = entry->value;
+  HTKeyValue_t kv;
+
+  HashTable_Remove(cache->index, entry->key, &kv);
+  Unlink(cache->recency, entry);
+  cache->size -= entry->size;
+  free(entry);
+  return value;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// LRUCache implementation.
+
+LRUCache* LRUCache_Allocate(size_t capacity, LRUSizeFnPtr size_function,
+                            ValueFreeFnPtr evict_function) {
+  LRUCache *cache;
+
+  Verify333(capacity > 0);
+  Verify333(evict_function != NULL);
+
+  cache = (LRUCache *) malloc(sizeof(LRUCache));
+  Verify333(cache != NULL);
+  cache->index = HashTable_Allocate(16);
+  cache->recency = LinkedList_Allocate();
+  cache->capacity = capacity;
+  cache->size = 0;
+  cache->size_function = size_function;
+  cache->evict_function = evict_function;
+  return cache;
+}
+
+void LRUCache_Free(LRUCache *cache) {
+  LinkedListNode *node, *next;
+
+  Verify333(cache != NULL);
+  for (node = cache->recency->head; node != NULL; node = next) {
+    LRUEntry *entry = (LRUEntry *) node->payload;
+
+    next = node->next;
+    cache->evict_function(entry->value);
+    free(entry);
+  }
+  cache->recency->head = cache->recency->tail = NULL;
+  cache->recency->num_elements = 0;
+  LinkedList_Free(cache->recency, &NoOpFree);
+  HashTable_Free(cache->index, &NoOpValueFree);
+  free(cache);
+}
+
+int LRUCache_NumElements(LRUCache *cache) {
+  Verify333(cache != NULL);
+  return LinkedList_NumElements(cache->recency);
+}
+
+size_t LRUCache_Size(LRUCache *cache) {
+  Verify333(cache != NULL);
+  return cache->size;
+}
+
+bool LRUCache_Get(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue) {
+  HTKeyValue_t kv;
+  LRUEntry *entry;
+
+  Verify333(cache != NULL);
+  if (!HashTable_Find(cache->index, key, &kv)) {
+    return false;
+  }
+  entry = (LRUEntry *) kv.value;
+  if (cache->recency->head != &entry->node) {
+    Unlink(cache->recency, entry);
+    PushFront(cache->recency, entry);
+  }
+  keyvalue->key = key;
+  keyvalue->value = entry->value;
+  return true;
+}
+
+bool LRUCache_Put(LRUCache *cache, HTKeyValue_t newkeyvalue) {
+  size_t size;
+  HTKeyValue_t kv, old;
+  LRUEntry *entry;
+  bool replaced;
+
+  Verify333(cache != NULL);
+  size = cache->size_function != NULL ?
+         cache->size_function(newkeyvalue.value) : 1;
+
+  replaced = HashTable_Find(cache->index, newkeyvalue.key, &kv);
+  if (replaced) {
+    // Reuse the entry, at the front of the list.
+    entry = (LRUEntry *) kv.value;
+    Unlink(cache->recency, entry);
+    if (entry->value != newkeyvalue.value) {
+      cache->evict_function(entry->value);
+    }
+    cache->size -= entry->size;
+  } else {
+    entry = (LRUEntry *) malloc(sizeof(LRUEntry));
+    Verify333(entry != NULL);
+    entry->node.payload = entry;
+    entry->key = newkeyvalue.key;
+    kv.key = newkeyvalue.key;
+    kv.value = entry;
+    HashTable_Insert(cache->index, kv, &old);
+  }
+  entry->value = newkeyvalue.value;
+  entry->size = size;
+  cache->size += size;
+  PushFront(cache->recency, entry);
+
+  // Evict from the back, which reaches the new entry last.
+  while (cache->size > cache->capacity) {
+    LRUEntry *victim = (LRUEntry *) cache->recency->tail->payload;
+    cache->evict_function(DropEntry(cache, victim));
+  }
+  return replaced;
+}
+
+bool LRUCache_Remove(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue) {
+  HTKeyValue_t kv;
+
+  Verify333(cache != NULL);
+  if (!HashTable_Find(cache->index, key, &kv)) {
+    return false;
+  }
+  keyvalue->key = key;
+  keyvalue->value = DropEntry(cache, (LRUEntry *) kv.value);
+  return true;
+}
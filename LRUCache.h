@@ -0,0 +1,133 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_LRUCACHE_H_
+#define HW1_LRUCACHE_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
+
+#include "./HashTable.h"  // for HTKey_t, HTKeyValue_t, ValueFreeFnPtr
+
+///////////////////////////////////////////////////////////////////////////////
+// An LRUCache is a map from HTKey_t keys to HTValue_t values with a
+// capacity: when a put would take it over capacity, it evicts the least
+// recently used (key,value)s until it fits.  A get or a put makes a key the
+// most recently used.
+//
+// Every operation is O(1).  A HashTable maps each key to its entry, and the
+// entries themselves are the nodes of a LinkedList in recency order, so a
+// hit relinks its entry at the front of the list without searching it, and
+// an eviction takes the entry at the back.
+//
+// The capacity is either a number of (key,value)s or, with a size
+// callback, a number of bytes: the sum of the callback's answer for each
+// value in the cache.
+//
+// The cache owns the values it holds.  It passes each value it drops --
+// evicted, replaced by a put of the same key, or left in the cache when
+// it is freed -- to the eviction callback, a ValueFreeFnPtr; values taken
+// out with LRUCache_Remove are the caller's.
+typedef struct lru_cache LRUCache;
+
+// The size callback: returns the number of bytes a value counts for.  It
+// is called once, when the value is put.
+typedef size_t(*LRUSizeFnPtr)(HTValue_t value);
+
+// Allocate and return a new, empty LRUCache.  The caller must eventually
+// free it with LRUCache_Free.
+//
+// Arguments:
+// - capacity: the most the cache may hold; MUST be greater than zero.
+//   Counts (key,value)s if size_function is NULL, else bytes.
+// - size_function: the size callback, or NULL to count (key,value)s.
+// - evict_function: invoked on every value the cache drops; must be
+//   non-NULL.
+//
+// Returns a pointer to the newly allocated LRUCache.
+LRUCache* LRUCache_Allocate(size_t capacity, LRUSizeFnPtr size_function,
+                            ValueFreeFnPtr evict_function);
+
+// Free an LRUCache, passing the values still in it to its eviction
+// callback.
+//
+// Arguments:
+// - cache: the cache to free.  It is unsafe to use cache after this
+//   function returns.
+void LRUCache_Free(LRUCache *cache);
+
+// Figure out the number of (key,value)s in the cache.
+//
+// Arguments:
+// - cache: the cache to query.
+//
+// Returns:
+// - the number of (key,value)s (>= 0).
+int LRUCache_NumElements(LRUCache *cache);
+
+// Figure out how much of the cache's capacity is in use: the number of
+// (key,value)s, or the sum of their sizes if the cache has a size
+// callback.
+//
+// Arguments:
+// - cache: the cache to query.
+//
+// Returns:
+// - the capacity in use, which is never more than the capacity.
+size_t LRUCache_Size(LRUCache *cache);
+
+// Looks up a key and, if it is present, makes it the most recently used.
+//
+// Arguments:
+// - cache: the LRUCache to look in.
+// - key: the key to look up.
+// - keyvalue: if the key is present, a copy of its (key,value) is
+//   returned through this return parameter.  The (key,value) stays in the
+//   cache, so the caller must not free keyvalue->value, and the value is
+//   only good until the cache drops it.
+//
+// Returns:
+//  - false: if the key wasn't found (a miss).
+//  - true: if the key was found and its (key,value) returned (a hit).
+bool LRUCache_Get(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue);
+
+// Puts a (key,value) into the cache as the most recently used, then
+// evicts the least recently used (key,value)s until the cache is within
+// its capacity.  A value that exceeds the capacity on its own is evicted
+// as soon as it is put.
+//
+// Arguments:
+// - cache: the LRUCache to put into.
+// - newkeyvalue: the (key,value) to put.  The cache takes ownership of the
+//   value.
+//
+// Returns:
+//  - false: if there was no (key,value) with that key.
+//  - true: if newkeyvalue replaced a (key,value) with the same key, whose
+//    value was passed to the eviction callback (unless it was the same
+//    value).
+bool LRUCache_Put(LRUCache *cache, HTKeyValue_t newkeyvalue);
+
+// Removes a key from the cache, without calling the eviction callback.
+//
+// Arguments:
+// - cache: the LRUCache to remove from.
+// - key: the key to remove.
+// - keyvalue: if the key is present, its (key,value) is removed and
+//   returned through this return parameter, and the caller takes
+//   ownership of its value.
+//
+// Returns:
+//  - false: if the key wasn't found.
+//  - true: if the key was found, removed and returned.
+bool LRUCache_Remove(LRUCache *cache, HTKey_t key, HTKeyValue_t *keyvalue);
+
+#endif  // HW1_LRUCACHE_H_
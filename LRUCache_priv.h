@@ -0,0 +1,49 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_LRUCACHE_PRIV_H_
+#define HW1_LRUCACHE_PRIV_H_
+
+#include <stddef.h>   // for size_t
+
+#include "./HashTable.h"
+#include "./LinkedList.h"
+#include "./LinkedList_priv.h"
+#include "./LRUCache.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures for our LRUCache implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// A (key,value) in the cache.  The entry is its own node in the recency
+// list: node comes first, and node.payload points back at the entry.
+typedef struct lru_entry {
+  LinkedListNode  node;
+  HTKey_t         key;
+  HTValue_t       value;
+  size_t          size;   // what the entry counts against the capacity
+} LRUEntry;
+
+// The cache.
+typedef struct lru_cache {
+  HashTable      *index;     // key -> its LRUEntry *
+  LinkedList     *recency;   // the entries, most recently used at the head
+  size_t          capacity;
+  size_t          size;      // the sum of the entries' sizes
+  LRUSizeFnPtr    size_function;   // NULL: every entry has size 1
+  ValueFreeFnPtr  evict_function;
+} LRUCache;
+
+#endif  // HW1_LRUCACHE_PRIV_H_
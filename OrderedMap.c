@@ -0,0 +1,596 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CSE333.h"
+#include "OrderedMap.h"
+#include "OrderedMap_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+// The fewest (key,value)s or keys a node other than the root may hold.
+#define OM_LEAF_MIN (OM_LEAF_SLOTS / 2)
+#define OM_INNER_MIN (OM_INNER_SLOTS / 2)
+
+// Allocates size bytes on a cache-line boundary.
+static void *AllocateNode(size_t size) {
+  void *node;
+
+  size = (size + OM_NODE_ALIGN - 1) / OM_NODE_ALIGN * OM_NODE_ALIGN;
+  node = aligned_alloc(OM_NODE_ALIGN, size);
+  Verify333(node != NULL);
+  return node;
+}
+
+static OMLeaf *AllocateLeaf(void) {
+  OMLeaf *leaf = (OMLeaf *) AllocateNode(sizeof(OMLeaf));
+
+  leaf->num_keys = 0;
+  leaf->prev = leaf->next = NULL;
+  return leaf;
+}
+
+static OMInner *AllocateInner(void) {
+  OMInner *inner = (OMInner *) AllocateNode(sizeof(OMInner));
+
+  inner->num_keys = 0;
+  return inner;
+}
+
+// Returns the number of keys[0..n) that are < key, by binary search.
+static inline int LowerBound(const HTKey_t *keys, int n, HTKey_t key) {
+  int lo = 0;
+
+  while (n > 0) {
+    int half = n / 2;
+
+    if (keys[lo + half] < key) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return lo;
+}
+
+// Returns the number of keys[0..n) that are <= key: the child of an
+// interior node that key belongs in.
+static inline int UpperBound(const HTKey_t *keys, int n, HTKey_t key) {
+  int lo = 0;
+
+  while (n > 0) {
+    int half = n / 2;
+
+    if (keys[lo + half] <= key) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return lo;
+}
+
+// Returns the leaf that key belongs in.
+static OMLeaf *FindLeaf(const OrderedMap *map, HTKey_t key) {
+  void *node = map->root;
+  int h;
+
+  for (h = map->height; h > 0; h--) {
+    const OMInner *inner = (const OMInner *) node;
+    node = inner->children[UpperBound(inner->keys, inner->num_keys, key)];
+  }
+  return (OMLeaf *) node;
+}
+
+// Frees the subtree at node, height levels above the leaves, passing its
+// values to value_free_function.
+static void FreeSubtree(void *node, int height,
+                        ValueFreeFnPtr value_free_function) {
+  int i;
+
+  if (height == 0) {
+    OMLeaf *leaf = (OMLeaf *) node;
+    for (i = 0; i < leaf->num_keys; i++) {
+      value_free_function(leaf->values[i]);
+    }
+  } else {
+    OMInner *inner = (OMInner *) node;
+    for (i = 0; i <= inner->num_keys; i++) {
+      FreeSubtree(inner->children[i], height - 1, value_free_function);
+    }
+  }
+  free(node);
+}
+
+// Moves the upper half of a full leaf into a new leaf linked in after it,
+// and returns the new leaf.
+static OMLeaf *SplitLeaf(OrderedMap *map, OMLeaf *leaf) {
+  OMLeaf *right = AllocateLeaf();
+  int keep = OM_LEAF_SLOTS / 2;
+
+  right->num_keys = leaf->num_keys - keep;
+  memcpy(right->keys, leaf->keys + keep, right->num_keys * sizeof(HTKey_t));
+  memcpy(right->values, leaf->values + keep,
+         right->num_keys * sizeof(HTValue_t));
+  leaf->num_keys = keep;
+
+  right->prev = leaf;
+  right->next = leaf->next;
+  if (leaf->next != NULL) {
+    leaf->next->prev = right;
+  } else {
+    map->last = right;
+  }
+  leaf->next = right;
+  return right;
+}
+
+// Inserts sep at keys[pos] and, just after it, child at children[pos + 1],
+// in the key and child arrays of an interior node with num_keys keys and
+// room for one more.
+static void InsertAt(HTKey_t *keys, void **children, int num_keys, int pos,
+                     HTKey_t sep, void *child) {
+  memmove(keys + pos + 1, keys + pos, (num_keys - pos) * sizeof(HTKey_t));
+  memmove(children + pos + 2, children + pos + 1,
+          (num_keys - pos) * sizeof(void *));
+  keys[pos] = sep;
+  children[pos + 1] = child;
+}
+
+// Inserts kv into the subtree at node, height levels above the leaves.
+// Sets *replaced, and *old if a (key,value) was replaced.  If node had to
+// split, returns its new right sibling and sets *sep to the key that
+// separates them; otherwise returns NULL.
+static void *InsertInto(OrderedMap *map, void *node, int height,
+                        HTKeyValue_t kv, HTKeyValue_t *old, bool *replaced,
+                        HTKey_t *sep) {
+  void *right = NULL;
+
+  if (height == 0) {
+    OMLeaf *leaf = (OMLeaf *) node;
+    int pos = LowerBound(leaf->keys, leaf->num_keys, kv.key);
+
+    if (pos < leaf->num_keys && leaf->keys[pos] == kv.key) {
+      old->key = kv.key;
+      old->value = leaf->values[pos];
+      leaf->values[pos] = kv.value;
+      *replaced = true;
+      return NULL;
+    }
+    if (leaf->num_keys == OM_LEAF_SLOTS) {
+      OMLeaf *new_leaf = SplitLeaf(map, leaf);
+
+      right = new_leaf;
+      *sep = new_leaf->keys[0];
+      if (pos > leaf->num_keys) {
+        pos -= leaf->num_keys;
+        leaf = new_leaf;
+      }
+    }
+    memmove(leaf->keys + pos + 1, leaf->keys + pos,
+            (leaf->num_keys - pos) * sizeof(HTKey_t));
+    memmove(leaf->values + pos + 1, leaf->values + pos,
+            (leaf->num_keys - pos) * sizeof(HTValue_t));
+    leaf->keys[pos] = kv.key;
+    leaf->values[pos] = kv.value;
+    leaf->num_keys++;
+    *replaced = false;
+    return right;
+  } else {
+    OMInner *inner = (OMInner *) node;
+    int pos = UpperBound(inner->keys, inner->num_keys, kv.key);
+    HTKey_t child_sep;
+    void *child_right = InsertInto(map, inner->children[pos], height - 1,
+                                   kv, old, replaced, &child_sep);
+
+    if (child_right == NULL) {
+      return NULL;
+    }
+    if (inner->num_keys == OM_INNER_SLOTS) {
+      // Lay out the node's keys and children with the new ones added, then
+      // split them around the middle key, which moves up to the parent.
+      HTKey_t keys[OM_INNER_SLOTS + 1];
+      void *children[OM_INNER_SLOTS + 2];
+      OMInner *new_inner = AllocateInner();
+      int mid = OM_INNER_SLOTS / 2;
+
+      memcpy(keys, inner->keys, sizeof(inner->keys));
+      memcpy(children, inner->children, sizeof(inner->children));
+      InsertAt(keys, children, OM_INNER_SLOTS, pos, child_sep, child_right);
+
+      inner->num_keys = mid;
+      memcpy(inner->keys, keys, mid * sizeof(HTKey_t));
+      memcpy(inner->children, children, (mid + 1) * sizeof(void *));
+      *sep = keys[mid];
+      new_inner->num_keys = OM_INNER_SLOTS - mid;
+      memcpy(new_inner->keys, keys + mid + 1,
+             new_inner->num_keys * sizeof(HTKey_t));
+      memcpy(new_inner->children, children + mid + 1,
+             (new_inner->num_keys + 1) * sizeof(void *));
+      return new_inner;
+    }
+    InsertAt(inner->keys, inner->children, inner->num_keys, pos, child_sep,
+             child_right);
+    inner->num_keys++;
+    return NULL;
+  }
+}
+
+// Removes the key at pos from an interior node, with the child after it.
+static void InnerRemoveAt(OMInner *inner, int pos) {
+  memmove(inner->keys + pos, inner->keys + pos + 1,
+          (inner->num_keys - pos - 1) * sizeof(HTKey_t));
+  memmove(inner->children + pos + 1, inner->children + pos + 2,
+          (inner->num_keys - pos - 1) * sizeof(void *));
+  inner->num_keys--;
+}
+
+// Refills parent->children[i], a leaf that has fallen below OM_LEAF_MIN,
+// by borrowing from a sibling or, if neither can spare any, by merging
+// with one.
+static void FixLeaf(OrderedMap *map, OMInner *parent, int i) {
+  OMLeaf *leaf = (OMLeaf *) parent->children[i];
+  OMLeaf *left = i > 0 ? (OMLeaf *) parent->children[i - 1] : NULL;
+  OMLeaf *right = i < parent->num_keys ?
+                  (OMLeaf *) parent->children[i + 1] : NULL;
+
+  if (left != NULL && left->num_keys > OM_LEAF_MIN) {
+    memmove(leaf->keys + 1, leaf->keys, leaf->num_keys * sizeof(HTKey_t));
+    memmove(leaf->values + 1, leaf->values,
+            leaf->num_keys * sizeof(HTValue_t));
+    left->num_keys--;
+    leaf->keys[0] = left->keys[left->num_keys];
+    leaf->values[0] = left->values[left->num_keys];
+    leaf->num_keys++;
+    parent->keys[i - 1] = leaf->keys[0];
+    return;
+  }
+  if (right != NULL && right->num_keys > OM_LEAF_MIN) {
+    leaf->keys[leaf->num_keys] = right->keys[0];
+    leaf->values[leaf->num_keys] = right->values[0];
+    leaf->num_keys++;
+    right->num_keys--;
+    memmove(right->keys, right->keys + 1, right->num_keys * sizeof(HTKey_t));
+    memmove(right->values, right->values + 1,
+            right->num_keys * sizeof(HTValue_t));
+    parent->keys[i] = right->keys[0];
+    return;
+  }
+
+  // Merge the pair into its left leaf.
+  if (left == NULL) {
+    left = leaf;
+  } else {
+    right = leaf;
+    i--;
+  }
+  memcpy(left->keys + left->num_keys, right->keys,
+         right->num_keys * sizeof(HTKey_t));
+  memcpy(left->values + left->num_keys, right->values,
+         right->num_keys * sizeof(HTValue_t));
+  left->num_keys += right->num_keys;
+  left->next = right->next;
+  if (right->next != NULL) {
+    right->next->prev = left;
+  } else {
+    map->last = left;
+  }
+  free(right);
+  InnerRemoveAt(parent, i);
+}
+
+// As FixLeaf, for an interior child.  Keys rotate through the parent.
+static void FixInner(OMInner *parent, int i) {
+  OMInner *node = (OMInner *) parent->children[i];
+  OMInner *left = i > 0 ? (OMInner *) parent->children[i - 1] : NULL;
+  OMInner *right = i < parent->num_keys ?
+                   (OMInner *) parent->children[i + 1] : NULL;
+
+  if (left != NULL && left->num_keys > OM_INNER_MIN) {
+    memmove(node->keys + 1, node->keys, node->num_keys * sizeof(HTKey_t));
+    memmove(node->children + 1, node->children,
+            (node->num_keys + 1) * sizeof(void *));
+    node->keys[0] = parent->keys[i - 1];
+    node->children[0] = left->children[left->num_keys];
+    node->num_keys++;
+    parent->keys[i - 1] = left->keys[left->num_keys - 1];
+    left->num_keys--;
+    return;
+  }
+  if (right != NULL && right->num_keys > OM_INNER_MIN) {
+    node->keys[node->num_keys] = parent->keys[i];
+    node->children[node->num_keys + 1] = right->children[0];
+    node->num_keys++;
+    parent->keys[i] = right->keys[0];
+    memmove(right->keys, right->keys + 1,
+            (right->num_keys - 1) * sizeof(HTKey_t));
+    memmove(right->children, right->children + 1,
+            right->num_keys * sizeof(void *));
+    right->num_keys--;
+    return;
+  }
+
+  // Merge the pair, and the key between them, into the left node.
+  if (left == NULL) {
+    left = node;
+  } else {
+    right = node;
+    i--;
+  }
+  left->keys[left->num_keys] = parent->keys[i];
+  memcpy(left->keys + left->num_keys + 1, right->keys,
+         right->num_keys * sizeof(HTKey_t));
+  memcpy(left->children + left->num_keys + 1, right->children,
+         (right->num_keys + 1) * sizeof(void *));
+  left->num_keys += right->num_keys + 1;
+  free(right);
+  InnerRemoveAt(parent, i);
+}
+
+// Removes key from the subtree at node, height levels above the leaves,
+// returning its (key,value) through kv.  Returns false if key isn't there.
+// Leaves node's children at least half full, though node itself may not
+// be; its parent fixes that.
+static bool RemoveFrom(OrderedMap *map, void *node, int height, HTKey_t key,
+                       HTKeyValue_t *kv) {
+  if (height == 0) {
+    OMLeaf *leaf = (OMLeaf *) node;
+    int pos = LowerBound(leaf->keys, leaf->num_keys, key);
+
+    if (pos == leaf->num_keys || leaf->keys[pos] != key) {
+      return false;
+    }
+    kv->key = key;
+    kv->value = leaf->values[pos];
+    leaf->num_keys--;
+    memmove(leaf->keys + pos, leaf->keys + pos + 1,
+            (leaf->num_keys - pos) * sizeof(HTKey_t));
+    memmove(leaf->values + pos, leaf->values + pos + 1,
+            (leaf->num_keys - pos) * sizeof(HTValue_t));
+    return true;
+  } else {
+    OMInner *inner = (OMInner *) node;
+    int pos = UpperBound(inner->keys, inner->num_keys, key);
+
+    if (!RemoveFrom(map, inner->children[pos], height - 1, key, kv)) {
+      return false;
+    }
+    if (height == 1) {
+      if (((OMLeaf *) inner->children[pos])->num_keys < OM_LEAF_MIN) {
+        FixLeaf(map, inner, pos);
+      }
+    } else if (((OMInner *) inner->children[pos])->num_keys < OM_INNER_MIN) {
+      FixInner(inner, pos);
+    }
+    return true;
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// OrderedMap implementation.
+
+OrderedMap* OrderedMap_Allocate(void) {
+  OrderedMap *map = (OrderedMap *) malloc(sizeof(OrderedMap));
+
+  Verify333(map != NULL);
+  map->first = map->last = AllocateLeaf();
+  map->root = map->first;
+  map->height = 0;
+  map->num_elements = 0;
+  return map;
+}
+
+void OrderedMap_Free(OrderedMap *map, ValueFreeFnPtr value_free_function) {
+  Verify333(map != NULL);
+  FreeSubtree(map->root, map->height, value_free_function);
+  free(map);
+}
+
+int OrderedMap_NumElements(OrderedMap *map) {
+  Verify333(map != NULL);
+  return map->num_elements;
+}
+
+bool OrderedMap_Insert(OrderedMap *map,
+                       HTKeyValue_t newkeyvalue,
+                       HTKeyValue_t *oldkeyvalue) {
+  bool replaced;
+  HTKey_t sep;
+  void *right;
+
+  Verify333(map != NULL);
+  right = InsertInto(map, map->root, map->height, newkeyvalue, oldkeyvalue,
+                     &replaced, &sep);
+  if (right != NULL) {
+    // The root split: grow the tree by a level.
+    OMInner *root = AllocateInner();
+
+    root->num_keys = 1;
+    root->keys[0] = sep;
+    root->children[0] = map->root;
+    root->children[1] = right;
+    map->root = root;
+    map->height++;
+  }
+  if (!replaced) {
+    map->num_elements++;
+  }
+  return replaced;
+}
+
+bool OrderedMap_Find(OrderedMap *map, HTKey_t key, HTKeyValue_t *keyvalue) {
+  OMLeaf *leaf;
+  int pos;
+
+  Verify333(map != NULL);
+  leaf = FindLeaf(map, key);
+  pos = LowerBound(leaf->keys, leaf->num_keys, key);
+  if (pos == leaf->num_keys || leaf->keys[pos] != key) {
+    return false;
+  }
+  keyvalue->key = key;
+  keyvalue->value = leaf->values[pos];
+  return true;
+}
+
+bool OrderedMap_LowerBound(OrderedMap *map, HTKey_t key,
+                           HTKeyValue_t *keyvalue) {
+  OMLeaf *leaf;
+  int pos;
+
+  Verify333(map != NULL);
+  leaf = FindLeaf(map, key);
+  pos = LowerBound(leaf->keys, leaf->num_keys, key);
+  if (pos == leaf->num_keys) {
+    // Every key in the next leaf is >= the separator that sent us here,
+    // which is > key.
+    leaf = leaf->next;
+    pos = 0;
+    if (leaf == NULL) {
+      return false;
+    }
+  }
+  keyvalue->key = leaf->keys[pos];
+  keyvalue->value = leaf->values[pos];
+  return true;
+}
+
+bool OrderedMap_Remove(OrderedMap *map, HTKey_t key, HTKeyValue_t *keyvalue) {
+  Verify333(map != NULL);
+  if (!RemoveFrom(map, map->root, map->height, key, keyvalue)) {
+    return false;
+  }
+  map->num_elements--;
+  if (map->height > 0 && ((OMInner *) map->root)->num_keys == 0) {
+    // The root is down to one child: shrink the tree by a level.
+    OMInner *root = (OMInner *) map->root;
+
+    map->root = root->children[0];
+    map->height--;
+    free(root);
+  }
+  return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// OMIterator implementation.
+
+// Makes the iterator invalid if it has left its range.
+static inline bool CheckRange(OMIterator *iter) {
+  if (iter->leaf != NULL) {
+    HTKey_t key = iter->leaf->keys[iter->pos];
+    if (key < iter->lo || key > iter->hi) {
+      iter->leaf = NULL;
+    }
+  }
+  return iter->leaf != NULL;
+}
+
+OMIterator* OMIterator_AllocateRange(OrderedMap *map, HTKey_t lo,
+                                     HTKey_t hi) {
+  OMIterator *iter;
+
+  Verify333(map != NULL);
+  Verify333(lo <= hi);
+
+  iter = (OMIterator *) malloc(sizeof(OMIterator));
+  Verify333(iter != NULL);
+  iter->map = map;
+  iter->lo = lo;
+  iter->hi = hi;
+  OMIterator_First(iter);
+  return iter;
+}
+
+OMIterator* OMIterator_Allocate(OrderedMap *map) {
+  return OMIterator_AllocateRange(map, 0, UINT64_MAX);
+}
+
+void OMIterator_Free(OMIterator *iter) {
+  Verify333(iter != NULL);
+  free(iter);
+}
+
+bool OMIterator_IsValid(OMIterator *iter) {
+  Verify333(iter != NULL);
+  return iter->leaf != NULL;
+}
+
+bool OMIterator_Next(OMIterator *iter) {
+  Verify333(iter != NULL);
+  if (iter->leaf == NULL) {
+    return false;
+  }
+  if (++iter->pos == iter->leaf->num_keys) {
+    iter->leaf = iter->leaf->next;
+    iter->pos = 0;
+  }
+  return CheckRange(iter);
+}
+
+bool OMIterator_Prev(OMIterator *iter) {
+  Verify333(iter != NULL);
+  if (iter->leaf == NULL) {
+    return false;
+  }
+  if (--iter->pos < 0) {
+    iter->leaf = iter->leaf->prev;
+    if (iter->leaf != NULL) {
+      iter->pos = iter->leaf->num_keys - 1;
+    }
+  }
+  return CheckRange(iter);
+}
+
+bool OMIterator_First(OMIterator *iter) {
+  Verify333(iter != NULL);
+  iter->leaf = FindLeaf(iter->map, iter->lo);
+  iter->pos = LowerBound(iter->leaf->keys, iter->leaf->num_keys, iter->lo);
+  if (iter->pos == iter->leaf->num_keys) {
+    iter->leaf = iter->leaf->next;
+    iter->pos = 0;
+  }
+  return CheckRange(iter);
+}
+
+bool OMIterator_Last(OMIterator *iter) {
+  Verify333(iter != NULL);
+  // The last key <= hi is just before the first key > hi, which is in hi's
+  // leaf or the one after it.
+  iter->leaf = FindLeaf(iter->map, iter->hi);
+  iter->pos = UpperBound(iter->leaf->keys, iter->leaf->num_keys,
+                         iter->hi) - 1;
+  if (iter->pos < 0) {
+    iter->leaf = iter->leaf->prev;
+    if (iter->leaf != NULL) {
+      iter->pos = iter->leaf->num_keys - 1;
+    }
+  }
+  return CheckRange(iter);
+}
+
+bool OMIterator_Get(OMIterator *iter, HTKeyValue_t *keyvalue) {
+  Verify333(iter != NULL);
+  if (iter->leaf == NULL) {
+    return false;
+  }
+  keyvalue->key = iter->leaf->keys[iter->pos];
+  keyvalue->value = iter->leaf->values[iter->pos];
+  return true;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_ORDEREDMAP_H_
+#define HW1_ORDEREDMAP_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stdint.h>     // for uint64_t, etc.
+
+#include "./HashTable.h"  // for HTKey_t, HTKeyValue_t, ValueFreeFnPtr
+
+///////////////////////////////////////////////////////////////////////////////
+// An OrderedMap maps HTKey_t keys to HTValue_t values, like a HashTable,
+// but keeps its keys in ascending order: it can find the first key at or
+// after a given one and visit every (key,value) between two keys, in
+// either direction, in time proportional to the number visited.  A
+// HashTable can only answer those questions by scanning and sorting every
+// key it has.
+//
+// The map is a B+tree with wide nodes: an interior node holds up to 64
+// keys, and a leaf up to 32 (key,value)s, their keys packed together and
+// aligned on cache lines, so that a lookup in a map of a million keys
+// reads four nodes and searches each within a few lines.  The leaves are
+// linked in key order for the iterators.
+//
+// Values follow HashTable's conventions: the map owns the values it holds,
+// hands back the values it replaces or removes, and passes the rest to a
+// ValueFreeFnPtr when it is freed.
+typedef struct ordered_map OrderedMap;
+
+// Allocate and return a new, empty OrderedMap.  The caller must eventually
+// free it with OrderedMap_Free.
+OrderedMap* OrderedMap_Allocate(void);
+
+// Free an OrderedMap.
+//
+// Arguments:
+// - map: the map to free.  It is unsafe to use map after this function
+//   returns.
+// - value_free_function: invoked once for each value in the map.
+void OrderedMap_Free(OrderedMap *map, ValueFreeFnPtr value_free_function);
+
+// Figure out the number of (key,value)s in the map.
+//
+// Arguments:
+// - map: the map to query.
+//
+// Returns:
+// - the number of (key,value)s (>= 0).
+int OrderedMap_NumElements(OrderedMap *map);
+
+// Inserts a (key,value) into the map, replacing any (key,value) with the
+// same key.
+//
+// Arguments:
+// - map: the OrderedMap to insert into.
+// - newkeyvalue: the (key,value) to insert.  The map takes ownership of
+//   the value.
+// - oldkeyvalue: if a (key,value) with the same key was already in the
+//   map, it is replaced and returned through this return parameter, and
+//   the caller takes ownership of its value.
+//
+// Returns:
+//  - false: if newkeyvalue was inserted and there was no (key,value) with
+//    that key.
+//  - true: if newkeyvalue replaced a (key,value), which was returned
+//    through oldkeyvalue.
+bool OrderedMap_Insert(OrderedMap *map,
+                       HTKeyValue_t newkeyvalue,
+                       HTKeyValue_t *oldkeyvalue);
+
+// Looks up a key in the map.
+//
+// Arguments:
+// - map: the OrderedMap to look in.
+// - key: the key to look up.
+// - keyvalue: if the key is present, a copy of its (key,value) is
+//   returned through this return parameter; the (key,value) stays in the
+//   map.
+//
+// Returns:
+//  - false: if the key wasn't found.
+//  - true: if the key was found and its (key,value) returned.
+bool OrderedMap_Find(OrderedMap *map, HTKey_t key, HTKeyValue_t *keyvalue);
+
+// Finds the (key,value) with the smallest key that is >= key.
+//
+// Arguments:
+// - map: the OrderedMap to look in.
+// - key: the key to search from.
+// - keyvalue: if there is such a (key,value), a copy of it is returned
+//   through this return parameter.
+//
+// Returns:
+//  - false: if every key in the map is smaller than key.
+//  - true: if a (key,value) was found and returned.
+bool OrderedMap_LowerBound(OrderedMap *map, HTKey_t key,
+                           HTKeyValue_t *keyvalue);
+
+// Removes a key from the map.
+//
+// Arguments:
+// - map: the OrderedMap to remove from.
+// - key: the key to remove.
+// - keyvalue: if the key is present, its (key,value) is removed and
+//   returned through this return parameter, and the caller takes
+//   ownership of its value.
+//
+// Returns:
+//  - false: if the key wasn't found.
+//  - true: if the key was found, removed and returned.
+bool OrderedMap_Remove(OrderedMap *map, HTKey_t key, HTKeyValue_t *keyvalue);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Range iterators
+//
+// An OMIterator visits the (key,value)s whose keys fall in a closed range
+// [lo, hi], in ascending order with OMIterator_Next or descending order
+// with OMIterator_Prev.  Stepping off either end of the range leaves the
+// iterator invalid; OMIterator_First and OMIterator_Last put it back on
+// the range's first or last (key,value).
+//
+// Any OrderedMap function that mutates the map (Insert, Remove) makes its
+// existing iterators undefined (ie, dangerous to use; arbitrary memory
+// corruption can occur).
+typedef struct om_it OMIterator;
+
+// Manufacture an iterator over the keys in [lo, hi] of the map, pointing
+// at the first of them.  The caller must eventually free it with
+// OMIterator_Free.
+//
+// Arguments:
+// - map: the map to iterate over.
+// - lo, hi: the smallest and largest keys to visit; lo <= hi.
+//
+// Returns:
+// - the newly-allocated iterator, which is invalid if no key in the map
+//   falls in [lo, hi].
+OMIterator* OMIterator_AllocateRange(OrderedMap *map, HTKey_t lo, HTKey_t hi);
+
+// Manufacture an iterator over the whole map, pointing at its smallest
+// key.  Same as OMIterator_AllocateRange(map, 0, UINT64_MAX).
+OMIterator* OMIterator_Allocate(OrderedMap *map);
+
+// When you're done with an iterator, you must free it by calling this
+// function.
+//
+// Arguments:
+// - iter: the iterator to free.  Don't use it after freeing it.
+void OMIterator_Free(OMIterator *iter);
+
+// Tests to see whether the iterator is pointing at a (key,value) in its
+// range.
+//
+// Arguments:
+// - iter: the iterator to test.
+//
+// Returns:
+// - true: if iter points at a (key,value).
+// - false: if iter has stepped off its range, or the range is empty.
+bool OMIterator_IsValid(OMIterator *iter);
+
+// Moves the iterator to the (key,value) with the next larger key.
+//
+// Arguments:
+// - iter: the iterator to move.  Must be non-NULL.
+//
+// Returns:
+// - true: if the iterator moved to another (key,value) in its range.
+// - false: if there is none, or the iterator was already invalid.  The
+//   iterator is invalid at this point.
+bool OMIterator_Next(OMIterator *iter);
+
+// Moves the iterator to the (key,value) with the next smaller key.
+//
+// Arguments and return value: as for OMIterator_Next.
+bool OMIterator_Prev(OMIterator *iter);
+
+// Points the iterator at the smallest key in its range.
+//
+// Arguments:
+// - iter: the iterator to move.  Must be non-NULL.
+//
+// Returns:
+// - true: if the range holds a key.
+// - false: if it doesn't; the iterator is invalid.
+bool OMIterator_First(OMIterator *iter);
+
+// Points the iterator at the largest key in its range.
+//
+// Arguments and return value: as for OMIterator_First.
+bool OMIterator_Last(OMIterator *iter);
+
+// Returns a copy of the (key,value) that the iterator is pointing at.
+//
+// Arguments:
+// - iter: the iterator to fetch the (key,value) from.  Must be non-NULL.
+// - keyvalue: a return parameter through which the (key,value) is
+//   returned.
+//
+// Returns:
+// - false: if the iterator is not valid.
+// - true: success.
+bool OMIterator_Get(OMIterator *iter, HTKeyValue_t *keyvalue);
+
+#endif  // HW1_ORDEREDMAP_H_
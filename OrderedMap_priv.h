@@ -0,0 +1,72 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_ORDEREDMAP_PRIV_H_
+#define HW1_ORDEREDMAP_PRIV_H_
+
+#include <stdint.h>   // for uint64_t, etc.
+
+#include "./OrderedMap.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures for our OrderedMap implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// The most (key,value)s in a leaf, and keys in an interior node.  Every
+// node but the root stays at least half full.
+#define OM_LEAF_SLOTS 32
+#define OM_INNER_SLOTS 64
+
+// Nodes are allocated on cache-line boundaries, with their keys first, so
+// that a search touches only the lines holding the keys it compares.
+#define OM_NODE_ALIGN 64
+
+// A leaf: num_keys (key,value)s in ascending key order.  The leaves form a
+// doubly-linked list in key order.
+typedef struct om_leaf {
+  HTKey_t          keys[OM_LEAF_SLOTS];
+  HTValue_t        values[OM_LEAF_SLOTS];
+  int              num_keys;
+  struct om_leaf  *prev;
+  struct om_leaf  *next;
+} OMLeaf;
+
+// An interior node: num_keys keys and num_keys + 1 children, which are
+// leaves or interior nodes by the node's height.  The keys in children[i]
+// are >= keys[i - 1] and < keys[i].
+typedef struct om_inner {
+  HTKey_t   keys[OM_INNER_SLOTS];
+  void     *children[OM_INNER_SLOTS + 1];
+  int       num_keys;
+} OMInner;
+
+// The map.
+typedef struct ordered_map {
+  void    *root;          // an OMLeaf if height is 0, else an OMInner
+  int      height;        // # of interior levels above the leaves
+  int      num_elements;
+  OMLeaf  *first;         // the leaves with the smallest and largest keys
+  OMLeaf  *last;
+} OrderedMap;
+
+// An iterator points at leaf->keys[pos], or is invalid if leaf is NULL.
+typedef struct om_it {
+  OrderedMap  *map;
+  OMLeaf      *leaf;
+  int          pos;
+  HTKey_t      lo, hi;     // the range it visits
+} OMIterator;
+
+#endif  // HW1_ORDEREDMAP_PRIV_H_
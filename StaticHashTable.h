@@ -0,0 +1,259 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_STATICHASHTABLE_H_
+#define HW1_STATICHASHTABLE_H_
+
+#ifndef __cplusplus
+#error "StaticHashTable.h is C++; C code calls a table's find function"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+extern "C" {
+  #include "./CSE333.h"
+  #include "./HashTable.h"
+}
+
+namespace hw1 {
+
+///////////////////////////////////////////////////////////////////////////////
+// A StaticHashTable is a read-only table whose keys are known when the
+// program is compiled, such as opcode or field IDs.  The compiler builds
+// it: a constexpr StaticHashTable is a perfect hash -- every key has a
+// slot of its own -- laid out in the program's read-only data, so there is
+// nothing to do at startup and a lookup is one hash, two array reads and
+// one key compare, whether or not the key is present.
+//
+// Define one from a list of (key, value) pairs, then give C code a
+// function with HashTable_Find's contract:
+//
+//   static constexpr auto kOpcodes = hw1::MakeStaticHashTable<const char *>({
+//     {0x01, "load"}, {0x02, "store"}, {0x10, "add"}, ...
+//   });
+//   HW1_STATIC_HASHTABLE_FIND_FN(Opcodes_Find, kOpcodes)
+//
+//   // In a C file:
+//   bool Opcodes_Find(HTKey_t key, HTKeyValue_t *keyvalue);
+//
+// The build is the same hash-and-displace scheme as HashTable_Freeze: the
+// keys are hashed into groups of about STATIC_HT_GROUP_SIZE, and each group
+// gets a "pilot", found by trial, that sends all of its keys to slots no
+// other key has taken.  The slot table here has a few more slots than
+// keys, which keeps the pilot search short enough for the compiler; empty
+// slots hold a copy of a key from the table, whose own slot is elsewhere,
+// so they never match and the lookup needn't test for them.
+//
+// A list with a key repeated, or that the build otherwise fails on, stops
+// the compile with a failed Verify333.
+
+#define STATIC_HT_GROUP_SIZE 4
+
+// One (key, value) pair of a StaticHashTable.  V is the value type; to be
+// found through the HashTable_Find contract it must be a pointer or an
+// integer type no wider than a pointer.
+template <typename V>
+struct StaticEntry {
+  HTKey_t key;
+  V value;
+};
+
+template <typename V, size_t N>
+class StaticHashTable {
+ public:
+  static_assert(N > 0, "a StaticHashTable needs at least one key");
+
+  static constexpr size_t kNumGroups = N / STATIC_HT_GROUP_SIZE + 1;
+  static constexpr size_t kNumSlots = N + N / 4 + 1;
+
+  // Builds the table from the N entries; see MakeStaticHashTable.
+  constexpr explicit StaticHashTable(const StaticEntry<V> (&entries)[N]) {
+    Build(entries);
+  }
+
+  // The number of keys in the table.
+  constexpr size_t NumKeys() const { return N; }
+
+  // Looks up key.
+  //
+  // Arguments:
+  // - key: the key to look up.
+  // - value: if the key is found, its value is returned through this
+  //   output parameter.
+  //
+  // Returns:
+  // - true if the key is in the table, false otherwise.
+  constexpr bool Find(HTKey_t key, V *value) const {
+    const StaticEntry<V> &slot = slots_[Slot(key)];
+
+    if (slot.key != key) {
+      return false;
+    }
+    *value = slot.value;
+    return true;
+  }
+
+  // Looks up key with HashTable_Find's contract: if the key is found, the
+  // key and its value (converted to an HTValue_t) are returned through
+  // keyvalue, which is otherwise left alone.
+  bool Find(HTKey_t key, HTKeyValue_t *keyvalue) const {
+    const StaticEntry<V> &slot = slots_[Slot(key)];
+
+    if (slot.key != key) {
+      return false;
+    }
+    keyvalue->key = key;
+    keyvalue->value = ToHTValue(slot.value);
+    return true;
+  }
+
+  // Returns true if key is in the table.
+  constexpr bool Contains(HTKey_t key) const {
+    return slots_[Slot(key)].key == key;
+  }
+
+ private:
+  // The SplitMix64 finalizer, as HashKeyToBloomHash uses.
+  static constexpr uint64_t Mix(HTKey_t key) {
+    uint64_t x = key + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  static constexpr size_t Group(uint64_t hash) {
+    return static_cast<size_t>(((hash >> 32) * kNumGroups) >> 32);
+  }
+
+  static constexpr size_t SlotFor(uint64_t hash, uint32_t pilot) {
+    uint64_t x = hash ^ (static_cast<uint64_t>(pilot) * 0x9e3779b97f4a7c15ULL);
+
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ULL;
+    x ^= x >> 32;
+    return static_cast<size_t>(((x >> 32) * kNumSlots) >> 32);
+  }
+
+  constexpr size_t Slot(HTKey_t key) const {
+    uint64_t hash = Mix(key);
+    return SlotFor(hash, pilots_[Group(hash)]);
+  }
+
+  static HTValue_t ToHTValue(V value) {
+    if constexpr (std::is_pointer_v<V>) {
+      return const_cast<void *>(static_cast<const void *>(value));
+    } else {
+      static_assert(std::is_integral_v<V> && sizeof(V) <= sizeof(HTValue_t),
+                    "V must be a pointer or an integer to be an HTValue_t");
+      return reinterpret_cast<HTValue_t>(static_cast<uintptr_t>(value));
+    }
+  }
+
+  // Finds every group's pilot, biggest groups first, then fills the slots.
+  constexpr void Build(const StaticEntry<V> (&entries)[N]) {
+    uint64_t hashes[N] = {};
+    size_t group_start[kNumGroups + 1] = {};
+    size_t order[N] = {};  // entry indices, sorted by group
+    size_t fill[kNumGroups] = {};
+    bool taken[kNumSlots] = {};
+    size_t max_size = 0;
+
+    // Counting-sort the entries by group.
+    for (size_t i = 0; i < N; i++) {
+      hashes[i] = Mix(entries[i].key);
+      group_start[Group(hashes[i]) + 1]++;
+    }
+    for (size_t g = 0; g < kNumGroups; g++) {
+      size_t size = group_start[g + 1];
+      max_size = size > max_size ? size : max_size;
+      group_start[g + 1] += group_start[g];
+    }
+    for (size_t i = 0; i < N; i++) {
+      size_t g = Group(hashes[i]);
+      order[group_start[g] + fill[g]++] = i;
+    }
+
+    for (size_t size = max_size; size > 0; size--) {
+      for (size_t g = 0; g < kNumGroups; g++) {
+        if (group_start[g + 1] - group_start[g] == size) {
+          pilots_[g] = FindPilot(entries, hashes, &order[group_start[g]],
+                                 size, taken);
+        }
+      }
+    }
+
+    for (size_t s = 0; s < kNumSlots; s++) {
+      slots_[s] = entries[0];
+    }
+    for (size_t i = 0; i < N; i++) {
+      slots_[SlotFor(hashes[i], pilots_[Group(hashes[i])])] = entries[i];
+    }
+  }
+
+  // Returns the first pilot that sends the size keys at members to
+  // distinct slots not yet taken, and takes them.
+  static constexpr uint32_t FindPilot(const StaticEntry<V> (&entries)[N],
+                                      const uint64_t (&hashes)[N],
+                                      const size_t *members, size_t size,
+                                      bool (&taken)[kNumSlots]) {
+    for (uint32_t pilot = 0; pilot < (1U << 20); pilot++) {
+      bool ok = true;
+
+      for (size_t j = 0; j < size && ok; j++) {
+        size_t s = SlotFor(hashes[members[j]], pilot);
+
+        ok = !taken[s];
+        for (size_t k = 0; k < j && ok; k++) {
+          if (s == SlotFor(hashes[members[k]], pilot)) {
+            // Equal keys collide under every pilot.
+            Verify333(entries[members[j]].key != entries[members[k]].key);
+            ok = false;
+          }
+        }
+      }
+      if (ok) {
+        for (size_t j = 0; j < size; j++) {
+          taken[SlotFor(hashes[members[j]], pilot)] = true;
+        }
+        return pilot;
+      }
+    }
+    Verify333(false);  // no pilot fits this group
+    return 0;
+  }
+
+  uint32_t pilots_[kNumGroups] = {};
+  StaticEntry<V> slots_[kNumSlots] = {};
+};
+
+// Builds a StaticHashTable of the (key, value) pairs in entries; N is
+// deduced from the list.  Declare the result constexpr so that the
+// compiler, not the program, builds it.
+template <typename V, size_t N>
+constexpr StaticHashTable<V, N> MakeStaticHashTable(
+    const StaticEntry<V> (&entries)[N]) {
+  return StaticHashTable<V, N>(entries);
+}
+
+}  // namespace hw1
+
+// Defines "bool name(HTKey_t key, HTKeyValue_t *keyvalue)", a C-callable
+// function that looks key up in the StaticHashTable table with
+// HashTable_Find's contract.
+#define HW1_STATIC_HASHTABLE_FIND_FN(name, table)             \
+  extern "C" bool name(HTKey_t key, HTKeyValue_t *keyvalue) {   \
+    return (table).Find(key, keyvalue);                         \
+  }
+
+#endif  // HW1_STATICHASHTABLE_H_
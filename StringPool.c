@@ -0,0 +1,292 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "HashTable_priv.h"
+#include "LinkedList_priv.h"
+#include "StringPool.h"
+#include "StringPool_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+void SPIdToSlot(StringId id, int *segment, uint32_t *offset) {
+  // Segment s starts at SP_SEGMENT_BASE * (2^s - 1), so s is the position
+  // of the highest set bit of id / SP_SEGMENT_BASE + 1.
+  uint64_t q = (uint64_t) id / SP_SEGMENT_BASE + 1;
+  int s = 63 - __builtin_clzll(q);
+
+  *segment = s;
+  *offset = id - (uint32_t) (SP_SEGMENT_BASE * ((1ULL << s) - 1));
+}
+
+static void SPNoOpFree(HTValue_t value) { }
+
+// Carves size bytes (rounded up to a multiple of 8) out of the shard's
+// arena.  The shard's lock must be held.
+static void *ArenaAlloc(SPShard *shard, size_t size) {
+  SPChunk *chunk = shard->chunks;
+  void *p;
+
+  size = (size + 7) & ~(size_t) 7;
+  if (size > SP_CHUNK_SIZE / 4) {
+    // A big string gets a chunk of its own, filed behind the chunk being
+    // filled so that the rest of that chunk isn't wasted.
+    SPChunk *big = (SPChunk *) malloc(sizeof(SPChunk) + size);
+    Verify333(big != NULL);
+    big->size = big->used = size;
+    shard->arena_bytes += sizeof(SPChunk) + size;
+    if (chunk == NULL) {
+      big->next = NULL;
+      shard->chunks = big;
+    } else {
+      big->next = chunk->next;
+      chunk->next = big;
+    }
+    return big + 1;
+  }
+
+  if (chunk == NULL || chunk->size - chunk->used < size) {
+    chunk = (SPChunk *) malloc(sizeof(SPChunk) + SP_CHUNK_SIZE);
+    Verify333(chunk != NULL);
+    chunk->next = shard->chunks;
+    chunk->size = SP_CHUNK_SIZE;
+    chunk->used = 0;
+    shard->chunks = chunk;
+    shard->arena_bytes += sizeof(SPChunk) + SP_CHUNK_SIZE;
+  }
+  p = (char *) (chunk + 1) + chunk->used;
+  chunk->used += size;
+  return p;
+}
+
+// Finds the record for a string in its shard.  Strings whose FNV hashes
+// collide are stored under hash, hash + 1, hash + 2, ...; *key is set to
+// the first free key of that sequence if the string isn't found.  The
+// shard's lock must be held.
+static SPRecord *FindRecord(SPShard *shard, HTKey_t hash, const void *bytes,
+                            size_t len, HTKey_t *key) {
+  HTKeyValue_t kv;
+
+  for (*key = hash; HashTable_Find(shard->table, *key, &kv); (*key)++) {
+    SPRecord *rec = (SPRecord *) kv.value;
+    if (rec->len == len && memcmp(SPRecord_Bytes(rec), bytes, len) == 0) {
+      return rec;
+    }
+  }
+  return NULL;
+}
+
+// Hashes a string and picks its shard.
+static SPShard *ShardFor(StringPool *pool, const void *bytes, size_t len,
+                         HTKey_t *hash) {
+  Verify333(len < INT_MAX);
+  *hash = FNVHash64((unsigned char *) bytes, (int) len);
+  return &pool->shards[*hash >> (64 - SP_SHARD_BITS)];
+}
+
+// Records rec under its ID so that StringPool_String can find it.
+static void PublishId(StringPool *pool, SPRecord *rec) {
+  SPRecord **seg;
+  int s;
+  uint32_t offset;
+
+  SPIdToSlot(rec->id, &s, &offset);
+  Verify333(s < SP_NUM_SEGMENTS);
+  seg = __atomic_load_n(&pool->segments[s], __ATOMIC_ACQUIRE);
+  if (seg == NULL) {
+    // Another shard may be allocating the same segment; one of us wins.
+    SPRecord **fresh =
+        (SPRecord **) calloc((size_t) SP_SEGMENT_BASE << s, sizeof(SPRecord *));
+    Verify333(fresh != NULL);
+    if (__atomic_compare_exchange_n(&pool->segments[s], &seg, fresh, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      seg = fresh;
+    } else {
+      free(fresh);
+    }
+  }
+  __atomic_store_n(&seg[offset], rec, __ATOMIC_RELEASE);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// StringPool implementation.
+
+StringPool* StringPool_Allocate(void) {
+  StringPool *pool = (StringPool *) malloc(sizeof(StringPool));
+  int i;
+
+  Verify333(pool != NULL);
+  for (i = 0; i < SP_NUM_SHARDS; i++) {
+    SPShard *shard = &pool->shards[i];
+    Verify333(pthread_mutex_init(&shard->lock, NULL) == 0);
+    shard->table = HashTable_Allocate(64);
+    shard->chunks = NULL;
+    shard->num_interns = 0;
+    shard->interned_bytes = 0;
+    shard->string_bytes = 0;
+    shard->arena_bytes = 0;
+  }
+  pool->num_strings = 0;
+  for (i = 0; i < SP_NUM_SEGMENTS; i++) {
+    pool->segments[i] = NULL;
+  }
+  return pool;
+}
+
+void StringPool_Free(StringPool *pool) {
+  int i;
+
+  Verify333(pool != NULL);
+  for (i = 0; i < SP_NUM_SHARDS; i++) {
+    SPShard *shard = &pool->shards[i];
+    SPChunk *chunk = shard->chunks;
+
+    // The records live in the chunks, so the table doesn't free them.
+    HashTable_Free(shard->table, &SPNoOpFree);
+    while (chunk != NULL) {
+      SPChunk *next = chunk->next;
+      free(chunk);
+      chunk = next;
+    }
+    pthread_mutex_destroy(&shard->lock);
+  }
+  for (i = 0; i < SP_NUM_SEGMENTS; i++) {
+    free(pool->segments[i]);
+  }
+  free(pool);
+}
+
+StringId StringPool_Intern(StringPool *pool, const void *bytes, size_t len) {
+  SPShard *shard;
+  SPRecord *rec;
+  HTKey_t hash, key;
+  StringId id;
+
+  Verify333(pool != NULL);
+  shard = ShardFor(pool, bytes, len, &hash);
+
+  pthread_mutex_lock(&shard->lock);
+  shard->num_interns++;
+  shard->interned_bytes += len;
+  rec = FindRecord(shard, hash, bytes, len, &key);
+  if (rec == NULL) {
+    HTKeyValue_t kv, unused;
+
+    // A new string: copy it into the arena, give it the next ID, and
+    // index it by hash and by ID.
+    rec = (SPRecord *) ArenaAlloc(shard, sizeof(SPRecord) + len + 1);
+    rec->len = (uint32_t) len;
+    memcpy(SPRecord_Bytes(rec), bytes, len);
+    SPRecord_Bytes(rec)[len] = '\0';
+    rec->id = __atomic_fetch_add(&pool->num_strings, 1, __ATOMIC_RELAXED);
+    Verify333(rec->id != UINT32_MAX);
+    PublishId(pool, rec);
+
+    kv.key = key;
+    kv.value = rec;
+    HashTable_Insert(shard->table, kv, &unused);
+    shard->string_bytes += len;
+  }
+  id = rec->id;
+  pthread_mutex_unlock(&shard->lock);
+  return id;
+}
+
+bool StringPool_Lookup(StringPool *pool, const void *bytes, size_t len,
+                       StringId *id) {
+  SPShard *shard;
+  SPRecord *rec;
+  HTKey_t hash, key;
+
+  Verify333(pool != NULL);
+  shard = ShardFor(pool, bytes, len, &hash);
+
+  pthread_mutex_lock(&shard->lock);
+  rec = FindRecord(shard, hash, bytes, len, &key);
+  if (rec != NULL) {
+    *id = rec->id;
+  }
+  pthread_mutex_unlock(&shard->lock);
+  return rec != NULL;
+}
+
+const char* StringPool_String(StringPool *pool, StringId id, size_t *len) {
+  SPRecord **seg, *rec;
+  int s;
+  uint32_t offset;
+
+  Verify333(pool != NULL);
+  Verify333(id < __atomic_load_n(&pool->num_strings, __ATOMIC_RELAXED));
+
+  // No lock: the ID map's segments never move, and each entry is written
+  // once, before the ID is returned to anyone.
+  SPIdToSlot(id, &s, &offset);
+  seg = __atomic_load_n(&pool->segments[s], __ATOMIC_ACQUIRE);
+  Verify333(seg != NULL);
+  rec = __atomic_load_n(&seg[offset], __ATOMIC_ACQUIRE);
+  Verify333(rec != NULL);
+
+  if (len != NULL) {
+    *len = rec->len;
+  }
+  return SPRecord_Bytes(rec);
+}
+
+int StringPool_NumStrings(StringPool *pool) {
+  Verify333(pool != NULL);
+  return (int) __atomic_load_n(&pool->num_strings, __ATOMIC_RELAXED);
+}
+
+void StringPool_GetStats(StringPool *pool, StringPoolStats *stats) {
+  int i;
+
+  Verify333(pool != NULL);
+  memset(stats, 0, sizeof(*stats));
+  stats->num_strings = __atomic_load_n(&pool->num_strings, __ATOMIC_RELAXED);
+  stats->index_bytes = sizeof(StringPool);
+
+  for (i = 0; i < SP_NUM_SHARDS; i++) {
+    SPShard *shard = &pool->shards[i];
+    HashTable *table;
+
+    pthread_mutex_lock(&shard->lock);
+    table = shard->table;
+    stats->num_interns += shard->num_interns;
+    stats->interned_bytes += shard->interned_bytes;
+    stats->string_bytes += shard->string_bytes;
+    stats->arena_bytes += shard->arena_bytes;
+    // The table: its record, bucket array and chain headers, and a chain
+    // node plus an HTKeyValue_t per element.
+    stats->index_bytes += sizeof(HashTable) +
+        (uint64_t) table->num_buckets * (sizeof(LinkedList *) +
+                                         sizeof(LinkedList)) +
+        (uint64_t) table->num_elements * (sizeof(LinkedListNode) +
+                                          sizeof(HTKeyValue_t));
+    pthread_mutex_unlock(&shard->lock);
+  }
+
+  for (i = 0; i < SP_NUM_SEGMENTS; i++) {
+    if (__atomic_load_n(&pool->segments[i], __ATOMIC_ACQUIRE) != NULL) {
+      stats->index_bytes += ((uint64_t) SP_SEGMENT_BASE << i) *
+                            sizeof(SPRecord *);
+    }
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_STRINGPOOL_H_
+#define HW1_STRINGPOOL_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for uint32_t, etc.
+
+///////////////////////////////////////////////////////////////////////////////
+// A StringPool interns byte strings: it keeps one copy of each distinct
+// string, and hands out a small integer ID for it.  Interning the same
+// bytes again returns the same ID, so two interned strings are equal
+// exactly when their IDs are, and a program that sees the same tokens over
+// and over stores each one only once.
+//
+// IDs are assigned densely from 0, so they make good array indexes.  Each
+// string's bytes live in the pool until the pool is freed, at an address
+// that never changes; StringPool_String returns that address, which is
+// also unique to the string and can be compared instead of the ID.
+//
+// Lookups hash with FNVHash64 into a HashTable.  The copies are packed
+// into large arena chunks rather than allocated one by one.
+//
+// The pool is split into independently locked shards, picked by the
+// string's hash, so many threads can intern at once.  All functions except
+// StringPool_Allocate and StringPool_Free may be called concurrently.
+typedef struct sp StringPool;
+
+// The ID of an interned string.
+typedef uint32_t StringId;
+
+// Memory use of a pool, as reported by StringPool_GetStats.
+typedef struct {
+  uint64_t num_strings;     // # of distinct strings
+  uint64_t num_interns;     // # of StringPool_Intern calls
+  uint64_t interned_bytes;  // total length passed to StringPool_Intern: the
+                            // bytes needed to keep every copy separately
+  uint64_t string_bytes;    // total length of the distinct strings
+  uint64_t arena_bytes;     // bytes allocated for the arena chunks
+  uint64_t index_bytes;     // bytes used by the lookup tables and ID maps
+} StringPoolStats;
+
+// Allocate and return a new, empty StringPool.
+StringPool* StringPool_Allocate(void);
+
+// Free a StringPool and every string in it.  No other thread may be using
+// it.
+//
+// Arguments:
+// - pool: the pool to free.  It is unsafe to use pool, or any pointer
+//   returned by StringPool_String, after this function returns.
+void StringPool_Free(StringPool *pool);
+
+// Intern a byte string.
+//
+// Arguments:
+// - pool: the pool to intern into.
+// - bytes: a pointer to the len bytes of the string; the pool keeps its
+//   own copy if the string is new.
+// - len: the length of the string; less than 2 GB.
+//
+// Returns:
+// - the string's ID.
+StringId StringPool_Intern(StringPool *pool, const void *bytes, size_t len);
+
+// Look up a byte string without interning it.
+//
+// Arguments:
+// - pool: the pool to look in.
+// - bytes, len: the string to look up.
+// - id: if the string has been interned, its ID is returned through this
+//   return parameter.
+//
+// Returns:
+// - true if the string was found, false otherwise.
+bool StringPool_Lookup(StringPool *pool, const void *bytes, size_t len,
+                       StringId *id);
+
+// Return an interned string.
+//
+// Arguments:
+// - pool: the pool that returned the ID.
+// - id: an ID returned by StringPool_Intern or StringPool_Lookup on this
+//   pool.  Like any other data, an ID passed to another thread must be
+//   passed with proper synchronization.
+// - len: if non-NULL, the string's length is returned through this
+//   return parameter.
+//
+// Returns:
+// - a pointer to the pool's copy of the string, followed by a '\0' (which
+//   is not counted in the length).  It stays valid until the pool is
+//   freed, and no other string has the same pointer.
+const char* StringPool_String(StringPool *pool, StringId id, size_t *len);
+
+// Figure out the number of distinct strings in the pool.
+//
+// Arguments:
+// - pool: the pool to query.
+//
+// Returns:
+// - the number of strings (>=0).  The IDs handed out so far are 0 up to
+//   one less than this number.
+int StringPool_NumStrings(StringPool *pool);
+
+// Report the pool's memory use.
+//
+// Arguments:
+// - pool: the pool to query.
+// - stats: a return parameter through which the statistics are returned.
+//   They are a snapshot; other threads may be changing them.
+void StringPool_GetStats(StringPool *pool, StringPoolStats *stats);
+
+#endif  // HW1_STRINGPOOL_H_
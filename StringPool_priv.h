@@ -0,0 +1,84 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_STRINGPOOL_PRIV_H_
+#define HW1_STRINGPOOL_PRIV_H_
+
+#include <pthread.h>  // for pthread_mutex_t
+#include <stdint.h>   // for uint32_t, etc.
+
+#include "./HashTable.h"
+#include "./StringPool.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our StringPool
+// implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// The number of shards; a power of two.  The top bits of a string's hash
+// pick its shard.
+#define SP_NUM_SHARDS 16
+#define SP_SHARD_BITS 4
+
+// Arena chunks are this big, except that a string too big to share a chunk
+// gets a chunk of its own.
+#define SP_CHUNK_SIZE (64 * 1024)
+
+// The ID map is split into segments that never move once allocated:
+// segment s holds IDs [SP_SEGMENT_BASE * (2^s - 1),
+// SP_SEGMENT_BASE * (2^(s+1) - 1)).
+#define SP_SEGMENT_BASE 256
+#define SP_NUM_SEGMENTS 25
+
+// An interned string, as stored in the arena.  The len bytes of the string
+// and a '\0' follow the struct; SPRecord_Bytes finds them.
+typedef struct {
+  uint32_t len;
+  StringId id;
+} SPRecord;
+
+#define SPRecord_Bytes(rec) ((char *) ((rec) + 1))
+
+// A chunk of arena memory.  Records are packed after the header, aligned
+// to 8 bytes.
+typedef struct sp_chunk {
+  struct sp_chunk *next;  // the previously filled chunk, or NULL
+  size_t           size;  // bytes available after the header
+  size_t           used;  // bytes handed out so far
+} SPChunk;
+
+// One shard: a lookup table from hash to record, and the arena the
+// records live in.  Everything in the shard is protected by its lock.
+typedef struct {
+  pthread_mutex_t lock;
+  HashTable      *table;      // FNVHash64 (+ probe offset) -> SPRecord*
+  SPChunk        *chunks;     // the chunk being filled, then older ones
+  uint64_t        num_interns;
+  uint64_t        interned_bytes;
+  uint64_t        string_bytes;
+  uint64_t        arena_bytes;
+} SPShard;
+
+// The pool.
+typedef struct sp {
+  SPShard    shards[SP_NUM_SHARDS];
+  uint32_t   num_strings;     // the next ID to hand out
+  SPRecord **segments[SP_NUM_SEGMENTS];  // the ID map; NULL until needed
+} StringPool;
+
+// Finds the ID map slot for an ID: segment *segment, index *offset.
+void SPIdToSlot(StringId id, int *segment, uint32_t *offset);
+
+#endif  // HW1_STRINGPOOL_PRIV_H_
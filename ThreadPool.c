@@ -0,0 +1,366 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // for sysconf and clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CSE333.h"
+#include "ThreadPool.h"
+#include "ThreadPool_priv.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Internal helper functions.
+
+// The worker that the calling thread is, or NULL for non-pool threads.
+static _Thread_local Worker *current_worker = NULL;
+
+// The shared pool returned by ThreadPool_Default.
+static ThreadPool     *default_pool = NULL;
+static pthread_once_t  default_pool_once = PTHREAD_ONCE_INIT;
+
+#define INITIAL_DEQUE_CAPACITY 64
+
+static void DequeInit(TaskDeque *dq) {
+  Verify333(pthread_mutex_init(&dq->lock, NULL) == 0);
+  dq->capacity = INITIAL_DEQUE_CAPACITY;
+  dq->tasks = (Task *) malloc(dq->capacity * sizeof(Task));
+  Verify333(dq->tasks != NULL);
+  dq->top = dq->bottom = 0;
+}
+
+static void DequeDestroy(TaskDeque *dq) {
+  pthread_mutex_destroy(&dq->lock);
+  free(dq->tasks);
+}
+
+// Lock-free peek used to skip empty deques without taking their locks.
+static bool DequeLooksEmpty(TaskDeque *dq) {
+  return __atomic_load_n(&dq->top, __ATOMIC_RELAXED) ==
+      __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED);
+}
+
+static void DequePush(TaskDeque *dq, Task task) {
+  pthread_mutex_lock(&dq->lock);
+  if (dq->bottom - dq->top == (uint64_t) dq->capacity) {
+    // Full: double the ring, keeping each task at its index modulo the
+    // new capacity.
+    int new_capacity = dq->capacity * 2;
+    Task *bigger = (Task *) malloc(new_capacity * sizeof(Task));
+    uint64_t i;
+
+    Verify333(bigger != NULL);
+    for (i = dq->top; i < dq->bottom; i++) {
+      bigger[i & (new_capacity - 1)] = dq->tasks[i & (dq->capacity - 1)];
+    }
+    free(dq->tasks);
+    dq->tasks = bigger;
+    dq->capacity = new_capacity;
+  }
+  dq->tasks[dq->bottom & (dq->capacity - 1)] = task;
+  __atomic_store_n(&dq->bottom, dq->bottom + 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&dq->lock);
+}
+
+// Take the newest task (owner end).
+static bool DequePop(TaskDeque *dq, Task *task) {
+  bool found = false;
+
+  pthread_mutex_lock(&dq->lock);
+  if (dq->bottom != dq->top) {
+    __atomic_store_n(&dq->bottom, dq->bottom - 1, __ATOMIC_RELAXED);
+    *task = dq->tasks[dq->bottom & (dq->capacity - 1)];
+    found = true;
+  }
+  pthread_mutex_unlock(&dq->lock);
+  return found;
+}
+
+// Take the oldest task (thief end).
+static bool DequeSteal(TaskDeque *dq, Task *task) {
+  bool found = false;
+
+  if (DequeLooksEmpty(dq)) {
+    return false;
+  }
+  pthread_mutex_lock(&dq->lock);
+  if (dq->bottom != dq->top) {
+    *task = dq->tasks[dq->top & (dq->capacity - 1)];
+    __atomic_store_n(&dq->top, dq->top + 1, __ATOMIC_RELAXED);
+    found = true;
+  }
+  pthread_mutex_unlock(&dq->lock);
+  return found;
+}
+
+// Find a task for the calling thread: first from its own deque if it is
+// one of pool's workers, then by stealing from the others.
+static bool FindTask(ThreadPool *pool, Task *task) {
+  Worker *self = current_worker;
+  int start, i;
+
+  if (self != NULL && self->pool != pool) {
+    self = NULL;  // a worker of some other pool; treat as an outsider
+  }
+  if (self != NULL && DequePop(&self->deque, task)) {
+    __atomic_fetch_sub(&pool->pending, 1, __ATOMIC_RELAXED);
+    return true;
+  }
+
+  // Start stealing just past ourselves so that thieves spread out.
+  start = (self != NULL) ? self->index + 1 :
+      __atomic_load_n(&pool->next_victim, __ATOMIC_RELAXED);
+  for (i = 0; i < pool->num_workers; i++) {
+    Worker *victim = &pool->workers[(start + i) % pool->num_workers];
+    if (victim != self && DequeSteal(&victim->deque, task)) {
+      __atomic_fetch_sub(&pool->pending, 1, __ATOMIC_RELAXED);
+      if (self != NULL) {
+        __atomic_fetch_add(&self->tasks_stolen, 1, __ATOMIC_RELAXED);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// Run a task and mark it finished in its group.
+static void RunTask(Task task) {
+  TaskGroup *group = task.group;
+
+  task.fn(task.arg);
+
+  // "finishing" tells TaskGroup_Wait that we may still touch the group
+  // after the count reaches zero, so it doesn't return (and let the
+  // caller free the group) until we're done.
+  __atomic_fetch_add(&group->finishing, 1, __ATOMIC_ACQ_REL);
+  if (__atomic_fetch_sub(&group->outstanding, 1, __ATOMIC_ACQ_REL) == 1) {
+    pthread_mutex_lock(&group->lock);
+    pthread_cond_broadcast(&group->done);
+    pthread_mutex_unlock(&group->lock);
+  }
+  __atomic_fetch_sub(&group->finishing, 1, __ATOMIC_RELEASE);
+}
+
+static void *WorkerMain(void *arg) {
+  Worker *self = (Worker *) arg;
+  ThreadPool *pool = self->pool;
+  Task task;
+
+  current_worker = self;
+  while (true) {
+    if (FindTask(pool, &task)) {
+      // Count the task before running it: once a waiter sees the task
+      // finished, it sees the count too.
+      __atomic_fetch_add(&self->tasks_run, 1, __ATOMIC_RELAXED);
+      RunTask(task);
+      continue;
+    }
+
+    // Nothing to do.  Announce that we're going to sleep, then re-check
+    // under the lock; a submitter that missed our announcement is ordered
+    // before it, so we'll see its task in "pending".
+    pthread_mutex_lock(&pool->lock);
+    __atomic_fetch_add(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&pool->pending, __ATOMIC_SEQ_CST) == 0 &&
+           !pool->shutdown) {
+      pthread_cond_wait(&pool->work_available, &pool->lock);
+    }
+    __atomic_fetch_sub(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+    if (pool->shutdown &&
+        __atomic_load_n(&pool->pending, __ATOMIC_SEQ_CST) == 0) {
+      pthread_mutex_unlock(&pool->lock);
+      break;
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+  current_worker = NULL;
+  return NULL;
+}
+
+static void InitDefaultPool(void) {
+  int64_t num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  default_pool = ThreadPool_Allocate(num_cpus > 0 ? (int) num_cpus : 1);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ThreadPool implementation.
+
+ThreadPool* ThreadPool_Allocate(int num_workers) {
+  ThreadPool *pool;
+  int i;
+
+  Verify333(num_workers > 0);
+
+  pool = (ThreadPool *) malloc(sizeof(ThreadPool));
+  Verify333(pool != NULL);
+  pool->num_workers = num_workers;
+  pool->pending = 0;
+  pool->sleepers = 0;
+  pool->next_victim = 0;
+  pool->shutdown = false;
+  Verify333(pthread_mutex_init(&pool->lock, NULL) == 0);
+  Verify333(pthread_cond_init(&pool->work_available, NULL) == 0);
+
+  pool->workers = (Worker *) malloc(num_workers * sizeof(Worker));
+  Verify333(pool->workers != NULL);
+  for (i = 0; i < num_workers; i++) {
+    Worker *w = &pool->workers[i];
+    w->pool = pool;
+    w->index = i;
+    w->tasks_run = 0;
+    w->tasks_stolen = 0;
+    DequeInit(&w->deque);
+  }
+  // Start the threads only once every deque exists; they steal from each
+  // other right away.
+  for (i = 0; i < num_workers; i++) {
+    Verify333(pthread_create(&pool->workers[i].thread, NULL, &WorkerMain,
+                             &pool->workers[i]) == 0);
+  }
+  return pool;
+}
+
+void ThreadPool_Free(ThreadPool *pool) {
+  int i;
+
+  Verify333(pool != NULL);
+  Verify333(pool != default_pool);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = true;
+  pthread_cond_broadcast(&pool->work_available);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (i = 0; i < pool->num_workers; i++) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  for (i = 0; i < pool->num_workers; i++) {
+    DequeDestroy(&pool->workers[i].deque);
+  }
+  free(pool->workers);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work_available);
+  free(pool);
+}
+
+ThreadPool* ThreadPool_Default(void) {
+  pthread_once(&default_pool_once, &InitDefaultPool);
+  return default_pool;
+}
+
+int ThreadPool_NumWorkers(ThreadPool *pool) {
+  Verify333(pool != NULL);
+  return pool->num_workers;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TaskGroup implementation.
+
+TaskGroup* TaskGroup_Allocate(ThreadPool *pool) {
+  TaskGroup *group;
+
+  Verify333(pool != NULL);
+
+  group = (TaskGroup *) malloc(sizeof(TaskGroup));
+  Verify333(group != NULL);
+  group->pool = pool;
+  group->outstanding = 0;
+  group->finishing = 0;
+  Verify333(pthread_mutex_init(&group->lock, NULL) == 0);
+  Verify333(pthread_cond_init(&group->done, NULL) == 0);
+  return group;
+}
+
+void TaskGroup_Submit(TaskGroup *group, TaskFnPtr fn, void *arg) {
+  ThreadPool *pool;
+  Worker *target;
+  Task task;
+
+  Verify333(group != NULL);
+  Verify333(fn != NULL);
+  pool = group->pool;
+
+  task.fn = fn;
+  task.arg = arg;
+  task.group = group;
+  __atomic_fetch_add(&group->outstanding, 1, __ATOMIC_RELAXED);
+
+  // Workers keep their own tasks local; everyone else deals round-robin.
+  if (current_worker != NULL && current_worker->pool == pool) {
+    target = current_worker;
+  } else {
+    int next = __atomic_fetch_add(&pool->next_victim, 1, __ATOMIC_RELAXED);
+    target = &pool->workers[(unsigned) next % pool->num_workers];
+  }
+  DequePush(&target->deque, task);
+
+  // Count the task, then wake a sleeper if there is one (see WorkerMain).
+  __atomic_fetch_add(&pool->pending, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&pool->sleepers, __ATOMIC_SEQ_CST) > 0) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+void TaskGroup_Wait(TaskGroup *group) {
+  Task task;
+
+  Verify333(group != NULL);
+
+  while (__atomic_load_n(&group->outstanding, __ATOMIC_ACQUIRE) > 0) {
+    struct timespec deadline;
+
+    // Help out rather than block.  The task may belong to any group.
+    if (FindTask(group->pool, &task)) {
+      RunTask(task);
+      continue;
+    }
+
+    // Our remaining tasks are running elsewhere.  Sleep until the last one
+    // finishes; the timeout covers new tasks appearing (e.g., from nested
+    // submits) that we could help with in the meantime.
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 1000000;  // 1 ms
+    if (deadline.tv_nsec >= 1000000000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&group->lock);
+    if (__atomic_load_n(&group->outstanding, __ATOMIC_ACQUIRE) > 0) {
+      pthread_cond_timedwait(&group->done, &group->lock, &deadline);
+    }
+    pthread_mutex_unlock(&group->lock);
+  }
+
+  // The last task to finish may still be signalling us.
+  while (__atomic_load_n(&group->finishing, __ATOMIC_ACQUIRE) > 0) {
+    sched_yield();
+  }
+}
+
+void TaskGroup_Free(TaskGroup *group) {
+  Verify333(group != NULL);
+  Verify333(__atomic_load_n(&group->outstanding, __ATOMIC_ACQUIRE) == 0);
+  pthread_mutex_destroy(&group->lock);
+  pthread_cond_destroy(&group->done);
+  free(group);
+}
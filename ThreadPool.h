@@ -0,0 +1,109 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_THREADPOOL_H_
+#define HW1_THREADPOOL_H_
+
+#include <stdbool.h>    // for bool type (true, false)
+
+///////////////////////////////////////////////////////////////////////////////
+// A ThreadPool is a fixed set of worker threads that run tasks.
+//
+// The library's parallel operations (HashTable_BuildFromArray,
+// HashTable_ForEachParallel, ...) run on a shared pool instead of creating
+// threads on every call; customers can submit their own work to the same
+// pool, or allocate a private one.
+//
+// Each worker has its own deque of tasks.  A worker pushes the tasks it
+// submits onto the bottom of its own deque and pops from the bottom, so
+// related work stays on one core; an idle worker steals from the top of
+// another worker's deque, so uneven work spreads itself out.
+//
+// Tasks are grouped with a TaskGroup: submit any number of tasks to a group,
+// then wait for all of them to finish.  A thread that waits on a group helps
+// run pending tasks instead of just sleeping, so tasks may themselves
+// submit to and wait on nested groups.
+typedef struct tp ThreadPool;
+typedef struct tp_group TaskGroup;
+
+// The function a task runs.
+//
+// Arguments:
+// - arg: the argument passed to TaskGroup_Submit.
+typedef void(*TaskFnPtr)(void *arg);
+
+// Allocate a pool and start its workers.
+//
+// Arguments:
+// - num_workers: the number of worker threads; MUST be greater than zero.
+//
+// Returns a pointer to the newly allocated ThreadPool.
+ThreadPool* ThreadPool_Allocate(int num_workers);
+
+// Stop the pool's workers and free the pool.  Every TaskGroup on the pool
+// must have been waited on and freed first.
+//
+// Arguments:
+// - pool: the pool to free.  It is unsafe to use pool after this
+//   function returns.  Must not be the pool returned by
+//   ThreadPool_Default.
+void ThreadPool_Free(ThreadPool *pool);
+
+// Return the library's shared pool, starting it on first use with one
+// worker per online CPU.  The shared pool lives until the program exits.
+//
+// Returns:
+// - the shared pool (never NULL).
+ThreadPool* ThreadPool_Default(void);
+
+// Figure out the number of worker threads in a pool.
+//
+// Arguments:
+// - pool: the pool to query.
+//
+// Returns:
+// - the number of workers (>0).
+int ThreadPool_NumWorkers(ThreadPool *pool);
+
+// Allocate a new, empty task group on a pool.
+//
+// Arguments:
+// - pool: the pool that will run the group's tasks.
+//
+// Returns a pointer to the newly allocated TaskGroup.
+TaskGroup* TaskGroup_Allocate(ThreadPool *pool);
+
+// Submit a task to a group.  The task may start running before this
+// function returns.  Safe to call from any thread, including from inside
+// another task.
+//
+// Arguments:
+// - group: the group the task belongs to.
+// - fn: the function to run.
+// - arg: passed to fn.
+void TaskGroup_Submit(TaskGroup *group, TaskFnPtr fn, void *arg);
+
+// Wait until every task submitted to the group so far has finished,
+// running pending tasks on the calling thread in the meantime.  The group
+// may be reused afterward.
+//
+// Arguments:
+// - group: the group to wait for.
+void TaskGroup_Wait(TaskGroup *group);
+
+// Free a task group.  It must have no unfinished tasks.
+//
+// Arguments:
+// - group: the group to free.  It is unsafe to use group after this
+//   function returns.
+void TaskGroup_Free(TaskGroup *group);
+
+#endif  // HW1_THREADPOOL_H_
@@ -0,0 +1,80 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_THREADPOOL_PRIV_H_
+#define HW1_THREADPOOL_PRIV_H_
+
+#include <pthread.h>  // for pthread_t, pthread_mutex_t, etc.
+#include <stdint.h>   // for uint64_t
+
+#include "./ThreadPool.h"
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+// Internal structures and helper functions for our ThreadPool
+// implementation.
+//
+// These are broken out into a "private .h" so that our unittests can peek
+// inside the implementation.  Customers should not include this file or
+// assume anything based on its contents.
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+// A unit of work.
+typedef struct {
+  TaskFnPtr  fn;
+  void      *arg;
+  TaskGroup *group;   // decremented when the task finishes
+} Task;
+
+// A worker's deque: a growable ring buffer of tasks.  The owner pushes and
+// pops at the bottom; thieves take from the top.  A short critical section
+// under a per-deque lock keeps it simple; the owner rarely contends with a
+// thief because they work at opposite ends of a usually-long deque.
+typedef struct {
+  pthread_mutex_t lock;
+  Task           *tasks;
+  int             capacity;  // a power of two
+  uint64_t        top;       // index of the oldest task
+  uint64_t        bottom;    // one past the newest task
+} TaskDeque;
+
+// One worker thread and its deque.
+typedef struct {
+  ThreadPool *pool;
+  int         index;         // position in pool->workers
+  pthread_t   thread;
+  TaskDeque   deque;
+  uint64_t    tasks_run;     // # tasks this worker has run (updated
+                             // atomically, before running the task)
+  uint64_t    tasks_stolen;  // # of those it stole from another worker
+} Worker;
+
+// The pool.
+typedef struct tp {
+  int             num_workers;
+  Worker         *workers;
+  int             pending;      // # of tasks sitting in deques
+  int             sleepers;     // # of workers about to sleep or asleep
+  int             next_victim;  // round-robin target for outside submits
+  bool            shutdown;     // set by ThreadPool_Free
+  pthread_mutex_t lock;         // protects sleeping only
+  pthread_cond_t  work_available;
+} ThreadPool;
+
+// A group of tasks that can be waited on together.
+typedef struct tp_group {
+  ThreadPool     *pool;
+  int             outstanding;  // # submitted tasks that haven't finished
+  int             finishing;    // # of tasks still signalling completion
+  pthread_mutex_t lock;
+  pthread_cond_t  done;         // signalled when outstanding reaches 0
+} TaskGroup;
+
+#endif  // HW1_THREADPOOL_PRIV_H_
@@ -0,0 +1,128 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "AggregateTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Counter bumps per second from 1..max_threads threads over a fixed key set:
+//   - "locked": one mutex around HashTable_Find, and on a miss a malloc'd
+//     counter plus HashTable_Insert
+//   - "atomic": AggregateTable_AddU64
+//
+// Usage: bench_aggregate [max_threads=4] [num_keys=10000]
+//                        [bumps_per_thread=1000000]
+
+typedef struct {
+  bool             atomic;
+  HashTable       *ht;
+  pthread_mutex_t *lock;
+  AggregateTable  *agg;
+  int              num_keys;
+  int              bumps;
+  uint64_t         seed;
+} BumpTask;
+
+static void *Bump(void *arg) {
+  BumpTask *task = (BumpTask *) arg;
+  int i;
+
+  for (i = 0; i < task->bumps; i++) {
+    HTKey_t key = Bench_Rand(&task->seed) % task->num_keys;
+
+    if (task->atomic) {
+      Verify333(AggregateTable_AddU64(task->agg, key, 1));
+    } else {
+      HTKeyValue_t kv, old;
+
+      pthread_mutex_lock(task->lock);
+      if (HashTable_Find(task->ht, key, &kv)) {
+        (*(uint64_t *) kv.value)++;
+      } else {
+        uint64_t *counter = (uint64_t *) malloc(sizeof(uint64_t));
+        Verify333(counter != NULL);
+        *counter = 1;
+        kv.key = key;
+        kv.value = counter;
+        HashTable_Insert(task->ht, kv, &old);
+      }
+      pthread_mutex_unlock(task->lock);
+    }
+  }
+  return NULL;
+}
+
+static void FreeCounter(HTValue_t value) {
+  free(value);
+}
+
+// Returns million bumps per second.
+static double RunOnce(bool atomic, int threads, int num_keys, int bumps) {
+  pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  HashTable *ht = HashTable_Allocate(16);
+  AggregateTable *agg = AggregateTable_Allocate(num_keys);
+  pthread_t *tids;
+  BumpTask *tasks;
+  double start, elapsed;
+  int t;
+
+  tids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+  tasks = (BumpTask *) malloc(threads * sizeof(BumpTask));
+  Verify333(tids != NULL && tasks != NULL);
+
+  start = Bench_Now();
+  for (t = 0; t < threads; t++) {
+    tasks[t].atomic = atomic;
+    tasks[t].ht = ht;
+    tasks[t].lock = &lock;
+    tasks[t].agg = agg;
+    tasks[t].num_keys = num_keys;
+    tasks[t].bumps = bumps;
+    tasks[t].seed = t + 1;
+    Verify333(pthread_create(&tids[t], NULL, &Bump, &tasks[t]) == 0);
+  }
+  for (t = 0; t < threads; t++) {
+    pthread_join(tids[t], NULL);
+  }
+  elapsed = Bench_Now() - start;
+
+  HashTable_Free(ht, &FreeCounter);
+  AggregateTable_Free(agg);
+  free(tids);
+  free(tasks);
+  return (double) threads * bumps / elapsed / 1e6;
+}
+
+int main(int argc, char **argv) {
+  int max_threads = Bench_IntArg(argc, argv, 1, 4);
+  int num_keys = Bench_IntArg(argc, argv, 2, 10000);
+  int bumps = Bench_IntArg(argc, argv, 3, 1000000);
+  int t;
+
+  printf("%d keys, %d bumps per thread\n", num_keys, bumps);
+  printf("%-8s %16s %16s %8s\n",
+         "threads", "locked Mbumps/s", "atomic Mbumps/s", "speedup");
+  for (t = 1; t <= max_threads; t++) {
+    double locked = RunOnce(false, t, num_keys, bumps);
+    double atomic = RunOnce(true, t, num_keys, bumps);
+    printf("%-8d %16.2f %16.2f %7.2fx\n", t, locked, atomic, atomic / locked);
+  }
+  return EXIT_SUCCESS;
+}
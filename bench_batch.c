@@ -0,0 +1,98 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "Hash.h"
+#include "Hash_priv.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Keys per second for hashing many short keys with FNVHash64: one call
+// per key, against FNVHash64_Batch and each of its implementations.
+//
+// Usage: bench_batch [num_keys=1000000] [key_len=16] [len_jitter=0]
+//
+// Each key is key_len bytes long, plus a random 0..len_jitter more.
+
+typedef void (*BatchFnPtr)(unsigned char **, const int *, HTKey_t *, int);
+
+static double TimeBatch(BatchFnPtr fn, unsigned char **buffers, int *lens,
+                        HTKey_t *out, int num_keys) {
+  double start = Bench_Now();
+  fn(buffers, lens, out, num_keys);
+  return Bench_Now() - start;
+}
+
+int main(int argc, char **argv) {
+  int num_keys = Bench_IntArg(argc, argv, 1, 1000000);
+  int key_len = Bench_IntArg(argc, argv, 2, 16);
+  int len_jitter = Bench_IntArg(argc, argv, 3, 0);
+  int stride = key_len + len_jitter;
+  unsigned char *data, **buffers;
+  int *lens;
+  HTKey_t *expected, *out;
+  uint64_t state = 1;
+  double start, secs;
+  int i, j;
+
+  data = (unsigned char *) malloc((size_t) num_keys * stride + 1);
+  buffers = (unsigned char **) malloc(num_keys * sizeof(unsigned char *));
+  lens = (int *) malloc(num_keys * sizeof(int));
+  expected = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  out = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  Verify333(data != NULL && buffers != NULL && lens != NULL);
+  Verify333(expected != NULL && out != NULL);
+  for (i = 0; i < num_keys; i++) {
+    buffers[i] = data + (size_t) i * stride;
+    lens[i] = key_len + (len_jitter ? Bench_Rand(&state) % (len_jitter + 1)
+                                    : 0);
+    for (j = 0; j < lens[i]; j++) {
+      buffers[i][j] = (unsigned char) Bench_Rand(&state);
+    }
+  }
+
+  printf("%d keys of %d..%d bytes\n", num_keys, key_len, stride);
+  start = Bench_Now();
+  for (i = 0; i < num_keys; i++) {
+    expected[i] = FNVHash64(buffers[i], lens[i]);
+  }
+  secs = Bench_Now() - start;
+  printf("  FNVHash64 loop:   %7.1f Mkeys/s\n", num_keys / secs / 1e6);
+
+  secs = TimeBatch(&FNVBatchScalar, buffers, lens, out, num_keys);
+  printf("  batch, scalar:    %7.1f Mkeys/s\n", num_keys / secs / 1e6);
+  if (FNVBatchHaveSSE2()) {
+    secs = TimeBatch(&FNVBatchSSE2, buffers, lens, out, num_keys);
+    printf("  batch, SSE2:      %7.1f Mkeys/s\n", num_keys / secs / 1e6);
+  }
+  if (FNVBatchHaveAVX2()) {
+    secs = TimeBatch(&FNVBatchAVX2, buffers, lens, out, num_keys);
+    printf("  batch, AVX2:      %7.1f Mkeys/s\n", num_keys / secs / 1e6);
+  }
+  secs = TimeBatch(&FNVHash64_Batch, buffers, lens, out, num_keys);
+  printf("  FNVHash64_Batch:  %7.1f Mkeys/s\n", num_keys / secs / 1e6);
+  for (i = 0; i < num_keys; i++) {
+    Verify333(out[i] == expected[i]);
+  }
+
+  free(data);
+  free(buffers);
+  free(lens);
+  free(expected);
+  free(out);
+  return EXIT_SUCCESS;
+}
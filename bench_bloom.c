@@ -0,0 +1,115 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Miss-heavy lookups with and without a Bloom filter in front of the
+// table (HashTable_EnableBloomFilter), at several false-positive rates.
+//
+// The table holds num_keys random keys at a load factor of about 3, so a
+// miss walks a three-node chain; the lookups are a mix of fresh random
+// keys (misses) and present keys, in random order.  Both a HashTable_Find loop
+// and HashTable_FindBatch are timed.
+//
+// Usage: bench_bloom [num_keys=4000000] [num_lookups=2000000]
+
+static void NoOpFree(HTValue_t value) { }
+
+// Puts a filter with the given rate (0 for none) on the table and times
+// looking up the keys.
+static void Run(HashTable *ht, HTKey_t *keys, int num_lookups,
+                HTKeyValue_t *results, bool *found, double fp_rate) {
+  double start, find_secs, batch_secs;
+  uint64_t hits = 0;
+  HTKeyValue_t kv;
+  int i;
+
+  HashTable_EnableBloomFilter(ht, fp_rate);
+
+  start = Bench_Now();
+  for (i = 0; i < num_lookups; i++) {
+    hits += HashTable_Find(ht, keys[i], &kv);
+  }
+  find_secs = Bench_Now() - start;
+
+  start = Bench_Now();
+  for (i = 0; i < num_lookups; i += 256) {
+    int n = (num_lookups - i < 256) ? num_lookups - i : 256;
+    hits += HashTable_FindBatch(ht, keys + i, n, results + i, found + i);
+  }
+  batch_secs = Bench_Now() - start;
+  Bench_Consume(hits);
+
+  if (fp_rate == 0) {
+    printf("    no filter   ");
+  } else {
+    printf("    fp %-8g", fp_rate);
+  }
+  printf("Find %6.1f ns/lookup   FindBatch %6.1f ns/lookup\n",
+         find_secs / num_lookups * 1e9, batch_secs / num_lookups * 1e9);
+}
+
+int main(int argc, char **argv) {
+  static const double kRates[] = {0, 0.1, 0.01, 0.001};
+  static const int kMissPcts[] = {90, 99};
+  int num_keys = Bench_IntArg(argc, argv, 1, 4000000);
+  int num_lookups = Bench_IntArg(argc, argv, 2, 2000000);
+  HashTable *ht = HashTable_Allocate(num_keys / 3 + 1);
+  HTKey_t *present = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  HTKey_t *keys = (HTKey_t *) malloc(num_lookups * sizeof(HTKey_t));
+  HTKeyValue_t *results =
+      (HTKeyValue_t *) malloc(num_lookups * sizeof(HTKeyValue_t));
+  bool *found = (bool *) malloc(num_lookups * sizeof(bool));
+  HTKeyValue_t kv, old;
+  uint64_t state = 1;
+  int i, m, r;
+
+  Verify333(present != NULL && keys != NULL && results != NULL &&
+            found != NULL);
+  for (i = 0; i < num_keys; i++) {
+    present[i] = kv.key = Bench_Rand(&state);
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  printf("%d keys, %d buckets, %d lookups\n", HashTable_NumElements(ht),
+         HashTable_NumBuckets(ht), num_lookups);
+
+  for (m = 0; m < (int) (sizeof(kMissPcts) / sizeof(kMissPcts[0])); m++) {
+    printf("  %d%% misses\n", kMissPcts[m]);
+    for (i = 0; i < num_lookups; i++) {
+      if ((int) (Bench_Rand(&state) % 100) < kMissPcts[m]) {
+        keys[i] = Bench_Rand(&state);
+      } else {
+        keys[i] = present[Bench_Rand(&state) % num_keys];
+      }
+    }
+    for (r = 0; r < (int) (sizeof(kRates) / sizeof(kRates[0])); r++) {
+      Run(ht, keys, num_lookups, results, found, kRates[r]);
+    }
+  }
+
+  HashTable_Free(ht, &NoOpFree);
+  free(present);
+  free(keys);
+  free(results);
+  free(found);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Time to load N random (key,value) pairs into a HashTable:
+//   - "insert": HashTable_Allocate(1) followed by N HashTable_Insert calls,
+//     resizing along the way
+//   - "build":  HashTable_BuildFromArray with 1..max_threads threads
+//
+// Usage: bench_build [num_pairs=2000000] [max_threads=4]
+
+static void NoOpFree(HTValue_t value) { }
+
+int main(int argc, char **argv) {
+  int n = Bench_IntArg(argc, argv, 1, 2000000);
+  int max_threads = Bench_IntArg(argc, argv, 2, 4);
+  HTKeyValue_t *kvs, old;
+  HashTable *ht;
+  uint64_t seed = 42;
+  double start, insert_secs, secs;
+  int i, t;
+
+  kvs = (HTKeyValue_t *) malloc(n * sizeof(HTKeyValue_t));
+  Verify333(kvs != NULL);
+  for (i = 0; i < n; i++) {
+    kvs[i].key = Bench_Rand(&seed);
+    kvs[i].value = (HTValue_t) (uintptr_t) i;
+  }
+
+  start = Bench_Now();
+  ht = HashTable_Allocate(1);
+  for (i = 0; i < n; i++) {
+    HashTable_Insert(ht, kvs[i], &old);
+  }
+  insert_secs = Bench_Now() - start;
+  Bench_Consume(HashTable_NumElements(ht));
+  HashTable_Free(ht, &NoOpFree);
+
+  printf("%d pairs\n", n);
+  printf("%-16s %10s %10s\n", "method", "seconds", "speedup");
+  printf("%-16s %10.3f %9.2fx\n", "insert loop", insert_secs, 1.0);
+  for (t = 1; t <= max_threads; t++) {
+    char label[32];
+
+    start = Bench_Now();
+    ht = HashTable_BuildFromArray(kvs, n, t, &NoOpFree);
+    secs = Bench_Now() - start;
+    Verify333(HashTable_NumElements(ht) <= n);
+    HashTable_Free(ht, &NoOpFree);
+
+    snprintf(label, sizeof(label), "build %d thr", t);
+    printf("%-16s %10.3f %9.2fx\n", label, secs, insert_secs / secs);
+  }
+
+  free(kvs);
+  return EXIT_SUCCESS;
+}
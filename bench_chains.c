@@ -0,0 +1,88 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Cost of a HashTable_Find hit and miss as the chains get longer.
+//
+// For each load factor the table holds num_keys random keys in
+// num_keys / load_factor buckets (3 is as long as the chains get before
+// the table resizes), and is looked up with random present keys, then
+// with random missing keys, one HashTable_Find at a time.  The default
+// 4M keys make a table of several hundred MB, far bigger than the caches,
+// so the time is mostly cache misses along the chain.
+//
+// Usage: bench_chains [num_keys=4000000] [num_lookups=1000000]
+
+static void NoOpFree(HTValue_t value) { }
+
+int main(int argc, char **argv) {
+  int num_keys = Bench_IntArg(argc, argv, 1, 4000000);
+  int num_lookups = Bench_IntArg(argc, argv, 2, 1000000);
+  HTKey_t *present = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  HTKey_t *keys = (HTKey_t *) malloc(num_lookups * sizeof(HTKey_t));
+  int load_factor;
+
+  Verify333(present != NULL && keys != NULL);
+  printf("%d keys, %d lookups\n", num_keys, num_lookups);
+  for (load_factor = 1; load_factor <= 3; load_factor++) {
+    HashTable *ht =
+        HashTable_Allocate((num_keys + load_factor - 1) / load_factor);
+    HTKeyValue_t kv, old;
+    uint64_t state = 1, hits;
+    double start, hit_secs, miss_secs;
+    int i;
+
+    for (i = 0; i < num_keys; i++) {
+      present[i] = kv.key = Bench_Rand(&state);
+      kv.value = NULL;
+      HashTable_Insert(ht, kv, &old);
+    }
+    for (i = 0; i < num_lookups; i++) {
+      keys[i] = present[Bench_Rand(&state) % num_keys];
+    }
+    hits = 0;
+    start = Bench_Now();
+    for (i = 0; i < num_lookups; i++) {
+      hits += HashTable_Find(ht, keys[i], &kv);
+    }
+    hit_secs = Bench_Now() - start;
+    Verify333(hits == (uint64_t) num_lookups);
+
+    for (i = 0; i < num_lookups; i++) {
+      keys[i] = Bench_Rand(&state);
+    }
+    start = Bench_Now();
+    for (i = 0; i < num_lookups; i++) {
+      hits += HashTable_Find(ht, keys[i], &kv);
+    }
+    miss_secs = Bench_Now() - start;
+    Bench_Consume(hits);
+
+    printf("  load factor %d (%d buckets): hit %6.1f ns   miss %6.1f ns\n",
+           load_factor, HashTable_NumBuckets(ht),
+           hit_secs / num_lookups * 1e9, miss_secs / num_lookups * 1e9);
+    HashTable_Free(ht, &NoOpFree);
+  }
+
+  free(present);
+  free(keys);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#ifndef HW1_BENCH_COMMON_H_
+#define HW1_BENCH_COMMON_H_
+
+// Small helpers shared by the bench_*.c programs.  Each benchmark is a
+// standalone program like the example programs; "make bench" builds them.
+//
+// Benchmarks must define _POSIX_C_SOURCE before including any system
+// header so that clock_gettime is visible under -std=c17.
+
+#include <stdint.h>     // for uint64_t
+#include <stdlib.h>     // for atoi
+#include <time.h>       // for clock_gettime
+
+// Returns a monotonic timestamp in seconds.
+static inline double Bench_Now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// A small, fast pseudo-random generator (xorshift64*) so that benchmark
+// inputs are reproducible across runs and platforms.
+static inline uint64_t Bench_Rand(uint64_t *state) {
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Returns argv[idx] as an int, or "dflt" if there aren't that many
+// arguments.
+static inline int Bench_IntArg(int argc, char **argv, int idx, int dflt) {
+  return (argc > idx) ? atoi(argv[idx]) : dflt;
+}
+
+// Keeps the compiler from optimizing away a benchmark's result.
+static inline void Bench_Consume(uint64_t v) {
+  static volatile uint64_t sink;
+  sink += v;
+}
+
+#endif  // HW1_BENCH_COMMON_H_
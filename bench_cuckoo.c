@@ -0,0 +1,126 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// A cuckoo table (HashTable_AllocateCuckoo) against the chained table.
+//
+// For each size, each table is grown from empty with random keys, then
+// looked up num_ops times with present keys and num_ops times with
+// missing ones, in random order.  The sizes are 93% of a power-of-two
+// number of cuckoo slots, so that the cuckoo tables end up that full
+// whether grown from empty (HashTable_AllocateCuckoo(0)) or presized
+// (HashTable_AllocateCuckoo(size)); "load" is the fraction of their slots
+// in use.  Memory is what malloc reports in use (glibc's mallinfo2), per
+// key.
+//
+// Usage: bench_cuckoo [num_ops=2000000]
+
+// The sizes, as numbers of cuckoo buckets of four slots.
+static const int kBuckets[] = {1 << 8, 1 << 15, 1 << 18, 1 << 20};
+
+static void NoOpFree(HTValue_t value) { }
+
+static size_t InUse(void) {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// Fills a table with size random (odd) keys, and prints its bytes per key
+// and insert rate.
+static void Fill(HashTable *table, int size, size_t before) {
+  uint64_t state = 1;
+  double start = Bench_Now(), secs;
+  int i;
+
+  for (i = 0; i < size; i++) {
+    HTKeyValue_t kv = {Bench_Rand(&state) | 1, NULL}, old;
+    HashTable_Insert(table, kv, &old);
+  }
+  secs = Bench_Now() - start;
+  printf("  %5.1f  %6.2fM", (double) (InUse() - before) / size,
+         size / secs / 1e6);
+}
+
+// Looks up num_ops random keys of the table's, then num_ops missing
+// (even) ones, and prints the nanoseconds per lookup of each.
+static void Lookups(HashTable *table, int size, int num_ops) {
+  uint64_t state = 2, hits = 0;
+  double start, hit_secs, miss_secs;
+  int i;
+  HTKey_t *keys = (HTKey_t *) malloc(size * sizeof(HTKey_t));
+  HTKeyValue_t kv;
+
+  Verify333(keys != NULL);
+  for (i = 0, state = 1; i < size; i++) {
+    keys[i] = Bench_Rand(&state) | 1;
+  }
+  start = Bench_Now();
+  for (i = 0; i < num_ops; i++) {
+    hits += HashTable_Find(table, keys[Bench_Rand(&state) % size], &kv);
+  }
+  hit_secs = Bench_Now() - start;
+  start = Bench_Now();
+  for (i = 0; i < num_ops; i++) {
+    hits += HashTable_Find(table, Bench_Rand(&state) & ~1ULL, &kv);
+  }
+  miss_secs = Bench_Now() - start;
+  Verify333(hits == (uint64_t) num_ops);
+  Bench_Consume(hits);
+  printf("  %5.0f  %5.0f", hit_secs / num_ops * 1e9,
+         miss_secs / num_ops * 1e9);
+  free(keys);
+}
+
+int main(int argc, char **argv) {
+  int num_ops = Bench_IntArg(argc, argv, 1, 2000000);
+  size_t s;
+
+  printf("%d lookups of each kind\n", num_ops);
+  printf("           %-31s %-31s %s\n", "chained", "cuckoo, grown",
+         "cuckoo, presized");
+  printf("     keys  B/key  insert/s  hit ns miss ns  B/key  insert/s  "
+         "hit ns miss ns  load  B/key  insert/s  hit ns miss ns  load\n");
+  for (s = 0; s < sizeof(kBuckets) / sizeof(kBuckets[0]); s++) {
+    int size = kBuckets[s] * 4 * 93 / 100, run;
+
+    printf("  %7d", size);
+    for (run = 0; run < 3; run++) {
+      size_t before = InUse();
+      HashTable *table;
+
+      if (run == 0) {
+        table = HashTable_Allocate(16);
+      } else {
+        table = HashTable_AllocateCuckoo(run == 1 ? 0 : size);
+      }
+      Fill(table, size, before);
+      Lookups(table, size, num_ops);
+      if (run > 0) {
+        printf("  %3.0f%%", 100.0 * HashTable_NumElements(table) /
+               (4.0 * HashTable_NumBuckets(table)));
+      }
+      HashTable_Free(table, &NoOpFree);
+    }
+    printf("\n");
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// A table watching for dense keys (HashTable_EnableDense) against an
+// ordinary one, on three key sets of num_keys keys each:
+// - dense: 0 .. num_keys - 1, inserted in order, like row IDs.
+// - shuffled: the same keys in random order.
+// - 1% outliers: the dense keys with one in a hundred replaced by a
+//   random one.
+// - sparse: random keys, where there is no range to find and the dense
+//   table should behave like any other.
+// Each table is filled, then looked up num_keys times with present keys
+// and num_keys times with missing ones.  Memory is what malloc reports in
+// use (glibc's mallinfo2), per key; the rates count one op per insert or
+// lookup.
+//
+// Usage: bench_dense [num_keys=1000000]
+
+static const char *kKeySets[] = {"dense", "shuffled", "1% outliers",
+                                 "sparse"};
+
+static void NoOpFree(HTValue_t value) { }
+
+static size_t InUse(void) {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// Fills keys with key set k; missing gets keys that aren't in it.
+static void MakeKeys(int k, HTKey_t *keys, HTKey_t *missing, int n) {
+  uint64_t state = 1;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    keys[i] = i;
+    missing[i] = n + i;
+    if (k == 3 || (k == 2 && i % 100 == 0)) {
+      // Random keys have the top bit set, so they can't collide with the
+      // dense ones, and the missing ones have it clear.
+      keys[i] = Bench_Rand(&state) | (1ULL << 63);
+      missing[i] = Bench_Rand(&state) >> 1;
+    }
+  }
+  if (k == 1) {
+    for (i = n - 1; i > 0; i--) {
+      int j = Bench_Rand(&state) % (i + 1);
+      HTKey_t tmp = keys[i];
+      keys[i] = keys[j];
+      keys[j] = tmp;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int num_keys = Bench_IntArg(argc, argv, 1, 1000000);
+  HTKey_t *keys = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  HTKey_t *missing = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  size_t k;
+  int dense;
+
+  Verify333(keys != NULL && missing != NULL);
+  printf("%d keys\n", num_keys);
+  printf("               %-27s %s\n", "HashTable_Allocate",
+         "HashTable_EnableDense");
+  printf("  keys         B/key  insert/s    find/s  B/key  insert/s    "
+         "find/s\n");
+  for (k = 0; k < sizeof(kKeySets) / sizeof(kKeySets[0]); k++) {
+    MakeKeys(k, keys, missing, num_keys);
+    printf("  %-11s", kKeySets[k]);
+    for (dense = 0; dense <= 1; dense++) {
+      size_t before = InUse(), bytes;
+      double start, insert_secs, find_secs;
+      uint64_t hits = 0;
+      HashTable *table;
+      int i;
+
+      start = Bench_Now();
+      table = HashTable_Allocate(16);
+      if (dense) {
+        HashTable_EnableDense(table);
+      }
+      for (i = 0; i < num_keys; i++) {
+        HTKeyValue_t kv = {keys[i], NULL}, old;
+        HashTable_Insert(table, kv, &old);
+      }
+      insert_secs = Bench_Now() - start;
+      bytes = InUse() - before;
+
+      start = Bench_Now();
+      for (i = 0; i < num_keys; i++) {
+        HTKeyValue_t kv;
+        hits += HashTable_Find(table, keys[i], &kv);
+        hits += HashTable_Find(table, missing[i], &kv);
+      }
+      find_secs = Bench_Now() - start;
+      Verify333(hits == (uint64_t) num_keys);
+      Bench_Consume(hits);
+
+      printf("  %5.1f  %7.2fM  %7.2fM", (double) bytes / num_keys,
+             num_keys / insert_secs / 1e6, 2.0 * num_keys / find_secs / 1e6);
+      HashTable_Free(table, &NoOpFree);
+    }
+    printf("\n");
+  }
+
+  free(missing);
+  free(keys);
+  return EXIT_SUCCESS;
+}
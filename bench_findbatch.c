@@ -0,0 +1,101 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Lookup throughput of a loop of HashTable_Find calls versus
+// HashTable_FindBatch, on a table far bigger than the last-level cache.
+//
+// Each element costs a chain node and an HTKeyValue_t (plus malloc
+// overhead) and a bucket slot and LinkedList, so the default 4M keys make
+// a table of roughly 400 MB.  Half the lookups are misses.  The keys are
+// inserted in random order so neighbouring nodes aren't neighbours in
+// memory either.
+//
+// Usage: bench_findbatch [num_keys=4000000] [num_lookups=2000000]
+
+static void NoOpFree(HTValue_t value) { }
+
+int main(int argc, char **argv) {
+  static const int kBatchSizes[] = {16, 64, 256, 1024};
+  int num_keys = Bench_IntArg(argc, argv, 1, 4000000);
+  int num_lookups = Bench_IntArg(argc, argv, 2, 2000000);
+  HashTable *ht = HashTable_Allocate(num_keys);
+  HTKey_t *keys = (HTKey_t *) malloc(num_lookups * sizeof(HTKey_t));
+  HTKeyValue_t *results =
+      (HTKeyValue_t *) malloc(num_lookups * sizeof(HTKeyValue_t));
+  bool *found = (bool *) malloc(num_lookups * sizeof(bool));
+  HTKeyValue_t kv, old;
+  uint64_t state = 1, miss_state, hits;
+  double start, loop_secs;
+  int i, b;
+
+  Verify333(keys != NULL && results != NULL && found != NULL);
+  for (i = 0; i < num_keys; i++) {
+    kv.key = Bench_Rand(&state);
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  // Replay the generator for the hits, so that lookup i is for the i-th
+  // inserted key; the misses come from a different sequence.  (Keys that
+  // differ only in a low bit would make a poor miss: with an even bucket
+  // count, they'd all land in buckets no present key uses.)
+  state = 1;
+  miss_state = 2;
+  for (i = 0; i < num_lookups; i++) {
+    HTKey_t k = Bench_Rand(&state);
+    keys[i] = (i % 2 == 0) ? k : Bench_Rand(&miss_state);
+  }
+  printf("%d keys, %d buckets, %d lookups\n", HashTable_NumElements(ht),
+         HashTable_NumBuckets(ht), num_lookups);
+
+  hits = 0;
+  start = Bench_Now();
+  for (i = 0; i < num_lookups; i++) {
+    hits += HashTable_Find(ht, keys[i], &kv);
+  }
+  loop_secs = Bench_Now() - start;
+  Bench_Consume(hits);
+  printf("  Find loop          %7.1f ns/lookup\n",
+         loop_secs / num_lookups * 1e9);
+
+  for (b = 0; b < (int) (sizeof(kBatchSizes) / sizeof(kBatchSizes[0])); b++) {
+    int batch = kBatchSizes[b];
+    double secs;
+
+    hits = 0;
+    start = Bench_Now();
+    for (i = 0; i < num_lookups; i += batch) {
+      int n = (num_lookups - i < batch) ? num_lookups - i : batch;
+      hits += HashTable_FindBatch(ht, keys + i, n, results + i, found + i);
+    }
+    secs = Bench_Now() - start;
+    Bench_Consume(hits);
+    printf("  FindBatch(%4d)    %7.1f ns/lookup  %.2fx\n", batch,
+           secs / num_lookups * 1e9, loop_secs / secs);
+  }
+
+  HashTable_Free(ht, &NoOpFree);
+  free(keys);
+  free(results);
+  free(found);
+  return EXIT_SUCCESS;
+}
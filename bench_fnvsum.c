@@ -0,0 +1,141 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CSE333.h"
+#include "Hash.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// An "fnvsum" tool: prints the 64-bit FNV-1a hash of each file, like
+// md5sum, and how fast it was computed two ways:
+//
+// - mmap: the whole file is mapped and hashed with one FNVHash64_Update.
+// - read: the file is read in chunk_kb chunks, each passed to
+//   FNVHash64_Update.
+//
+// Both give the same hash as FNVHash64 over the whole file, for files of
+// any size (FNVHash64 itself can't take more than 2 GB).  Run a file
+// twice to see the numbers with a warm page cache.
+//
+// Usage: bench_fnvsum [-c chunk_kb] file...
+
+// Hashes a file through mmap.  Returns false (with errno set) on failure.
+static bool HashMapped(int fd, size_t size, HTKey_t *hash) {
+  FNVHashState state;
+  void *p;
+
+  FNVHash64_Init(&state);
+  if (size > 0) {
+    p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      return false;
+    }
+    posix_madvise(p, size, POSIX_MADV_SEQUENTIAL);
+    FNVHash64_Update(&state, p, size);
+    munmap(p, size);
+  }
+  *hash = FNVHash64_Final(&state);
+  return true;
+}
+
+// Hashes a file with read(2) into buf.  Returns false (with errno set) on
+// failure.
+static bool HashRead(int fd, unsigned char *buf, size_t buf_size,
+                     HTKey_t *hash) {
+  FNVHashState state;
+  ssize_t n;
+
+  FNVHash64_Init(&state);
+  while ((n = read(fd, buf, buf_size)) != 0) {
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    FNVHash64_Update(&state, buf, (size_t) n);
+  }
+  *hash = FNVHash64_Final(&state);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  size_t chunk = 1024 * 1024;
+  unsigned char *buf;
+  int status = EXIT_SUCCESS;
+  int i = 1;
+
+  if (argc > 2 && strcmp(argv[1], "-c") == 0) {
+    chunk = (size_t) atoi(argv[2]) * 1024;
+    i = 3;
+  }
+  if (i >= argc || chunk == 0) {
+    fprintf(stderr, "usage: %s [-c chunk_kb] file...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  buf = (unsigned char *) malloc(chunk);
+  Verify333(buf != NULL);
+
+  for (; i < argc; i++) {
+    struct stat st;
+    HTKey_t mapped_hash, read_hash;
+    double start, mmap_secs, read_secs;
+    int fd = open(argv[i], O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &st) != 0) {
+      fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+      status = EXIT_FAILURE;
+      if (fd >= 0) {
+        close(fd);
+      }
+      continue;
+    }
+
+    start = Bench_Now();
+    if (!HashMapped(fd, (size_t) st.st_size, &mapped_hash)) {
+      fprintf(stderr, "%s: mmap: %s\n", argv[i], strerror(errno));
+      status = EXIT_FAILURE;
+      close(fd);
+      continue;
+    }
+    mmap_secs = Bench_Now() - start;
+
+    start = Bench_Now();
+    if (!HashRead(fd, buf, chunk, &read_hash)) {
+      fprintf(stderr, "%s: read: %s\n", argv[i], strerror(errno));
+      status = EXIT_FAILURE;
+      close(fd);
+      continue;
+    }
+    read_secs = Bench_Now() - start;
+    close(fd);
+    Verify333(mapped_hash == read_hash);
+
+    printf("%016" PRIx64 "  %s  (%jd bytes; mmap %.2f GB/s, read %.2f GB/s)\n",
+           mapped_hash, argv[i], (intmax_t) st.st_size,
+           st.st_size / mmap_secs / 1e9, st.st_size / read_secs / 1e9);
+  }
+  free(buf);
+  return status;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// A table before and after HashTable_Freeze.
+//
+// Builds a table of num_keys random keys with HashTable_Insert, looks it up
+// (random present keys, then random missing ones, by HashTable_Find and by
+// HashTable_FindBatch), freezes it, and looks it up again the same way.
+// Memory is what malloc reports in use (glibc's mallinfo2), counting big
+// blocks that it maps separately.
+//
+// Usage: bench_freeze [num_keys=4000000] [num_lookups=2000000]
+
+static void NoOpFree(HTValue_t value) { }
+
+// The bytes malloc has handed out and not had back.
+static size_t BytesInUse(void) {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// Times num_lookups lookups of keys, one HashTable_Find at a time and then
+// as one HashTable_FindBatch, and prints ns per lookup.
+static void TimeLookups(HashTable *ht, const char *what, const HTKey_t *keys,
+                        int num_lookups, HTKeyValue_t *results,
+                        bool *found) {
+  HTKeyValue_t kv;
+  uint64_t hits = 0;
+  double start, find_secs, batch_secs;
+  int i;
+
+  start = Bench_Now();
+  for (i = 0; i < num_lookups; i++) {
+    hits += HashTable_Find(ht, keys[i], &kv);
+  }
+  find_secs = Bench_Now() - start;
+  start = Bench_Now();
+  hits += HashTable_FindBatch(ht, keys, num_lookups, results, found);
+  batch_secs = Bench_Now() - start;
+  Bench_Consume(hits);
+  printf("    %-6s Find %6.1f ns   FindBatch %6.1f ns\n", what,
+         find_secs / num_lookups * 1e9, batch_secs / num_lookups * 1e9);
+}
+
+int main(int argc, char **argv) {
+  int num_keys = Bench_IntArg(argc, argv, 1, 4000000);
+  int num_lookups = Bench_IntArg(argc, argv, 2, 2000000);
+  HTKey_t *present = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  HTKey_t *hits = (HTKey_t *) malloc(num_lookups * sizeof(HTKey_t));
+  HTKey_t *misses = (HTKey_t *) malloc(num_lookups * sizeof(HTKey_t));
+  HTKeyValue_t *results =
+      (HTKeyValue_t *) malloc(num_lookups * sizeof(HTKeyValue_t));
+  bool *found = (bool *) malloc(num_lookups * sizeof(bool));
+  uint64_t state = 1, miss_state = 2;
+  size_t before, chained_bytes;
+  double start, insert_secs, freeze_secs;
+  HashTable *ht;
+  int i, frozen;
+
+  Verify333(present != NULL && hits != NULL && misses != NULL &&
+            results != NULL && found != NULL);
+  printf("%d keys, %d lookups\n", num_keys, num_lookups);
+
+  before = BytesInUse();
+  start = Bench_Now();
+  ht = HashTable_Allocate(1);
+  for (i = 0; i < num_keys; i++) {
+    HTKeyValue_t kv, old;
+
+    present[i] = kv.key = Bench_Rand(&state);
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  insert_secs = Bench_Now() - start;
+  chained_bytes = BytesInUse() - before;
+  for (i = 0; i < num_lookups; i++) {
+    hits[i] = present[Bench_Rand(&state) % num_keys];
+    misses[i] = Bench_Rand(&miss_state);
+  }
+
+  for (frozen = 0; frozen <= 1; frozen++) {
+    if (frozen) {
+      start = Bench_Now();
+      HashTable_Freeze(ht);
+      freeze_secs = Bench_Now() - start;
+      printf("  frozen: freeze %.2f s, %.1f bytes/key\n", freeze_secs,
+             (double) (BytesInUse() - before) / num_keys);
+    } else {
+      printf("  chained: %d inserts %.2f s, %.1f bytes/key\n", num_keys,
+             insert_secs, (double) chained_bytes / num_keys);
+    }
+    TimeLookups(ht, "hit", hits, num_lookups, results, found);
+    TimeLookups(ht, "miss", misses, num_lookups, results, found);
+  }
+
+  HashTable_Free(ht, &NoOpFree);
+  free(present);
+  free(hits);
+  free(misses);
+  free(results);
+  free(found);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "Hash.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Hash throughput for input sizes from 8 bytes to 64 KB: FNVHash64 against
+// the word-at-a-time hashes in Hash.h.  Each measurement hashes about
+// total_mb megabytes, in a chain so that one hash's result feeds the next
+// input (as a table lookup's would), so the timings include latency rather
+// than just pipelined throughput.
+//
+// Usage: bench_hash [total_mb=256]
+
+#define MAX_LEN (64 * 1024)
+
+int main(int argc, char **argv) {
+  int total_mb = Bench_IntArg(argc, argv, 1, 256);
+  static const char *names[HASH_NUM_ALGORITHMS] = {
+    "FNVHash64", "XXHash64", "WyHash64"
+  };
+  unsigned char *buf = (unsigned char *) malloc(MAX_LEN + 8);
+  uint64_t state = 1;
+  size_t len;
+  int i, a;
+
+  Verify333(buf != NULL);
+  for (i = 0; i < MAX_LEN + 8; i++) {
+    buf[i] = (unsigned char) Bench_Rand(&state);
+  }
+
+  printf("%8s", "bytes");
+  for (a = 0; a < HASH_NUM_ALGORITHMS; a++) {
+    printf(" %18s", names[a]);
+  }
+  printf("   (GB/s, ns/hash)\n");
+
+  for (len = 8; len <= MAX_LEN; len *= 2) {
+    int64_t iters = ((int64_t) total_mb << 20) / len;
+    printf("%8zu", len);
+    for (a = 0; a < HASH_NUM_ALGORITHMS; a++) {
+      HashFnPtr fn = Hash_Function((HashAlgorithm) a);
+      uint64_t h = 0;
+      double start, secs;
+      int64_t n;
+
+      start = Bench_Now();
+      for (n = 0; n < iters; n++) {
+        // Vary the start by the previous hash so each call depends on the
+        // last one.
+        h = fn(buf + (h & 7), len, 0);
+      }
+      secs = Bench_Now() - start;
+      Bench_Consume(h);
+      printf("   %6.2f %9.1f", (double) len * iters / secs / 1e9,
+             secs / iters * 1e9);
+    }
+    printf("\n");
+  }
+  free(buf);
+  return EXIT_SUCCESS;
+}
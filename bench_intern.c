@@ -0,0 +1,157 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "CSE333.h"
+#include "StringPool.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Interning throughput and memory on a repetitive token stream, like the
+// identifiers a parser sees: a skewed mix of num_words distinct words.
+//
+// The baseline copies every token into its own malloc'ed buffer, the way a
+// parser that doesn't intern would.  Its memory is estimated as the
+// requested bytes plus 16 bytes of malloc overhead per buffer.
+//
+// Usage: bench_intern [num_tokens=2000000] [num_words=20000] [threads=4]
+
+typedef struct {
+  StringPool *pool;
+  char      **tokens;
+  int        *lens;
+  int         begin, end;
+} InternTask;
+
+static void *InternRange(void *arg) {
+  InternTask *task = (InternTask *) arg;
+  uint64_t sum = 0;
+  int i;
+
+  for (i = task->begin; i < task->end; i++) {
+    sum += StringPool_Intern(task->pool, task->tokens[i], task->lens[i]);
+  }
+  Bench_Consume(sum);
+  return NULL;
+}
+
+// Interns all the tokens on "threads" threads; returns the elapsed time.
+static double InternAll(StringPool *pool, char **tokens, int *lens,
+                        int num_tokens, int threads) {
+  pthread_t *tids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+  InternTask *tasks = (InternTask *) malloc(threads * sizeof(InternTask));
+  double start;
+  int t;
+
+  Verify333(tids != NULL && tasks != NULL);
+  start = Bench_Now();
+  for (t = 0; t < threads; t++) {
+    tasks[t].pool = pool;
+    tasks[t].tokens = tokens;
+    tasks[t].lens = lens;
+    tasks[t].begin = (int) ((int64_t) num_tokens * t / threads);
+    tasks[t].end = (int) ((int64_t) num_tokens * (t + 1) / threads);
+    Verify333(pthread_create(&tids[t], NULL, &InternRange, &tasks[t]) == 0);
+  }
+  for (t = 0; t < threads; t++) {
+    pthread_join(tids[t], NULL);
+  }
+  start = Bench_Now() - start;
+  free(tids);
+  free(tasks);
+  return start;
+}
+
+int main(int argc, char **argv) {
+  int num_tokens = Bench_IntArg(argc, argv, 1, 2000000);
+  int num_words = Bench_IntArg(argc, argv, 2, 20000);
+  int threads = Bench_IntArg(argc, argv, 3, 4);
+  char **words = (char **) malloc(num_words * sizeof(char *));
+  char **tokens = (char **) malloc(num_tokens * sizeof(char *));
+  char **copies = (char **) malloc(num_tokens * sizeof(char *));
+  int *lens = (int *) malloc(num_tokens * sizeof(int));
+  uint64_t state = 1, baseline_bytes = 0;
+  StringPool *pool;
+  StringPoolStats stats;
+  double start, secs;
+  int i;
+
+  Verify333(words != NULL && tokens != NULL && copies != NULL);
+  Verify333(lens != NULL);
+
+  // The vocabulary: identifier-like words of 3 to 18 characters.
+  for (i = 0; i < num_words; i++) {
+    int len = 3 + Bench_Rand(&state) % 16, j;
+    words[i] = (char *) malloc(len + 1);
+    Verify333(words[i] != NULL);
+    for (j = 0; j < len; j++) {
+      words[i][j] = 'a' + Bench_Rand(&state) % 26;
+    }
+    words[i][len] = '\0';
+  }
+  // The stream: word index num_words * r^3 for uniform r, so a few words
+  // are very common and most are rare.
+  for (i = 0; i < num_tokens; i++) {
+    double r = (Bench_Rand(&state) >> 11) / 9007199254740992.0;
+    tokens[i] = words[(int) (num_words * r * r * r)];
+    lens[i] = (int) strlen(tokens[i]);
+  }
+
+  start = Bench_Now();
+  for (i = 0; i < num_tokens; i++) {
+    copies[i] = (char *) malloc(lens[i] + 1);
+    Verify333(copies[i] != NULL);
+    memcpy(copies[i], tokens[i], lens[i] + 1);
+    baseline_bytes += lens[i] + 1 + 16;
+  }
+  secs = Bench_Now() - start;
+  printf("%d tokens, %d-word vocabulary\n", num_tokens, num_words);
+  printf("  malloc per token:   %7.1f Mtokens/s, %8.1f MB\n",
+         num_tokens / secs / 1e6, baseline_bytes / 1e6);
+  for (i = 0; i < num_tokens; i++) {
+    free(copies[i]);
+  }
+
+  pool = StringPool_Allocate();
+  secs = InternAll(pool, tokens, lens, num_tokens, 1);
+  StringPool_GetStats(pool, &stats);
+  printf("  intern, 1 thread:   %7.1f Mtokens/s, %8.1f MB "
+         "(%.2f arena + %.2f index)\n", num_tokens / secs / 1e6,
+         (stats.arena_bytes + stats.index_bytes) / 1e6,
+         stats.arena_bytes / 1e6, stats.index_bytes / 1e6);
+  printf("  %" PRIu64 " distinct strings, %.1f MB of text interned as "
+         "%.2f MB\n", stats.num_strings, stats.interned_bytes / 1e6,
+         stats.string_bytes / 1e6);
+  StringPool_Free(pool);
+
+  pool = StringPool_Allocate();
+  secs = InternAll(pool, tokens, lens, num_tokens, threads);
+  printf("  intern, %d threads:  %7.1f Mtokens/s\n", threads,
+         num_tokens / secs / 1e6);
+  StringPool_Free(pool);
+
+  for (i = 0; i < num_words; i++) {
+    free(words[i]);
+  }
+  free(words);
+  free(tokens);
+  free(copies);
+  free(lens);
+  return EXIT_SUCCESS;
+}
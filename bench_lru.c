@@ -0,0 +1,179 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "LinkedList.h"
+#include "LRUCache.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// LRUCache against the usual hand-rolled LRU: a HashTable for the values
+// plus a LinkedList of keys in recency order, which a hit has to search to
+// move its key to the back.
+//
+// For each capacity, two workloads:
+// - hits: the cache is full and every get is a hit on a random key; the
+//   time per get is the hit-path latency.
+// - mixed: gets of random keys from twice as many as fit, with a put after
+//   every miss, which evicts; the rate counts one op per get.
+// The hand-rolled LRU is only run at the smaller capacities, where its
+// O(capacity) hits finish.
+//
+// Usage: bench_lru [num_ops=2000000]
+
+static const int kCapacities[] = {100, 1000, 10000, 100000, 1000000};
+
+// The largest capacity to run the hand-rolled LRU at.
+#define NAIVE_MAX 10000
+
+static void NoOpFree(HTValue_t value) { }
+
+static void NoOpPayloadFree(LLPayload_t payload) { }
+
+// The hand-rolled LRU.  keys holds the keys, least recently used first.
+typedef struct {
+  HashTable  *values;
+  LinkedList *keys;
+  int         capacity;
+} NaiveLRU;
+
+static bool NaiveGet(NaiveLRU *lru, HTKey_t key, HTKeyValue_t *kv) {
+  LLIterator *iter;
+
+  if (!HashTable_Find(lru->values, key, kv)) {
+    return false;
+  }
+  // Find the key in the list and move it to the back.
+  iter = LLIterator_Allocate(lru->keys);
+  while (LLIterator_IsValid(iter)) {
+    LLPayload_t payload;
+
+    LLIterator_Get(iter, &payload);
+    if ((HTKey_t) (uintptr_t) payload == key) {
+      LLIterator_Remove(iter, &NoOpPayloadFree);
+      break;
+    }
+    LLIterator_Next(iter);
+  }
+  LLIterator_Free(iter);
+  LinkedList_Append(lru->keys, (LLPayload_t) (uintptr_t) key);
+  return true;
+}
+
+static void NaivePut(NaiveLRU *lru, HTKeyValue_t kv) {
+  HTKeyValue_t old;
+
+  HashTable_Insert(lru->values, kv, &old);
+  LinkedList_Append(lru->keys, (LLPayload_t) (uintptr_t) kv.key);
+  if (LinkedList_NumElements(lru->keys) > lru->capacity) {
+    LLPayload_t payload;
+
+    LinkedList_Pop(lru->keys, &payload);
+    HashTable_Remove(lru->values, (HTKey_t) (uintptr_t) payload, &old);
+  }
+}
+
+// Runs num_ops gets of keys in [0, universe) on a cache (if naive is NULL)
+// or on the hand-rolled LRU, each miss followed by a put, and returns the
+// seconds taken.  Counts the hits in *hits.
+static double RunOps(LRUCache *cache, NaiveLRU *naive, uint64_t universe,
+                     int num_ops, uint64_t *state, uint64_t *hits) {
+  double start = Bench_Now();
+  int i;
+
+  for (i = 0; i < num_ops; i++) {
+    HTKeyValue_t kv = {Bench_Rand(state) % universe, NULL};
+    bool hit = naive == NULL ? LRUCache_Get(cache, kv.key, &kv) :
+               NaiveGet(naive, kv.key, &kv);
+
+    if (hit) {
+      (*hits)++;
+    } else if (naive == NULL) {
+      LRUCache_Put(cache, kv);
+    } else {
+      NaivePut(naive, kv);
+    }
+  }
+  return Bench_Now() - start;
+}
+
+int main(int argc, char **argv) {
+  int num_ops = Bench_IntArg(argc, argv, 1, 2000000);
+  size_t c;
+
+  printf("%d ops\n", num_ops);
+  printf("  capacity  %-28s %s\n", "LRUCache", "hand-rolled");
+  printf("            hit ns   mixed Mops/s  hit%%   hit ns   mixed Mops/s\n");
+  for (c = 0; c < sizeof(kCapacities) / sizeof(kCapacities[0]); c++) {
+    int capacity = kCapacities[c];
+    int naive_run;
+
+    printf("  %8d", capacity);
+    for (naive_run = 0; naive_run <= 1; naive_run++) {
+      LRUCache *cache = NULL;
+      NaiveLRU naive, *lru = NULL;
+      uint64_t state = 1, hits = 0;
+      double hit_secs, mixed_secs;
+      int ops = num_ops;
+      HTKey_t key;
+
+      if (naive_run) {
+        if (capacity > NAIVE_MAX) {
+          printf("  %6s   %12s", "-", "-");
+          break;
+        }
+        // Fewer ops, scaled to the O(capacity) hits.
+        ops = num_ops / (capacity / 100);
+        naive.values = HashTable_Allocate(capacity);
+        naive.keys = LinkedList_Allocate();
+        naive.capacity = capacity;
+        lru = &naive;
+      } else {
+        cache = LRUCache_Allocate(capacity, NULL, &NoOpFree);
+      }
+
+      // Fill it, then time hits.
+      for (key = 0; key < (HTKey_t) capacity; key++) {
+        HTKeyValue_t kv = {key, NULL};
+        if (naive_run) {
+          NaivePut(lru, kv);
+        } else {
+          LRUCache_Put(cache, kv);
+        }
+      }
+      hit_secs = RunOps(cache, lru, capacity, ops, &state, &hits);
+      Verify333(hits == (uint64_t) ops);
+      hits = 0;
+      mixed_secs = RunOps(cache, lru, 2 * (uint64_t) capacity, ops, &state,
+                          &hits);
+      Bench_Consume(hits);
+
+      printf("  %6.1f   %12.2f", hit_secs / ops * 1e9,
+             ops / mixed_secs / 1e6);
+      if (!naive_run) {
+        printf("  %3.0f%%", 100.0 * hits / ops);
+        LRUCache_Free(cache);
+      } else {
+        HashTable_Free(naive.values, &NoOpFree);
+        LinkedList_Free(naive.keys, &NoOpPayloadFree);
+      }
+    }
+    printf("\n");
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "LinkedList.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// A multimap table (HashTable_AllocateMulti) against the usual way of
+// keeping several values per key: an ordinary table whose values are
+// LinkedLists, found or made on each insert and appended to.
+//
+// For each number of values per key, num_values values are inserted over
+// num_values / per_key keys, the keys taken round-robin so that a key's
+// values arrive spread out.  Then every key's values are visited once:
+// HashTable_FindAll and an HTIterator walk against HashTable_Find and an
+// LLIterator walk.  Memory is what malloc reports in use (glibc's
+// mallinfo2), per value; the rates count one op per value.
+//
+// Usage: bench_multimap [num_values=1000000]
+
+static const int kPerKey[] = {1, 2, 4, 8, 32, 128};
+
+static void NoOpFree(HTValue_t value) { }
+
+static void NoOpPayloadFree(LLPayload_t payload) { }
+
+static void FreeList(HTValue_t value) {
+  LinkedList_Free((LinkedList *) value, &NoOpPayloadFree);
+}
+
+static size_t InUse(void) {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// The key of the i'th value; the values are the i's themselves.
+static HTKey_t KeyOf(int i, int num_keys) {
+  return (HTKey_t) (i % num_keys);
+}
+
+int main(int argc, char **argv) {
+  int num_values = Bench_IntArg(argc, argv, 1, 1000000);
+  size_t p;
+  int lists;
+
+  printf("%d values\n", num_values);
+  printf("           %-28s %s\n", "list-as-value", "multimap");
+  printf("  per key  B/value  insert/s  visit/s  B/value  insert/s  "
+         "visit/s\n");
+  for (p = 0; p < sizeof(kPerKey) / sizeof(kPerKey[0]); p++) {
+    int per_key = kPerKey[p];
+    int num_keys = num_values / per_key;
+    int total = num_keys * per_key;
+
+    printf("  %7d", per_key);
+    for (lists = 1; lists >= 0; lists--) {
+      HashTable *table;
+      size_t before = InUse(), bytes;
+      double start, insert_secs, visit_secs;
+      uint64_t sum = 0;
+      int i;
+
+      start = Bench_Now();
+      table = lists ? HashTable_Allocate(16) : HashTable_AllocateMulti(16);
+      for (i = 0; i < total; i++) {
+        HTKeyValue_t kv = {KeyOf(i, num_keys), (HTValue_t) (uintptr_t) i};
+        HTKeyValue_t old;
+
+        if (lists) {
+          HTKeyValue_t found;
+
+          if (!HashTable_Find(table, kv.key, &found)) {
+            found.key = kv.key;
+            found.value = LinkedList_Allocate();
+            HashTable_Insert(table, found, &old);
+          }
+          LinkedList_Append((LinkedList *) found.value, kv.value);
+        } else {
+          HashTable_Insert(table, kv, &old);
+        }
+      }
+      insert_secs = Bench_Now() - start;
+      bytes = InUse() - before;
+
+      start = Bench_Now();
+      for (i = 0; i < num_keys; i++) {
+        HTKey_t key = KeyOf(i, num_keys);
+
+        if (lists) {
+          HTKeyValue_t found;
+          LLIterator *iter;
+
+          Verify333(HashTable_Find(table, key, &found));
+          iter = LLIterator_Allocate((LinkedList *) found.value);
+          while (LLIterator_IsValid(iter)) {
+            LLPayload_t payload;
+
+            LLIterator_Get(iter, &payload);
+            sum += (uintptr_t) payload;
+            LLIterator_Next(iter);
+          }
+          LLIterator_Free(iter);
+        } else {
+          HTIterator *iter = HashTable_FindAll(table, key);
+          HTKeyValue_t kv;
+
+          while (HTIterator_Get(iter, &kv)) {
+            sum += (uintptr_t) kv.value;
+            HTIterator_Next(iter);
+          }
+          HTIterator_Free(iter);
+        }
+      }
+      visit_secs = Bench_Now() - start;
+      Verify333(sum == (uint64_t) total * (total - 1) / 2);
+      Bench_Consume(sum);
+
+      printf("  %7.1f  %7.2fM  %6.2fM", (double) bytes / total,
+             total / insert_secs / 1e6, total / visit_secs / 1e6);
+      HashTable_Free(table, lists ? &FreeList : &NoOpFree);
+    }
+    printf("\n");
+  }
+  return EXIT_SUCCESS;
+}
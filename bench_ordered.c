@@ -0,0 +1,161 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "OrderedMap.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// An OrderedMap against a HashTable holding the same num_keys random keys:
+// the time to build each by inserting the keys one at a time, point
+// lookups of random present keys, and range queries -- every (key,value)
+// in [lo, hi], in key order -- for ranges expected to hold 10, 1000 and
+// 100000 keys.  The OrderedMap answers a range query with a range
+// iterator; the HashTable can only scan every key, keep the ones in range
+// and sort them.
+//
+// Usage: bench_ordered [num_keys=1000000] [num_lookups=2000000]
+
+static void NoOpFree(HTValue_t value) { }
+
+static int CompareKeyValues(const void *a, const void *b) {
+  HTKey_t ka = ((const HTKeyValue_t *) a)->key;
+  HTKey_t kb = ((const HTKeyValue_t *) b)->key;
+  return ka < kb ? -1 : ka > kb;
+}
+
+// Collects the (key,value)s in [lo, hi] into out, in key order, by
+// scanning and sorting the whole table.  Returns how many there are.
+static int HashTableRange(HashTable *ht, HTKey_t lo, HTKey_t hi,
+                          HTKeyValue_t *out) {
+  HTIterator *iter = HTIterator_Allocate(ht);
+  int n = 0;
+
+  while (HTIterator_IsValid(iter)) {
+    HTIterator_Get(iter, &out[n]);
+    if (out[n].key >= lo && out[n].key <= hi) {
+      n++;
+    }
+    HTIterator_Next(iter);
+  }
+  HTIterator_Free(iter);
+  qsort(out, n, sizeof(HTKeyValue_t), &CompareKeyValues);
+  return n;
+}
+
+// The same, with an OrderedMap range iterator.
+static int OrderedMapRange(OrderedMap *map, HTKey_t lo, HTKey_t hi,
+                           HTKeyValue_t *out) {
+  OMIterator *iter = OMIterator_AllocateRange(map, lo, hi);
+  int n = 0;
+
+  while (OMIterator_Get(iter, &out[n])) {
+    n++;
+    OMIterator_Next(iter);
+  }
+  OMIterator_Free(iter);
+  return n;
+}
+
+int main(int argc, char **argv) {
+  static const int kRangeSizes[] = {10, 1000, 100000};
+  int num_keys = Bench_IntArg(argc, argv, 1, 1000000);
+  int num_lookups = Bench_IntArg(argc, argv, 2, 2000000);
+  HTKey_t *keys = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  HTKeyValue_t *out = (HTKeyValue_t *) malloc(num_keys * sizeof(HTKeyValue_t));
+  uint64_t state = 1, hits = 0;
+  double start, ht_secs, om_secs;
+  HashTable *ht;
+  OrderedMap *map;
+  size_t r;
+  int i;
+
+  Verify333(keys != NULL && out != NULL);
+  printf("%d keys, %d lookups\n", num_keys, num_lookups);
+
+  start = Bench_Now();
+  ht = HashTable_Allocate(1);
+  for (i = 0; i < num_keys; i++) {
+    HTKeyValue_t kv, old;
+
+    keys[i] = kv.key = Bench_Rand(&state);
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  ht_secs = Bench_Now() - start;
+  start = Bench_Now();
+  map = OrderedMap_Allocate();
+  for (i = 0; i < num_keys; i++) {
+    HTKeyValue_t kv = {keys[i], NULL}, old;
+    OrderedMap_Insert(map, kv, &old);
+  }
+  om_secs = Bench_Now() - start;
+  printf("  %-26s %12s %12s\n", "", "HashTable", "OrderedMap");
+  printf("  %-26s %9.1f ns %9.1f ns\n", "insert", ht_secs / num_keys * 1e9,
+         om_secs / num_keys * 1e9);
+
+  start = Bench_Now();
+  for (i = 0; i < num_lookups; i++) {
+    HTKeyValue_t kv;
+    hits += HashTable_Find(ht, keys[Bench_Rand(&state) % num_keys], &kv);
+  }
+  ht_secs = Bench_Now() - start;
+  start = Bench_Now();
+  for (i = 0; i < num_lookups; i++) {
+    HTKeyValue_t kv;
+    hits += OrderedMap_Find(map, keys[Bench_Rand(&state) % num_keys], &kv);
+  }
+  om_secs = Bench_Now() - start;
+  Verify333(hits == 2 * (uint64_t) num_lookups);
+  printf("  %-26s %9.1f ns %9.1f ns\n", "find", ht_secs / num_lookups * 1e9,
+         om_secs / num_lookups * 1e9);
+
+  for (r = 0; r < sizeof(kRangeSizes) / sizeof(kRangeSizes[0]); r++) {
+    // A range of width w holds about w * num_keys / 2^64 random keys.
+    HTKey_t width = (HTKey_t) ((double) kRangeSizes[r] / num_keys *
+                               18446744073709551616.0);
+    int ht_queries = 5, om_queries = 2000000 / kRangeSizes[r];
+    uint64_t found = 0, ht_found = 0;
+    char label[32];
+
+    start = Bench_Now();
+    for (i = 0; i < ht_queries; i++) {
+      HTKey_t lo = Bench_Rand(&state) % (UINT64_MAX - width);
+      ht_found += HashTableRange(ht, lo, lo + width, out);
+    }
+    ht_secs = Bench_Now() - start;
+    start = Bench_Now();
+    for (i = 0; i < om_queries; i++) {
+      HTKey_t lo = Bench_Rand(&state) % (UINT64_MAX - width);
+      found += OrderedMapRange(map, lo, lo + width, out);
+    }
+    om_secs = Bench_Now() - start;
+    Bench_Consume(found + ht_found);
+
+    snprintf(label, sizeof(label), "range of ~%d keys", kRangeSizes[r]);
+    printf("  %-26s %9.1f us %9.1f us   (%.0f keys/query)\n", label,
+           ht_secs / ht_queries * 1e6, om_secs / om_queries * 1e6,
+           (double) found / om_queries);
+  }
+
+  HashTable_Free(ht, &NoOpFree);
+  OrderedMap_Free(map, &NoOpFree);
+  free(keys);
+  free(out);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "ThreadPool.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Two measurements of the ThreadPool:
+//
+// 1. Overhead per task: the cost of submitting and waiting for empty
+//    tasks, against creating and joining one pthread per task.
+//
+// 2. Load balancing: a read-only scan of a HashTable whose chains are very
+//    uneven (the first eighth of the buckets hold most of the elements).
+//    A static split, one pthread per equal bucket range, leaves one thread
+//    with most of the work; HashTable_ForEachParallel runs several ranges
+//    per thread on the pool, and idle workers steal the long ones.
+//
+// Usage: bench_pool [threads=4] [num_tasks=200000] [num_elements=400000]
+
+static void EmptyTask(void *arg) { }
+
+static void *EmptyThread(void *arg) {
+  return NULL;
+}
+
+// Simulates per-element work in the scan.
+static uint64_t Work(HTKey_t key) {
+  uint64_t h = key;
+  int i;
+  for (i = 0; i < 50; i++) {
+    h = h * 0x100000001b3ULL ^ (h >> 17);
+  }
+  return h;
+}
+
+static bool ScanFn(HTKeyValue_t kv, void *ctx) {
+  __atomic_fetch_add((uint64_t *) ctx, Work(kv.key), __ATOMIC_RELAXED);
+  return false;
+}
+
+typedef struct {
+  HashTable *ht;
+  int        begin, end;
+  uint64_t   sum;
+} StaticRange;
+
+static void *ScanRange(void *arg) {
+  StaticRange *r = (StaticRange *) arg;
+  HTIterator *it = HTIterator_AllocateRange(r->ht, r->begin, r->end);
+  HTKeyValue_t kv;
+
+  for (; HTIterator_IsValid(it); HTIterator_Next(it)) {
+    HTIterator_Get(it, &kv);
+    r->sum += Work(kv.key);
+  }
+  HTIterator_Free(it);
+  return NULL;
+}
+
+static void NoOpFree(HTValue_t value) { }
+
+int main(int argc, char **argv) {
+  int threads = Bench_IntArg(argc, argv, 1, 4);
+  int num_tasks = Bench_IntArg(argc, argv, 2, 200000);
+  int num_elements = Bench_IntArg(argc, argv, 3, 400000);
+  ThreadPool *pool;
+  TaskGroup *group;
+  HashTable *ht;
+  StaticRange *ranges;
+  pthread_t *tids;
+  uint64_t pool_sum = 0, static_sum = 0;
+  double start, secs;
+  int i, num_buckets, per_range;
+
+  // 1. Overhead per task.
+  pool = ThreadPool_Allocate(threads);
+  group = TaskGroup_Allocate(pool);
+  start = Bench_Now();
+  for (i = 0; i < num_tasks; i++) {
+    TaskGroup_Submit(group, &EmptyTask, NULL);
+  }
+  TaskGroup_Wait(group);
+  secs = Bench_Now() - start;
+  TaskGroup_Free(group);
+  ThreadPool_Free(pool);
+  printf("pool: %d empty tasks on %d workers: %.0f ns/task\n",
+         num_tasks, threads, secs / num_tasks * 1e9);
+
+  start = Bench_Now();
+  for (i = 0; i < num_tasks / 100; i++) {
+    pthread_t tid;
+    Verify333(pthread_create(&tid, NULL, &EmptyThread, NULL) == 0);
+    pthread_join(tid, NULL);
+  }
+  secs = Bench_Now() - start;
+  printf("pthread_create+join per task: %.0f ns/task\n\n",
+         secs / (num_tasks / 100) * 1e9);
+
+  // 2. Load balancing on uneven chains.  Buckets [0, num_buckets/8) get
+  // 7/8 of the keys.
+  num_buckets = num_elements / 2;
+  ht = HashTable_Allocate(num_buckets);
+  for (i = 0; i < num_elements; i++) {
+    HTKeyValue_t kv, old;
+    int bucket = (i % 8 != 0) ? i % (num_buckets / 8) : i % num_buckets;
+    kv.key = (HTKey_t) bucket + (HTKey_t) num_buckets * (i / 8 + 1);
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  num_buckets = HashTable_NumBuckets(ht);
+
+  ranges = (StaticRange *) malloc(threads * sizeof(StaticRange));
+  tids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+  Verify333(ranges != NULL && tids != NULL);
+  per_range = (num_buckets + threads - 1) / threads;
+  start = Bench_Now();
+  for (i = 0; i < threads; i++) {
+    ranges[i].ht = ht;
+    ranges[i].begin = i * per_range < num_buckets ? i * per_range :
+        num_buckets;
+    ranges[i].end = ranges[i].begin + per_range < num_buckets ?
+        ranges[i].begin + per_range : num_buckets;
+    ranges[i].sum = 0;
+    Verify333(pthread_create(&tids[i], NULL, &ScanRange, &ranges[i]) == 0);
+  }
+  for (i = 0; i < threads; i++) {
+    pthread_join(tids[i], NULL);
+    static_sum += ranges[i].sum;
+  }
+  secs = Bench_Now() - start;
+  printf("uneven scan of %d elements, %d threads\n",
+         HashTable_NumElements(ht), threads);
+  printf("  static ranges:      %.3f s\n", secs);
+
+  start = Bench_Now();
+  HashTable_ForEachParallel(ht, &ScanFn, &pool_sum, threads);
+  secs = Bench_Now() - start;
+  printf("  ForEachParallel:    %.3f s (shared pool, %d workers)\n", secs,
+         ThreadPool_NumWorkers(ThreadPool_Default()));
+  Verify333(pool_sum == static_sum);
+
+  free(ranges);
+  free(tids);
+  HashTable_Free(ht, &NoOpFree);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "CSE333.h"
+#include "LinkedList.h"
+#include "ConcurrentQueue.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Throughput of a work queue shared by P producers and C consumers, for
+// every 1 <= P, C <= N:
+//   - "mutex": a LinkedList with Append and Pop wrapped in one mutex
+//   - "cq":    a ConcurrentQueue
+//
+// Usage: bench_queue [max_threads=4] [items_per_run=400000]
+
+typedef struct {
+  bool             lockfree;
+  ConcurrentQueue *queue;
+  LinkedList      *list;
+  pthread_mutex_t  list_lock;
+  int              items_per_producer;
+  int              producers_left;   // decremented as producers finish
+  uint64_t         checksum;         // sum of all popped payloads
+} BenchState;
+
+static void *Producer(void *arg) {
+  BenchState *st = (BenchState *) arg;
+  int i;
+
+  for (i = 1; i <= st->items_per_producer; i++) {
+    if (st->lockfree) {
+      ConcurrentQueue_Append(st->queue, (LLPayload_t) (uintptr_t) i);
+    } else {
+      pthread_mutex_lock(&st->list_lock);
+      LinkedList_Append(st->list, (LLPayload_t) (uintptr_t) i);
+      pthread_mutex_unlock(&st->list_lock);
+    }
+  }
+  __atomic_fetch_sub(&st->producers_left, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static void *Consumer(void *arg) {
+  BenchState *st = (BenchState *) arg;
+  uint64_t sum = 0;
+  LLPayload_t p;
+
+  while (true) {
+    bool done = __atomic_load_n(&st->producers_left, __ATOMIC_ACQUIRE) == 0;
+    bool got;
+
+    if (st->lockfree) {
+      got = ConcurrentQueue_Pop(st->queue, &p);
+    } else {
+      pthread_mutex_lock(&st->list_lock);
+      got = LinkedList_Pop(st->list, &p);
+      pthread_mutex_unlock(&st->list_lock);
+    }
+    if (got) {
+      sum += (uintptr_t) p;
+    } else if (done) {
+      // Producers had finished before we found the queue empty.
+      break;
+    }
+  }
+  __atomic_fetch_add(&st->checksum, sum, __ATOMIC_RELAXED);
+  return NULL;
+}
+
+static void NoOpFree(LLPayload_t payload) { }
+
+// Runs one configuration and returns the throughput in million items/sec.
+static double RunOnce(bool lockfree, int producers, int consumers,
+                      int items) {
+  BenchState st;
+  pthread_t *threads;
+  uint64_t per, expected;
+  double start, elapsed;
+  int i;
+
+  st.lockfree = lockfree;
+  st.queue = ConcurrentQueue_Allocate();
+  st.list = LinkedList_Allocate();
+  pthread_mutex_init(&st.list_lock, NULL);
+  st.items_per_producer = items / producers;
+  st.producers_left = producers;
+  st.checksum = 0;
+
+  threads = (pthread_t *) malloc((producers + consumers) * sizeof(pthread_t));
+  Verify333(threads != NULL);
+
+  start = Bench_Now();
+  for (i = 0; i < consumers; i++) {
+    Verify333(pthread_create(&threads[i], NULL, &Consumer, &st) == 0);
+  }
+  for (i = 0; i < producers; i++) {
+    Verify333(pthread_create(&threads[consumers + i], NULL,
+                             &Producer, &st) == 0);
+  }
+  for (i = 0; i < producers + consumers; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  elapsed = Bench_Now() - start;
+
+  // Every item must come out exactly once.
+  per = st.items_per_producer;
+  expected = producers * (per * (per + 1) / 2);
+  Verify333(st.checksum == expected);
+
+  free(threads);
+  pthread_mutex_destroy(&st.list_lock);
+  LinkedList_Free(st.list, &NoOpFree);
+  ConcurrentQueue_Free(st.queue, &NoOpFree);
+  return (double) producers * st.items_per_producer / elapsed / 1e6;
+}
+
+int main(int argc, char **argv) {
+  int max_threads = Bench_IntArg(argc, argv, 1, 4);
+  int items = Bench_IntArg(argc, argv, 2, 400000);
+  int p, c;
+
+  printf("%-10s %-10s %14s %14s %8s\n",
+         "producers", "consumers", "mutex Mops/s", "cq Mops/s", "speedup");
+  for (p = 1; p <= max_threads; p++) {
+    for (c = 1; c <= max_threads; c++) {
+      double locked = RunOnce(false, p, c, items);
+      double lockfree = RunOnce(true, p, c, items);
+      printf("%-10d %-10d %14.2f %14.2f %7.2fx\n",
+             p, c, locked, lockfree, lockfree / locked);
+    }
+  }
+  return EXIT_SUCCESS;
+}
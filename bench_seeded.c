@@ -0,0 +1,103 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Latency of HashTable operations under a collision attack, with and
+// without a seeded table (HashTable_AllocateSeeded).
+//
+// The attack keys are all multiples of every bucket count the table will
+// pass through as it resizes (initial_buckets * 9^k), so an unseeded table
+// chains them all off bucket 0.  Random keys show what seeding costs when
+// nobody is attacking.
+//
+// Usage: bench_seeded [num_keys=10000]
+
+#define INITIAL_BUCKETS 16
+
+static void NoOpFree(HTValue_t value) { }
+
+static int CompareDoubles(const void *a, const void *b) {
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+// Inserts the keys, then looks each one up, timing every lookup.
+static void Run(const char *name, bool seeded, HTKey_t *keys, int num_keys,
+                double *lat) {
+  HashTable *ht = seeded ? HashTable_AllocateSeeded(INITIAL_BUCKETS)
+                         : HashTable_Allocate(INITIAL_BUCKETS);
+  HTKeyValue_t kv, old;
+  double start, insert_secs;
+  int i;
+
+  start = Bench_Now();
+  for (i = 0; i < num_keys; i++) {
+    kv.key = keys[i];
+    kv.value = NULL;
+    HashTable_Insert(ht, kv, &old);
+  }
+  insert_secs = Bench_Now() - start;
+
+  for (i = 0; i < num_keys; i++) {
+    start = Bench_Now();
+    Verify333(HashTable_Find(ht, keys[i], &kv));
+    lat[i] = Bench_Now() - start;
+  }
+  qsort(lat, num_keys, sizeof(double), &CompareDoubles);
+
+  printf("  %-10s insert %8.0f ns/op   find p50 %8.0f ns  p99 %8.0f ns\n",
+         name, insert_secs / num_keys * 1e9, lat[num_keys / 2] * 1e9,
+         lat[num_keys * 99 / 100] * 1e9);
+  HashTable_Free(ht, &NoOpFree);
+}
+
+int main(int argc, char **argv) {
+  int num_keys = Bench_IntArg(argc, argv, 1, 10000);
+  HTKey_t *keys = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  double *lat = (double *) malloc(num_keys * sizeof(double));
+  HTKey_t stride = INITIAL_BUCKETS;
+  uint64_t state = 1;
+  int i;
+
+  Verify333(keys != NULL && lat != NULL);
+  for (i = 0; i < 8; i++) {
+    stride *= 9;
+  }
+
+  printf("%d attack keys (multiples of %" PRIu64 ")\n", num_keys, stride);
+  for (i = 0; i < num_keys; i++) {
+    keys[i] = (HTKey_t) i * stride;
+  }
+  Run("unseeded", false, keys, num_keys, lat);
+  Run("seeded", true, keys, num_keys, lat);
+
+  printf("%d random keys\n", num_keys);
+  for (i = 0; i < num_keys; i++) {
+    keys[i] = Bench_Rand(&state);
+  }
+  Run("unseeded", false, keys, num_keys, lat);
+  Run("seeded", true, keys, num_keys, lat);
+
+  free(keys);
+  free(lat);
+  return EXIT_SUCCESS;
+}
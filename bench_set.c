@@ -0,0 +1,115 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashSet.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// HashSet against the usual stand-in for a set: a HashTable with NULL
+// values.
+//
+// For each set size, the set is filled with random keys, then probed
+// num_ops times, half with present keys and half with missing ones.
+// Memory is what malloc reports in use (glibc's mallinfo2), per key; the
+// rates count one op per add or lookup.
+//
+// Usage: bench_set [num_ops=4000000]
+
+static const int kSizes[] = {100, 10000, 100000, 1000000, 4000000};
+
+static void NoOpFree(HTValue_t value) { }
+
+static size_t InUse(void) {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+int main(int argc, char **argv) {
+  int num_ops = Bench_IntArg(argc, argv, 1, 4000000);
+  size_t s;
+  int use_set;
+
+  printf("%d lookups\n", num_ops);
+  printf("           %-28s %s\n", "HashTable, NULL values", "HashSet");
+  printf("     keys  B/key    add/s  contains/s  B/key    add/s  "
+         "contains/s\n");
+  for (s = 0; s < sizeof(kSizes) / sizeof(kSizes[0]); s++) {
+    int size = kSizes[s];
+
+    printf("  %7d", size);
+    for (use_set = 0; use_set <= 1; use_set++) {
+      HashTable *table = NULL;
+      HashSet *hs = NULL;
+      uint64_t state = 1, hits = 0;
+      size_t before = InUse(), bytes;
+      double start, add_secs, find_secs;
+      int i;
+
+      // Present keys are odd.
+      start = Bench_Now();
+      if (use_set) {
+        hs = HashSet_Allocate(16);
+        for (i = 0; i < size; i++) {
+          HashSet_Add(hs, Bench_Rand(&state) | 1);
+        }
+      } else {
+        table = HashTable_Allocate(16);
+        for (i = 0; i < size; i++) {
+          HTKeyValue_t kv = {Bench_Rand(&state) | 1, NULL}, old;
+          HashTable_Insert(table, kv, &old);
+        }
+      }
+      add_secs = Bench_Now() - start;
+      bytes = InUse() - before;
+
+      // Replay the keys, each followed by a missing (even) one.
+      start = Bench_Now();
+      for (i = 0; i < num_ops / 2; i++) {
+        HTKey_t key;
+
+        if (i % size == 0) {
+          state = 1;
+        }
+        key = Bench_Rand(&state) | 1;
+        if (use_set) {
+          hits += HashSet_Contains(hs, key);
+          hits += HashSet_Contains(hs, key - 1);
+        } else {
+          HTKeyValue_t kv;
+          hits += HashTable_Find(table, key, &kv);
+          hits += HashTable_Find(table, key - 1, &kv);
+        }
+      }
+      find_secs = Bench_Now() - start;
+      Verify333(hits == (uint64_t) (num_ops / 2));
+      Bench_Consume(hits);
+
+      printf("  %5.1f  %6.2fM  %9.2fM", (double) bytes / size,
+             size / add_secs / 1e6, 2.0 * (num_ops / 2) / find_secs / 1e6);
+      if (use_set) {
+        HashSet_Free(hs);
+      } else {
+        HashTable_Free(table, &NoOpFree);
+      }
+    }
+    printf("\n");
+  }
+  return EXIT_SUCCESS;
+}
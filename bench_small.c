@@ -0,0 +1,108 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Many tiny tables: a table from HashTable_AllocateSmall, which keeps up
+// to eight entries inline, against the smallest ordinary table,
+// HashTable_Allocate(1).
+//
+// For each table size, num_tables tables are filled with that many random
+// keys, then each table is looked up twice per key, once with a present
+// key and once with a missing one.  Memory is what malloc reports in use
+// (glibc's mallinfo2), so it includes malloc's own overhead; the rates
+// count one op per insert or lookup.
+//
+// Usage: bench_small [num_tables=20000]
+
+static const int kSizes[] = {0, 1, 2, 3, 4, 6, 8, 9, 12, 16, 24, 32};
+
+static void NoOpFree(HTValue_t value) { }
+
+int main(int argc, char **argv) {
+  int num_tables = Bench_IntArg(argc, argv, 1, 20000);
+  HashTable **tables = (HashTable **) malloc(num_tables * sizeof(HashTable *));
+  size_t s;
+  int small;
+
+  Verify333(tables != NULL);
+  printf("%d tables\n", num_tables);
+  printf("          %-28s %s\n", "HashTable_Allocate(1)",
+         "HashTable_AllocateSmall");
+  printf("  keys    bytes  insert/s  find/s    bytes  insert/s  find/s\n");
+  for (s = 0; s < sizeof(kSizes) / sizeof(kSizes[0]); s++) {
+    int size = kSizes[s];
+
+    printf("  %4d", size);
+    for (small = 0; small <= 1; small++) {
+      uint64_t state = 1 + size, hits = 0;
+      size_t before;
+      double start, insert_secs, find_secs;
+      int t, i;
+
+      before = mallinfo2().uordblks;
+      start = Bench_Now();
+      for (t = 0; t < num_tables; t++) {
+        HTKeyValue_t kv, old;
+
+        tables[t] = small ? HashTable_AllocateSmall() : HashTable_Allocate(1);
+        for (i = 0; i < size; i++) {
+          kv.key = Bench_Rand(&state) | 1;  // present keys are odd
+          kv.value = NULL;
+          HashTable_Insert(tables[t], kv, &old);
+        }
+      }
+      insert_secs = Bench_Now() - start;
+
+      // Replay the same keys, interleaved with even (missing) ones.
+      state = 1 + size;
+      start = Bench_Now();
+      for (t = 0; t < num_tables; t++) {
+        HTKeyValue_t kv;
+
+        for (i = 0; i < size; i++) {
+          HTKey_t key = Bench_Rand(&state) | 1;
+          hits += HashTable_Find(tables[t], key, &kv);
+          hits += HashTable_Find(tables[t], key - 1, &kv);
+        }
+      }
+      find_secs = Bench_Now() - start;
+      Verify333(hits == (uint64_t) num_tables * size);
+      Bench_Consume(hits);
+
+      printf("  %7.0f", (double) (mallinfo2().uordblks - before) / num_tables);
+      if (size == 0) {
+        printf("  %8s  %6s", "-", "-");
+      } else {
+        printf("  %7.1fM  %5.1fM",
+               (double) num_tables * size / insert_secs / 1e6,
+               2.0 * num_tables * size / find_secs / 1e6);
+      }
+      for (t = 0; t < num_tables; t++) {
+        HashTable_Free(tables[t], &NoOpFree);
+      }
+    }
+    printf("\n");
+  }
+
+  free(tables);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <utility>
+
+extern "C" {
+  #include "./CSE333.h"
+  #include "./HashTable.h"
+  #include "./bench_common.h"
+}
+
+#include "./StaticHashTable.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// A fixed set of NUM_KEYS keys, looked up in a StaticHashTable that the
+// compiler built and in a HashTable built with HashTable_Insert at startup.
+//
+// The keys are random 64-bit values, picked at compile time.  The runtime
+// table's startup is the time to allocate and fill it; the static table
+// has none.  Lookups go through the C-callable find function, the way C
+// code would call it, and through HashTable_Find: random present keys,
+// then random missing ones.
+//
+// Usage: bench_static [num_lookups=10000000]
+
+#define NUM_KEYS 2048
+
+namespace {
+
+constexpr uint64_t KeyAt(uint64_t i) {
+  uint64_t x = (i + 1) * 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 31)) * 0xbf58476d1ce4e5b9ULL;
+  return x ^ (x >> 29);
+}
+
+template <size_t... I>
+constexpr auto MakeKeys(std::index_sequence<I...>) {
+  return hw1::MakeStaticHashTable<uint32_t>(
+      {hw1::StaticEntry<uint32_t>{KeyAt(I), I}...});
+}
+
+constexpr auto kTable = MakeKeys(std::make_index_sequence<NUM_KEYS>());
+
+}  // anonymous namespace
+
+HW1_STATIC_HASHTABLE_FIND_FN(Static_Find, kTable)
+
+static void NoOpFree(HTValue_t value) { }
+
+// Times num_lookups lookups of keys with find, or with HashTable_Find on
+// ht if find is NULL, and prints ns per lookup.
+static void TimeLookups(bool (*find)(HTKey_t, HTKeyValue_t *), HashTable *ht,
+                        const char *what, const HTKey_t *keys,
+                        int num_lookups) {
+  HTKeyValue_t kv;
+  uint64_t hits = 0;
+  double start, secs;
+  int i;
+
+  start = Bench_Now();
+  if (find != NULL) {
+    for (i = 0; i < num_lookups; i++) {
+      hits += find(keys[i], &kv);
+    }
+  } else {
+    for (i = 0; i < num_lookups; i++) {
+      hits += HashTable_Find(ht, keys[i], &kv);
+    }
+  }
+  secs = Bench_Now() - start;
+  Bench_Consume(hits);
+  printf("    %-5s %6.1f ns/lookup\n", what, secs / num_lookups * 1e9);
+}
+
+int main(int argc, char **argv) {
+  int num_lookups = Bench_IntArg(argc, argv, 1, 10000000);
+  HTKey_t *hits = static_cast<HTKey_t *>(malloc(num_lookups * sizeof(HTKey_t)));
+  HTKey_t *misses =
+      static_cast<HTKey_t *>(malloc(num_lookups * sizeof(HTKey_t)));
+  uint64_t state = 1;
+  double start, startup_secs;
+  HashTable *ht;
+  int i;
+
+  Verify333(hits != NULL && misses != NULL);
+  for (i = 0; i < num_lookups; i++) {
+    hits[i] = KeyAt(Bench_Rand(&state) % NUM_KEYS);
+    misses[i] = Bench_Rand(&state);
+  }
+  printf("%d keys, %d lookups\n", NUM_KEYS, num_lookups);
+
+  start = Bench_Now();
+  ht = HashTable_Allocate(NUM_KEYS);
+  for (i = 0; i < NUM_KEYS; i++) {
+    HTKeyValue_t kv = {KeyAt(i), reinterpret_cast<HTValue_t>(i)}, old;
+    HashTable_Insert(ht, kv, &old);
+  }
+  startup_secs = Bench_Now() - start;
+
+  printf("  HashTable: startup %.1f us\n", startup_secs * 1e6);
+  TimeLookups(NULL, ht, "hit", hits, num_lookups);
+  TimeLookups(NULL, ht, "miss", misses, num_lookups);
+  printf("  StaticHashTable: startup 0 us, %zu bytes of read-only data\n",
+         sizeof(kTable));
+  TimeLookups(&Static_Find, NULL, "hit", hits, num_lookups);
+  TimeLookups(&Static_Find, NULL, "miss", misses, num_lookups);
+
+  HashTable_Free(ht, &NoOpFree);
+  free(hits);
+  free(misses);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Lookups in a chain of forced collisions, with and without a tree.
+//
+// For each chain length, a table starting with one bucket is filled with
+// that many multiples of 9^8, which all land in bucket 0 however often the
+// table resizes, so every key shares one chain.  A multimap never gives
+// its chains trees, so it stands in for a table without them; its keys
+// are distinct here, so it holds the same chain (though its inserts are
+// cheaper, since they don't look for the key first).  Each table is
+// looked up at random present keys, at the key deepest in the chain (the
+// first inserted, now at its tail), and at missing keys, which a plain
+// chain must walk to the end.  The rates are in ns per op; each kind of lookup
+// runs num_ops / length times (at least 1000), so long chains finish.
+// Memory is what malloc reports in use (glibc's mallinfo2), per key.
+//
+// Usage: bench_treeify [num_ops=20000000]
+
+static const HTKey_t kStride = 43046721;  // 9^8
+static const int kLengths[] = {8, 16, 128, 1024, 8192};
+
+static void NoOpFree(HTValue_t value) { }
+
+static size_t InUse(void) {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+int main(int argc, char **argv) {
+  int num_ops = Bench_IntArg(argc, argv, 1, 20000000);
+  size_t l;
+  int with_tree;
+
+  printf("%d ops per length\n", num_ops);
+  printf("            %-34s %s\n", "plain chain", "chain with a tree");
+  printf("  length  B/key  ins ns  hit ns  tail ns  miss ns  B/key  ins ns  "
+         "hit ns  tail ns  miss ns\n");
+  for (l = 0; l < sizeof(kLengths) / sizeof(kLengths[0]); l++) {
+    int length = kLengths[l];
+    int ops = num_ops / length > 1000 ? num_ops / length : 1000;
+
+    printf("  %6d", length);
+    for (with_tree = 0; with_tree <= 1; with_tree++) {
+      uint64_t state = 1, hits = 0;
+      size_t before = InUse(), bytes;
+      double start, insert_secs, hit_secs, tail_secs, miss_secs;
+      HashTable *table;
+      HTKeyValue_t kv;
+      int i;
+
+      start = Bench_Now();
+      table = with_tree ? HashTable_Allocate(1) : HashTable_AllocateMulti(1);
+      for (i = 1; i <= length; i++) {
+        HTKeyValue_t newkv = {i * kStride, NULL}, old;
+        HashTable_Insert(table, newkv, &old);
+      }
+      insert_secs = Bench_Now() - start;
+      bytes = InUse() - before;
+
+      start = Bench_Now();
+      for (i = 0; i < ops; i++) {
+        hits += HashTable_Find(table,
+                               (1 + Bench_Rand(&state) % length) * kStride,
+                               &kv);
+      }
+      hit_secs = Bench_Now() - start;
+      start = Bench_Now();
+      for (i = 0; i < ops; i++) {
+        hits += HashTable_Find(table, kStride, &kv);
+      }
+      tail_secs = Bench_Now() - start;
+      start = Bench_Now();
+      for (i = 0; i < ops; i++) {
+        hits += HashTable_Find(table,
+                               (length + 1 + Bench_Rand(&state) % length) *
+                               kStride, &kv);
+      }
+      miss_secs = Bench_Now() - start;
+      Verify333(hits == 2 * (uint64_t) ops);
+      Bench_Consume(hits);
+
+      printf("  %5.1f  %6.0f  %6.0f  %7.0f  %7.0f", (double) bytes / length,
+             insert_secs / length * 1e9, hit_secs / ops * 1e9,
+             tail_secs / ops * 1e9, miss_secs / ops * 1e9);
+      HashTable_Free(table, &NoOpFree);
+    }
+    printf("\n");
+  }
+  return EXIT_SUCCESS;
+}
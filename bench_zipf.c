@@ -0,0 +1,127 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "CSE333.h"
+#include "HashTable.h"
+#include "bench_common.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// HashTable_Find under each chain policy (see HashTable_SetChainPolicy),
+// for lookups that follow a Zipf(0.99) distribution -- the i-th most
+// popular key is looked up in proportion to 1 / i^0.99 -- and for uniform
+// lookups, which a self-organizing chain can't help and only pays for.
+//
+// The table holds num_keys random keys at a load factor of 3, the longest
+// chains it allows before resizing.  Each policy gets a freshly built
+// table and the same sequence of lookups, so its time includes the
+// reordering it does as the sequence runs.
+//
+// Usage: bench_zipf [num_keys=1000000] [num_lookups=4000000]
+
+#define ZIPF_S 0.99
+
+static void NoOpFree(HTValue_t value) { }
+
+// Fills keys with num_lookups picks from present: Zipf-distributed ranks if
+// cdf is non-NULL (cdf[i] is the probability of a rank <= i), else uniform.
+static void PickKeys(const HTKey_t *present, int num_keys, const double *cdf,
+                     HTKey_t *keys, int num_lookups, uint64_t *state) {
+  int i;
+
+  for (i = 0; i < num_lookups; i++) {
+    int lo = 0, hi = num_keys - 1;
+    double u;
+
+    if (cdf == NULL) {
+      keys[i] = present[Bench_Rand(state) % num_keys];
+      continue;
+    }
+    // Binary search for the first rank whose cdf reaches u.
+    u = (double) (Bench_Rand(state) >> 11) / (double) (1ULL << 53);
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (cdf[mid] < u) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    keys[i] = present[lo];
+  }
+}
+
+int main(int argc, char **argv) {
+  static const char *kPolicyNames[] = {"static", "move-to-front",
+                                       "transpose"};
+  int num_keys = Bench_IntArg(argc, argv, 1, 1000000);
+  int num_lookups = Bench_IntArg(argc, argv, 2, 4000000);
+  HTKey_t *present = (HTKey_t *) malloc(num_keys * sizeof(HTKey_t));
+  HTKey_t *keys = (HTKey_t *) malloc(num_lookups * sizeof(HTKey_t));
+  double *cdf = (double *) malloc(num_keys * sizeof(double));
+  double sum = 0;
+  uint64_t state = 1;
+  int i, zipf;
+
+  Verify333(present != NULL && keys != NULL && cdf != NULL);
+  for (i = 0; i < num_keys; i++) {
+    present[i] = Bench_Rand(&state);
+    sum += 1.0 / pow(i + 1, ZIPF_S);
+    cdf[i] = sum;
+  }
+  for (i = 0; i < num_keys; i++) {
+    cdf[i] /= sum;
+  }
+
+  printf("%d keys, %d lookups, load factor 3\n", num_keys, num_lookups);
+  for (zipf = 1; zipf >= 0; zipf--) {
+    HTChainPolicy policy;
+
+    PickKeys(present, num_keys, zipf ? cdf : NULL, keys, num_lookups,
+             &state);
+    printf("  %s lookups:\n", zipf ? "Zipf(0.99)" : "uniform");
+    for (policy = HT_CHAIN_STATIC; policy <= HT_CHAIN_TRANSPOSE; policy++) {
+      HashTable *ht = HashTable_Allocate((num_keys + 2) / 3);
+      HTKeyValue_t kv, old;
+      uint64_t hits = 0;
+      double start, secs;
+
+      for (i = 0; i < num_keys; i++) {
+        kv.key = present[i];
+        kv.value = NULL;
+        HashTable_Insert(ht, kv, &old);
+      }
+      HashTable_SetChainPolicy(ht, policy);
+      start = Bench_Now();
+      for (i = 0; i < num_lookups; i++) {
+        hits += HashTable_Find(ht, keys[i], &kv);
+      }
+      secs = Bench_Now() - start;
+      Verify333(hits == (uint64_t) num_lookups);
+      Bench_Consume(hits);
+
+      printf("    %-14s %6.1f ns/lookup\n", kPolicyNames[policy],
+             secs / num_lookups * 1e9);
+      HashTable_Free(ht, &NoOpFree);
+    }
+  }
+
+  free(present);
+  free(keys);
+  free(cdf);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <map>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./AggregateTable.h"
+  #include "./AggregateTable_priv.h"
+}
+
+#include "./test_suite.h"
+
+namespace hw1 {
+
+namespace {
+// Collects drained (key,value)s into a std::map.
+void CollectInto(HTKey_t key, uint64_t value, void *ctx) {
+  std::map<HTKey_t, uint64_t> *out =
+      static_cast<std::map<HTKey_t, uint64_t> *>(ctx);
+  ASSERT_EQ(0U, out->count(key));
+  (*out)[key] = value;
+}
+
+static const int kThreads = 4;
+static const int kKeys = 100;
+static const int kBumpsPerThread = 20000;
+
+struct BumpState {
+  AggregateTable *table;
+  int thread_id;
+};
+
+void *Bump(void *arg) {
+  BumpState *st = static_cast<BumpState *>(arg);
+  for (int i = 0; i < kBumpsPerThread; i++) {
+    HTKey_t key = i % kKeys;
+    AggregateTable_AddU64(st->table, key, 1);
+    AggregateTable_MaxU64(st->table, kKeys + key,
+                          st->thread_id * kBumpsPerThread + i);
+  }
+  return NULL;
+}
+}  // anonymous namespace
+
+TEST(Test_AggregateTable, AllocFree) {
+  AggregateTable *table = AggregateTable_Allocate(10);
+  ASSERT_EQ(0, AggregateTable_NumElements(table));
+  // At least twice as many slots as keys, and a power of two.
+  ASSERT_LE(20U, table->mask + 1);
+  ASSERT_EQ(0U, (table->mask + 1) & table->mask);
+
+  uint64_t v = 7;
+  ASSERT_FALSE(AggregateTable_Find(table, 3, &v));
+  ASSERT_EQ(7U, v);
+  AggregateTable_Free(table);
+}
+
+TEST(Test_AggregateTable, SumMinMax) {
+  AggregateTable *table = AggregateTable_Allocate(10);
+  uint64_t v;
+
+  ASSERT_TRUE(AggregateTable_AddU64(table, 1, 5));
+  ASSERT_TRUE(AggregateTable_AddU64(table, 1, 7));
+  ASSERT_TRUE(AggregateTable_MinU64(table, 2, 50));
+  ASSERT_TRUE(AggregateTable_MinU64(table, 2, 70));
+  ASSERT_TRUE(AggregateTable_MinU64(table, 2, 30));
+  ASSERT_TRUE(AggregateTable_MaxU64(table, 3, 50));
+  ASSERT_TRUE(AggregateTable_MaxU64(table, 3, 30));
+  ASSERT_TRUE(AggregateTable_MaxU64(table, 3, 70));
+  ASSERT_EQ(3, AggregateTable_NumElements(table));
+
+  ASSERT_TRUE(AggregateTable_Find(table, 1, &v));
+  ASSERT_EQ(12U, v);
+  ASSERT_TRUE(AggregateTable_Find(table, 2, &v));
+  ASSERT_EQ(30U, v);
+  ASSERT_TRUE(AggregateTable_Find(table, 3, &v));
+  ASSERT_EQ(70U, v);
+  ASSERT_FALSE(AggregateTable_Find(table, 4, &v));
+
+  AggregateTable_Free(table);
+}
+
+TEST(Test_AggregateTable, FullTable) {
+  AggregateTable *table = AggregateTable_Allocate(1);
+  int capacity = static_cast<int>(table->mask + 1);
+
+  for (int i = 0; i < capacity; i++) {
+    ASSERT_TRUE(AggregateTable_AddU64(table, i, 1));
+  }
+  ASSERT_FALSE(AggregateTable_AddU64(table, capacity, 1));
+  // Existing keys can still be updated, and misses still terminate.
+  ASSERT_TRUE(AggregateTable_AddU64(table, 0, 1));
+  uint64_t v;
+  ASSERT_FALSE(AggregateTable_Find(table, capacity, &v));
+  ASSERT_TRUE(AggregateTable_Find(table, 0, &v));
+  ASSERT_EQ(2U, v);
+
+  AggregateTable_Free(table);
+}
+
+TEST(Test_AggregateTable, DrainAndMerge) {
+  AggregateTable *src = AggregateTable_Allocate(10);
+  AggregateTable *dst = AggregateTable_Allocate(10);
+  std::map<HTKey_t, uint64_t> drained;
+  uint64_t v;
+
+  AggregateTable_AddU64(src, 1, 5);
+  AggregateTable_MinU64(src, 2, 9);
+  AggregateTable_MaxU64(src, 3, 4);
+  AggregateTable_AddU64(src, 4, 0);   // never moves off the identity
+
+  AggregateTable_Drain(src, &CollectInto, &drained);
+  ASSERT_EQ(3U, drained.size());
+  ASSERT_EQ(5U, drained[1]);
+  ASSERT_EQ(9U, drained[2]);
+  ASSERT_EQ(4U, drained[3]);
+
+  // Keys remain, reset to the identity of their operation.
+  ASSERT_EQ(4, AggregateTable_NumElements(src));
+  ASSERT_TRUE(AggregateTable_Find(src, 2, &v));
+  ASSERT_EQ(UINT64_MAX, v);
+  drained.clear();
+  AggregateTable_Drain(src, &CollectInto, &drained);
+  ASSERT_EQ(0U, drained.size());
+
+  // Merging combines with each key's own operation.
+  AggregateTable_AddU64(src, 1, 5);
+  AggregateTable_MinU64(src, 2, 9);
+  AggregateTable_MaxU64(src, 3, 4);
+  AggregateTable_AddU64(dst, 1, 10);
+  AggregateTable_MinU64(dst, 2, 3);
+  ASSERT_TRUE(AggregateTable_Merge(dst, src));
+  ASSERT_TRUE(AggregateTable_Find(dst, 1, &v));
+  ASSERT_EQ(15U, v);
+  ASSERT_TRUE(AggregateTable_Find(dst, 2, &v));
+  ASSERT_EQ(3U, v);
+  ASSERT_TRUE(AggregateTable_Find(dst, 3, &v));
+  ASSERT_EQ(4U, v);
+  ASSERT_TRUE(AggregateTable_Find(src, 1, &v));
+  ASSERT_EQ(0U, v);
+
+  AggregateTable_Free(src);
+  AggregateTable_Free(dst);
+}
+
+TEST(Test_AggregateTable, ConcurrentUpdates) {
+  AggregateTable *table = AggregateTable_Allocate(2 * kKeys);
+  pthread_t threads[kThreads];
+  BumpState states[kThreads];
+
+  for (int t = 0; t < kThreads; t++) {
+    states[t] = {table, t};
+    ASSERT_EQ(0, pthread_create(&threads[t], NULL, &Bump, &states[t]));
+  }
+  for (int t = 0; t < kThreads; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  ASSERT_EQ(2 * kKeys, AggregateTable_NumElements(table));
+  for (int k = 0; k < kKeys; k++) {
+    uint64_t v;
+    ASSERT_TRUE(AggregateTable_Find(table, k, &v));
+    ASSERT_EQ(static_cast<uint64_t>(kThreads * kBumpsPerThread / kKeys), v);
+  }
+  // The largest value written for key kKeys + j comes from the last thread.
+  for (int j = 0; j < kKeys; j++) {
+    uint64_t v, last = 0;
+    for (int i = j; i < kBumpsPerThread; i += kKeys) {
+      last = (kThreads - 1) * kBumpsPerThread + i;
+    }
+    ASSERT_TRUE(AggregateTable_Find(table, kKeys + j, &v));
+    ASSERT_EQ(last, v);
+  }
+
+  AggregateTable_Free(table);
+}
+
+}  // namespace hw1
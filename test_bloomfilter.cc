@@ -0,0 +1,86 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./BloomFilter.h"
+  #include "./BloomFilter_priv.h"
+  #include "./Hash.h"
+}
+
+#include "./test_suite.h"
+
+namespace hw1 {
+
+namespace {
+// Well-mixed, distinct hashes for the test keys.
+uint64_t Mixed(uint64_t i) {
+  return WyHash64(&i, sizeof(i), 0);
+}
+}  // anonymous namespace
+
+TEST(Test_BloomFilter, NoFalseNegatives) {
+  BloomFilter *filter = BloomFilter_Allocate(1000, 0.01);
+
+  for (uint64_t i = 0; i < 1000; i++) {
+    ASSERT_FALSE(BloomFilter_MayContain(filter, Mixed(i)) && i == 0);
+    BloomFilter_Add(filter, Mixed(i));
+    ASSERT_TRUE(BloomFilter_MayContain(filter, Mixed(i)));
+  }
+  for (uint64_t i = 0; i < 1000; i++) {
+    ASSERT_TRUE(BloomFilter_MayContain(filter, Mixed(i)));
+  }
+
+  // Past its capacity it still never forgets.
+  for (uint64_t i = 1000; i < 5000; i++) {
+    BloomFilter_Add(filter, Mixed(i));
+  }
+  for (uint64_t i = 0; i < 5000; i++) {
+    ASSERT_TRUE(BloomFilter_MayContain(filter, Mixed(i)));
+  }
+  BloomFilter_Free(filter);
+}
+
+TEST(Test_BloomFilter, FalsePositiveRate) {
+  static const int kCapacity = 20000;
+  static const int kProbes = 200000;
+  const double rates[] = {0.5, 0.1, 0.01, 0.001};
+  size_t last_size = 0;
+
+  for (double rate : rates) {
+    BloomFilter *filter = BloomFilter_Allocate(kCapacity, rate);
+
+    // The bits are in whole, cache-line-aligned blocks.
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(filter->blocks) % 64);
+    ASSERT_EQ(filter->num_blocks * 64U, BloomFilter_SizeBytes(filter));
+    ASSERT_LT(last_size, BloomFilter_SizeBytes(filter));
+    last_size = BloomFilter_SizeBytes(filter);
+
+    // Full to capacity, the filter lets through about fp_rate of the
+    // hashes it never saw, and not many more.
+    for (uint64_t i = 0; i < kCapacity; i++) {
+      BloomFilter_Add(filter, Mixed(i));
+    }
+    int false_positives = 0;
+    for (uint64_t i = 0; i < kProbes; i++) {
+      false_positives += BloomFilter_MayContain(filter, Mixed(kCapacity + i));
+    }
+    double measured = static_cast<double>(false_positives) / kProbes;
+    ASSERT_LT(measured, 1.25 * rate);
+    ASSERT_GT(measured, 0.25 * rate);
+    BloomFilter_Free(filter);
+  }
+}
+
+}  // namespace hw1
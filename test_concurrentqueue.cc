@@ -0,0 +1,218 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./ConcurrentQueue.h"
+  #include "./ConcurrentQueue_priv.h"
+}
+
+#include "./test_suite.h"
+
+namespace hw1 {
+
+namespace {
+// Payloads are small integers cast to pointers; 0 is never used so that a
+// NULL payload always indicates a bug.
+LLPayload_t AsPayload(uintptr_t i) {
+  return reinterpret_cast<LLPayload_t>(i);
+}
+
+static const int kProducers = 4;
+static const int kConsumers = 4;
+static const int kItemsPerProducer = 20000;
+
+// Shared between the producer and consumer threads of the stress tests.
+struct StressState {
+  ConcurrentQueue *queue;
+  int producer_id;
+  std::vector<int> *seen;   // per-item pop counts, indexed by item - 1
+  pthread_mutex_t *seen_lock;
+};
+
+void *Producer(void *arg) {
+  StressState *st = static_cast<StressState *>(arg);
+  for (int i = 0; i < kItemsPerProducer; i++) {
+    uintptr_t item = 1 + st->producer_id * kItemsPerProducer + i;
+    ConcurrentQueue_Append(st->queue, AsPayload(item));
+  }
+  return NULL;
+}
+
+void *Consumer(void *arg) {
+  StressState *st = static_cast<StressState *>(arg);
+  std::vector<uintptr_t> mine;
+  LLPayload_t batch[16];
+  int n;
+
+  // Mix single and batched pops; both must hand each item out exactly once.
+  while ((n = ConcurrentQueue_PopBatch(st->queue, batch, 16, true)) > 0) {
+    for (int i = 0; i < n; i++) {
+      mine.push_back(reinterpret_cast<uintptr_t>(batch[i]));
+    }
+    LLPayload_t p;
+    if (ConcurrentQueue_Pop(st->queue, &p)) {
+      mine.push_back(reinterpret_cast<uintptr_t>(p));
+    }
+  }
+
+  pthread_mutex_lock(st->seen_lock);
+  for (uintptr_t item : mine) {
+    (*st->seen)[item - 1]++;
+  }
+  pthread_mutex_unlock(st->seen_lock);
+  return NULL;
+}
+}  // anonymous namespace
+
+class Test_ConcurrentQueue : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    freeInvocations_ = 0;
+  }
+
+  // Counts how many times it's been invoked; the payloads were never
+  // allocated, so there's nothing to actually free.
+  static int freeInvocations_;
+  static void StubbedFree(LLPayload_t payload) {
+    ASSERT_TRUE(payload != NULL);
+    freeInvocations_++;
+  }
+};  // class Test_ConcurrentQueue
+
+// statics:
+int Test_ConcurrentQueue::freeInvocations_;
+
+TEST_F(Test_ConcurrentQueue, AllocFree) {
+  ConcurrentQueue *q = ConcurrentQueue_Allocate();
+  ASSERT_TRUE(q != NULL);
+  ASSERT_TRUE(q->head != NULL);
+  ASSERT_EQ(q->head, q->tail);
+  ASSERT_TRUE(ConcurrentQueue_IsEmpty(q));
+
+  LLPayload_t p = AsPayload(99);
+  ASSERT_FALSE(ConcurrentQueue_Pop(q, &p));
+  ASSERT_EQ(AsPayload(99), p);
+
+  ConcurrentQueue_Free(q, &Test_ConcurrentQueue::StubbedFree);
+  ASSERT_EQ(0, freeInvocations_);
+}
+
+TEST_F(Test_ConcurrentQueue, AppendPopIsFIFO) {
+  ConcurrentQueue *q = ConcurrentQueue_Allocate();
+  LLPayload_t p;
+
+  for (uintptr_t i = 1; i <= 5; i++) {
+    ConcurrentQueue_Append(q, AsPayload(i));
+  }
+  ASSERT_FALSE(ConcurrentQueue_IsEmpty(q));
+  for (uintptr_t i = 1; i <= 3; i++) {
+    ASSERT_TRUE(ConcurrentQueue_Pop(q, &p));
+    ASSERT_EQ(AsPayload(i), p);
+  }
+
+  // Interleave appends with the remaining pops.
+  ConcurrentQueue_Append(q, AsPayload(6));
+  for (uintptr_t i = 4; i <= 6; i++) {
+    ASSERT_TRUE(ConcurrentQueue_Pop(q, &p));
+    ASSERT_EQ(AsPayload(i), p);
+  }
+  ASSERT_FALSE(ConcurrentQueue_Pop(q, &p));
+  ASSERT_TRUE(ConcurrentQueue_IsEmpty(q));
+
+  // Whatever is left when we free the queue goes to the free function.
+  ConcurrentQueue_Append(q, AsPayload(7));
+  ConcurrentQueue_Append(q, AsPayload(8));
+  ConcurrentQueue_Free(q, &Test_ConcurrentQueue::StubbedFree);
+  ASSERT_EQ(2, freeInvocations_);
+}
+
+TEST_F(Test_ConcurrentQueue, PopBatch) {
+  ConcurrentQueue *q = ConcurrentQueue_Allocate();
+  LLPayload_t batch[4];
+
+  ASSERT_EQ(0, ConcurrentQueue_PopBatch(q, batch, 4, false));
+  for (uintptr_t i = 1; i <= 6; i++) {
+    ConcurrentQueue_Append(q, AsPayload(i));
+  }
+  ASSERT_EQ(4, ConcurrentQueue_PopBatch(q, batch, 4, false));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ(AsPayload(i + 1), batch[i]);
+  }
+  ASSERT_EQ(2, ConcurrentQueue_PopBatch(q, batch, 4, true));
+  ASSERT_EQ(AsPayload(5), batch[0]);
+  ASSERT_EQ(AsPayload(6), batch[1]);
+
+  // A waiting pop on a closed, empty queue returns immediately.
+  ConcurrentQueue_Close(q);
+  ASSERT_EQ(0, ConcurrentQueue_PopBatch(q, batch, 4, true));
+  ASSERT_FALSE(ConcurrentQueue_PopWait(q, &batch[0]));
+
+  ConcurrentQueue_Free(q, &Test_ConcurrentQueue::StubbedFree);
+  ASSERT_EQ(0, freeInvocations_);
+}
+
+TEST_F(Test_ConcurrentQueue, ReclaimsPoppedNodes) {
+  ConcurrentQueue *q = ConcurrentQueue_Allocate();
+  LLPayload_t p;
+
+  for (uintptr_t i = 1; i <= 1000; i++) {
+    ConcurrentQueue_Append(q, AsPayload(i));
+    ASSERT_TRUE(ConcurrentQueue_Pop(q, &p));
+  }
+  // No hazards are published between operations, so every retired node
+  // can be freed.
+  ASSERT_EQ(0, CQReclaim());
+
+  ConcurrentQueue_Free(q, &Test_ConcurrentQueue::StubbedFree);
+}
+
+TEST_F(Test_ConcurrentQueue, MultiProducerMultiConsumer) {
+  ConcurrentQueue *q = ConcurrentQueue_Allocate();
+  std::vector<int> seen(kProducers * kItemsPerProducer, 0);
+  pthread_mutex_t seen_lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_t producers[kProducers], consumers[kConsumers];
+  StressState pstate[kProducers], cstate;
+
+  cstate = {q, -1, &seen, &seen_lock};
+  for (int i = 0; i < kConsumers; i++) {
+    ASSERT_EQ(0, pthread_create(&consumers[i], NULL, &Consumer, &cstate));
+  }
+  for (int i = 0; i < kProducers; i++) {
+    pstate[i] = {q, i, &seen, &seen_lock};
+    ASSERT_EQ(0, pthread_create(&producers[i], NULL, &Producer, &pstate[i]));
+  }
+
+  for (int i = 0; i < kProducers; i++) {
+    pthread_join(producers[i], NULL);
+  }
+  // Once the producers are done, closing the queue lets the consumers
+  // drain what's left and exit.
+  ConcurrentQueue_Close(q);
+  for (int i = 0; i < kConsumers; i++) {
+    pthread_join(consumers[i], NULL);
+  }
+
+  for (size_t i = 0; i < seen.size(); i++) {
+    ASSERT_EQ(1, seen[i]) << "item " << i + 1;
+  }
+  ASSERT_TRUE(ConcurrentQueue_IsEmpty(q));
+  ConcurrentQueue_Free(q, &Test_ConcurrentQueue::StubbedFree);
+  ASSERT_EQ(0, freeInvocations_);
+}
+
+}  // namespace hw1
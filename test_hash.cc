@@ -0,0 +1,265 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./Hash.h"
+  #include "./Hash_priv.h"
+  #include "./HashTable.h"
+}
+
+#include "./test_suite.h"
+
+namespace hw1 {
+
+namespace {
+// Counts the keys landing in each of num_buckets buckets, the way
+// HashKeyToBucketNum assigns them, and returns the chi-squared statistic
+// against a uniform distribution.  For a good hash it is close to
+// num_buckets - 1, give or take a few times sqrt(2 * num_buckets).
+double ChiSquared(const uint64_t *keys, int num_keys, int num_buckets) {
+  int *counts = new int[num_buckets]();
+  for (int i = 0; i < num_keys; i++) {
+    counts[keys[i] % num_buckets]++;
+  }
+  double expected = static_cast<double>(num_keys) / num_buckets;
+  double chi2 = 0;
+  for (int b = 0; b < num_buckets; b++) {
+    chi2 += (counts[b] - expected) * (counts[b] - expected) / expected;
+  }
+  delete[] counts;
+  return chi2;
+}
+
+uint64_t Xorshift(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+}  // anonymous namespace
+
+TEST(Test_Hash, KnownValues) {
+  // Reference values from the xxHash distribution.
+  ASSERT_EQ(0xef46db3751d8e999ULL, XXHash64("", 0, 0));
+  ASSERT_EQ(0xd24ec4f1a98c6e5bULL, XXHash64("a", 1, 0));
+  ASSERT_EQ(0x44bc2cf5ad770999ULL, XXHash64("abc", 3, 0));
+
+  // The SipHash-2-4 paper's test vector: key 00..0f, message 00..0e.
+  unsigned char msg[15];
+  for (int i = 0; i < 15; i++) {
+    msg[i] = static_cast<unsigned char>(i);
+  }
+  ASSERT_EQ(0xa129ca6149be45e5ULL,
+            SipHash64(msg, 15, 0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL));
+
+  // The FNV entry with a zero seed is FNVHash64.
+  unsigned char buf[100];
+  for (int i = 0; i < 100; i++) {
+    buf[i] = static_cast<unsigned char>(i * 7 + 3);
+  }
+  HashFnPtr fnv = Hash_Function(HASH_FNV1A);
+  for (int len = 0; len <= 100; len++) {
+    ASSERT_EQ(FNVHash64(buf, len), fnv(buf, len, 0));
+  }
+  ASSERT_NE(FNVHash64(buf, 100), fnv(buf, 100, 1));
+
+  ASSERT_EQ(&XXHash64, Hash_Function(HASH_XXHASH64));
+  ASSERT_EQ(&WyHash64, Hash_Function(HASH_WYHASH64));
+  ASSERT_EQ(WyHash64(buf, 50, 9), Hash_Bytes(HASH_WYHASH64, buf, 50, 9));
+}
+
+TEST(Test_Hash, EveryByteCounts) {
+  // Each length exercises a different mix of the word, half-word and byte
+  // paths; changing any one byte, or the seed, must change the hash.
+  unsigned char buf[200];
+  for (int a = 0; a < HASH_NUM_ALGORITHMS; a++) {
+    HashFnPtr fn = Hash_Function(static_cast<HashAlgorithm>(a));
+    for (int len = 1; len <= 200; len++) {
+      memset(buf, 'x', len);
+      uint64_t base = fn(buf, len, 0);
+      ASSERT_NE(base, fn(buf, len, 1));
+      for (int i = 0; i < len; i++) {
+        buf[i] = 'y';
+        ASSERT_NE(base, fn(buf, len, 0)) << "alg " << a << " len " << len
+                                         << " byte " << i;
+        buf[i] = 'x';
+      }
+      // Buffers that differ only in length differ in hash.
+      ASSERT_NE(base, fn(buf, len - 1, 0));
+    }
+  }
+}
+
+TEST(Test_Hash, Avalanche) {
+  // Flipping any single input bit should flip each output bit with
+  // probability 1/2, ie about 32 of the 64 output bits on average.
+  static const int kTrials = 200;
+  for (int a = HASH_XXHASH64; a < HASH_NUM_ALGORITHMS; a++) {
+    HashFnPtr fn = Hash_Function(static_cast<HashAlgorithm>(a));
+    for (int len : {8, 16, 40, 100}) {
+      uint64_t state = 88172645463325252ULL;
+      uint64_t flipped = 0, samples = 0;
+      unsigned char buf[100];
+      for (int t = 0; t < kTrials; t++) {
+        for (int i = 0; i < len; i++) {
+          buf[i] = static_cast<unsigned char>(Xorshift(&state));
+        }
+        uint64_t base = fn(buf, len, 0);
+        for (int bit = 0; bit < len * 8; bit++) {
+          buf[bit / 8] ^= 1 << (bit % 8);
+          flipped += __builtin_popcountll(base ^ fn(buf, len, 0));
+          buf[bit / 8] ^= 1 << (bit % 8);
+          samples++;
+        }
+      }
+      double mean = static_cast<double>(flipped) / samples;
+      ASSERT_GT(mean, 31.5) << "alg " << a << " len " << len;
+      ASSERT_LT(mean, 32.5) << "alg " << a << " len " << len;
+    }
+  }
+}
+
+TEST(Test_Hash, BucketDistribution) {
+  // Structured inputs of the kind that trip up weak hashes: sequential
+  // decimal strings, and 8-byte integers that differ only in high bits.
+  // Each word-at-a-time hash must spread them over the buckets as evenly as
+  // FNVHash64 does.
+  static const int kNumKeys = 1 << 16;
+  static const int kNumBuckets = 1024;
+  uint64_t *keys = new uint64_t[kNumKeys];
+  double bound = (kNumBuckets - 1) + 6 * sqrt(2.0 * kNumBuckets);
+
+  for (int input = 0; input < 2; input++) {
+    double chi2[HASH_NUM_ALGORITHMS];
+    for (int a = 0; a < HASH_NUM_ALGORITHMS; a++) {
+      HashFnPtr fn = Hash_Function(static_cast<HashAlgorithm>(a));
+      for (int i = 0; i < kNumKeys; i++) {
+        if (input == 0) {
+          char str[32];
+          int len = snprintf(str, sizeof(str), "user%d", i);
+          keys[i] = fn(str, len, 0);
+        } else {
+          uint64_t v = static_cast<uint64_t>(i) << 40;
+          keys[i] = fn(&v, sizeof(v), 0);
+        }
+      }
+      chi2[a] = ChiSquared(keys, kNumKeys, kNumBuckets);
+    }
+    ASSERT_LT(chi2[HASH_FNV1A], bound) << "input " << input;
+    for (int a = HASH_XXHASH64; a < HASH_NUM_ALGORITHMS; a++) {
+      ASSERT_LT(chi2[a], bound) << "alg " << a << " input " << input
+                                << " fnv " << chi2[HASH_FNV1A];
+    }
+  }
+  delete[] keys;
+}
+
+TEST(Test_Hash, FNVBatch) {
+  // Keys of mixed lengths, including empty ones and negative lengths (which
+  // FNVHash64 treats as empty), and batch sizes that leave every possible
+  // partial group at the end.
+  static const int kMaxKeys = 67;
+  unsigned char data[kMaxKeys][80];
+  unsigned char *buffers[kMaxKeys];
+  int lens[kMaxKeys];
+  HTKey_t out[kMaxKeys];
+  uint64_t state = 12345;
+
+  for (int i = 0; i < kMaxKeys; i++) {
+    for (int j = 0; j < 80; j++) {
+      data[i][j] = static_cast<unsigned char>(Xorshift(&state));
+    }
+    buffers[i] = data[i];
+    lens[i] = (i % 5 == 0) ? i % 3 : static_cast<int>(Xorshift(&state) % 80);
+    if (i % 7 == 3) {
+      lens[i] = -1 - i;
+    }
+  }
+
+  for (int n = 0; n <= kMaxKeys; n++) {
+    FNVHash64_Batch(buffers, lens, out, n);
+    for (int i = 0; i < n; i++) {
+      ASSERT_EQ(FNVHash64(buffers[i], lens[i]), out[i]) << n << " " << i;
+    }
+
+    // Each implementation on its own, where the CPU can run it.
+    FNVBatchScalar(buffers, lens, out, n);
+    for (int i = 0; i < n; i++) {
+      ASSERT_EQ(FNVHash64(buffers[i], lens[i]), out[i]) << n << " " << i;
+    }
+    if (FNVBatchHaveSSE2()) {
+      FNVBatchSSE2(buffers, lens, out, n);
+      for (int i = 0; i < n; i++) {
+        ASSERT_EQ(FNVHash64(buffers[i], lens[i]), out[i]) << n << " " << i;
+      }
+    }
+    if (FNVBatchHaveAVX2()) {
+      FNVBatchAVX2(buffers, lens, out, n);
+      for (int i = 0; i < n; i++) {
+        ASSERT_EQ(FNVHash64(buffers[i], lens[i]), out[i]) << n << " " << i;
+      }
+    }
+  }
+}
+
+TEST(Test_Hash, FNVIncremental) {
+  unsigned char buf[1000];
+  uint64_t state = 777;
+  for (int i = 0; i < 1000; i++) {
+    buf[i] = static_cast<unsigned char>(Xorshift(&state));
+  }
+  const HTKey_t expected = FNVHash64(buf, 1000);
+
+  // Nothing hashed yet is the same as the empty buffer.
+  FNVHashState fnv;
+  FNVHash64_Init(&fnv);
+  ASSERT_EQ(FNVHash64(buf, 0), FNVHash64_Final(&fnv));
+
+  // Any split of the input gives the same hash, and Final can be called
+  // part way through.
+  for (int trial = 0; trial < 50; trial++) {
+    FNVHash64_Init(&fnv);
+    size_t done = 0;
+    while (done < 1000) {
+      size_t len = Xorshift(&state) % 64;
+      if (len > 1000 - done) {
+        len = 1000 - done;
+      }
+      FNVHash64_Update(&fnv, buf + done, len);
+      done += len;
+      ASSERT_EQ(FNVHash64(buf, static_cast<int>(done)),
+                FNVHash64_Final(&fnv));
+    }
+    ASSERT_EQ(expected, FNVHash64_Final(&fnv));
+  }
+
+  // The same through an iovec, including empty pieces.
+  struct iovec iov[4];
+  iov[0].iov_base = buf;
+  iov[0].iov_len = 10;
+  iov[1].iov_base = buf + 10;
+  iov[1].iov_len = 0;
+  iov[2].iov_base = buf + 10;
+  iov[2].iov_len = 900;
+  iov[3].iov_base = buf + 910;
+  iov[3].iov_len = 90;
+  ASSERT_EQ(expected, FNVHash64_IoVec(iov, 4));
+  ASSERT_EQ(FNVHash64(buf, 0), FNVHash64_IoVec(iov, 0));
+}
+
+}  // namespace hw1
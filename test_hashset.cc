@@ -0,0 +1,176 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <set>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./HashSet.h"
+  #include "./HashSet_priv.h"
+}
+
+#include "./test_suite.h"
+
+using std::set;
+
+namespace hw1 {
+
+namespace {
+// The set's keys, through an iterator.
+set<HTKey_t> Keys(HashSet *hs) {
+  set<HTKey_t> keys;
+  HSIterator *iter = HSIterator_Allocate(hs);
+  HTKey_t key;
+
+  while (HSIterator_Get(iter, &key)) {
+    EXPECT_TRUE(keys.insert(key).second);
+    HSIterator_Next(iter);
+  }
+  EXPECT_FALSE(HSIterator_IsValid(iter));
+  EXPECT_FALSE(HSIterator_Next(iter));
+  HSIterator_Free(iter);
+  EXPECT_EQ(static_cast<size_t>(HashSet_NumElements(hs)), keys.size());
+  return keys;
+}
+
+// Checks that every key in the slots can be reached from its home slot
+// without crossing an empty one.
+void VerifyProbeRuns(HashSet *hs) {
+  for (uint64_t i = 0; i <= hs->mask; i++) {
+    if (hs->slots[i] == HS_EMPTY_SLOT) {
+      continue;
+    }
+    for (uint64_t j = HSKeyToSlot(hs, hs->slots[i]); j != i;
+         j = (j + 1) & hs->mask) {
+      ASSERT_NE(static_cast<HTKey_t>(HS_EMPTY_SLOT), hs->slots[j]);
+    }
+  }
+}
+
+HashSet *MakeSet(const set<HTKey_t> &keys) {
+  HashSet *hs = HashSet_Allocate(1);
+  for (HTKey_t key : keys) {
+    EXPECT_TRUE(HashSet_Add(hs, key));
+  }
+  return hs;
+}
+}  // anonymous namespace
+
+TEST(Test_HashSet, AddContainsRemove) {
+  HashSet *hs = HashSet_Allocate(1);
+
+  ASSERT_EQ(0, HashSet_NumElements(hs));
+  ASSERT_EQ(set<HTKey_t>{}, Keys(hs));
+  ASSERT_FALSE(HashSet_Contains(hs, 0));
+  ASSERT_FALSE(HashSet_Remove(hs, 0));
+
+  // Key 0 is stored apart from the slots, but behaves like any other.
+  ASSERT_TRUE(HashSet_Add(hs, 0));
+  ASSERT_FALSE(HashSet_Add(hs, 0));
+  ASSERT_TRUE(HashSet_Add(hs, 7));
+  ASSERT_FALSE(HashSet_Add(hs, 7));
+  ASSERT_TRUE(HashSet_Add(hs, UINT64_MAX));
+  ASSERT_EQ(3, HashSet_NumElements(hs));
+  ASSERT_TRUE(HashSet_Contains(hs, 0));
+  ASSERT_TRUE(HashSet_Contains(hs, 7));
+  ASSERT_TRUE(HashSet_Contains(hs, UINT64_MAX));
+  ASSERT_FALSE(HashSet_Contains(hs, 8));
+  ASSERT_EQ((set<HTKey_t>{0, 7, UINT64_MAX}), Keys(hs));
+
+  ASSERT_TRUE(HashSet_Remove(hs, 0));
+  ASSERT_FALSE(HashSet_Remove(hs, 0));
+  ASSERT_TRUE(HashSet_Remove(hs, 7));
+  ASSERT_FALSE(HashSet_Contains(hs, 7));
+  ASSERT_EQ((set<HTKey_t>{UINT64_MAX}), Keys(hs));
+  HashSet_Free(hs);
+}
+
+TEST(Test_HashSet, GrowAndRemove) {
+  HashSet *hs = HashSet_Allocate(1);
+  set<HTKey_t> expected;
+
+  // Sequential keys, through many doublings; the load factor holds.
+  for (HTKey_t key = 1; key <= 10000; key++) {
+    ASSERT_TRUE(HashSet_Add(hs, key));
+    expected.insert(key);
+  }
+  ASSERT_EQ(10000, HashSet_NumElements(hs));
+  ASSERT_LE(4 * 10000U, 3 * (hs->mask + 1));
+  VerifyProbeRuns(hs);
+
+  // Removing every third key shifts the probe runs back together.
+  for (HTKey_t key = 3; key <= 10000; key += 3) {
+    ASSERT_TRUE(HashSet_Remove(hs, key));
+    expected.erase(key);
+  }
+  VerifyProbeRuns(hs);
+  for (HTKey_t key = 1; key <= 10001; key++) {
+    ASSERT_EQ(expected.count(key) == 1, HashSet_Contains(hs, key));
+  }
+  ASSERT_EQ(expected, Keys(hs));
+
+  // Fill a small set to its load factor and empty it in another order, so
+  // that removals move keys back across the end of the slots.
+  HashSet_Free(hs);
+  hs = HashSet_Allocate(6);
+  ASSERT_EQ(7U, hs->mask);
+  for (HTKey_t key = 100; key < 106; key++) {
+    HashSet_Add(hs, key);
+  }
+  ASSERT_EQ(7U, hs->mask);
+  VerifyProbeRuns(hs);
+  for (HTKey_t key = 105; key >= 100; key -= 2) {
+    ASSERT_TRUE(HashSet_Remove(hs, key));
+    VerifyProbeRuns(hs);
+  }
+  ASSERT_EQ((set<HTKey_t>{100, 102, 104}), Keys(hs));
+  HashSet_Free(hs);
+}
+
+TEST(Test_HashSet, Algebra) {
+  set<HTKey_t> a_keys{0, 1, 2, 3, 4, 5, 100}, b_keys{4, 5, 6, 7, 0, 200};
+  HashSet *a = MakeSet(a_keys), *b = MakeSet(b_keys), *c;
+
+  c = HashSet_Union(a, b);
+  ASSERT_EQ((set<HTKey_t>{0, 1, 2, 3, 4, 5, 6, 7, 100, 200}), Keys(c));
+  HashSet_Free(c);
+
+  c = HashSet_Intersection(a, b);
+  ASSERT_EQ((set<HTKey_t>{0, 4, 5}), Keys(c));
+  HashSet_Free(c);
+  c = HashSet_Intersection(b, a);
+  ASSERT_EQ((set<HTKey_t>{0, 4, 5}), Keys(c));
+  HashSet_Free(c);
+
+  c = HashSet_Difference(a, b);
+  ASSERT_EQ((set<HTKey_t>{1, 2, 3, 100}), Keys(c));
+  HashSet_Free(c);
+  c = HashSet_Difference(b, a);
+  ASSERT_EQ((set<HTKey_t>{6, 7, 200}), Keys(c));
+  HashSet_Free(c);
+
+  // The same set on both sides.
+  c = HashSet_Union(a, a);
+  ASSERT_EQ(a_keys, Keys(c));
+  HashSet_Free(c);
+  c = HashSet_Difference(a, a);
+  ASSERT_EQ(0, HashSet_NumElements(c));
+  HashSet_Free(c);
+
+  // The arguments are unchanged.
+  ASSERT_EQ(a_keys, Keys(a));
+  ASSERT_EQ(b_keys, Keys(b));
+  HashSet_Free(a);
+  HashSet_Free(b);
+}
+
+}  // namespace hw1
@@ -9,12 +9,19 @@
  * author.
  */
 
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
 extern "C" {
+  #include "./BloomFilter.h"
+  #include "./Hash.h"
   #include "./HashTable.h"
   #include "./HashTable_priv.h"
   #include "./LinkedList.h"
@@ -24,6 +31,7 @@ extern "C" {
 
 using std::set;
 using std::string;
+using std::vector;
 
 namespace hw1 {
 
@@ -55,6 +63,58 @@ static void InsertElement(HashTable *table, int e) {
   ASSERT_FALSE(HashTable_Insert(table, newkv, &oldkv));
 }
 
+// Checks that every bucket's tags word matches its chain.
+static void VerifyTags(HashTable *table) {
+  for (int b = 0; b < table->num_buckets; b++) {
+    uint64_t expected = 0;
+    int pos = 0;
+    for (LinkedListNode *n = table->buckets[b]->head;
+         n != NULL && pos < HT_NUM_TAGS; n = n->next, pos++) {
+      HTKey_t key = static_cast<HTKeyValue_t *>(n->payload)->key;
+      expected |= static_cast<uint64_t>(HashKeyToTag(key)) << (8 * pos);
+    }
+    ASSERT_EQ(expected, table->tags[b]) << "bucket " << b;
+  }
+}
+
+// Fills an empty table with keys 0 to num_keys - 1 (with value i for key
+// i), appending each to its chain directly so that the chains are in key
+// order and may be much longer than HashTable_Insert would allow before
+// resizing.
+static void FillChains(HashTable *table, int num_keys) {
+  for (int i = 0; i < num_keys; i++) {
+    HTKeyValue_t *newkv = static_cast<HTKeyValue_t *>(
+        malloc(sizeof(HTKeyValue_t)));
+    newkv->key = static_cast<HTKey_t>(i);
+    newkv->value = NewPayload(i);
+    int bucket = HashKeyToBucketNum(table, newkv->key);
+    LinkedList_Append(table->buckets[bucket], newkv);
+    table->num_elements++;
+  }
+  for (int b = 0; b < table->num_buckets; b++) {
+    table->tags[b] = 0;
+    int pos = 0;
+    for (LinkedListNode *n = table->buckets[b]->head;
+         n != NULL && pos < HT_NUM_TAGS; n = n->next, pos++) {
+      table->tags[b] |= static_cast<uint64_t>(HashKeyToTag(
+          static_cast<HTKeyValue_t *>(n->payload)->key)) << (8 * pos);
+    }
+  }
+}
+
+// Returns the keys of a bucket's chain, from the head.
+static vector<HTKey_t> ChainKeys(HashTable *table, int bucket) {
+  vector<HTKey_t> keys;
+  LinkedListNode *prev = NULL;
+  for (LinkedListNode *n = table->buckets[bucket]->head; n != NULL;
+       prev = n, n = n->next) {
+    EXPECT_EQ(prev, n->prev);
+    keys.push_back(static_cast<HTKeyValue_t *>(n->payload)->key);
+  }
+  EXPECT_EQ(prev, table->buckets[bucket]->tail);
+  return keys;
+}
+
 static HTKey_t AsKeyType(HTValue_t v) {
   return static_cast<HTKey_t>(static_cast<TestPayload *>(v)->payload);
 }
@@ -93,10 +153,19 @@ class Test_HashTable : public ::testing::Test {
     freeInvocations_++;
     VerifiedFree(payload);
   }
+
+  // Like InstrumentedVerifiedFree(), but safe to call from several threads
+  // at once, as HashTable_BuildFromArray() may.
+  static int buildFreeInvocations_;
+  static void ConcurrentVerifiedFree(HTValue_t payload) {
+    __atomic_fetch_add(&buildFreeInvocations_, 1, __ATOMIC_RELAXED);
+    VerifiedFree(payload);
+  }
 };  // class Test_HashTable
 
 // statics:
 int Test_HashTable::freeInvocations_;
+int Test_HashTable::buildFreeInvocations_;
 
 // Insert, insert again, and find an element in the table.  This is a written
 // as a helper function instead of a TEST_F() so that we can write tests
@@ -535,4 +604,1386 @@ TEST_F(Test_HashTable, Resize) {
   HW1Environment::AddPoints(5);
 }
 
+TEST_F(Test_HashTable, BuildFromArray) {
+  static const int kNumKeys = 5000;
+  static const int kNumDuplicates = 1000;
+
+  // Every key in [0, kNumKeys) once, then the first kNumDuplicates keys
+  // again.  The second copy of each duplicate must win.
+  HTKeyValue_t *kvs = static_cast<HTKeyValue_t *>(
+      malloc((kNumKeys + kNumDuplicates) * sizeof(HTKeyValue_t)));
+
+  for (int threads : {1, 3, 8}) {
+    SCOPED_TRACE(threads);
+    for (int i = 0; i < kNumKeys; i++) {
+      kvs[i].key = i;
+      kvs[i].value = NewPayload(i);
+    }
+    for (int i = 0; i < kNumDuplicates; i++) {
+      kvs[kNumKeys + i].key = i;
+      kvs[kNumKeys + i].value = NewPayload(i);
+    }
+
+    buildFreeInvocations_ = 0;
+    HashTable *table = HashTable_BuildFromArray(
+        kvs, kNumKeys + kNumDuplicates, threads,
+        &Test_HashTable::ConcurrentVerifiedFree);
+    ASSERT_EQ(kNumDuplicates, buildFreeInvocations_);
+    ASSERT_EQ(kNumKeys, HashTable_NumElements(table));
+    ASSERT_LE(kNumKeys, table->num_buckets);
+
+    HTKeyValue_t kv;
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_TRUE(HashTable_Find(table, i, &kv));
+      ASSERT_EQ(static_cast<HTKey_t>(i), AsKeyType(kv.value));
+      HTValue_t expected = kvs[i < kNumDuplicates ? kNumKeys + i : i].value;
+      ASSERT_EQ(expected, kv.value);
+    }
+    ASSERT_FALSE(HashTable_Find(table, kNumKeys, &kv));
+
+    // The table must keep working normally afterward.
+    InsertElement(table, kNumKeys);
+    ASSERT_EQ(kNumKeys + 1, HashTable_NumElements(table));
+
+    freeInvocations_ = 0;
+    HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+    ASSERT_EQ(kNumKeys + 1, freeInvocations_);
+  }
+  free(kvs);
+
+  // An empty input produces an empty, usable table.
+  HashTable *empty = HashTable_BuildFromArray(NULL, 0, 4,
+                                              &Test_HashTable::VerifiedFree);
+  ASSERT_EQ(0, HashTable_NumElements(empty));
+  TestInsertAndFind(empty, 7, 0);
+  HashTable_Free(empty, &Test_HashTable::VerifiedFree);
+}
+
+TEST_F(Test_HashTable, Iterator_Range) {
+  static const int kTableSize = 10;
+  static const int kNumKeys = 25;
+
+  HashTable *table = HashTable_Allocate(kTableSize);
+  for (int i = 0; i < kNumKeys; i++) {
+    InsertElement(table, i);
+  }
+  ASSERT_EQ(kTableSize, HashTable_NumBuckets(table));
+
+  // Ranges [0,3), [3,3), [3,7), [7,10) partition the table; together they
+  // must visit every key exactly once, each in its own range.
+  int bounds[] = {0, 3, 3, 7, kTableSize};
+  int num_times_seen[kNumKeys] = { 0 };
+  for (int r = 0; r < 4; r++) {
+    HTIterator *it = HTIterator_AllocateRange(table, bounds[r], bounds[r + 1]);
+    if (bounds[r] == bounds[r + 1]) {
+      ASSERT_FALSE(HTIterator_IsValid(it));
+    }
+    for (; HTIterator_IsValid(it); HTIterator_Next(it)) {
+      HTKeyValue_t kv;
+      ASSERT_TRUE(HTIterator_Get(it, &kv));
+      int bucket = static_cast<int>(kv.key) % kTableSize;
+      ASSERT_LE(bounds[r], bucket);
+      ASSERT_LT(bucket, bounds[r + 1]);
+      num_times_seen[kv.key]++;
+    }
+    HTIterator_Free(it);
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(1, num_times_seen[i]);
+  }
+
+  // Removing through a range iterator stays inside the range.
+  HTIterator *it = HTIterator_AllocateRange(table, 5, 6);
+  HTKeyValue_t kv;
+  while (HTIterator_Remove(it, &kv)) {
+    ASSERT_EQ(5, static_cast<int>(kv.key) % kTableSize);
+    FreeValue(kv.value);
+  }
+  HTIterator_Free(it);
+  ASSERT_EQ(0, LinkedList_NumElements(table->buckets[5]));
+  ASSERT_EQ(kNumKeys - 2, HashTable_NumElements(table));  // 5 and 15
+
+  HashTable_Free(table, &Test_HashTable::VerifiedFree);
+}
+
+namespace {
+// Context for the ForEachParallel tests.
+struct ForEachCtx {
+  uint64_t key_sum;           // updated atomically by the callback
+  int visits;                 // ditto
+  bool remove_odd;            // remove (and free) keys that are odd?
+};
+
+bool SumAndMaybeRemove(HTKeyValue_t kv, void *arg) {
+  ForEachCtx *ctx = static_cast<ForEachCtx *>(arg);
+  __atomic_fetch_add(&ctx->key_sum, kv.key, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&ctx->visits, 1, __ATOMIC_RELAXED);
+  if (ctx->remove_odd && (kv.key & 1) == 1) {
+    FreeValue(kv.value);
+    return true;
+  }
+  return false;
+}
+
+// Context for the test that ForEachParallel respects num_threads.
+struct ConcurrencyCtx {
+  int active;                 // callbacks running now; updated atomically
+  int max_active;             // the most seen at once; ditto
+};
+
+bool CountConcurrent(HTKeyValue_t kv, void *arg) {
+  ConcurrencyCtx *ctx = static_cast<ConcurrencyCtx *>(arg);
+  int active = __atomic_add_fetch(&ctx->active, 1, __ATOMIC_RELAXED);
+  int seen = __atomic_load_n(&ctx->max_active, __ATOMIC_RELAXED);
+  while (active > seen &&
+         !__atomic_compare_exchange_n(&ctx->max_active, &seen, active, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+  // Now and then linger, so that callbacks on other threads overlap with
+  // this one even on a single CPU.
+  if (kv.key % 100 == 0) {
+    struct timespec ms = {0, 1000000};
+    nanosleep(&ms, NULL);
+  }
+  __atomic_fetch_sub(&ctx->active, 1, __ATOMIC_RELAXED);
+  return false;
+}
+}  // anonymous namespace
+
+TEST_F(Test_HashTable, ForEachParallel) {
+  static const int kNumKeys = 3000;
+
+  HashTable *table = HashTable_Allocate(64);
+  for (int i = 0; i < kNumKeys; i++) {
+    InsertElement(table, i);
+  }
+  const uint64_t kExpectedSum =
+      static_cast<uint64_t>(kNumKeys) * (kNumKeys - 1) / 2;
+
+  // A read-only scan visits every element once, on any number of threads.
+  for (int threads : {1, 4, 13}) {
+    SCOPED_TRACE(threads);
+    ForEachCtx ctx = {0, 0, false};
+    HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, threads);
+    ASSERT_EQ(kNumKeys, ctx.visits);
+    ASSERT_EQ(kExpectedSum, ctx.key_sum);
+    ASSERT_EQ(kNumKeys, HashTable_NumElements(table));
+  }
+
+  // However many workers the pool has, no more than num_threads threads
+  // scan at once.
+  for (int threads : {1, 2, 3}) {
+    SCOPED_TRACE(threads);
+    ConcurrencyCtx ctx = {0, 0};
+    HashTable_ForEachParallel(table, &CountConcurrent, &ctx, threads);
+    ASSERT_LE(1, ctx.max_active);
+    ASSERT_GE(threads, ctx.max_active);
+  }
+
+  // A scan that removes the current element.
+  ForEachCtx ctx = {0, 0, true};
+  HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, 4);
+  ASSERT_EQ(kNumKeys, ctx.visits);
+  ASSERT_EQ(kNumKeys / 2, HashTable_NumElements(table));
+  HTKeyValue_t kv;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0, HashTable_Find(table, i, &kv));
+  }
+
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(kNumKeys / 2, freeInvocations_);
+}
+
+TEST_F(Test_HashTable, SmallTable) {
+  HashTable *table = HashTable_AllocateSmall();
+  HTKeyValue_t kv, oldkv;
+
+  // No buckets until the table is full.
+  ASSERT_EQ(NULL, table->buckets);
+  ASSERT_EQ(1, HashTable_NumBuckets(table));
+  ASSERT_FALSE(HashTable_Find(table, 0, &kv));
+  for (int i = 0; i < HT_SMALL_CAPACITY; i++) {
+    InsertElement(table, i);
+  }
+  ASSERT_EQ(NULL, table->buckets);
+  ASSERT_EQ(HT_SMALL_CAPACITY, HashTable_NumElements(table));
+
+  // Replace, find, and remove from the middle and the end.
+  kv.key = 3;
+  kv.value = NewPayload(3);
+  ASSERT_TRUE(HashTable_Insert(table, kv, &oldkv));
+  ASSERT_EQ(3U, oldkv.key);
+  FreeValue(oldkv.value);
+  ASSERT_TRUE(HashTable_Find(table, 3, &oldkv));
+  ASSERT_EQ(kv.value, oldkv.value);
+  for (HTKey_t key : {2, HT_SMALL_CAPACITY - 1}) {
+    ASSERT_TRUE(HashTable_Remove(table, key, &kv));
+    ASSERT_EQ(key, kv.key);
+    FreeValue(kv.value);
+    ASSERT_FALSE(HashTable_Remove(table, key, &kv));
+  }
+  HTKey_t keys[HT_SMALL_CAPACITY + 1];
+  HTKeyValue_t results[HT_SMALL_CAPACITY + 1];
+  bool found[HT_SMALL_CAPACITY + 1];
+  for (int i = 0; i <= HT_SMALL_CAPACITY; i++) {
+    keys[i] = i;
+  }
+  ASSERT_EQ(HT_SMALL_CAPACITY - 2,
+            HashTable_FindBatch(table, keys, HT_SMALL_CAPACITY + 1, results,
+                                found));
+  for (int i = 0; i <= HT_SMALL_CAPACITY; i++) {
+    ASSERT_EQ(i != 2 && i < HT_SMALL_CAPACITY - 1, found[i]);
+  }
+
+  // Iterate, removing every other key.
+  HTIterator *it = HTIterator_Allocate(table);
+  int visits = 0;
+  for (int n = 0; HTIterator_IsValid(it); n++) {
+    ASSERT_TRUE(HTIterator_Get(it, &kv));
+    visits++;
+    if (n % 2 == 0) {
+      ASSERT_TRUE(HTIterator_Remove(it, &oldkv));
+      ASSERT_EQ(kv.key, oldkv.key);
+      FreeValue(oldkv.value);
+    } else {
+      HTIterator_Next(it);
+    }
+  }
+  HTIterator_Free(it);
+  ASSERT_EQ(HT_SMALL_CAPACITY - 2, visits);
+  ASSERT_EQ(HT_SMALL_CAPACITY / 2 - 1, HashTable_NumElements(table));
+  it = HTIterator_AllocateRange(table, 0, 0);
+  ASSERT_FALSE(HTIterator_IsValid(it));
+  HTIterator_Free(it);
+
+  // The Bloom filter and parallel scans work without buckets too.
+  HashTable_EnableBloomFilter(table, 0.01);
+  ForEachCtx ctx = {0, 0, false};
+  HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, 4);
+  ASSERT_EQ(HashTable_NumElements(table), ctx.visits);
+
+  // Outgrowing the array gives the table buckets and loses nothing.
+  int num_keys = HashTable_NumElements(table);
+  for (int i = 100; i < 100 + 3 * HT_SMALL_CAPACITY; i++) {
+    InsertElement(table, i);
+    num_keys++;
+    ASSERT_EQ(num_keys, HashTable_NumElements(table));
+    ASSERT_TRUE(HashTable_Find(table, i, &kv));
+  }
+  ASSERT_NE(nullptr, table->buckets);
+  VerifyTags(table);
+  ctx = {0, 0, false};
+  HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, 4);
+  ASSERT_EQ(num_keys, ctx.visits);
+  for (int i = 0; i < HT_SMALL_CAPACITY; i++) {
+    ASSERT_EQ(i == 1 || i == 4 || i == 6, HashTable_Find(table, i, &kv));
+  }
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(num_keys, freeInvocations_);
+
+  // Byte-string keys go straight to buckets.
+  table = HashTable_AllocateSmall();
+  HTValue_t value;
+  ASSERT_FALSE(HashTable_FindBytes(table, "k", 1, &value));
+  ASSERT_FALSE(HashTable_InsertBytes(table, "k", 1, NewPayload(1), &value));
+  ASSERT_NE(nullptr, table->buckets);
+  ASSERT_TRUE(HashTable_FindBytes(table, "k", 1, &value));
+  HashTable_Free(table, &FreeValue);
+
+  // A table freed while still small frees its Bloom filter too.
+  table = HashTable_AllocateSmall();
+  InsertElement(table, 1);
+  HashTable_EnableBloomFilter(table, 0.01);
+  ASSERT_NE(nullptr, table->bloom);
+  ASSERT_EQ(NULL, table->buckets);
+  ASSERT_TRUE(HashTable_Find(table, 1, &kv));
+  ASSERT_FALSE(HashTable_Find(table, 2, &kv));
+  HashTable_Free(table, &FreeValue);
+}
+
+TEST_F(Test_HashTable, Freeze) {
+  static const int kNumKeys = 10000;
+  HashTable *table = HashTable_Allocate(10);
+  HTKeyValue_t kv;
+
+  for (int i = 0; i < kNumKeys; i++) {
+    InsertElement(table, i * 3);
+  }
+  for (int i = 0; i < kNumKeys; i += 7) {
+    ASSERT_TRUE(HashTable_Remove(table, i * 3, &kv));
+    FreeValue(kv.value);
+  }
+  HashTable_EnableBloomFilter(table, 0.01);
+  int num_keys = HashTable_NumElements(table);
+  HashTable_Freeze(table);
+  ASSERT_NE(nullptr, table->frozen);
+  ASSERT_EQ(NULL, table->buckets);
+  ASSERT_EQ(num_keys, HashTable_NumElements(table));
+  ASSERT_EQ(num_keys, table->frozen->num_keys);
+  ASSERT_LE(num_keys, table->frozen->num_slots);
+  HashTable_Freeze(table);  // does nothing
+
+  // Every key is found with its value, and nothing else is.
+  static HTKey_t keys[3 * kNumKeys];
+  static HTKeyValue_t results[3 * kNumKeys];
+  static bool found[3 * kNumKeys];
+  for (int i = 0; i < 3 * kNumKeys; i++) {
+    bool present = i % 3 == 0 && (i / 3) % 7 != 0;
+    keys[i] = i;
+    ASSERT_EQ(present, HashTable_Find(table, i, &kv));
+    if (present) {
+      ASSERT_EQ(static_cast<HTKey_t>(i), kv.key);
+      ASSERT_EQ(static_cast<HTKey_t>(i), AsKeyType(kv.value));
+    }
+  }
+  ASSERT_EQ(num_keys, HashTable_FindBatch(table, keys, 3 * kNumKeys,
+                                          results, found));
+  for (int i = 0; i < 3 * kNumKeys; i++) {
+    ASSERT_EQ(i % 3 == 0 && (i / 3) % 7 != 0, found[i]);
+    if (found[i]) {
+      ASSERT_EQ(keys[i], results[i].key);
+    }
+  }
+
+  // Iteration, in ranges and in parallel, visits each key once.
+  ASSERT_LT(1, HashTable_NumBuckets(table));
+  set<HTKey_t> seen;
+  for (int b = 0; b < HashTable_NumBuckets(table); b++) {
+    HTIterator *it = HTIterator_AllocateRange(table, b, b + 1);
+    for (; HTIterator_IsValid(it); HTIterator_Next(it)) {
+      ASSERT_TRUE(HTIterator_Get(it, &kv));
+      ASSERT_TRUE(seen.insert(kv.key).second);
+    }
+    HTIterator_Free(it);
+  }
+  ASSERT_EQ(static_cast<size_t>(num_keys), seen.size());
+  ForEachCtx ctx = {0, 0, false};
+  HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, 4);
+  ASSERT_EQ(num_keys, ctx.visits);
+
+  // HashTable_FindAll finds each key wherever its entry is, well past the
+  // first HT_FLAT_RANGE, and nothing else.
+  ASSERT_LT(HT_FLAT_RANGE, num_keys);
+  for (int i = 0; i < 3 * kNumKeys; i++) {
+    bool present = i % 3 == 0 && (i / 3) % 7 != 0;
+    HTIterator *it = HashTable_FindAll(table, i);
+    ASSERT_EQ(present, HTIterator_Get(it, &kv)) << "key " << i;
+    if (present) {
+      ASSERT_EQ(static_cast<HTKey_t>(i), kv.key);
+      ASSERT_EQ(static_cast<HTKey_t>(i), AsKeyType(kv.value));
+      ASSERT_FALSE(HTIterator_Next(it));
+    }
+    ASSERT_FALSE(HTIterator_IsValid(it));
+    HTIterator_Free(it);
+  }
+
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(num_keys, freeInvocations_);
+
+  // Empty and small tables freeze too.
+  table = HashTable_Allocate(4);
+  HashTable_Freeze(table);
+  ASSERT_FALSE(HashTable_Find(table, 0, &kv));
+  ASSERT_EQ(0, HashTable_FindBatch(table, keys, 10, results, found));
+  HTIterator *it = HTIterator_Allocate(table);
+  ASSERT_FALSE(HTIterator_IsValid(it));
+  HTIterator_Free(it);
+  HashTable_Free(table, &FreeValue);
+  table = HashTable_AllocateSmall();
+  InsertElement(table, 5);
+  InsertElement(table, 6);
+  HashTable_Freeze(table);
+  ASSERT_TRUE(HashTable_Find(table, 6, &kv));
+  ASSERT_FALSE(HashTable_Find(table, 7, &kv));
+  it = HashTable_FindAll(table, 6);
+  ASSERT_TRUE(HTIterator_Get(it, &kv));
+  ASSERT_EQ(6U, kv.key);
+  ASSERT_FALSE(HTIterator_Next(it));
+  HTIterator_Free(it);
+  it = HashTable_FindAll(table, 7);
+  ASSERT_FALSE(HTIterator_IsValid(it));
+  HTIterator_Free(it);
+  HashTable_Free(table, &FreeValue);
+}
+
+TEST_F(Test_HashTable, Seeded) {
+  static const int kInitialNumBuckets = 10;
+  static const int kNumKeys = 500;
+  // Every key is a multiple of every bucket count the table will have, so
+  // an unseeded table would put them all in bucket 0.
+  static const HTKey_t kStride = 10 * 9 * 9 * 9;
+
+  HashTable *table = HashTable_AllocateSeeded(kInitialNumBuckets);
+  HashTable *other = HashTable_AllocateSeeded(kInitialNumBuckets);
+  ASSERT_TRUE(table->seeded);
+  ASSERT_FALSE(table->seed[0] == other->seed[0] &&
+               table->seed[1] == other->seed[1]);
+  HashTable_Free(other, &Test_HashTable::VerifiedFree);
+
+  uint64_t seed0 = table->seed[0], seed1 = table->seed[1];
+  for (int i = 0; i < kNumKeys; i++) {
+    HTKeyValue_t kv, oldkv;
+    kv.key = i * kStride;
+    kv.value = NewPayload(i);
+    ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+  }
+  // The table resized, keeping its seed, and the keys are spread out.
+  ASSERT_LT(kInitialNumBuckets, table->num_buckets);
+  ASSERT_EQ(seed0, table->seed[0]);
+  ASSERT_EQ(seed1, table->seed[1]);
+  int longest = 0;
+  for (int b = 0; b < table->num_buckets; b++) {
+    longest = std::max(longest, LinkedList_NumElements(table->buckets[b]));
+  }
+  ASSERT_GT(10, longest);
+
+  // Everything else behaves as usual.
+  HTKeyValue_t kv;
+  for (int i = 0; i < kNumKeys; i++) {
+    Reset(&kv);
+    ASSERT_TRUE(HashTable_Find(table, i * kStride, &kv));
+    ASSERT_EQ(static_cast<HTKey_t>(i), AsKeyType(kv.value));
+  }
+  ASSERT_FALSE(HashTable_Find(table, 1, &kv));
+  ASSERT_TRUE(HashTable_Remove(table, 7 * kStride, &kv));
+  FreeValue(kv.value);
+  ASSERT_FALSE(HashTable_Find(table, 7 * kStride, &kv));
+  ASSERT_EQ(kNumKeys - 1, HashTable_NumElements(table));
+
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(kNumKeys - 1, freeInvocations_);
+}
+
+TEST_F(Test_HashTable, BytesKeys) {
+  static const int kNumKeys = 300;
+
+  // Start small so that the table resizes with byte-keyed entries in it.
+  HashTable *table = HashTable_Allocate(2);
+  HTValue_t value;
+  for (int i = 0; i < kNumKeys; i++) {
+    string key = "key" + std::to_string(i) + string(i % 40, 'x');
+    ASSERT_FALSE(HashTable_InsertBytes(table, key.data(), key.size(),
+                                       NewPayload(i), &value));
+  }
+  ASSERT_LT(2, table->num_buckets);
+  ASSERT_EQ(kNumKeys, HashTable_NumElements(table));
+
+  // The empty key is a key like any other.
+  ASSERT_FALSE(HashTable_FindBytes(table, "", 0, &value));
+  ASSERT_FALSE(HashTable_InsertBytes(table, "", 0, NewPayload(-1), &value));
+  ASSERT_TRUE(HashTable_FindBytes(table, "", 0, &value));
+  ASSERT_EQ(static_cast<HTKey_t>(-1), AsKeyType(value));
+  ASSERT_TRUE(HashTable_RemoveBytes(table, "", 0, &value));
+  FreeValue(value);
+
+  // Lookups compare the whole key: the caller's buffer need not outlive
+  // the insert, and prefixes or extensions of a key don't match.
+  for (int i = 0; i < kNumKeys; i++) {
+    string key = "key" + std::to_string(i) + string(i % 40, 'x');
+    ASSERT_TRUE(HashTable_FindBytes(table, key.data(), key.size(), &value));
+    ASSERT_EQ(static_cast<HTKey_t>(i), AsKeyType(value));
+    ASSERT_FALSE(HashTable_FindBytes(table, key.data(), key.size() - 1,
+                                     &value));
+    key += 'y';
+    ASSERT_FALSE(HashTable_FindBytes(table, key.data(), key.size(), &value));
+  }
+
+  // Replacing a value returns the old one.
+  ASSERT_TRUE(HashTable_InsertBytes(table, "key7xxxxxxx", 11, NewPayload(77),
+                                    &value));
+  ASSERT_EQ(7U, AsKeyType(value));
+  FreeValue(value);
+
+  // Forge an entry whose hash collides with "key5"'s but whose bytes
+  // differ, and put it at the front of key5's chain.
+  HTBytesEntry *key5 = NULL;
+  HTIterator *it = HTIterator_Allocate(table);
+  for (; HTIterator_IsValid(it); HTIterator_Next(it)) {
+    const void *key;
+    size_t key_len;
+    ASSERT_TRUE(HTIterator_GetBytes(it, &key, &key_len, &value));
+    if (key_len == 9 && memcmp(key, "key5xxxxx", 9) == 0) {
+      key5 = reinterpret_cast<HTBytesEntry *>(
+          static_cast<unsigned char *>(const_cast<void *>(key)) -
+          sizeof(HTBytesEntry));
+    }
+  }
+  HTIterator_Free(it);
+  ASSERT_TRUE(key5 != NULL);
+  HTBytesEntry *forged = static_cast<HTBytesEntry *>(
+      malloc(sizeof(HTBytesEntry) + 9));
+  forged->kv.key = key5->kv.key;
+  forged->kv.value = NewPayload(-5);
+  forged->key_len = 9;
+  memcpy(HTBytesEntry_Key(forged), "KEY5XXXXX", 9);
+  int bucket = HashKeyToBucketNum(table, key5->kv.key);
+  LinkedList_Push(table->buckets[bucket], forged);
+  table->tags[bucket] = (table->tags[bucket] << 8) |
+                        HashKeyToTag(forged->kv.key);
+  table->num_elements++;
+
+  ASSERT_TRUE(HashTable_FindBytes(table, "key5xxxxx", 9, &value));
+  ASSERT_EQ(5U, AsKeyType(value));
+  ASSERT_TRUE(HashTable_RemoveBytes(table, "key5xxxxx", 9, &value));
+  FreeValue(value);
+  ASSERT_FALSE(HashTable_FindBytes(table, "key5xxxxx", 9, &value));
+  ASSERT_EQ(kNumKeys, HashTable_NumElements(table));
+
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(kNumKeys, freeInvocations_);
+}
+
+TEST_F(Test_HashTable, BytesKeysHash) {
+  static const int kNumKeys = 100;
+
+  // HASH_NUM_ALGORITHMS stands for the default, WyHash64.
+  for (int a = 0; a <= HASH_NUM_ALGORITHMS; a++) {
+    SCOPED_TRACE(a);
+    HashAlgorithm algorithm = static_cast<HashAlgorithm>(a);
+    HashTable *table = HashTable_Allocate(2);
+    if (algorithm != HASH_NUM_ALGORITHMS) {
+      HashTable_SetBytesHash(table, algorithm);
+    } else {
+      algorithm = HASH_WYHASH64;
+    }
+    HTValue_t value;
+    for (int i = 0; i < kNumKeys; i++) {
+      string key = "key" + std::to_string(i);
+      ASSERT_FALSE(HashTable_InsertBytes(table, key.data(), key.size(),
+                                         NewPayload(i), &value));
+    }
+
+    // The entries are hashed with the chosen algorithm, and found by it.
+    int visited = 0;
+    HTIterator *it = HTIterator_Allocate(table);
+    for (; HTIterator_IsValid(it); HTIterator_Next(it), visited++) {
+      HTKeyValue_t kv;
+      const void *key;
+      size_t key_len;
+      ASSERT_TRUE(HTIterator_Get(it, &kv));
+      ASSERT_TRUE(HTIterator_GetBytes(it, &key, &key_len, &value));
+      ASSERT_EQ(Hash_Bytes(algorithm, key, key_len, 0), kv.key);
+    }
+    HTIterator_Free(it);
+    ASSERT_EQ(kNumKeys, visited);
+    for (int i = 0; i < kNumKeys; i++) {
+      string key = "key" + std::to_string(i);
+      ASSERT_TRUE(HashTable_FindBytes(table, key.data(), key.size(),
+                                      &value));
+      ASSERT_EQ(static_cast<HTKey_t>(i), AsKeyType(value));
+    }
+    HashTable_Free(table, &Test_HashTable::VerifiedFree);
+  }
+}
+
+TEST_F(Test_HashTable, FindBatch) {
+  static const int kNumKeys = 3000;
+  static const int kNumLookups = 2 * kNumKeys + 7;
+  HashTable *table = HashTable_Allocate(100);
+  HTKeyValue_t kv, oldkv;
+
+  // Every third key is present, and the chains are several long.
+  for (int i = 0; i < kNumKeys; i++) {
+    kv.key = static_cast<HTKey_t>(3 * i);
+    kv.value = NewPayload(i);
+    ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+  }
+
+  // Look up hits, misses and repeats, in batch sizes that aren't multiples
+  // of the group size; each answer must match HashTable_Find's.
+  static HTKey_t keys[kNumLookups];
+  static HTKeyValue_t results[kNumLookups];
+  static bool found[kNumLookups];
+  for (int i = 0; i < kNumLookups; i++) {
+    keys[i] = static_cast<HTKey_t>((i * 7919) % (3 * kNumKeys + 10));
+  }
+  for (int n : {0, 1, 15, 16, 17, 100, kNumLookups}) {
+    int expected = 0;
+    for (int i = 0; i < n; i++) {
+      expected += HashTable_Find(table, keys[i], &kv) ? 1 : 0;
+    }
+    ASSERT_EQ(expected, HashTable_FindBatch(table, keys, n, results, found));
+    for (int i = 0; i < n; i++) {
+      ASSERT_EQ(HashTable_Find(table, keys[i], &kv), found[i]);
+      if (found[i]) {
+        ASSERT_EQ(keys[i], results[i].key);
+        ASSERT_EQ(kv.value, results[i].value);
+        ASSERT_EQ(keys[i] / 3, AsKeyType(results[i].value));
+      }
+    }
+  }
+  ASSERT_EQ(kNumKeys, HashTable_NumElements(table));
+
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(kNumKeys, freeInvocations_);
+}
+
+TEST_F(Test_HashTable, BloomFilter) {
+  static const int kNumKeys = 5000;
+  HashTable *table = HashTable_Allocate(10);
+  HTKeyValue_t kv, oldkv;
+  HTValue_t value;
+
+  // Even keys go in before the filter, odd ones after.
+  for (int i = 0; i < kNumKeys; i += 2) {
+    kv.key = static_cast<HTKey_t>(i);
+    kv.value = NewPayload(i);
+    ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+  }
+  HashTable_EnableBloomFilter(table, 0.01);
+  ASSERT_TRUE(table->bloom != NULL);
+  ASSERT_EQ(kNumKeys, table->bloom_capacity);
+  for (int i = 1; i < kNumKeys; i += 2) {
+    kv.key = static_cast<HTKey_t>(i);
+    kv.value = NewPayload(i);
+    ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+  }
+  // Once full, it is rebuilt bigger.
+  ASSERT_EQ(kNumKeys, table->bloom_capacity);
+  ASSERT_FALSE(HashTable_InsertBytes(table, "bytes", 5, NewPayload(-1),
+                                     &value));
+  ASSERT_EQ(2 * kNumKeys, table->bloom_capacity);
+
+  // Every key is still found; nearly every missing key is turned away by
+  // the filter without looking at its chain.
+  int filtered = 0;
+  for (int i = 0; i < 2 * kNumKeys; i++) {
+    HTKey_t key = static_cast<HTKey_t>(i);
+    ASSERT_EQ(i < kNumKeys, HashTable_Find(table, key, &kv));
+    if (i < kNumKeys) {
+      ASSERT_EQ(key, AsKeyType(kv.value));
+    } else {
+      filtered += !BloomFilter_MayContain(table->bloom,
+                                          HashKeyToBloomHash(table, key));
+    }
+  }
+  ASSERT_LT(0.97 * kNumKeys, filtered);
+  ASSERT_TRUE(HashTable_FindBytes(table, "bytes", 5, &value));
+  ASSERT_FALSE(HashTable_FindBytes(table, "bytez", 5, &value));
+
+  static HTKey_t keys[2 * kNumKeys];
+  static HTKeyValue_t results[2 * kNumKeys];
+  static bool found[2 * kNumKeys];
+  for (int i = 0; i < 2 * kNumKeys; i++) {
+    keys[i] = static_cast<HTKey_t>(i);
+  }
+  ASSERT_EQ(kNumKeys,
+            HashTable_FindBatch(table, keys, 2 * kNumKeys, results, found));
+  for (int i = 0; i < 2 * kNumKeys; i++) {
+    ASSERT_EQ(i < kNumKeys, found[i]);
+  }
+
+  // Removed keys linger in the filter...
+  for (int i = 0; i < kNumKeys; i += 2) {
+    HTKey_t key = static_cast<HTKey_t>(i);
+    ASSERT_TRUE(HashTable_Remove(table, key, &kv));
+    FreeValue(kv.value);
+    ASSERT_FALSE(HashTable_Find(table, key, &kv));
+    ASSERT_TRUE(BloomFilter_MayContain(table->bloom,
+                                       HashKeyToBloomHash(table, key)));
+  }
+  ASSERT_TRUE(HashTable_RemoveBytes(table, "bytes", 5, &value));
+  FreeValue(value);
+  ASSERT_EQ(kNumKeys / 2 + 1, table->bloom_removed);
+
+  // ...until enough removals have piled up that it is rebuilt without
+  // them, sized for what's left.
+  while (table->bloom_removed > 0) {
+    kv.key = static_cast<HTKey_t>(10 * kNumKeys);
+    kv.value = NewPayload(0);
+    ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+    ASSERT_TRUE(HashTable_Remove(table, kv.key, &kv));
+    FreeValue(kv.value);
+  }
+  ASSERT_EQ(kNumKeys, table->bloom_capacity);
+  filtered = 0;
+  for (int i = 0; i < kNumKeys; i++) {
+    HTKey_t key = static_cast<HTKey_t>(i);
+    ASSERT_EQ(i % 2 == 1, HashTable_Find(table, key, &kv));
+    filtered += !BloomFilter_MayContain(table->bloom,
+                                        HashKeyToBloomHash(table, key));
+  }
+  ASSERT_LT(0.97 * kNumKeys / 2, filtered);
+
+  // Passing 0 takes the filter away.
+  HashTable_EnableBloomFilter(table, 0);
+  ASSERT_TRUE(table->bloom == NULL);
+  ASSERT_TRUE(HashTable_Find(table, 1, &kv));
+  ASSERT_FALSE(HashTable_Find(table, 0, &kv));
+
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(kNumKeys / 2, freeInvocations_);
+}
+
+TEST_F(Test_HashTable, Tags) {
+  static const int kNumBuckets = 7;
+  static const int kNumKeys = 20 * kNumBuckets;
+  HashTable *table = HashTable_Allocate(kNumBuckets);
+  HTKeyValue_t kv, oldkv;
+
+  // Tags are never 0, and keys that share a bucket mostly differ in them.
+  set<uint8_t> tags;
+  for (int i = 0; i < 1000; i++) {
+    uint8_t tag = HashKeyToTag(static_cast<HTKey_t>(i * kNumBuckets));
+    ASSERT_NE(0, tag);
+    tags.insert(tag);
+  }
+  ASSERT_LT(200U, tags.size());
+
+  // Chains up to 20 long, so some have untagged entries past the first
+  // HT_NUM_TAGS.
+  FillChains(table, kNumKeys);
+  VerifyTags(table);
+  for (int i = 0; i < 2 * kNumKeys; i++) {
+    ASSERT_EQ(i < kNumKeys, HashTable_Find(table, static_cast<HTKey_t>(i),
+                                            &kv));
+  }
+
+  // Removing from the front, middle, tagged end and untagged tail of the
+  // chains keeps the tags in step.
+  for (int i : {0, 7 * 7, 7 * 19, 7 * 8, 7 * 7 + 1, 7 * 3 + 2, 7 * 12 + 3}) {
+    ASSERT_TRUE(HashTable_Remove(table, static_cast<HTKey_t>(i), &kv));
+    FreeValue(kv.value);
+    VerifyTags(table);
+    ASSERT_FALSE(HashTable_Find(table, static_cast<HTKey_t>(i), &kv));
+  }
+  HTIterator *it = HTIterator_Allocate(table);
+  for (int n = 0; HTIterator_IsValid(it); n++) {
+    if (n % 3 == 0) {
+      ASSERT_TRUE(HTIterator_Remove(it, &kv));
+      FreeValue(kv.value);
+      VerifyTags(table);
+    } else {
+      HTIterator_Next(it);
+    }
+  }
+  HTIterator_Free(it);
+
+  // Inserting pushes tags, and resizing rebuilds them.
+  for (int i = kNumKeys; i < 3 * kNumKeys; i++) {
+    kv.key = static_cast<HTKey_t>(i);
+    kv.value = NewPayload(i);
+    ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+    VerifyTags(table);
+  }
+  ASSERT_LT(kNumBuckets, HashTable_NumBuckets(table));
+  ASSERT_FALSE(HashTable_InsertBytes(table, "tag", 3, NewPayload(-1),
+                                     &kv.value));
+  VerifyTags(table);
+  int num_elements = HashTable_NumElements(table);
+  static HTKey_t keys[3 * kNumKeys];
+  static HTKeyValue_t results[3 * kNumKeys];
+  static bool found[3 * kNumKeys];
+  int expected = 0;
+  for (int i = 0; i < 3 * kNumKeys; i++) {
+    keys[i] = static_cast<HTKey_t>(i);
+    expected += HashTable_Find(table, keys[i], &kv) ? 1 : 0;
+  }
+  ASSERT_EQ(num_elements - 1, expected);
+  ASSERT_EQ(expected,
+            HashTable_FindBatch(table, keys, 3 * kNumKeys, results, found));
+  HashTable_Free(table, &Test_HashTable::InstrumentedVerifiedFree);
+  ASSERT_EQ(num_elements, freeInvocations_);
+
+  // Tables built in bulk have their tags too.
+  static HTKeyValue_t kvs[kNumKeys];
+  for (int i = 0; i < kNumKeys; i++) {
+    kvs[i].key = static_cast<HTKey_t>(i % (kNumKeys / 2));
+    kvs[i].value = NewPayload(i);
+  }
+  table = HashTable_BuildFromArray(kvs, kNumKeys, 4, &FreeValue);
+  VerifyTags(table);
+  HashTable_Free(table, &FreeValue);
+}
+
+TEST_F(Test_HashTable, ChainPolicy) {
+  static const int kNumKeys = 12;
+  HashTable *table = HashTable_Allocate(1);
+  HTKeyValue_t kv;
+  HTValue_t value;
+
+  // One chain, 0 .. 11 from the head.  Static: lookups change nothing.
+  FillChains(table, kNumKeys);
+  ASSERT_TRUE(HashTable_Find(table, 5, &kv));
+  ASSERT_EQ(vector<HTKey_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}),
+            ChainKeys(table, 0));
+
+  // Transpose moves a key one step per hit, from the untagged tail, the
+  // first untagged position and the tagged part.
+  HashTable_SetChainPolicy(table, HT_CHAIN_TRANSPOSE);
+  for (HTKey_t key : {10, 8, 8, 5, 0}) {
+    ASSERT_TRUE(HashTable_Find(table, key, &kv));
+    ASSERT_EQ(key, kv.key);
+    ASSERT_EQ(static_cast<int>(key),
+              static_cast<TestPayload *>(kv.value)->payload);
+    VerifyTags(table);
+  }
+  ASSERT_EQ(vector<HTKey_t>({0, 1, 2, 3, 5, 4, 8, 6, 7, 10, 9, 11}),
+            ChainKeys(table, 0));
+  ASSERT_FALSE(HashTable_Find(table, kNumKeys, &kv));
+
+  // Move-to-front, from the tail, the untagged part, the last tagged
+  // position and the middle.
+  HashTable_SetChainPolicy(table, HT_CHAIN_MOVE_TO_FRONT);
+  for (HTKey_t key : {11, 6, 4, 2, 2}) {
+    ASSERT_TRUE(HashTable_Find(table, key, &kv));
+    ASSERT_EQ(key, kv.key);
+    VerifyTags(table);
+  }
+  ASSERT_EQ(vector<HTKey_t>({2, 4, 6, 11, 0, 1, 3, 5, 8, 7, 10, 9}),
+            ChainKeys(table, 0));
+
+  // The chains stay usable: every key is still found, and removal and
+  // insertion keep the tags in step.
+  for (HTKey_t key = 0; key < kNumKeys; key++) {
+    ASSERT_TRUE(HashTable_Find(table, key, &kv));
+    VerifyTags(table);
+  }
+  ASSERT_TRUE(HashTable_Remove(table, 3, &kv));
+  FreeValue(kv.value);
+  VerifyTags(table);
+  ASSERT_EQ(static_cast<size_t>(kNumKeys - 1), ChainKeys(table, 0).size());
+  HashTable_Free(table, &FreeValue);
+
+  // Byte-keyed lookups reorder too.
+  table = HashTable_Allocate(1);
+  HashTable_SetChainPolicy(table, HT_CHAIN_MOVE_TO_FRONT);
+  ASSERT_FALSE(HashTable_InsertBytes(table, "a", 1, NewPayload(1), &value));
+  ASSERT_FALSE(HashTable_InsertBytes(table, "b", 1, NewPayload(2), &value));
+  ASSERT_TRUE(HashTable_FindBytes(table, "a", 1, &value));
+  ASSERT_EQ(1, static_cast<TestPayload *>(value)->payload);
+  ASSERT_EQ(1, static_cast<TestPayload *>(static_cast<HTKeyValue_t *>(
+      table->buckets[0]->head->payload)->value)->payload);
+  VerifyTags(table);
+  HashTable_Free(table, &FreeValue);
+}
+
+TEST_F(Test_HashTable, Multimap) {
+  static const int kNumKeys = 100;
+  HashTable *table = HashTable_AllocateMulti(1);
+  HTKeyValue_t kv, oldkv;
+
+  // Key k gets k % 7 values, payloads 1000 * k + 0, 1, ..., inserted in
+  // rounds so that the table resizes with duplicates in the chains.
+  int total = 0;
+  for (int round = 0; round < 7; round++) {
+    for (int k = 0; k < kNumKeys; k++) {
+      if (round < k % 7) {
+        kv.key = k;
+        kv.value = NewPayload(1000 * k + round);
+        ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+        total++;
+      }
+    }
+  }
+  ASSERT_EQ(total, HashTable_NumElements(table));
+  ASSERT_LT(1, HashTable_NumBuckets(table));
+  VerifyTags(table);
+
+  // FindAll visits exactly a key's values.
+  for (int k = 0; k < kNumKeys; k++) {
+    vector<bool> seen(k % 7, false);
+    HTIterator *it = HashTable_FindAll(table, k);
+    while (HTIterator_Get(it, &kv)) {
+      ASSERT_EQ(static_cast<HTKey_t>(k), kv.key);
+      int round = static_cast<TestPayload *>(kv.value)->payload - 1000 * k;
+      ASSERT_LE(0, round);
+      ASSERT_GT(k % 7, round);
+      ASSERT_FALSE(seen[round]);
+      seen[round] = true;
+      HTIterator_Next(it);
+    }
+    HTIterator_Free(it);
+    ASSERT_EQ(vector<bool>(k % 7, true), seen);
+    ASSERT_EQ(k % 7 != 0, HashTable_Find(table, k, &kv));
+  }
+
+  // RemoveOne takes a given value; the key's others stay.
+  HTIterator *it = HashTable_FindAll(table, 13);
+  TestPayload *victim = NULL;
+  while (HTIterator_Get(it, &kv)) {
+    if (static_cast<TestPayload *>(kv.value)->payload == 13003) {
+      victim = static_cast<TestPayload *>(kv.value);
+    }
+    HTIterator_Next(it);
+  }
+  HTIterator_Free(it);
+  ASSERT_TRUE(victim != NULL);
+  ASSERT_TRUE(HashTable_RemoveOne(table, 13, victim));
+  ASSERT_FALSE(HashTable_RemoveOne(table, 13, victim));
+  FreeValue(victim);
+  ASSERT_EQ(total - 1, HashTable_NumElements(table));
+
+  // An iterator from FindAll removes a key's values as it goes.
+  it = HashTable_FindAll(table, 20);
+  while (HTIterator_IsValid(it)) {
+    ASSERT_TRUE(HTIterator_Remove(it, &kv));
+    ASSERT_EQ(20U, kv.key);
+    FreeValue(kv.value);
+  }
+  HTIterator_Free(it);
+  ASSERT_FALSE(HashTable_Find(table, 20, &kv));
+  ASSERT_EQ(total - 1 - 6, HashTable_NumElements(table));
+
+  // RemoveAll takes the rest of a key's values, with the Bloom filter on.
+  HashTable_EnableBloomFilter(table, 0.01);
+  ASSERT_EQ(5, HashTable_RemoveAll(table, 13, &FreeValue));
+  ASSERT_EQ(0, HashTable_RemoveAll(table, 13, &FreeValue));
+  ASSERT_EQ(0, HashTable_RemoveAll(table, kNumKeys, &FreeValue));
+  it = HashTable_FindAll(table, 13);
+  ASSERT_FALSE(HTIterator_IsValid(it));
+  HTIterator_Free(it);
+  ASSERT_EQ(total - 1 - 6 - 5, HashTable_NumElements(table));
+  VerifyTags(table);
+  HashTable_Free(table, &FreeValue);
+
+  // FindAll works on an ordinary table too, including one without buckets.
+  table = HashTable_AllocateSmall();
+  InsertElement(table, 1);
+  InsertElement(table, 2);
+  it = HashTable_FindAll(table, 2);
+  ASSERT_TRUE(HTIterator_Get(it, &kv));
+  ASSERT_EQ(2U, kv.key);
+  ASSERT_FALSE(HTIterator_Next(it));
+  HTIterator_Free(it);
+  ASSERT_EQ(1, HashTable_RemoveAll(table, 1, &FreeValue));
+  ASSERT_EQ(1, HashTable_NumElements(table));
+  HashTable_Free(table, &FreeValue);
+}
+
+TEST_F(Test_HashTable, Dense) {
+  static const int kNumKeys = 10000;
+  static const int kNumOutliers = 100;
+  static const HTKey_t kOutlierBase = 1ULL << 40;
+  HashTable *table = HashTable_Allocate(16);
+  HTKeyValue_t kv, oldkv;
+
+  // Keys 0 .. kNumKeys - 1 in order, with a few far-off outliers mixed in;
+  // the first resize finds the window and later keys grow it.
+  HashTable_EnableDense(table);
+  ASSERT_TRUE(table->dense == NULL);
+  for (int i = 0; i < kNumKeys; i++) {
+    InsertElement(table, i);
+    if (i % (kNumKeys / kNumOutliers) == 0) {
+      kv.key = kOutlierBase + i;
+      kv.value = NewPayload(i);
+      ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+    }
+  }
+  ASSERT_TRUE(table->dense != NULL);
+  ASSERT_EQ(0U, table->dense->first_key);
+  ASSERT_EQ(kNumKeys, table->dense->num_present);
+  ASSERT_EQ(kNumKeys + kNumOutliers, HashTable_NumElements(table));
+  ASSERT_GE(3 * HashTable_NumBuckets(table), kNumOutliers);
+  VerifyTags(table);
+  for (int b = 0; b < table->num_buckets; b++) {
+    for (HTKey_t key : ChainKeys(table, b)) {
+      ASSERT_LE(kOutlierBase, key);
+    }
+  }
+
+  // Lookups, one at a time and batched, in and out of the window.
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_TRUE(HashTable_Find(table, i, &kv));
+    ASSERT_EQ(static_cast<HTKey_t>(i), kv.key);
+    ASSERT_EQ(static_cast<HTKey_t>(i), AsKeyType(kv.value));
+    ASSERT_EQ(i % (kNumKeys / kNumOutliers) == 0,
+              HashTable_Find(table, kOutlierBase + i, &kv));
+  }
+  ASSERT_FALSE(HashTable_Find(table, table->dense->num_slots - 1, &kv));
+  ASSERT_FALSE(HashTable_Find(table, UINT64_MAX, &kv));
+  HTKey_t keys[] = {5, kOutlierBase, kNumKeys, kOutlierBase + 1, 9999, 17};
+  HTKeyValue_t results[6];
+  bool found[6];
+  ASSERT_EQ(4, HashTable_FindBatch(table, keys, 6, results, found));
+  ASSERT_EQ((vector<bool>{true, true, false, false, true, true}),
+            vector<bool>(found, found + 6));
+  ASSERT_EQ(kOutlierBase, results[1].key);
+  ASSERT_EQ(17U, results[5].key);
+
+  // Replacing and removing in the window.
+  kv.key = 42;
+  kv.value = NewPayload(-42);
+  ASSERT_TRUE(HashTable_Insert(table, kv, &oldkv));
+  ASSERT_EQ(42U, AsKeyType(oldkv.value));
+  FreeValue(oldkv.value);
+  ASSERT_TRUE(HashTable_Remove(table, 42, &kv));
+  ASSERT_EQ(-42, static_cast<TestPayload *>(kv.value)->payload);
+  FreeValue(kv.value);
+  ASSERT_FALSE(HashTable_Remove(table, 42, &kv));
+  ASSERT_TRUE(HashTable_Remove(table, kOutlierBase, &kv));
+  FreeValue(kv.value);
+  HTIterator *it = HashTable_FindAll(table, 43);
+  ASSERT_TRUE(HTIterator_Get(it, &kv));
+  ASSERT_EQ(43U, kv.key);
+  ASSERT_FALSE(HTIterator_Next(it));
+  HTIterator_Free(it);
+  it = HashTable_FindAll(table, 42);
+  ASSERT_FALSE(HTIterator_IsValid(it));
+  HTIterator_Free(it);
+  int num_elements = kNumKeys + kNumOutliers - 2;
+  ASSERT_EQ(num_elements, HashTable_NumElements(table));
+
+  // Iterators visit the window and the chains, each key once.
+  set<HTKey_t> seen;
+  it = HTIterator_Allocate(table);
+  while (HTIterator_Get(it, &kv)) {
+    ASSERT_TRUE(seen.insert(kv.key).second);
+    HTIterator_Next(it);
+  }
+  HTIterator_Free(it);
+  ASSERT_EQ(static_cast<size_t>(num_elements), seen.size());
+
+  // Parallel ranges split the window among them, and remove from it.
+  ForEachCtx ctx = {0, 0, true};
+  HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, 4);
+  ASSERT_EQ(num_elements, ctx.visits);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(i % 2 == 0 && i != 42, HashTable_Find(table, i, &kv));
+  }
+  ASSERT_EQ(kNumKeys / 2 - 1, table->dense->num_present);
+
+  // Freezing takes the window's keys along.
+  num_elements = HashTable_NumElements(table);
+  HashTable_Freeze(table);
+  ASSERT_EQ(num_elements, HashTable_NumElements(table));
+  ASSERT_TRUE(HashTable_Find(table, 0, &kv));
+  ASSERT_TRUE(HashTable_Find(table, kOutlierBase + kNumKeys / 2, &kv));
+  ASSERT_FALSE(HashTable_Find(table, 1, &kv));
+  HashTable_Free(table, &FreeValue);
+
+  // An explicit window, with an outlier below it; it grows to take a key
+  // just past its end, and the outliers that land inside it.
+  table = HashTable_AllocateDense(1000, 100);
+  InsertElement(table, 1150);
+  InsertElement(table, 500);
+  ASSERT_EQ(0, table->dense->num_present);
+  for (int i = 1000; i < 1100; i++) {
+    InsertElement(table, i);
+  }
+  InsertElement(table, 1100);
+  ASSERT_EQ(200, table->dense->num_slots);
+  ASSERT_EQ(102, table->dense->num_present);
+  ASSERT_EQ(103, HashTable_NumElements(table));
+  ASSERT_TRUE(HashTable_Find(table, 1150, &kv));
+  ASSERT_TRUE(HashTable_Find(table, 500, &kv));
+  VerifyTags(table);
+  HashTable_Free(table, &FreeValue);
+
+  // Keys with no dense range never get a window.
+  table = HashTable_Allocate(4);
+  HashTable_EnableDense(table);
+  for (int i = 0; i < 1000; i++) {
+    InsertElement(table, i * 1000003);
+  }
+  ASSERT_TRUE(table->dense == NULL);
+  HashTable_Free(table, &FreeValue);
+}
+
+// Checks that every entry of a cuckoo table is in one of its key's two
+// buckets, under its tag, and that the count is right.
+static void VerifyCuckoo(HashTable *table) {
+  int num_occupied = 0;
+  for (int b = 0; b < table->num_buckets; b++) {
+    for (int i = 0; i < HT_CUCKOO_SLOTS; i++) {
+      uint8_t tag = (table->cuckoo->tags[b] >> (8 * i)) & 0xff;
+      if (tag == 0) {
+        continue;
+      }
+      HTKey_t key = table->cuckoo->slots[b * HT_CUCKOO_SLOTS + i].key;
+      uint64_t hash = HashKeyToBloomHash(table, key);
+      int b1 = hash & (table->num_buckets - 1);
+      int b2 = (hash >> 32) & (table->num_buckets - 1);
+      if (b2 == b1) {
+        b2 = b1 ^ 1;
+      }
+      ASSERT_TRUE(b == b1 || b == b2) << "key " << key;
+      ASSERT_EQ(HashKeyToTag(key), tag);
+      num_occupied++;
+    }
+  }
+  ASSERT_EQ(HashTable_NumElements(table), num_occupied);
+}
+
+TEST_F(Test_HashTable, Cuckoo) {
+  static const HTKey_t kMul = 0x9e3779b97f4a7c15ULL;
+  HTKeyValue_t kv, oldkv;
+
+  // Sized for 1000 keys: 512 buckets, which hold up to 95% of their 2048
+  // slots before doubling, moving keys aside as the buckets fill.
+  HashTable *table = HashTable_AllocateCuckoo(1000);
+  ASSERT_EQ(512, HashTable_NumBuckets(table));
+  const int kFull = 512 * HT_CUCKOO_SLOTS * HT_CUCKOO_MAX_LOAD / 100;
+  for (int i = 0; i < kFull; i++) {
+    kv.key = i * kMul;
+    kv.value = NewPayload(i);
+    ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+  }
+  ASSERT_EQ(512, HashTable_NumBuckets(table));
+  ASSERT_EQ(kFull, HashTable_NumElements(table));
+  VerifyCuckoo(table);
+  for (int i = 0; i < kFull; i++) {
+    ASSERT_TRUE(HashTable_Find(table, i * kMul, &kv));
+    ASSERT_EQ(i, static_cast<TestPayload *>(kv.value)->payload);
+  }
+  ASSERT_FALSE(HashTable_Find(table, kFull * kMul, &kv));
+
+  // One more key doubles it.
+  kv.key = kFull * kMul;
+  kv.value = NewPayload(kFull);
+  ASSERT_FALSE(HashTable_Insert(table, kv, &oldkv));
+  ASSERT_EQ(1024, HashTable_NumBuckets(table));
+  int num_keys = kFull + 1;
+  VerifyCuckoo(table);
+
+  // Replace and remove.
+  kv.key = 7 * kMul;
+  kv.value = NewPayload(-7);
+  ASSERT_TRUE(HashTable_Insert(table, kv, &oldkv));
+  ASSERT_EQ(7, static_cast<TestPayload *>(oldkv.value)->payload);
+  FreeValue(oldkv.value);
+  ASSERT_TRUE(HashTable_Remove(table, 7 * kMul, &kv));
+  ASSERT_EQ(-7, static_cast<TestPayload *>(kv.value)->payload);
+  FreeValue(kv.value);
+  ASSERT_FALSE(HashTable_Remove(table, 7 * kMul, &kv));
+  ASSERT_FALSE(HashTable_Find(table, 7 * kMul, &kv));
+  num_keys--;
+  VerifyCuckoo(table);
+
+  // Batched lookups, FindAll and a full iteration.
+  HTKey_t keys[] = {0, kMul, 7 * kMul, 3, 100 * kMul};
+  HTKeyValue_t results[5];
+  bool found[5];
+  ASSERT_EQ(3, HashTable_FindBatch(table, keys, 5, results, found));
+  ASSERT_EQ((vector<bool>{true, true, false, false, true}),
+            vector<bool>(found, found + 5));
+  ASSERT_EQ(100, static_cast<TestPayload *>(results[4].value)->payload);
+  HTIterator *it = HashTable_FindAll(table, 100 * kMul);
+  ASSERT_TRUE(HTIterator_Get(it, &kv));
+  ASSERT_EQ(100 * kMul, kv.key);
+  ASSERT_FALSE(HTIterator_Next(it));
+  HTIterator_Free(it);
+  it = HashTable_FindAll(table, 7 * kMul);
+  ASSERT_FALSE(HTIterator_IsValid(it));
+  HTIterator_Free(it);
+  set<HTKey_t> seen;
+  it = HTIterator_Allocate(table);
+  while (HTIterator_Get(it, &kv)) {
+    ASSERT_TRUE(seen.insert(kv.key).second);
+    HTIterator_Next(it);
+  }
+  HTIterator_Free(it);
+  ASSERT_EQ(static_cast<size_t>(num_keys), seen.size());
+
+  // Parallel ranges remove the odd keys.
+  ForEachCtx ctx = {0, 0, true};
+  HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, 4);
+  ASSERT_EQ(num_keys, ctx.visits);
+  VerifyCuckoo(table);
+  for (int i = 0; i <= kFull; i++) {
+    ASSERT_EQ(i % 2 == 0, HashTable_Find(table, i * kMul, &kv));
+  }
+
+  // Freezing keeps the entries.
+  num_keys = HashTable_NumElements(table);
+  HashTable_Freeze(table);
+  ASSERT_EQ(num_keys, HashTable_NumElements(table));
+  ASSERT_TRUE(HashTable_Find(table, 2 * kMul, &kv));
+  ASSERT_FALSE(HashTable_Find(table, kMul, &kv));
+  HashTable_Free(table, &FreeValue);
+
+  // Sequential keys, from a table with no room to start with.
+  table = HashTable_AllocateCuckoo(0);
+  for (int i = 0; i < 20000; i++) {
+    InsertElement(table, i);
+  }
+  VerifyCuckoo(table);
+  for (int i = 0; i < 20000; i++) {
+    ASSERT_TRUE(HashTable_Find(table, i, &kv));
+  }
+  HashTable_Free(table, &FreeValue);
+}
+
+// Checks that t is an AVL tree whose keys are in [lo, hi] and whose nodes
+// point at chain nodes with their keys, and adds those to nodes.  Returns
+// its height.
+static int VerifyTree(HTTreeNode *t, HTKey_t lo, HTKey_t hi,
+                      set<LinkedListNode *> *nodes) {
+  if (t == NULL) {
+    return 0;
+  }
+  EXPECT_TRUE(lo <= t->key && t->key <= hi) << "key " << t->key;
+  EXPECT_EQ(t->key, static_cast<HTKeyValue_t *>(t->node->payload)->key);
+  EXPECT_TRUE(nodes->insert(t->node).second);
+  int left = t->left != NULL ? VerifyTree(t->left, lo, t->key - 1, nodes) : 0;
+  int right = t->right != NULL ? VerifyTree(t->right, t->key + 1, hi, nodes)
+                               : 0;
+  EXPECT_TRUE(left - right >= -1 && left - right <= 1) << "key " << t->key;
+  EXPECT_EQ(std::max(left, right) + 1, t->height);
+  return t->height;
+}
+
+// Checks that every chain long enough to need a tree has one, and that
+// every tree indexes exactly its chain's nodes.
+static void VerifyTrees(HashTable *table) {
+  for (int b = 0; b < table->num_buckets; b++) {
+    LinkedList *chain = table->buckets[b];
+    HTTreeNode *tree = table->trees != NULL ? table->trees[b] : NULL;
+
+    if (tree == NULL) {
+      ASSERT_LE(LinkedList_NumElements(chain), HT_TREEIFY_THRESHOLD)
+          << "bucket " << b;
+      continue;
+    }
+    ASSERT_GT(LinkedList_NumElements(chain), HT_UNTREEIFY_THRESHOLD);
+    set<LinkedListNode *> nodes, chain_nodes;
+    VerifyTree(tree, 0, UINT64_MAX, &nodes);
+    for (LinkedListNode *n = chain->head; n != NULL; n = n->next) {
+      chain_nodes.insert(n);
+    }
+    ASSERT_EQ(chain_nodes, nodes) << "bucket " << b;
+  }
+}
+
+TEST_F(Test_HashTable, Treeify) {
+  // Multiples of 9^5 share bucket 0 of a table that starts with one
+  // bucket through its first five resizes.
+  static const int kStride = 9 * 9 * 9 * 9 * 9;
+  static const int kNumColliding = 100, kNumOthers = 300;
+  HashTable *table = HashTable_Allocate(1);
+  HTKeyValue_t kv, oldkv;
+  set<HTKey_t> present;
+
+  // The entry that takes a chain past HT_TREEIFY_THRESHOLD gives it a tree.
+  for (int i = 1; i <= HT_TREEIFY_THRESHOLD; i++) {
+    InsertElement(table, i * kStride);
+  }
+  ASSERT_TRUE(table->trees == NULL);
+  InsertElement(table, (HT_TREEIFY_THRESHOLD + 1) * kStride);
+  ASSERT_TRUE(table->trees != NULL && table->trees[0] != NULL);
+  VerifyTrees(table);
+
+  // The long chain keeps a tree through resizes, while the other keys
+  // spread out.
+  for (int i = HT_TREEIFY_THRESHOLD + 2; i <= kNumColliding; i++) {
+    InsertElement(table, i * kStride);
+  }
+  for (int i = 1; i <= kNumOthers; i++) {
+    InsertElement(table, i);
+  }
+  ASSERT_EQ(729, HashTable_NumBuckets(table));
+  ASSERT_EQ(kNumColliding, LinkedList_NumElements(table->buckets[0]));
+  VerifyTrees(table);
+  VerifyTags(table);
+  for (int i = 1; i <= kNumColliding; i++) {
+    present.insert(static_cast<HTKey_t>(i) * kStride);
+  }
+  for (int i = 1; i <= kNumOthers; i++) {
+    present.insert(i);
+  }
+
+  // Lookups, one at a time and batched, and a replacement.
+  vector<HTKey_t> keys;
+  for (int i = 1; i <= kNumColliding + 1; i++) {
+    keys.push_back(static_cast<HTKey_t>(i) * kStride);
+    ASSERT_EQ(i <= kNumColliding, HashTable_Find(table, keys.back(), &kv));
+    if (i <= kNumColliding) {
+      ASSERT_EQ(i * kStride, static_cast<TestPayload *>(kv.value)->payload);
+    }
+  }
+  keys.push_back(1);
+  keys.push_back(kNumOthers + 1);
+  vector<HTKeyValue_t> results(keys.size());
+  bool found[kNumColliding + 3];
+  ASSERT_EQ(kNumColliding + 1,
+            HashTable_FindBatch(table, keys.data(),
+                                static_cast<int>(keys.size()),
+                                results.data(), found));
+  ASSERT_EQ(50 * kStride,
+            static_cast<TestPayload *>(results[49].value)->payload);
+  ASSERT_FALSE(found[kNumColliding]);
+  kv.key = 50 * kStride;
+  kv.value = NewPayload(-50);
+  ASSERT_TRUE(HashTable_Insert(table, kv, &oldkv));
+  ASSERT_EQ(50 * kStride, static_cast<TestPayload *>(oldkv.value)->payload);
+  FreeValue(oldkv.value);
+  ASSERT_EQ(kNumColliding, LinkedList_NumElements(table->buckets[0]));
+
+  // Lookups don't reorder a chain with a tree.
+  HashTable_SetChainPolicy(table, HT_CHAIN_MOVE_TO_FRONT);
+  vector<HTKey_t> chain = ChainKeys(table, 0);
+  ASSERT_TRUE(HashTable_Find(table, kStride, &kv));
+  ASSERT_EQ(chain, ChainKeys(table, 0));
+  HashTable_SetChainPolicy(table, HT_CHAIN_STATIC);
+
+  // Removal from the head, middle and tail of the chain.
+  for (int i = kNumColliding; i >= 1; i -= 3) {
+    ASSERT_TRUE(HashTable_Remove(table, i * kStride, &kv));
+    FreeValue(kv.value);
+    ASSERT_FALSE(HashTable_Remove(table, i * kStride, &kv));
+    present.erase(i * kStride);
+  }
+  VerifyTrees(table);
+  VerifyTags(table);
+
+  // Parallel ranges remove the odd keys (kStride is odd).
+  ForEachCtx ctx = {0, 0, true};
+  HashTable_ForEachParallel(table, &SumAndMaybeRemove, &ctx, 4);
+  ASSERT_EQ(static_cast<int>(present.size()), ctx.visits);
+  for (auto k = present.begin(); k != present.end();) {
+    k = (*k & 1) == 1 ? present.erase(k) : std::next(k);
+  }
+  VerifyTrees(table);
+  VerifyTags(table);
+
+  // An iterator removing down to HT_UNTREEIFY_THRESHOLD frees the tree.
+  HTIterator *it = HTIterator_AllocateRange(table, 0, 1);
+  while (LinkedList_NumElements(table->buckets[0]) >
+         HT_UNTREEIFY_THRESHOLD + 1) {
+    ASSERT_TRUE(HTIterator_Remove(it, &kv));
+    FreeValue(kv.value);
+    present.erase(kv.key);
+    VerifyTrees(table);
+  }
+  ASSERT_TRUE(table->trees[0] != NULL);
+  ASSERT_TRUE(HTIterator_Remove(it, &kv));
+  FreeValue(kv.value);
+  present.erase(kv.key);
+  ASSERT_TRUE(table->trees[0] == NULL);
+  HTIterator_Free(it);
+  VerifyTags(table);
+  ASSERT_EQ(static_cast<int>(present.size()), HashTable_NumElements(table));
+  for (int i = 1; i <= kNumColliding; i++) {
+    HTKey_t key = static_cast<HTKey_t>(i) * kStride;
+    ASSERT_EQ(present.count(key) == 1, HashTable_Find(table, key, &kv));
+  }
+
+  // Freezing keeps the entries.
+  HashTable_Freeze(table);
+  ASSERT_TRUE(table->trees == NULL);
+  for (HTKey_t key : present) {
+    ASSERT_TRUE(HashTable_Find(table, key, &kv));
+  }
+  HashTable_Free(table, &FreeValue);
+
+  // A table built in bulk gets trees for its long chains; a multimap never
+  // does.
+  static HTKeyValue_t kvs[2 * kNumOthers];
+  for (int i = 0; i < 2 * kNumOthers; i++) {
+    kvs[i].key = static_cast<HTKey_t>(i % 2 == 0 ? i / 2 : i * 2 * kNumOthers);
+    kvs[i].value = NewPayload(i);
+  }
+  table = HashTable_BuildFromArray(kvs, 2 * kNumOthers, 4, &FreeValue);
+  ASSERT_TRUE(table->trees != NULL && table->trees[0] != NULL);
+  VerifyTrees(table);
+  ASSERT_TRUE(HashTable_Find(table, 3 * 2 * kNumOthers, &kv));
+  HashTable_Free(table, &FreeValue);
+  table = HashTable_AllocateMulti(1);
+  for (int i = 0; i < 2 * HT_TREEIFY_THRESHOLD; i++) {
+    InsertElement(table, (i / 2) * kStride);
+  }
+  ASSERT_TRUE(table->trees == NULL);
+  HashTable_Free(table, &FreeValue);
+}
+
 }  // namespace hw1
@@ -0,0 +1,158 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./LRUCache.h"
+  #include "./LRUCache_priv.h"
+}
+
+#include "./test_suite.h"
+
+using std::vector;
+
+namespace hw1 {
+
+namespace {
+HTValue_t ToValue(uintptr_t v) {
+  return reinterpret_cast<HTValue_t>(v);
+}
+
+vector<uintptr_t> evicted;
+void RecordEvict(HTValue_t value) {
+  evicted.push_back(reinterpret_cast<uintptr_t>(value));
+}
+
+// A value's size is the value itself.
+size_t ValueSize(HTValue_t value) {
+  return reinterpret_cast<uintptr_t>(value);
+}
+
+// The cache's keys, most recently used first.
+vector<HTKey_t> RecencyOrder(LRUCache *cache) {
+  vector<HTKey_t> keys;
+  for (LinkedListNode *node = cache->recency->head; node != NULL;
+       node = node->next) {
+    keys.push_back(static_cast<LRUEntry *>(node->payload)->key);
+  }
+  return keys;
+}
+}  // anonymous namespace
+
+TEST(Test_LRUCache, CountCapacity) {
+  LRUCache *cache = LRUCache_Allocate(3, NULL, &RecordEvict);
+  HTKeyValue_t kv;
+
+  evicted.clear();
+  ASSERT_FALSE(LRUCache_Get(cache, 1, &kv));
+  for (HTKey_t key = 1; key <= 3; key++) {
+    ASSERT_FALSE(LRUCache_Put(cache, {key, ToValue(10 * key)}));
+  }
+  ASSERT_EQ(3, LRUCache_NumElements(cache));
+  ASSERT_EQ(3U, LRUCache_Size(cache));
+  ASSERT_EQ((vector<HTKey_t>{3, 2, 1}), RecencyOrder(cache));
+
+  // A hit makes 1 the most recent, so a fourth key evicts 2.
+  ASSERT_TRUE(LRUCache_Get(cache, 1, &kv));
+  ASSERT_EQ(1U, kv.key);
+  ASSERT_EQ(ToValue(10), kv.value);
+  ASSERT_EQ((vector<HTKey_t>{1, 3, 2}), RecencyOrder(cache));
+  ASSERT_FALSE(LRUCache_Put(cache, {4, ToValue(40)}));
+  ASSERT_EQ((vector<uintptr_t>{20}), evicted);
+  ASSERT_FALSE(LRUCache_Get(cache, 2, &kv));
+  ASSERT_EQ((vector<HTKey_t>{4, 1, 3}), RecencyOrder(cache));
+
+  // Replacing a key hands the old value to the callback, but not if it's
+  // the same value again.
+  ASSERT_TRUE(LRUCache_Put(cache, {3, ToValue(31)}));
+  ASSERT_TRUE(LRUCache_Put(cache, {3, ToValue(31)}));
+  ASSERT_EQ((vector<uintptr_t>{20, 30}), evicted);
+  ASSERT_EQ((vector<HTKey_t>{3, 4, 1}), RecencyOrder(cache));
+  ASSERT_EQ(3, LRUCache_NumElements(cache));
+
+  // Remove gives the value back without the callback.
+  ASSERT_TRUE(LRUCache_Remove(cache, 4, &kv));
+  ASSERT_EQ(ToValue(40), kv.value);
+  ASSERT_FALSE(LRUCache_Remove(cache, 4, &kv));
+  ASSERT_EQ((vector<HTKey_t>{3, 1}), RecencyOrder(cache));
+  ASSERT_EQ(2U, LRUCache_Size(cache));
+  ASSERT_EQ(2, cache->recency->num_elements);
+
+  evicted.clear();
+  LRUCache_Free(cache);
+  ASSERT_EQ((vector<uintptr_t>{31, 10}), evicted);
+}
+
+TEST(Test_LRUCache, ByteCapacity) {
+  LRUCache *cache = LRUCache_Allocate(100, &ValueSize, &RecordEvict);
+  HTKeyValue_t kv;
+
+  evicted.clear();
+  LRUCache_Put(cache, {1, ToValue(40)});
+  LRUCache_Put(cache, {2, ToValue(30)});
+  LRUCache_Put(cache, {3, ToValue(20)});
+  ASSERT_EQ(90U, LRUCache_Size(cache));
+
+  // 50 more bytes evict just the oldest, 40, to fill the cache exactly.
+  LRUCache_Put(cache, {4, ToValue(50)});
+  ASSERT_EQ((vector<uintptr_t>{40}), evicted);
+  ASSERT_EQ(100U, LRUCache_Size(cache));
+  ASSERT_EQ((vector<HTKey_t>{4, 3, 2}), RecencyOrder(cache));
+
+  // Growing a value in place evicts around it.
+  LRUCache_Get(cache, 3, &kv);
+  ASSERT_TRUE(LRUCache_Put(cache, {3, ToValue(60)}));
+  ASSERT_EQ((vector<uintptr_t>{40, 20, 30, 50}), evicted);
+  ASSERT_EQ(60U, LRUCache_Size(cache));
+  ASSERT_EQ((vector<HTKey_t>{3}), RecencyOrder(cache));
+
+  // A value too big for the whole cache doesn't stay, and takes the rest
+  // with it.
+  ASSERT_FALSE(LRUCache_Put(cache, {5, ToValue(101)}));
+  ASSERT_EQ((vector<uintptr_t>{40, 20, 30, 50, 60, 101}), evicted);
+  ASSERT_EQ(0, LRUCache_NumElements(cache));
+  ASSERT_EQ(0U, LRUCache_Size(cache));
+  ASSERT_FALSE(LRUCache_Get(cache, 5, &kv));
+
+  LRUCache_Put(cache, {6, ToValue(100)});
+  ASSERT_TRUE(LRUCache_Get(cache, 6, &kv));
+  LRUCache_Free(cache);
+}
+
+TEST(Test_LRUCache, Many) {
+  LRUCache *cache = LRUCache_Allocate(1000, NULL, &RecordEvict);
+  HTKeyValue_t kv;
+
+  // Stream 10000 keys through, touching key 0 as we go so that it stays.
+  evicted.clear();
+  LRUCache_Put(cache, {0, ToValue(0)});
+  for (uintptr_t i = 1; i < 10000; i++) {
+    LRUCache_Put(cache, {i, ToValue(i)});
+    ASSERT_TRUE(LRUCache_Get(cache, 0, &kv));
+  }
+  ASSERT_EQ(1000, LRUCache_NumElements(cache));
+  ASSERT_EQ(9000U, evicted.size());
+  for (uintptr_t i = 0; i < evicted.size(); i++) {
+    ASSERT_EQ(i + 1, evicted[i]);
+  }
+  for (HTKey_t key = 9001; key < 10000; key++) {
+    ASSERT_TRUE(LRUCache_Get(cache, key, &kv));
+  }
+  ASSERT_EQ(1000, HashTable_NumElements(cache->index));
+  LRUCache_Free(cache);
+}
+
+}  // namespace hw1
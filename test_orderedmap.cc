@@ -0,0 +1,273 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+
+#include <map>
+#include <random>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./OrderedMap.h"
+  #include "./OrderedMap_priv.h"
+}
+
+#include "./test_suite.h"
+
+using std::map;
+
+namespace hw1 {
+
+namespace {
+HTValue_t ToValue(uint64_t v) {
+  return reinterpret_cast<HTValue_t>(static_cast<uintptr_t>(v));
+}
+
+int num_freed;
+void CountFree(HTValue_t value) { num_freed++; }
+
+// Checks the subtree at node against the B+tree's invariants: keys sorted
+// and within [lo, hi), nodes other than the root at least half full, all
+// leaves at the same depth.  Returns the number of (key,value)s.
+int CheckSubtree(void *node, int height, bool is_root, HTKey_t lo,
+                 HTKey_t hi, bool has_hi) {
+  if (height == 0) {
+    OMLeaf *leaf = static_cast<OMLeaf *>(node);
+    EXPECT_LE(leaf->num_keys, OM_LEAF_SLOTS);
+    if (!is_root) {
+      EXPECT_GE(leaf->num_keys, OM_LEAF_SLOTS / 2);
+    }
+    for (int i = 0; i < leaf->num_keys; i++) {
+      EXPECT_LE(lo, leaf->keys[i]);
+      EXPECT_TRUE(!has_hi || leaf->keys[i] < hi);
+      EXPECT_TRUE(i == 0 || leaf->keys[i - 1] < leaf->keys[i]);
+    }
+    return leaf->num_keys;
+  }
+  OMInner *inner = static_cast<OMInner *>(node);
+  int count = 0;
+  EXPECT_LE(inner->num_keys, OM_INNER_SLOTS);
+  EXPECT_GE(inner->num_keys, is_root ? 1 : OM_INNER_SLOTS / 2);
+  for (int i = 0; i <= inner->num_keys; i++) {
+    HTKey_t child_lo = i == 0 ? lo : inner->keys[i - 1];
+    bool child_has_hi = i < inner->num_keys || has_hi;
+    HTKey_t child_hi = i < inner->num_keys ? inner->keys[i] : hi;
+    count += CheckSubtree(inner->children[i], height - 1, false, child_lo,
+                          child_hi, child_has_hi);
+  }
+  return count;
+}
+
+// Checks the whole map against expected, including the leaf links.
+void CheckMap(OrderedMap *m, const map<HTKey_t, uint64_t> &expected) {
+  ASSERT_EQ(static_cast<int>(expected.size()), OrderedMap_NumElements(m));
+  ASSERT_EQ(static_cast<int>(expected.size()),
+            CheckSubtree(m->root, m->height, true, 0, 0, false));
+
+  auto it = expected.begin();
+  OMLeaf *prev = NULL;
+  for (OMLeaf *leaf = m->first; leaf != NULL; leaf = leaf->next) {
+    ASSERT_EQ(prev, leaf->prev);
+    for (int i = 0; i < leaf->num_keys; i++, ++it) {
+      ASSERT_NE(expected.end(), it);
+      ASSERT_EQ(it->first, leaf->keys[i]);
+      ASSERT_EQ(ToValue(it->second), leaf->values[i]);
+    }
+    prev = leaf;
+  }
+  ASSERT_EQ(prev, m->last);
+  ASSERT_EQ(expected.end(), it);
+}
+}  // anonymous namespace
+
+TEST(Test_OrderedMap, Basic) {
+  OrderedMap *m = OrderedMap_Allocate();
+  HTKeyValue_t kv, old;
+
+  ASSERT_EQ(0, OrderedMap_NumElements(m));
+  ASSERT_FALSE(OrderedMap_Find(m, 5, &kv));
+  ASSERT_FALSE(OrderedMap_LowerBound(m, 0, &kv));
+  ASSERT_FALSE(OrderedMap_Remove(m, 5, &kv));
+
+  kv = {5, ToValue(50)};
+  ASSERT_FALSE(OrderedMap_Insert(m, kv, &old));
+  kv = {UINT64_MAX, ToValue(1)};
+  ASSERT_FALSE(OrderedMap_Insert(m, kv, &old));
+  kv = {0, ToValue(2)};
+  ASSERT_FALSE(OrderedMap_Insert(m, kv, &old));
+  kv = {5, ToValue(55)};
+  ASSERT_TRUE(OrderedMap_Insert(m, kv, &old));
+  ASSERT_EQ(5U, old.key);
+  ASSERT_EQ(ToValue(50), old.value);
+  ASSERT_EQ(3, OrderedMap_NumElements(m));
+
+  ASSERT_TRUE(OrderedMap_Find(m, 5, &kv));
+  ASSERT_EQ(ToValue(55), kv.value);
+  ASSERT_TRUE(OrderedMap_LowerBound(m, 1, &kv));
+  ASSERT_EQ(5U, kv.key);
+  ASSERT_TRUE(OrderedMap_LowerBound(m, 6, &kv));
+  ASSERT_EQ(UINT64_MAX, kv.key);
+
+  ASSERT_TRUE(OrderedMap_Remove(m, 0, &kv));
+  ASSERT_EQ(ToValue(2), kv.value);
+  ASSERT_FALSE(OrderedMap_Find(m, 0, &kv));
+  ASSERT_EQ(2, OrderedMap_NumElements(m));
+
+  num_freed = 0;
+  OrderedMap_Free(m, &CountFree);
+  ASSERT_EQ(2, num_freed);
+}
+
+TEST(Test_OrderedMap, Random) {
+  OrderedMap *m = OrderedMap_Allocate();
+  map<HTKey_t, uint64_t> expected;
+  std::mt19937_64 rng(42);
+  HTKeyValue_t kv, old;
+
+  // Enough keys for a tree three interior levels deep, from a small key
+  // space so that inserts replace and removes hit.  Grow, then shrink
+  // back to nothing.
+  for (int phase = 0; phase < 2; phase++) {
+    for (int i = 0; i < 200000; i++) {
+      HTKey_t key = rng() % 100000;
+      bool insert = phase == 0 ? rng() % 4 != 0 : rng() % 4 == 0;
+
+      if (insert) {
+        kv = {key, ToValue(i)};
+        ASSERT_EQ(expected.count(key) == 1, OrderedMap_Insert(m, kv, &old));
+        expected[key] = i;
+      } else {
+        bool present = expected.erase(key) == 1;
+        ASSERT_EQ(present, OrderedMap_Remove(m, key, &kv));
+      }
+      if (i % 20000 == 0) {
+        CheckMap(m, expected);
+      }
+    }
+    if (phase == 0) {
+      ASSERT_LE(2, m->height);
+    }
+    CheckMap(m, expected);
+  }
+  for (HTKey_t key = 0; key < 100000; key++) {
+    OrderedMap_Remove(m, key, &kv);
+  }
+  expected.clear();
+  CheckMap(m, expected);
+  ASSERT_EQ(0, m->height);
+  OrderedMap_Free(m, &CountFree);
+}
+
+TEST(Test_OrderedMap, LowerBound) {
+  OrderedMap *m = OrderedMap_Allocate();
+  HTKeyValue_t kv, old;
+
+  // The even keys 0..19998.
+  for (HTKey_t key = 0; key < 20000; key += 2) {
+    kv = {key, ToValue(key)};
+    OrderedMap_Insert(m, kv, &old);
+  }
+  for (HTKey_t key = 0; key < 19999; key++) {
+    ASSERT_TRUE(OrderedMap_LowerBound(m, key, &kv));
+    ASSERT_EQ((key + 1) & ~1ULL, kv.key);
+    ASSERT_EQ(ToValue(kv.key), kv.value);
+  }
+  ASSERT_FALSE(OrderedMap_LowerBound(m, 19999, &kv));
+  OrderedMap_Free(m, &CountFree);
+}
+
+TEST(Test_OrderedMap, Iterators) {
+  OrderedMap *m = OrderedMap_Allocate();
+  HTKeyValue_t kv, old;
+
+  // An empty map's iterators are invalid, and stay so.
+  OMIterator *iter = OMIterator_Allocate(m);
+  ASSERT_FALSE(OMIterator_IsValid(iter));
+  ASSERT_FALSE(OMIterator_Get(iter, &kv));
+  ASSERT_FALSE(OMIterator_Next(iter));
+  ASSERT_FALSE(OMIterator_Last(iter));
+  OMIterator_Free(iter);
+
+  // The multiples of 3 in 0..2999, and the extreme keys.
+  for (HTKey_t key = 0; key < 3000; key += 3) {
+    kv = {key, ToValue(key)};
+    OrderedMap_Insert(m, kv, &old);
+  }
+  kv = {UINT64_MAX, ToValue(0)};
+  OrderedMap_Insert(m, kv, &old);
+
+  // A full forward scan, then a full backward one.
+  iter = OMIterator_Allocate(m);
+  for (HTKey_t key = 0; key < 3000; key += 3) {
+    ASSERT_TRUE(OMIterator_Get(iter, &kv));
+    ASSERT_EQ(key, kv.key);
+    ASSERT_EQ(ToValue(key), kv.value);
+    ASSERT_TRUE(OMIterator_Next(iter));
+  }
+  ASSERT_TRUE(OMIterator_Get(iter, &kv));
+  ASSERT_EQ(UINT64_MAX, kv.key);
+  ASSERT_FALSE(OMIterator_Next(iter));
+  ASSERT_FALSE(OMIterator_IsValid(iter));
+  ASSERT_FALSE(OMIterator_Prev(iter));
+
+  ASSERT_TRUE(OMIterator_Last(iter));
+  ASSERT_TRUE(OMIterator_Get(iter, &kv));
+  ASSERT_EQ(UINT64_MAX, kv.key);
+  for (int64_t key = 2997; key >= 0; key -= 3) {
+    ASSERT_TRUE(OMIterator_Prev(iter));
+    ASSERT_TRUE(OMIterator_Get(iter, &kv));
+    ASSERT_EQ(static_cast<HTKey_t>(key), kv.key);
+  }
+  ASSERT_FALSE(OMIterator_Prev(iter));
+  ASSERT_TRUE(OMIterator_First(iter));
+  ASSERT_TRUE(OMIterator_Get(iter, &kv));
+  ASSERT_EQ(0U, kv.key);
+  OMIterator_Free(iter);
+
+  // Ranges, with bounds on and between keys, in both directions.
+  for (HTKey_t lo = 0; lo < 400; lo += 7) {
+    for (HTKey_t hi = lo; hi < lo + 300; hi += 11) {
+      iter = OMIterator_AllocateRange(m, lo, hi);
+      HTKey_t first = (lo + 2) / 3 * 3;
+      HTKey_t key = first;
+      for (; key <= hi; key += 3) {
+        ASSERT_TRUE(OMIterator_Get(iter, &kv));
+        ASSERT_EQ(key, kv.key);
+        OMIterator_Next(iter);
+      }
+      ASSERT_FALSE(OMIterator_IsValid(iter));
+      ASSERT_EQ(first <= hi, OMIterator_Last(iter));
+      for (key -= 3; key >= first && key <= hi; key -= 3) {
+        ASSERT_TRUE(OMIterator_Get(iter, &kv));
+        ASSERT_EQ(key, kv.key);
+        OMIterator_Prev(iter);
+      }
+      ASSERT_FALSE(OMIterator_IsValid(iter));
+      OMIterator_Free(iter);
+    }
+  }
+
+  // A range past every key but the largest, and one holding no key.
+  iter = OMIterator_AllocateRange(m, 3000, UINT64_MAX);
+  ASSERT_TRUE(OMIterator_Get(iter, &kv));
+  ASSERT_EQ(UINT64_MAX, kv.key);
+  ASSERT_FALSE(OMIterator_Prev(iter));
+  OMIterator_Free(iter);
+  iter = OMIterator_AllocateRange(m, 3000, UINT64_MAX - 1);
+  ASSERT_FALSE(OMIterator_IsValid(iter));
+  ASSERT_FALSE(OMIterator_Last(iter));
+  OMIterator_Free(iter);
+
+  OrderedMap_Free(m, &CountFree);
+}
+
+}  // namespace hw1
@@ -0,0 +1,94 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <utility>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./HashTable.h"
+}
+
+#include "./StaticHashTable.h"
+#include "./test_suite.h"
+
+namespace hw1 {
+
+namespace {
+constexpr auto kOpcodes = MakeStaticHashTable<const char *>({
+  {0x01, "load"}, {0x02, "store"}, {0x10, "add"}, {0x11, "sub"},
+  {0x12, "mul"}, {0x13, "div"}, {0x20, "jump"}, {0x21, "branch"},
+  {0xff, "halt"}, {0x8000000000000000ULL, "trap"},
+});
+
+// Built by the compiler, so these are checked before the suite even runs.
+static_assert(kOpcodes.NumKeys() == 10);
+static_assert(kOpcodes.Contains(0x10) && kOpcodes.Contains(0xff));
+static_assert(!kOpcodes.Contains(0) && !kOpcodes.Contains(0x03));
+
+// The keys 1, 1 + 7919, 1 + 2 * 7919, ..., each with value its index.
+template <size_t... I>
+constexpr auto ManyKeys(std::index_sequence<I...>) {
+  return MakeStaticHashTable<uint32_t>(
+      {StaticEntry<uint32_t>{1 + I * 7919, I}...});
+}
+constexpr auto kMany = ManyKeys(std::make_index_sequence<1000>());
+}  // anonymous namespace
+
+HW1_STATIC_HASHTABLE_FIND_FN(Opcodes_Find, kOpcodes)
+HW1_STATIC_HASHTABLE_FIND_FN(Many_Find, kMany)
+
+TEST(Test_StaticHashTable, Find) {
+  const char *name;
+
+  ASSERT_TRUE(kOpcodes.Find(0x21, &name));
+  ASSERT_STREQ("branch", name);
+  ASSERT_TRUE(kOpcodes.Find(0x8000000000000000ULL, &name));
+  ASSERT_STREQ("trap", name);
+  name = "unchanged";
+  ASSERT_FALSE(kOpcodes.Find(0x22, &name));
+  ASSERT_STREQ("unchanged", name);
+
+  for (size_t i = 0; i < 1000; i++) {
+    uint32_t value;
+
+    ASSERT_TRUE(kMany.Find(1 + i * 7919, &value));
+    ASSERT_EQ(i, value);
+    ASSERT_FALSE(kMany.Contains(2 + i * 7919));
+  }
+}
+
+TEST(Test_StaticHashTable, HashTableFindContract) {
+  // The generated functions can stand in for HashTable_Find, bound to
+  // their table.
+  bool (*find)(HTKey_t, HTKeyValue_t *) = &Opcodes_Find;
+  HTKeyValue_t kv = {1234, NULL};
+
+  ASSERT_TRUE(find(0x02, &kv));
+  ASSERT_EQ(0x02U, kv.key);
+  ASSERT_STREQ("store", static_cast<const char *>(kv.value));
+  ASSERT_FALSE(find(0x03, &kv));
+  ASSERT_EQ(0x02U, kv.key);
+
+  // Integer values come back as HTValue_t, as if stored with a cast.
+  find = &Many_Find;
+  for (uint64_t i = 0; i < 1000; i++) {
+    ASSERT_TRUE(find(1 + i * 7919, &kv));
+    ASSERT_EQ(1 + i * 7919, kv.key);
+    ASSERT_EQ(i, reinterpret_cast<uintptr_t>(kv.value));
+  }
+  ASSERT_FALSE(find(0, &kv));
+}
+
+}  // namespace hw1
@@ -0,0 +1,217 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./HashTable.h"
+  #include "./StringPool.h"
+  #include "./StringPool_priv.h"
+}
+
+#include "./test_suite.h"
+
+using std::string;
+using std::vector;
+
+namespace hw1 {
+
+namespace {
+string Token(int i) {
+  return "tok" + std::to_string(i * 7919 % 1000) + string(i % 13, '_');
+}
+
+struct InternCtx {
+  StringPool *pool;
+  int offset;
+  vector<StringId> ids;  // ids[i] is the ID this thread got for Token(i)
+};
+
+void *InternThread(void *arg) {
+  InternCtx *ctx = static_cast<InternCtx *>(arg);
+  const int n = static_cast<int>(ctx->ids.size());
+  // Each thread walks the tokens from a different starting point, so the
+  // threads race to be the first to intern each one.
+  for (int round = 0; round < 3; round++) {
+    for (int j = 0; j < n; j++) {
+      int i = (j + ctx->offset) % n;
+      string t = Token(i);
+      ctx->ids[i] = StringPool_Intern(ctx->pool, t.data(), t.size());
+    }
+  }
+  return NULL;
+}
+}  // anonymous namespace
+
+TEST(Test_StringPool, IdToSlot) {
+  int s;
+  uint32_t offset;
+
+  SPIdToSlot(0, &s, &offset);
+  ASSERT_EQ(0, s);
+  ASSERT_EQ(0U, offset);
+  SPIdToSlot(SP_SEGMENT_BASE - 1, &s, &offset);
+  ASSERT_EQ(0, s);
+  ASSERT_EQ(static_cast<uint32_t>(SP_SEGMENT_BASE - 1), offset);
+  SPIdToSlot(SP_SEGMENT_BASE, &s, &offset);
+  ASSERT_EQ(1, s);
+  ASSERT_EQ(0U, offset);
+  SPIdToSlot(3 * SP_SEGMENT_BASE, &s, &offset);
+  ASSERT_EQ(2, s);
+  ASSERT_EQ(0U, offset);
+  SPIdToSlot(UINT32_MAX - 1, &s, &offset);
+  ASSERT_GT(SP_NUM_SEGMENTS, s);
+  ASSERT_GT(static_cast<uint64_t>(SP_SEGMENT_BASE) << s, offset);
+}
+
+TEST(Test_StringPool, InternAndLookup) {
+  StringPool *pool = StringPool_Allocate();
+  StringId id;
+  size_t len;
+
+  ASSERT_EQ(0, StringPool_NumStrings(pool));
+  ASSERT_FALSE(StringPool_Lookup(pool, "hello", 5, &id));
+
+  // IDs are handed out densely, and re-interning returns the same one.
+  ASSERT_EQ(0U, StringPool_Intern(pool, "hello", 5));
+  ASSERT_EQ(1U, StringPool_Intern(pool, "world", 5));
+  ASSERT_EQ(2U, StringPool_Intern(pool, "hell", 4));
+  ASSERT_EQ(3U, StringPool_Intern(pool, "", 0));
+  ASSERT_EQ(0U, StringPool_Intern(pool, "hello", 5));
+  ASSERT_EQ(3U, StringPool_Intern(pool, "", 0));
+  ASSERT_EQ(4, StringPool_NumStrings(pool));
+  ASSERT_TRUE(StringPool_Lookup(pool, "world", 5, &id));
+  ASSERT_EQ(1U, id);
+
+  // The pool's copy is NUL-terminated and stable.
+  char buf[] = "hello";
+  const char *s = StringPool_String(pool, StringPool_Intern(pool, buf, 5),
+                                    &len);
+  buf[0] = 'j';
+  ASSERT_STREQ("hello", s);
+  ASSERT_EQ(5U, len);
+  ASSERT_STREQ("", StringPool_String(pool, 3, NULL));
+
+  // Enough strings to fill several chunks and ID segments, plus some too
+  // big to share a chunk.
+  for (int i = 0; i < 20000; i++) {
+    string t = "string number " + std::to_string(i);
+    if (i % 1000 == 0) {
+      t += string(SP_CHUNK_SIZE, 'z');
+    }
+    ASSERT_EQ(static_cast<StringId>(4 + i),
+              StringPool_Intern(pool, t.data(), t.size()));
+  }
+  ASSERT_EQ(s, StringPool_String(pool, 0, NULL));
+  for (int i = 0; i < 20000; i++) {
+    string t = "string number " + std::to_string(i);
+    if (i % 1000 == 0) {
+      t += string(SP_CHUNK_SIZE, 'z');
+    }
+    s = StringPool_String(pool, 4 + i, &len);
+    ASSERT_EQ(t.size(), len);
+    ASSERT_EQ(0, memcmp(t.data(), s, len));
+    ASSERT_EQ('\0', s[len]);
+  }
+
+  StringPoolStats stats;
+  StringPool_GetStats(pool, &stats);
+  ASSERT_EQ(20004U, stats.num_strings);
+  ASSERT_EQ(20007U, stats.num_interns);
+  ASSERT_LT(stats.string_bytes, stats.interned_bytes);
+  ASSERT_LE(stats.string_bytes, stats.arena_bytes);
+  ASSERT_LT(0U, stats.index_bytes);
+
+  StringPool_Free(pool);
+}
+
+TEST(Test_StringPool, HashCollisions) {
+  StringPool *pool = StringPool_Allocate();
+  HTKey_t hash = FNVHash64(reinterpret_cast<unsigned char *>(
+                               const_cast<char *>("apple")), 5);
+  SPShard *shard = &pool->shards[hash >> (64 - SP_SHARD_BITS)];
+
+  // Plant a different string under "apple"'s hash, as if the two collided.
+  SPRecord *fake = static_cast<SPRecord *>(malloc(sizeof(SPRecord) + 6));
+  fake->len = 5;
+  fake->id = 1000;
+  memcpy(SPRecord_Bytes(fake), "mango", 6);
+  HTKeyValue_t kv = {hash, fake}, old;
+  HashTable_Insert(shard->table, kv, &old);
+
+  // "apple" probes past it to the next key.
+  StringId id = StringPool_Intern(pool, "apple", 5);
+  ASSERT_EQ(0U, id);
+  ASSERT_TRUE(HashTable_Find(shard->table, hash + 1, &kv));
+  ASSERT_STREQ("apple", SPRecord_Bytes(static_cast<SPRecord *>(kv.value)));
+  ASSERT_EQ(0U, StringPool_Intern(pool, "apple", 5));
+  ASSERT_TRUE(StringPool_Lookup(pool, "apple", 5, &id));
+  ASSERT_EQ(0U, id);
+
+  ASSERT_TRUE(HashTable_Remove(shard->table, hash, &kv));
+  free(fake);
+  StringPool_Free(pool);
+}
+
+TEST(Test_StringPool, Concurrent) {
+  static const int kNumThreads = 4;
+  static const int kNumTokens = 3000;
+  StringPool *pool = StringPool_Allocate();
+  pthread_t threads[kNumThreads];
+  InternCtx ctx[kNumThreads];
+
+  for (int t = 0; t < kNumThreads; t++) {
+    ctx[t].pool = pool;
+    ctx[t].offset = t * kNumTokens / kNumThreads;
+    ctx[t].ids.resize(kNumTokens);
+    ASSERT_EQ(0, pthread_create(&threads[t], NULL, &InternThread, &ctx[t]));
+  }
+  for (int t = 0; t < kNumThreads; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  // Every thread got the same ID for the same token, distinct tokens got
+  // distinct IDs, and the IDs are exactly 0..N-1.
+  int num_distinct = StringPool_NumStrings(pool);
+  vector<int> owner(num_distinct, -1);
+  for (int i = 0; i < kNumTokens; i++) {
+    StringId id = ctx[0].ids[i];
+    for (int t = 1; t < kNumThreads; t++) {
+      ASSERT_EQ(id, ctx[t].ids[i]);
+    }
+    ASSERT_LT(id, static_cast<StringId>(num_distinct));
+    string t = Token(i);
+    ASSERT_EQ(t, StringPool_String(pool, id, NULL));
+    if (owner[id] == -1) {
+      owner[id] = i;
+    } else {
+      ASSERT_EQ(Token(owner[id]), t);
+    }
+  }
+  for (int id = 0; id < num_distinct; id++) {
+    ASSERT_NE(-1, owner[id]);
+  }
+
+  StringPoolStats stats;
+  StringPool_GetStats(pool, &stats);
+  ASSERT_EQ(static_cast<uint64_t>(3 * kNumThreads * kNumTokens),
+            stats.num_interns);
+  StringPool_Free(pool);
+}
+
+}  // namespace hw1
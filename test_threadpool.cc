@@ -0,0 +1,182 @@
+/*
+ * Copyright ©2025 Hal Perkins.  All rights reserved.  Permission is
+ * hereby granted to students registered for University of Washington
+ * CSE 333 for use solely during Spring Quarter 2025 for purposes of
+ * the course.  No other use, copying, distribution, or modification
+ * is permitted without prior written consent. Copyrights for
+ * third-party components of this work must be honored.  Instructors
+ * interested in reusing these course materials should contact the
+ * author.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+  #include "./ThreadPool.h"
+  #include "./ThreadPool_priv.h"
+}
+
+#include "./test_suite.h"
+
+namespace hw1 {
+
+namespace {
+// Each task adds its argument to this counter.
+uint64_t counter;
+
+void AddToCounter(void *arg) {
+  __atomic_fetch_add(&counter, reinterpret_cast<uintptr_t>(arg),
+                     __ATOMIC_RELAXED);
+}
+
+// A task that fans out into child tasks on a nested group and waits for
+// them, the way a recursive parallel algorithm would.
+struct FanOut {
+  ThreadPool *pool;
+  int depth;
+};
+
+void FanOutTask(void *arg) {
+  FanOut *f = static_cast<FanOut *>(arg);
+  __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+  if (f->depth == 0) {
+    return;
+  }
+  FanOut children[3];
+  TaskGroup *group = TaskGroup_Allocate(f->pool);
+  for (int i = 0; i < 3; i++) {
+    children[i] = {f->pool, f->depth - 1};
+    TaskGroup_Submit(group, &FanOutTask, &children[i]);
+  }
+  TaskGroup_Wait(group);
+  TaskGroup_Free(group);
+}
+
+// A task that submits num_tasks slow tasks to a nested group from
+// whichever worker it runs on, and waits for them.
+struct Skewed {
+  ThreadPool *pool;
+  int num_tasks;
+  pthread_t thread;  // the thread it ran on
+  bool done;
+};
+
+void SlowTask(void *arg) {
+  struct timespec one_ms = {0, 1000000};
+  nanosleep(&one_ms, NULL);
+  __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+}
+
+void SkewedTask(void *arg) {
+  Skewed *s = static_cast<Skewed *>(arg);
+  TaskGroup *group = TaskGroup_Allocate(s->pool);
+
+  s->thread = pthread_self();
+  for (int i = 0; i < s->num_tasks; i++) {
+    TaskGroup_Submit(group, &SlowTask, NULL);
+  }
+  TaskGroup_Wait(group);
+  TaskGroup_Free(group);
+  __atomic_store_n(&s->done, true, __ATOMIC_RELEASE);
+}
+}  // anonymous namespace
+
+TEST(Test_ThreadPool, AllocFree) {
+  ThreadPool *pool = ThreadPool_Allocate(3);
+  ASSERT_EQ(3, ThreadPool_NumWorkers(pool));
+  ASSERT_EQ(0, pool->pending);
+
+  // Waiting on an empty group returns right away.
+  TaskGroup *group = TaskGroup_Allocate(pool);
+  TaskGroup_Wait(group);
+  TaskGroup_Free(group);
+  ThreadPool_Free(pool);
+
+  // The shared pool is created once and reused.
+  ThreadPool *shared = ThreadPool_Default();
+  ASSERT_TRUE(shared != NULL);
+  ASSERT_LT(0, ThreadPool_NumWorkers(shared));
+  ASSERT_EQ(shared, ThreadPool_Default());
+}
+
+TEST(Test_ThreadPool, SubmitAndWait) {
+  static const int kNumTasks = 10000;
+  ThreadPool *pool = ThreadPool_Allocate(4);
+  TaskGroup *group = TaskGroup_Allocate(pool);
+
+  // The same group can be waited on and reused several times.
+  for (int round = 1; round <= 3; round++) {
+    counter = 0;
+    for (int i = 1; i <= kNumTasks; i++) {
+      TaskGroup_Submit(group, &AddToCounter,
+                       reinterpret_cast<void *>(static_cast<uintptr_t>(i)));
+    }
+    TaskGroup_Wait(group);
+    ASSERT_EQ(static_cast<uint64_t>(kNumTasks) * (kNumTasks + 1) / 2,
+              counter);
+    ASSERT_EQ(0, group->outstanding);
+  }
+  TaskGroup_Free(group);
+  ThreadPool_Free(pool);
+}
+
+TEST(Test_ThreadPool, Stealing) {
+  static const int kNumTasks = 64;
+  ThreadPool *pool = ThreadPool_Allocate(4);
+  TaskGroup *group = TaskGroup_Allocate(pool);
+  Skewed root = {pool, kNumTasks, pthread_self(), false};
+
+  // Spin rather than wait, so that the root task runs on a worker, which
+  // then has every child task on its own deque.
+  counter = 0;
+  TaskGroup_Submit(group, &SkewedTask, &root);
+  while (!__atomic_load_n(&root.done, __ATOMIC_ACQUIRE)) {
+    sched_yield();
+  }
+  TaskGroup_Wait(group);
+  TaskGroup_Free(group);
+  ASSERT_EQ(static_cast<uint64_t>(kNumTasks), counter);
+
+  // The other workers only ran tasks they stole from the root's worker,
+  // and the root's worker couldn't have run them all alone in the time.
+  uint64_t others_run = 0;
+  int root_worker = -1;
+  for (int w = 0; w < pool->num_workers; w++) {
+    Worker *worker = &pool->workers[w];
+    uint64_t run = __atomic_load_n(&worker->tasks_run, __ATOMIC_RELAXED);
+    uint64_t stolen = __atomic_load_n(&worker->tasks_stolen,
+                                      __ATOMIC_RELAXED);
+    if (pthread_equal(worker->thread, root.thread)) {
+      root_worker = w;
+      continue;
+    }
+    ASSERT_EQ(run, stolen) << "worker " << w;
+    others_run += run;
+  }
+  ASSERT_NE(-1, root_worker);
+  ASSERT_LT(0U, others_run);
+  ThreadPool_Free(pool);
+}
+
+TEST(Test_ThreadPool, NestedGroups) {
+  // More nested waits than workers: waiters must help rather than block.
+  ThreadPool *pool = ThreadPool_Allocate(2);
+  FanOut root = {pool, 5};
+  TaskGroup *group = TaskGroup_Allocate(pool);
+
+  counter = 0;
+  TaskGroup_Submit(group, &FanOutTask, &root);
+  TaskGroup_Wait(group);
+  TaskGroup_Free(group);
+
+  // 1 + 3 + 9 + ... + 3^5 tasks.
+  ASSERT_EQ(364U, counter);
+  ThreadPool_Free(pool);
+}
+
+}  // namespace hw1